@@ -9,24 +9,135 @@ bool Application::applicationInit()
 	renderManager.renderSetSamples(samples);
 	renderManager.renderSetDimension(width, height);
 	renderManager.renderSetFrames(swapchainImages.size());
+	renderManager.renderSetGeometryArena(geometryArena);
+	renderManager.renderSetLodThreshold(lodThreshold);
+	renderManager.renderSetClusterCulling(clusterCulling);
+	renderManager.renderSetDeformPrepass(deformPrepass);
+	renderManager.renderSetJointMatrices3x4(jointMatrices3x4);
+
+	WorldBuilderSettings worldBuilderSettings = {};
+	worldBuilderSettings.quantize = quantize;
+	worldBuilderSettings.optimize = optimize;
+	worldBuilderSettings.lod = lod;
+	worldBuilderSettings.crowdCount = crowdCount;
+	worldBuilderSettings.meshlets = clusterCulling;
+
+	WorldBuilder worldBuilder(glTF, environment, renderManager, worldBuilderSettings);
+	worldBuilder.setWorkerPool(workerPool);
+
+	// Build results are cached next to the glTF and reused, as long as the source and settings do not change.
+	std::string sceneCacheFilename = filename + ".cache";
+
+	SceneCache sceneCache;
+
+	// Checked as soon as the buffers are resolved. Images are only decoded, if the scene cache can not be used, and then overlap the rest of the parse.
+	auto skipImages = [&](const GLTF& source) {
+		uint64_t sourceHash = 0;
+		if (!SceneCache::hashSource(sourceHash, source, filename))
+		{
+			return false;
+		}
+
+		// Recorded images are block compressed or not, so the setting is part of the key.
+		uint64_t key = HelperHash::combine(HelperHash::combine(sourceHash, worldBuilder.getSettingsHash()), HelperBlockCompression::VERSION);
+		key = HelperHash::combine(key, compressTextures ? 1 : 0);
+		if (!sceneCache.open(sceneCacheFilename, key))
+		{
+			sceneCache.record(key);
+		}
 
-	HelperLoad helperLoad;
-	if(!helperLoad.open(glTF, filename))
+		worldBuilder.setSceneCache(sceneCache);
+
+		return sceneCache.isValid();
+	};
+
+	// Textures are only block compressed on request.
+	HelperParse helperParse;
+	helperParse.setCompressTextures(compressTextures);
+	if(!helperParse.open(glTF, filename, &workerPool, skipImages))
 	{
 		return false;
 	}
 
+	// Lossy, so only done on request.
+	if (compressAnimations)
+	{
+		std::vector<AnimationCompressionReport> animationCompressionReports;
+		if (!HelperAnimate::compress(animationCompressionReports, glTF))
+		{
+			return false;
+		}
+
+		size_t byteSizeBefore = 0;
+		size_t byteSizeAfter = 0;
+		float maximumError = 0.0f;
+		float maximumRotationError = 0.0f;
+		for (const AnimationCompressionReport& report : animationCompressionReports)
+		{
+			byteSizeBefore += report.byteSizeBefore;
+			byteSizeAfter += report.byteSizeAfter;
+
+			if (report.path == rotation)
+			{
+				maximumRotationError = glm::max(maximumRotationError, report.maximumError);
+			}
+			else
+			{
+				maximumError = glm::max(maximumError, report.maximumError);
+			}
+		}
+
+		Logger::print(TinyEngine_INFO, __FILE__, __LINE__, "Compressed %u animation channels from %.1f KB to %.1f KB, maximum error %f, rotation %f radians", static_cast<uint32_t>(animationCompressionReports.size()), byteSizeBefore / 1024.0, byteSizeAfter / 1024.0, maximumError, maximumRotationError);
+	}
+
 	if (!HelperUpdate::update(glTF, glm::mat4(1.0f)))
 	{
 		return false;
 	}
 
-	WorldBuilder worldBuilder(glTF, environment, renderManager);
+	// Crowds sample the joint matrices of the first animation from a texture.
+	std::vector<BakedJointMatrices> bakedJointMatrices(glTF.nodes.size());
+	bakedNodes.resize(glTF.nodes.size(), false);
+	if (crowdCount > 0)
+	{
+		for (size_t i = 0; i < glTF.nodes.size(); i++)
+		{
+			if (glTF.nodes[i].mesh < 0 || glTF.nodes[i].skin < 0)
+			{
+				continue;
+			}
+
+			if (!HelperAnimate::bakeJointMatrices(bakedJointMatrices[i], glTF, static_cast<int32_t>(i), 0))
+			{
+				continue;
+			}
+
+			Logger::print(TinyEngine_INFO, __FILE__, __LINE__, "Node %u: baked %u joints with %u frames", static_cast<uint32_t>(i), bakedJointMatrices[i].jointsCount, bakedJointMatrices[i].framesCount);
+
+			worldBuilder.setBakedJointMatrices(static_cast<int32_t>(i), bakedJointMatrices[i]);
+			bakedNodes[i] = true;
+		}
+
+		if (!HelperUpdate::update(glTF, glm::mat4(1.0f)))
+		{
+			return false;
+		}
+	}
+
 	if(!worldBuilder.build())
 	{
 		return false;
 	}
 
+	const RenderStatistics& renderStatistics = renderManager.renderGetStatistics();
+	Logger::print(TinyEngine_INFO, __FILE__, __LINE__, "Textures use %.1f MB, %.1f MB uncompressed", renderStatistics.textureMemory / (1024.0 * 1024.0), renderStatistics.textureMemoryUncompressed / (1024.0 * 1024.0));
+	Logger::print(TinyEngine_INFO, __FILE__, __LINE__, "Shared %u duplicate textures and %u duplicate samplers", static_cast<uint32_t>(renderStatistics.texturesDeduplicated), static_cast<uint32_t>(renderStatistics.samplersDeduplicated));
+
+	if (sceneCache.isRecording())
+	{
+		sceneCache.save(sceneCacheFilename);
+	}
+
 	nodeToHandles = worldBuilder.cloneNodeToHandles();
 
 	//
@@ -36,6 +147,32 @@ bool Application::applicationInit()
 	{
 		animationController.setStopTime(stop);
 		animationController.setPlay(true);
+
+		// Small characters are animated at a reduced rate and with less joints.
+		std::vector<AnimationLodLevel> lodLevels(3);
+		lodLevels[0].screenSize = 256.0f;
+		lodLevels[1].screenSize = 64.0f;
+		lodLevels[1].interval = 1.0f / 20.0f;
+		lodLevels[2].interval = 1.0f / 5.0f;
+		lodLevels[2].jointDepth = 4;
+
+		// Every skin has its own level of detail, so the joints are masked per skin. All other channels are evaluated every frame.
+		skinControllers.assign(glTF.skins.size(), AnimationController());
+		skinJointMasks.assign(glTF.skins.size(), std::vector<uint8_t>(glTF.nodes.size(), 0));
+		unskinnedMask.assign(glTF.nodes.size(), 1);
+		for (size_t i = 0; i < glTF.skins.size(); i++)
+		{
+			skinControllers[i].setLodLevels(lodLevels);
+
+			for (int32_t joint : glTF.skins[i].joints)
+			{
+				if (joint >= 0 && joint < static_cast<int32_t>(glTF.nodes.size()))
+				{
+					skinJointMasks[i][joint] = 1;
+					unskinnedMask[joint] = 0;
+				}
+			}
+		}
 	}
 	else
 	{
@@ -72,6 +209,29 @@ bool Application::applicationUpdate(uint32_t frameIndex, double deltaTime, doubl
 	ImGui::SliderFloat("World Scale", &worldScale, 0.1f, 10.0f, "ratio = %.1f");
 	ImGui::Separator();
 	ImGui::SliderFloat("Zoom Speed", &zoomSpeed, 0.01f, 0.1f, "ratio = %.2f");
+	if (crowdCount > 0 || clusterCulling || lod)
+	{
+		// Statistics of the last frame.
+		const RenderStatistics& renderStatistics = renderManager.renderGetStatistics();
+
+		ImGui::Separator();
+		if (crowdCount > 0)
+		{
+			ImGui::Text("Crowd: %u", crowdCount);
+		}
+		ImGui::Text("Frame: %.2f ms", 1000.0 * deltaTime);
+		ImGui::Text("Draw calls: %llu", static_cast<unsigned long long>(renderStatistics.drawCalls));
+		ImGui::Text("Triangles: %llu", static_cast<unsigned long long>(renderStatistics.trianglesSubmitted));
+		if (lod)
+		{
+			ImGui::Text("Full resolution: %llu", static_cast<unsigned long long>(renderStatistics.trianglesFullResolution));
+		}
+		if (clusterCulling)
+		{
+			ImGui::Text("Culled draws: %llu", static_cast<unsigned long long>(renderStatistics.cullDispatches));
+			ImGui::Text("Meshlets tested: %llu", static_cast<unsigned long long>(renderStatistics.meshletsTested));
+		}
+	}
 	ImGui::End();
 
 	ImGui::Render();
@@ -81,13 +241,55 @@ bool Application::applicationUpdate(uint32_t frameIndex, double deltaTime, doubl
 	if (animate)
 	{
 		animationController.updateCurrentTime(deltaTime);
-		HelperAnimate::update(glTF, 0, animationController.getCurrentTime());
+
+		// Visibility and size of the last frame. Nodes sharing a skin are one character.
+		std::vector<float> skinScreenSizes(glTF.skins.size(), 0.0f);
+		for (const Node& node : glTF.nodes)
+		{
+			float nodeScreenSize = 0.0f;
+			if (node.mesh >= 0 && node.skin >= 0 && renderManager.instanceGetScreenSize(nodeScreenSize, nodeToHandles[&node]))
+			{
+				skinScreenSizes[node.skin] = glm::max(skinScreenSizes[node.skin], nodeScreenSize);
+			}
+		}
+
+		std::vector<uint8_t> nodeMask = unskinnedMask;
+		for (size_t i = 0; i < skinControllers.size(); i++)
+		{
+			skinControllers[i].updateLod(skinScreenSizes[i], static_cast<float>(deltaTime));
+
+			if (skinControllers[i].isLodEvaluate())
+			{
+				for (size_t k = 0; k < nodeMask.size(); k++)
+				{
+					nodeMask[k] |= skinJointMasks[i][k];
+				}
+			}
+		}
+
+		// Skins, which are not evaluated this frame, keep blending from their stored joint matrices.
+		for (Node& node : glTF.nodes)
+		{
+			if (node.skin >= 0 && skinControllers[node.skin].isLodEvaluate())
+			{
+				node.previousJointMatrices = node.jointMatrices;
+				node.jointDepth = skinControllers[node.skin].getJointDepth();
+			}
+		}
+
+		HelperAnimate::update(glTF, 0, animationController.getCurrentTime(), nodeMask);
+	}
+	HelperUpdate::update(glTF, glm::scale(glm::vec3(worldScale)), &workerPool);
+
+	if (animate)
+	{
+		renderManager.worldUpdateTime(static_cast<float>(totalTime));
 	}
-	HelperUpdate::update(glTF, glm::scale(glm::vec3(worldScale)));
 
 	//
 
 	// Update the animations to the renderer.
+	std::vector<glm::mat4> jointMatrices;
 	for (size_t i = 0; i < glTF.nodes.size(); i++)
 	{
 		const Node& node = glTF.nodes[i];
@@ -97,18 +299,47 @@ bool Application::applicationUpdate(uint32_t frameIndex, double deltaTime, doubl
 		{
 			if (node.weights.size() > 0)
 			{
-				renderManager.instanceUpdateWeights(nodeToHandles[&node], node.weights, frameIndex);
+				renderManager.instanceUpdateWeights(nodeToHandles[&node], node.weights);
 			}
 
-			if (node.jointMatrices.size() > 0)
+			// Baked skinning is evaluated on the device.
+			if (node.jointMatrices.size() > 0 && !bakedNodes[i])
 			{
-				renderManager.instanceUpdateJointMatrices(nodeToHandles[&node], node.jointMatrices, frameIndex);
+				HelperAnimate::blendJointMatrices(jointMatrices, node, (node.skin >= 0 && node.skin < static_cast<int32_t>(skinControllers.size())) ? skinControllers[node.skin].getLodBlend() : 1.0f);
+
+				renderManager.instanceUpdateJointMatrices(nodeToHandles[&node], jointMatrices);
 			}
 		}
 	}
 
 	//
 
+	glm::mat4 projectionMatrix = Projection::perspective(45.0f, (float)width/(float)height, 0.1f, 100.0f);
+
+	glm::mat3 orbitMatrix = glm::rotate(rotY, glm::vec3(0.0f, 1.0f, 0.0f)) * glm::rotate(rotX, glm::vec3(1.0f, 0.0f, 0.0f));
+	glm::vec3 orbitEye = orbitMatrix * glm::vec3(0.0f, 0.0f, eyeObjectDistance);
+	glm::vec3 orbitCenter = orbitMatrix * glm::vec3(0.0f, 0.0f, 0.0f);
+
+	glm::mat4 viewMatrix = glm::translate(glm::vec3(posX, posY, 0.0f)) * glm::lookAt(orbitEye, orbitCenter, glm::vec3(0.0f, 1.0f, 0.0f));
+
+	renderManager.cameraUpdateProjectionMatrix(cameraHandle, projectionMatrix);
+	renderManager.cameraUpdateViewMatrix(cameraHandle, viewMatrix);
+
+	renderManager.renderResetStatistics();
+
+	// Compute pre-passes are recorded outside of the render pass and need the camera of this frame.
+	if (clusterCulling)
+	{
+		renderManager.cull(commandBuffers[frameIndex], frameIndex);
+	}
+
+	if (deformPrepass)
+	{
+		renderManager.deform(commandBuffers[frameIndex], frameIndex);
+	}
+
+	//
+
 	VkClearColorValue resolveClearColorValue = {};
 	resolveClearColorValue.float32[0] = 0.0f;
 	resolveClearColorValue.float32[1] = 0.0f;
@@ -151,17 +382,6 @@ bool Application::applicationUpdate(uint32_t frameIndex, double deltaTime, doubl
 
 	vkCmdBeginRenderPass(commandBuffers[frameIndex], &renderPassBeginInfo, VK_SUBPASS_CONTENTS_INLINE);
 
-	glm::mat4 projectionMatrix = Projection::perspective(45.0f, (float)width/(float)height, 0.1f, 100.0f);
-
-	glm::mat3 orbitMatrix = glm::rotate(rotY, glm::vec3(0.0f, 1.0f, 0.0f)) * glm::rotate(rotX, glm::vec3(1.0f, 0.0f, 0.0f));
-	glm::vec3 orbitEye = orbitMatrix * glm::vec3(0.0f, 0.0f, eyeObjectDistance);
-	glm::vec3 orbitCenter = orbitMatrix * glm::vec3(0.0f, 0.0f, 0.0f);
-
-	glm::mat4 viewMatrix = glm::translate(glm::vec3(posX, posY, 0.0f)) * glm::lookAt(orbitEye, orbitCenter, glm::vec3(0.0f, 1.0f, 0.0f));
-
-	renderManager.cameraUpdateProjectionMatrix(cameraHandle, projectionMatrix);
-	renderManager.cameraUpdateViewMatrix(cameraHandle, viewMatrix);
-
 	renderManager.draw(commandBuffers[frameIndex], frameIndex, OPAQUE);
 	renderManager.draw(commandBuffers[frameIndex], frameIndex, TRANSPARENT);
 
@@ -182,8 +402,8 @@ void Application::applicationTerminate()
 
 // Public
 
-Application::Application(const std::string& filename, const std::string& environment) :
-	filename(filename), environment(environment)
+Application::Application(const std::string& filename, const std::string& environment, uint32_t crowdCount) :
+	filename(filename), environment(environment), crowdCount(crowdCount)
 {
 }
 
@@ -191,6 +411,56 @@ Application::~Application()
 {
 }
 
+void Application::setQuantize(bool quantize)
+{
+	this->quantize = quantize;
+}
+
+void Application::setOptimize(bool optimize)
+{
+	this->optimize = optimize;
+}
+
+void Application::setLod(bool lod)
+{
+	this->lod = lod;
+}
+
+void Application::setLodThreshold(float lodThreshold)
+{
+	this->lodThreshold = lodThreshold;
+}
+
+void Application::setGeometryArena(bool geometryArena)
+{
+	this->geometryArena = geometryArena;
+}
+
+void Application::setClusterCulling(bool clusterCulling)
+{
+	this->clusterCulling = clusterCulling;
+}
+
+void Application::setDeformPrepass(bool deformPrepass)
+{
+	this->deformPrepass = deformPrepass;
+}
+
+void Application::setJointMatrices3x4(bool jointMatrices3x4)
+{
+	this->jointMatrices3x4 = jointMatrices3x4;
+}
+
+void Application::setCompressAnimations(bool compressAnimations)
+{
+	this->compressAnimations = compressAnimations;
+}
+
+void Application::setCompressTextures(bool compressTextures)
+{
+	this->compressTextures = compressTextures;
+}
+
 void Application::orbitY(float orbit)
 {
 	if (!focused)
@@ -12,11 +12,29 @@ private:
 	RenderManager renderManager;
 	GLTF glTF;
 	AnimationController animationController;
+	std::vector<AnimationController> skinControllers;
+	std::vector<std::vector<uint8_t>> skinJointMasks;
+	std::vector<uint8_t> unskinnedMask;
+	WorkerPool workerPool;
 	std::map<const Node*, uint64_t> nodeToHandles;
 
 	std::string filename = "";
 	std::string environment = "";
 
+	uint32_t crowdCount = 0;
+	std::vector<bool> bakedNodes;
+
+	bool quantize = false;
+	bool optimize = false;
+	bool lod = false;
+	float lodThreshold = 1.0f;
+	bool geometryArena = false;
+	bool clusterCulling = false;
+	bool deformPrepass = false;
+	bool jointMatrices3x4 = false;
+	bool compressAnimations = false;
+	bool compressTextures = false;
+
 	float eyeObjectDistance = 5.0f;
 	float rotY = 0.0f;
 	float rotX = 0.0f;
@@ -35,9 +53,39 @@ private:
 	virtual void applicationTerminate();
 
 public:
-	Application(const std::string& filename, const std::string& environment);
+	Application(const std::string& filename, const std::string& environment, uint32_t crowdCount = 0);
 	~Application();
 
+	// Vertex data is quantized on import and the maximum errors are logged. Has to be set before init.
+	void setQuantize(bool quantize);
+
+	// Triangles and vertices are reordered on import and the cache statistics are logged per primitive. Has to be set before init.
+	void setOptimize(bool optimize);
+
+	// Simplified index buffers are generated on import and selected by the projected error. Has to be set before init.
+	void setLod(bool lod);
+
+	// Projected error in pixels, below which a level of detail is drawn.
+	void setLodThreshold(float lodThreshold);
+
+	// Vertices and indices are copied into shared buffers, so primitives are drawn without rebinding. Has to be set before init.
+	void setGeometryArena(bool geometryArena);
+
+	// Meshlets are built on import and culled on the device. Has to be set before init.
+	void setClusterCulling(bool clusterCulling);
+
+	// Skinned and morphed meshes are deformed in a compute pass before the render pass. Has to be set before init.
+	void setDeformPrepass(bool deformPrepass);
+
+	// Joint matrices are uploaded as three rows, which saves a quarter of the animation updates. Has to be set before init.
+	void setJointMatrices3x4(bool jointMatrices3x4);
+
+	// Animation keys are reduced and quantized within the default tolerances. Has to be set before init.
+	void setCompressAnimations(bool compressAnimations);
+
+	// Images are block compressed and cached next to their source, if the directory is writable. Has to be set before init.
+	void setCompressTextures(bool compressTextures);
+
 	void orbitY(float orbit);
 	void orbitX(float orbit);
 
@@ -1,24 +1,192 @@
 #include "Application.h"
 
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
 #include <GLFW/glfw3.h>
 
 #define APP_WIDTH 1920
 #define APP_HEIGHT 1080
 #define APP_TITLE "Application"
 
+// Compares the loaders on a generated scene with a flat hierarchy of nodes.
+static int benchmarkParse(uint32_t nodesCount)
+{
+	std::string filename = "benchmark_parse.gltf";
+
+	std::string output = "{\"asset\":{\"version\":\"2.0\"},\"scene\":0,\"scenes\":[{\"nodes\":[0]}],\"nodes\":[{\"name\":\"root\",\"children\":[";
+	for (uint32_t i = 1; i < nodesCount; i++)
+	{
+		output += std::to_string(i) + (i + 1 < nodesCount ? "," : "");
+	}
+	output += "]}";
+	for (uint32_t i = 1; i < nodesCount; i++)
+	{
+		output += ",{\"name\":\"node" + std::to_string(i) + "\",\"translation\":[" + std::to_string(i * 0.5f) + ",1.25,-3.0],\"rotation\":[0.0,0.7071068,0.0,0.7071068],\"scale\":[1.0,2.0,1.0]}";
+	}
+	output += "]}";
+
+	if (!FileIO::save(output, filename))
+	{
+		return -1;
+	}
+
+	GLTF parsedGlTF;
+	auto start = std::chrono::steady_clock::now();
+	HelperParse helperParse;
+	if (!helperParse.open(parsedGlTF, filename))
+	{
+		return -1;
+	}
+	double parseTime = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+	GLTF loadedGlTF;
+	start = std::chrono::steady_clock::now();
+	HelperLoad helperLoad;
+	if (!helperLoad.open(loadedGlTF, filename))
+	{
+		return -1;
+	}
+	double loadTime = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+	bool identical = (parsedGlTF.nodes.size() == loadedGlTF.nodes.size());
+	for (size_t i = 0; identical && i < parsedGlTF.nodes.size(); i++)
+	{
+		identical = parsedGlTF.nodes[i].translation == loadedGlTF.nodes[i].translation && parsedGlTF.nodes[i].rotation == loadedGlTF.nodes[i].rotation && parsedGlTF.nodes[i].scale == loadedGlTF.nodes[i].scale && parsedGlTF.nodes[i].children == loadedGlTF.nodes[i].children;
+	}
+
+	Logger::print(TinyEngine_INFO, __FILE__, __LINE__, "%u nodes, %.1f MB: HelperParse %.2f ms, HelperLoad %.2f ms, %s", nodesCount, output.size() / (1024.0 * 1024.0), parseTime, loadTime, identical ? "identical" : "different");
+
+	return identical ? 0 : -1;
+}
+
+// Packs a directory, e.g. '--pack ../Resources ../Resources.pack zstd'.
+static int pack(int argc, char **argv)
+{
+	if (argc < 4)
+	{
+		Logger::print(TinyEngine_ERROR, __FILE__, __LINE__, "Usage: --pack directory archive [zstd|lz4]");
+
+		return -1;
+	}
+
+	PackCompression compression = PackCompression_NONE;
+	if (argc > 4)
+	{
+		if (strcmp(argv[4], "zstd") == 0)
+		{
+			compression = PackCompression_ZSTD;
+		}
+		else if (strcmp(argv[4], "lz4") == 0)
+		{
+			compression = PackCompression_LZ4;
+		}
+	}
+
+	return PackFile::pack(argv[3], argv[2], compression) ? 0 : -1;
+}
+
 int main(int argc, char **argv)
 {
+	if (argc > 1 && strcmp(argv[1], "--benchmark-parse") == 0)
+	{
+		return benchmarkParse(argc > 2 ? static_cast<uint32_t>(atoi(argv[2])) : 100000);
+	}
+
+	if (argc > 1 && strcmp(argv[1], "--pack") == 0)
+	{
+		return pack(argc, argv);
+	}
+
+	// Resources are read from the archive, if one is deployed.
+	if (HelperFile::exists("../Resources.pack") && !VirtualFile::mount("../Resources.pack", "../Resources"))
+	{
+		return -1;
+	}
+
 	std::string filename = "../Resources/glTF/AnimatedCube/AnimatedCube.gltf";
 
 	std::string environment = "../Resources/brdf/doge2";
 
-	if (argc > 1)
+	// Skinned meshes are baked and drawn this many times, e.g. 10000 to benchmark large crowds.
+	uint32_t crowdCount = 0;
+
+	// Options can be given anywhere, e.g. '--cluster-culling' to compare the frame time with and without.
+	bool quantize = false;
+	bool optimize = false;
+	bool lod = false;
+	float lodThreshold = 1.0f;
+	bool geometryArena = false;
+	bool clusterCulling = false;
+	bool compressAnimations = false;
+	bool compressTextures = false;
+	bool deformPrepass = false;
+	bool jointMatrices3x4 = false;
+
+	std::vector<std::string> arguments;
+	for (int i = 1; i < argc; i++)
 	{
-		filename = argv[1];
+		if (strcmp(argv[i], "--quantize") == 0)
+		{
+			quantize = true;
+		}
+		else if (strcmp(argv[i], "--optimize") == 0)
+		{
+			optimize = true;
+		}
+		else if (strcmp(argv[i], "--lod") == 0)
+		{
+			lod = true;
+		}
+		else if (strcmp(argv[i], "--lod-threshold") == 0 && i + 1 < argc)
+		{
+			lodThreshold = static_cast<float>(atof(argv[++i]));
+		}
+		else if (strcmp(argv[i], "--geometry-arena") == 0)
+		{
+			geometryArena = true;
+		}
+		else if (strcmp(argv[i], "--cluster-culling") == 0)
+		{
+			clusterCulling = true;
+		}
+		else if (strcmp(argv[i], "--deform-prepass") == 0)
+		{
+			deformPrepass = true;
+		}
+		else if (strcmp(argv[i], "--joint-matrices-3x4") == 0)
+		{
+			jointMatrices3x4 = true;
+		}
+		else if (strcmp(argv[i], "--compress-animations") == 0)
+		{
+			compressAnimations = true;
+		}
+		else if (strcmp(argv[i], "--compress-textures") == 0)
+		{
+			compressTextures = true;
+		}
+		else
+		{
+			arguments.push_back(argv[i]);
+		}
+	}
 
-		if (argc > 2)
+	if (arguments.size() > 0)
+	{
+		filename = arguments[0];
+
+		if (arguments.size() > 1)
 		{
-			environment = argv[2];
+			environment = arguments[1];
+
+			if (arguments.size() > 2)
+			{
+				crowdCount = static_cast<uint32_t>(atoi(arguments[2].c_str()));
+			}
 		}
 	}
 
@@ -38,7 +206,17 @@ int main(int argc, char **argv)
 	    return -1;
 	}
 
-	Application application(filename, environment);
+	Application application(filename, environment, crowdCount);
+	application.setQuantize(quantize);
+	application.setOptimize(optimize);
+	application.setLod(lod);
+	application.setLodThreshold(lodThreshold);
+	application.setGeometryArena(geometryArena);
+	application.setClusterCulling(clusterCulling);
+	application.setCompressAnimations(compressAnimations);
+	application.setCompressTextures(compressTextures);
+	application.setDeformPrepass(deformPrepass);
+	application.setJointMatrices3x4(jointMatrices3x4);
 	application.setApplicationName(APP_TITLE);
 	application.setUseImgui(true);
 	application.setMinor(2);
@@ -69,12 +69,12 @@ bool Application::applicationUpdate(uint32_t frameIndex, double deltaTime, doubl
 		{
 			if (node.weights.size() > 0)
 			{
-				renderManager.instanceUpdateWeights(nodeToHandles[&node], node.weights, frameIndex);
+				renderManager.instanceUpdateWeights(nodeToHandles[&node], node.weights);
 			}
 
 			if (node.jointMatrices.size() > 0)
 			{
-				renderManager.instanceUpdateJointMatrices(nodeToHandles[&node], node.jointMatrices, frameIndex);
+				renderManager.instanceUpdateJointMatrices(nodeToHandles[&node], node.jointMatrices);
 			}
 		}
 	}
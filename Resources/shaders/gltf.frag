@@ -221,8 +221,15 @@ vec3 getNormal()
 
     mat3 tbn = mat3(tangent, bitangent, normal);
 
+#ifdef NORMAL_XY
+    vec3 n = vec3(texture(u_normalTexture, NORMAL_TEXCOORD.st).rg, 0.0);
+    n.xy = 2.0 * n.xy - 1.0;
+    n.z = sqrt(max(1.0 - dot(n.xy, n.xy), 0.0));
+    n = normalize(n * vec3(in_ub.normalScale, in_ub.normalScale, 1.0));
+#else
     vec3 n = texture(u_normalTexture, NORMAL_TEXCOORD.st).rgb;
     n = normalize((2.0 * n - 1.0) * vec3(in_ub.normalScale, in_ub.normalScale, 1.0));
+#endif
 
     normal = tbn * n;
 #endif
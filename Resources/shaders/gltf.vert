@@ -8,12 +8,27 @@ layout(push_constant) uniform UniformPushConstant {
     uint attributeCount;
 
     uint targetsCount;
+
+    uint vertexOffset;
+
+    uint jointMatricesOffset;
+
+    uint weightsOffset;
+
+    float time;
+
+    vec4 positionDequantizeScale;
+    vec4 positionDequantizeOffset;
 } in_upc;
 
 layout (location = POSITION_LOC) in vec3 in_position;
 #ifdef NORMAL_VEC3
+#ifdef NORMAL_OCT
+layout (location = NORMAL_LOC) in vec2 in_normal;
+#else
 layout (location = NORMAL_LOC) in vec3 in_normal;
 #endif
+#endif
 #ifdef TANGENT_VEC4
 layout (location = TANGENT_LOC) in vec4 in_tangent;
 #endif
@@ -64,36 +79,151 @@ layout (location = 7) out vec4 out_color;
 layout (location = 7) out vec4 out_color;
 #endif
 
+#ifdef HAS_TARGETS
+layout (binding = TARGET_OFFSET_BINDING) readonly buffer Offset {
+    uint i[];
+} u_targetOffset;
+#endif
 #ifdef HAS_TARGET_POSITION
-layout (binding = TARGET_POSITION_BINDING) buffer Position {
-    float i[];
+layout (binding = TARGET_POSITION_BINDING) readonly buffer Position {
+    uvec2 i[];
 } u_targetPosition;
 #endif
 #ifdef HAS_TARGET_NORMAL
-layout (binding = TARGET_NORMAL_BINDING) buffer Normal {
-    float i[];
+layout (binding = TARGET_NORMAL_BINDING) readonly buffer Normal {
+    uvec2 i[];
 } u_targetNormal;
 #endif
 #ifdef HAS_TARGET_TANGENT
-layout (binding = TARGET_TANGENT_BINDING) buffer Tangent {
-    float i[];
+layout (binding = TARGET_TANGENT_BINDING) readonly buffer Tangent {
+    uvec2 i[];
 } u_targetTangent;
 #endif
 
-#ifdef HAS_WEIGHTS
-layout (binding = WEIGHTS_BINDING) uniform Weights { 
-    vec4 i[TARGETS_COUNT];
-} u_weights;
+#if defined(HAS_WEIGHTS) || (defined(HAS_JOINTS) && !defined(HAS_BAKED_JOINTS))
+// Weights and joint matrices of all instances, addressed by the offsets.
+layout (binding = ANIMATION_BINDING) readonly buffer Animation {
+    uvec4 i[];
+} u_animation;
 #endif
 
-#ifdef HAS_JOINTS
-layout (binding = JOINT_MATRICES_BINDING) uniform JointMatrices { 
-    mat4 i[JOINT_MATRICES_COUNT];
-} u_jointMatrices;
+#ifdef HAS_BAKED_JOINTS
+// Three rows of the joint matrices per joint, one row of texels per frame.
+layout (binding = BAKED_JOINTS_BINDING) uniform sampler2D u_bakedJoints;
+#endif
+
+#ifdef HAS_CROWD
+struct CrowdMember {
+    mat4 worldMatrix;
+
+    float timeOffset;
+    float speed;
+
+    vec2 padding;
+};
+
+layout (binding = CROWD_BINDING) readonly buffer Crowd {
+    CrowdMember i[];
+} u_crowd;
 #endif
 
 layout (location = 8) flat out float out_determinant;
 
+#ifdef NORMAL_OCT
+vec3 decodeOctahedral(vec2 octahedral)
+{
+    vec3 normal = vec3(octahedral.x, octahedral.y, 1.0 - abs(octahedral.x) - abs(octahedral.y));
+    float t = max(-normal.z, 0.0);
+    normal.x += normal.x >= 0.0 ? -t : t;
+    normal.y += normal.y >= 0.0 ? -t : t;
+    return normalize(normal);
+}
+#endif
+
+#if defined(HAS_TARGETS) && defined(HAS_WEIGHTS)
+// Target index and weight bits of the active entry.
+uvec2 getActiveWeight(uint active)
+{
+    uvec4 pair = u_animation.i[in_upc.weightsOffset + 1 + active / 2];
+    return (active % 2) == 0 ? pair.xy : pair.zw;
+}
+#endif
+
+#if defined(HAS_TARGETS) && defined(HAS_WEIGHTS)
+vec3 unpackDelta(uvec2 delta)
+{
+    return vec3(unpackHalf2x16(delta.x), unpackHalf2x16(delta.y).x);
+}
+
+// Merges the vertex entries, sorted by target, with the active weights, also sorted by target.
+void morph(uint vertexIndex, inout vec3 position, inout vec3 normal, inout vec3 tangent)
+{
+    uint activeCount = u_animation.i[in_upc.weightsOffset].x;
+    uint active = 0;
+
+    for (uint entry = u_targetOffset.i[vertexIndex]; entry < u_targetOffset.i[vertexIndex + 1] && active < activeCount; entry++)
+    {
+#if defined(HAS_TARGET_POSITION)
+        uint target = u_targetPosition.i[entry].y >> 16;
+#elif defined(HAS_TARGET_NORMAL)
+        uint target = u_targetNormal.i[entry].y >> 16;
+#else
+        uint target = u_targetTangent.i[entry].y >> 16;
+#endif
+
+        uvec2 activeWeight = getActiveWeight(active);
+        while (activeWeight.x < target && ++active < activeCount)
+        {
+            activeWeight = getActiveWeight(active);
+        }
+        if (activeWeight.x != target)
+        {
+            continue;
+        }
+
+        float weight = uintBitsToFloat(activeWeight.y);
+#ifdef HAS_TARGET_POSITION
+        position += weight * unpackDelta(u_targetPosition.i[entry]);
+#endif
+#ifdef HAS_TARGET_NORMAL
+        normal += weight * unpackDelta(u_targetNormal.i[entry]);
+#endif
+#ifdef HAS_TARGET_TANGENT
+        tangent += weight * unpackDelta(u_targetTangent.i[entry]);
+#endif
+    }
+}
+#endif
+
+#ifdef HAS_BAKED_JOINTS
+// Neighbouring frames of the current time and the blend factor between them.
+ivec2 bakedFrames = ivec2(0);
+float bakedBlend = 0.0;
+#endif
+
+#ifdef HAS_JOINTS
+mat4 getJoint(uint index)
+{
+#if defined(HAS_BAKED_JOINTS)
+    int x = 3 * int(index);
+    vec4 row0 = mix(texelFetch(u_bakedJoints, ivec2(x + 0, bakedFrames.x), 0), texelFetch(u_bakedJoints, ivec2(x + 0, bakedFrames.y), 0), bakedBlend);
+    vec4 row1 = mix(texelFetch(u_bakedJoints, ivec2(x + 1, bakedFrames.x), 0), texelFetch(u_bakedJoints, ivec2(x + 1, bakedFrames.y), 0), bakedBlend);
+    vec4 row2 = mix(texelFetch(u_bakedJoints, ivec2(x + 2, bakedFrames.x), 0), texelFetch(u_bakedJoints, ivec2(x + 2, bakedFrames.y), 0), bakedBlend);
+    return transpose(mat4(row0, row1, row2, vec4(0.0, 0.0, 0.0, 1.0)));
+#elif defined(JOINT_MATRICES_3X4)
+    // Stored as the first three rows of the matrix.
+    uint offset = in_upc.jointMatricesOffset + 3 * index;
+    vec4 row0 = uintBitsToFloat(u_animation.i[offset + 0]);
+    vec4 row1 = uintBitsToFloat(u_animation.i[offset + 1]);
+    vec4 row2 = uintBitsToFloat(u_animation.i[offset + 2]);
+    return transpose(mat4(row0, row1, row2, vec4(0.0, 0.0, 0.0, 1.0)));
+#else
+    uint offset = in_upc.jointMatricesOffset + 4 * index;
+    return mat4(uintBitsToFloat(u_animation.i[offset + 0]), uintBitsToFloat(u_animation.i[offset + 1]), uintBitsToFloat(u_animation.i[offset + 2]), uintBitsToFloat(u_animation.i[offset + 3]));
+#endif
+}
+#endif
+
 #ifdef HAS_JOINTS
 mat4 getJointMatrix()
 {
@@ -102,20 +232,20 @@ mat4 getJointMatrix()
     #ifdef JOINTS_0_VEC4
     #ifdef WEIGHTS_0_VEC4
     jointMatrix +=
-        in_weights0.x * u_jointMatrices.i[in_joints0.x] +
-        in_weights0.y * u_jointMatrices.i[in_joints0.y] +
-        in_weights0.z * u_jointMatrices.i[in_joints0.z] +
-        in_weights0.w * u_jointMatrices.i[in_joints0.w];
+        in_weights0.x * getJoint(in_joints0.x) +
+        in_weights0.y * getJoint(in_joints0.y) +
+        in_weights0.z * getJoint(in_joints0.z) +
+        in_weights0.w * getJoint(in_joints0.w);
     #endif
     #endif
 
     #ifdef JOINTS_1_VEC4
     #ifdef WEIGHTS_1_VEC4
     jointMatrix +=
-        in_weights1.x * u_jointMatrices.i[in_joints1.x] +
-        in_weights1.y * u_jointMatrices.i[in_joints1.y] +
-        in_weights1.z * u_jointMatrices.i[in_joints1.z] +
-        in_weights1.w * u_jointMatrices.i[in_joints1.w];
+        in_weights1.x * getJoint(in_joints1.x) +
+        in_weights1.y * getJoint(in_joints1.y) +
+        in_weights1.z * getJoint(in_joints1.z) +
+        in_weights1.w * getJoint(in_joints1.w);
     #endif
     #endif
 
@@ -125,7 +255,25 @@ mat4 getJointMatrix()
 
 void main()
 {
+    // Geometry in an arena is drawn with a vertex offset, but the targets start at zero.
+    uint vertexIndex = uint(gl_VertexIndex) - in_upc.vertexOffset;
+
     mat4 worldMatrix = in_upc.world;
+    float time = in_upc.time;
+
+#ifdef HAS_CROWD
+    CrowdMember crowdMember = u_crowd.i[gl_InstanceIndex];
+    worldMatrix = crowdMember.worldMatrix * worldMatrix;
+    time = time * crowdMember.speed + crowdMember.timeOffset;
+#endif
+
+#ifdef HAS_BAKED_JOINTS
+    // Looped, the last frame equals the end of the animation.
+    float frame = fract(time / BAKED_DURATION) * float(BAKED_FRAMES_COUNT - 1);
+    bakedFrames = ivec2(int(frame), min(int(frame) + 1, BAKED_FRAMES_COUNT - 1));
+    bakedBlend = fract(frame);
+#endif
+
     mat3 tangentMatrix = mat3(worldMatrix);
     mat3 normalMatrix = transpose(inverse(tangentMatrix));
 
@@ -139,27 +287,26 @@ void main()
     normalMatrix = normalMatrix * normalJointMatrix;
 #endif
 
+    vec3 positionDelta = vec3(0.0);
+    vec3 normalDelta = vec3(0.0);
+    vec3 tangentDelta = vec3(0.0);
+#if defined(HAS_TARGETS) && defined(HAS_WEIGHTS)
+    morph(vertexIndex, positionDelta, normalDelta, tangentDelta);
+#endif
+
 #ifdef NORMAL_VEC3
+#ifdef NORMAL_OCT
+    vec3 normal = decodeOctahedral(in_normal);
+#else
     vec3 normal = in_normal;
-#ifdef HAS_TARGET_NORMAL
-    for (uint target = 0; target < in_upc.targetsCount; target++)
-    {
-        uint index = 3 * gl_VertexIndex + 3 * target * in_upc.attributeCount;
-        normal += u_weights.i[target / 4][target % 4] * vec3(u_targetNormal.i[index + 0], u_targetNormal.i[index + 1], u_targetNormal.i[index + 2]);
-    }
 #endif
+    normal += normalDelta;
     out_normal = normalMatrix * normal;
 #endif
 
 #ifdef TANGENT_VEC4
     vec3 tangent = in_tangent.xyz;
-#ifdef HAS_TARGET_TANGENT
-    for (uint target = 0; target < in_upc.targetsCount; target++)
-    {
-        uint index = 3 * gl_VertexIndex + 3 * target * in_upc.attributeCount;
-        tangent += u_weights.i[target / 4][target % 4] * vec3(u_targetTangent.i[index + 0], u_targetTangent.i[index + 1], u_targetTangent.i[index + 2]);
-    }
-#endif
+    tangent += tangentDelta;
     vec3 bitangent = cross(normal, tangent) * in_tangent.w;
     out_tangent = tangentMatrix * tangent;
     out_bitangent = tangentMatrix * bitangent;
@@ -180,14 +327,10 @@ void main()
 #endif
 
     vec3 tempPosition = in_position;
-#ifdef HAS_TARGET_POSITION
-    for (uint target = 0; target < in_upc.targetsCount; target++)
-    {
-        uint index = 3 * gl_VertexIndex + 3 * target * in_upc.attributeCount;
-
-        tempPosition += u_weights.i[target / 4][target % 4] * vec3(u_targetPosition.i[index + 0], u_targetPosition.i[index + 1], u_targetPosition.i[index + 2]);
-    }
+#ifdef POSITION_DEQUANTIZE
+    tempPosition = tempPosition * in_upc.positionDequantizeScale.xyz + in_upc.positionDequantizeOffset.xyz;
 #endif
+    tempPosition += positionDelta;
     vec4 position = vec4(tempPosition, 1.0);
     position = worldMatrix * position;
     out_position = position.xyz / position.w;
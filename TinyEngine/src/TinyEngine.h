@@ -16,6 +16,7 @@
 
 #include "composite/Composite.h"
 #include "gltf/GLTF.h"
+#include "geometry/Geometry.h"
 
 #include "render/Render.h"
 #include "wsi/Wsi.h"
@@ -1,5 +1,7 @@
 #include "AnimationController.h"
 
+#include <algorithm>
+
 #include "../math/Math.h"
 
 AnimationController::AnimationController()
@@ -120,3 +122,134 @@ void AnimationController::updateCurrentTime(float deltaTime)
 
 	this->currentTime = glm::clamp(currentTime, startTime, stopTime);
 }
+
+void AnimationController::setLodLevels(const std::vector<AnimationLodLevel>& lodLevels)
+{
+	this->lodLevels = lodLevels;
+
+	std::sort(this->lodLevels.begin(), this->lodLevels.end(), [](const AnimationLodLevel& a, const AnimationLodLevel& b) { return a.screenSize > b.screenSize; });
+
+	lod = 0;
+	lodElapsed = 0.0f;
+	lodBlend = 1.0f;
+	lodEvaluate = true;
+	lodResume = false;
+	lodHold = false;
+}
+
+const std::vector<AnimationLodLevel>& AnimationController::getLodLevels() const
+{
+	return lodLevels;
+}
+
+void AnimationController::setHiddenInterval(float hiddenInterval)
+{
+	this->hiddenInterval = hiddenInterval;
+}
+
+float AnimationController::getHiddenInterval() const
+{
+	return hiddenInterval;
+}
+
+void AnimationController::updateLod(float screenSize, float deltaTime)
+{
+	lodEvaluate = true;
+	lodBlend = 1.0f;
+
+	if (lodLevels.size() == 0)
+	{
+		lod = 0;
+
+		return;
+	}
+
+	float interval = 0.0f;
+	if (screenSize <= 0.0f)
+	{
+		lod = static_cast<uint32_t>(lodLevels.size()) - 1;
+
+		if (hiddenInterval < 0.0f)
+		{
+			lodEvaluate = false;
+			lodElapsed = 0.0f;
+			lodResume = true;
+
+			return;
+		}
+
+		interval = hiddenInterval;
+	}
+	else
+	{
+		lod = static_cast<uint32_t>(lodLevels.size()) - 1;
+		for (uint32_t i = 0; i < static_cast<uint32_t>(lodLevels.size()); i++)
+		{
+			if (screenSize >= lodLevels[i].screenSize)
+			{
+				lod = i;
+
+				break;
+			}
+		}
+
+		interval = lodLevels[lod].interval;
+	}
+
+	if (interval <= 0.0f)
+	{
+		lodElapsed = 0.0f;
+		lodResume = false;
+		lodHold = false;
+
+		return;
+	}
+
+	// After a pause, the stored matrices are outdated, so the evaluated pose is kept until the next evaluation.
+	if (lodResume)
+	{
+		lodElapsed = 0.0f;
+		lodResume = false;
+		lodHold = true;
+
+		return;
+	}
+
+	lodElapsed += deltaTime;
+	if (lodElapsed >= interval)
+	{
+		lodElapsed = 0.0f;
+		lodBlend = 0.0f;
+		lodHold = false;
+
+		return;
+	}
+
+	lodEvaluate = false;
+	lodBlend = lodHold ? 1.0f : lodElapsed / interval;
+}
+
+uint32_t AnimationController::getLod() const
+{
+	return lod;
+}
+
+bool AnimationController::isLodEvaluate() const
+{
+	return lodEvaluate;
+}
+
+float AnimationController::getLodBlend() const
+{
+	return lodBlend;
+}
+
+uint32_t AnimationController::getJointDepth() const
+{
+	if (lod >= lodLevels.size())
+	{
+		return 0;
+	}
+
+	return lodLevels[lod].jointDepth;
+}
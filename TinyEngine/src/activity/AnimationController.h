@@ -1,6 +1,9 @@
 #ifndef ACTIVITY_ANIMATIONCONTROLLER_H_
 #define ACTIVITY_ANIMATIONCONTROLLER_H_
 
+#include <cstdint>
+#include <vector>
+
 enum AnimationType {
 	PLAY_ONCE,
 	PLAY_ONCE_REVERSE,
@@ -9,6 +12,17 @@ enum AnimationType {
 	PLAY_PING_PONG
 };
 
+struct AnimationLodLevel {
+	// Minimum projected size in pixels.
+	float screenSize = 0.0f;
+
+	// Seconds between two evaluations, zero evaluates every frame.
+	float interval = 0.0f;
+
+	// Joints at or below this depth are not animated for skinning, zero uses all joints.
+	uint32_t jointDepth = 0;
+};
+
 class AnimationController {
 private:
 	float startTime = 0.0f;
@@ -22,6 +36,16 @@ private:
 
 	AnimationType animationType = PLAY_LOOP;
 
+	std::vector<AnimationLodLevel> lodLevels;
+	float hiddenInterval = -1.0f;
+
+	uint32_t lod = 0;
+	float lodElapsed = 0.0f;
+	float lodBlend = 1.0f;
+	bool lodEvaluate = true;
+	bool lodResume = false;
+	bool lodHold = false;
+
 public:
 	AnimationController();
 	~AnimationController();
@@ -45,6 +69,27 @@ public:
 
 	void updateCurrentTime(float deltaTime);
 
+	// Levels are sorted by decreasing screen size.
+	void setLodLevels(const std::vector<AnimationLodLevel>& lodLevels);
+	const std::vector<AnimationLodLevel>& getLodLevels() const;
+
+	// Seconds between two evaluations outside of the view, negative does not evaluate at all.
+	void setHiddenInterval(float hiddenInterval);
+	float getHiddenInterval() const;
+
+	// Selects the level by the projected size, where zero is outside of the view.
+	void updateLod(float screenSize, float deltaTime);
+
+	uint32_t getLod() const;
+
+	// The animation has to be evaluated in this frame.
+	bool isLodEvaluate() const;
+
+	// Blend factor between the previous and the last evaluation.
+	float getLodBlend() const;
+
+	uint32_t getJointDepth() const;
+
 };
 
 #endif /* ACTIVITY_ANIMATIONCONTROLLER_H_ */
@@ -1,6 +1,7 @@
 #ifndef BUILDER_BUILDER_H_
 #define BUILDER_BUILDER_H_
 
+#include "SceneCache.h"
 #include "WorldBuilder.h"
 
 #endif /* BUILDER_BUILDER_H_ */
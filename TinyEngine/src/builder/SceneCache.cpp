@@ -0,0 +1,275 @@
+#include "SceneCache.h"
+
+#include "../shader/Shader.h"
+
+// Magic, version, key, file size and offset of the shaders.
+static const size_t HEADER_SIZE = 32;
+
+SceneCache::SceneCache()
+{
+}
+
+void SceneCache::align()
+{
+	if (recording)
+	{
+		output.resize((output.size() + ALIGNMENT - 1) & ~(ALIGNMENT - 1), '\0');
+	}
+	else
+	{
+		offset = (offset + ALIGNMENT - 1) & ~(ALIGNMENT - 1);
+	}
+}
+
+bool SceneCache::hashSource(uint64_t& sourceHash, const GLTF& glTF, const std::string& filename)
+{
+	MappedFile file;
+	if (!file.open(filename))
+	{
+		return false;
+	}
+
+	sourceHash = HelperHash::hash(file.getData(), file.getSize());
+
+	// Embedded buffers are part of the file, but hashing them again is cheap compared to decoding.
+	for (const Buffer& buffer : glTF.buffers)
+	{
+		sourceHash = HelperHash::combine(sourceHash, HelperHash::hash(HelperAccess::accessData(buffer), buffer.byteLength));
+	}
+
+	// Images in buffer views or data URIs are already covered.
+	std::string path = HelperFile::getPath(filename);
+	for (const Image& image : glTF.images)
+	{
+		if (image.uri == "" || image.uri.compare(0, 5, "data:") == 0)
+		{
+			continue;
+		}
+
+		MappedFile imageFile;
+		if (!imageFile.open(path + image.uri))
+		{
+			return false;
+		}
+
+		sourceHash = HelperHash::combine(sourceHash, HelperHash::hash(imageFile.getData(), imageFile.getSize()));
+	}
+
+	return true;
+}
+
+bool SceneCache::open(const std::string& filename, uint64_t key)
+{
+	valid = false;
+	offset = 0;
+
+	if (!mappedFile.open(filename))
+	{
+		return false;
+	}
+
+	uint32_t magic = 0;
+	uint32_t version = 0;
+	uint64_t fileKey = 0;
+	uint64_t fileSize = 0;
+	uint64_t shadersOffset = 0;
+	if (!read(&magic, sizeof(magic)) || !read(&version, sizeof(version)) || !read(&fileKey, sizeof(fileKey)) || !read(&fileSize, sizeof(fileSize)) || !read(&shadersOffset, sizeof(shadersOffset)))
+	{
+		mappedFile.close();
+
+		return false;
+	}
+
+	// Outdated or partially written caches are rebuilt.
+	if (magic != MAGIC || version != VERSION || fileKey != key || fileSize != mappedFile.getSize() || shadersOffset < HEADER_SIZE || shadersOffset > fileSize)
+	{
+		Logger::print(TinyEngine_INFO, __FILE__, __LINE__, "Scene cache '%s' is outdated", filename.c_str());
+
+		mappedFile.close();
+
+		return false;
+	}
+
+	// Shaders
+
+	offset = static_cast<size_t>(shadersOffset);
+
+	uint32_t shadersCount = 0;
+	if (!read(&shadersCount, sizeof(shadersCount)))
+	{
+		mappedFile.close();
+
+		return false;
+	}
+
+	std::vector<CompiledShader> compiledShaders(shadersCount);
+	for (CompiledShader& compiledShader : compiledShaders)
+	{
+		if (!readValue(compiledShader.key) || !readString(compiledShader.macros) || !readVector(compiledShader.spirv))
+		{
+			mappedFile.close();
+
+			return false;
+		}
+	}
+
+	for (const CompiledShader& compiledShader : compiledShaders)
+	{
+		Compiler::addCompiledShader(compiledShader);
+	}
+
+	//
+
+	offset = HEADER_SIZE;
+	valid = true;
+
+	Logger::print(TinyEngine_INFO, __FILE__, __LINE__, "Using scene cache '%s'", filename.c_str());
+
+	return true;
+}
+
+bool SceneCache::isValid() const
+{
+	return valid;
+}
+
+void SceneCache::record(uint64_t key)
+{
+	if (valid)
+	{
+		return;
+	}
+
+	output.clear();
+	recording = true;
+
+	writeValue(MAGIC);
+	writeValue(VERSION);
+	writeValue(key);
+
+	// File size and shaders offset are patched on save.
+	writeValue(static_cast<uint64_t>(0));
+	writeValue(static_cast<uint64_t>(0));
+}
+
+bool SceneCache::isRecording() const
+{
+	return recording;
+}
+
+bool SceneCache::save(const std::string& filename)
+{
+	if (!recording)
+	{
+		return false;
+	}
+
+	align();
+	uint64_t shadersOffset = static_cast<uint64_t>(output.size());
+
+	std::vector<CompiledShader> compiledShaders = Compiler::getCompiledShaders();
+
+	writeValue(static_cast<uint32_t>(compiledShaders.size()));
+	for (const CompiledShader& compiledShader : compiledShaders)
+	{
+		writeValue(compiledShader.key);
+		writeString(compiledShader.macros);
+		writeVector(compiledShader.spirv);
+	}
+
+	uint64_t fileSize = static_cast<uint64_t>(output.size());
+	memcpy(&output[16], &fileSize, sizeof(fileSize));
+	memcpy(&output[24], &shadersOffset, sizeof(shadersOffset));
+
+	recording = false;
+
+	bool result = FileIO::save(output, filename);
+
+	output.clear();
+	output.shrink_to_fit();
+
+	if (!result)
+	{
+		Logger::print(TinyEngine_WARNING, __FILE__, __LINE__, "Could not write scene cache '%s'", filename.c_str());
+
+		return false;
+	}
+
+	Logger::print(TinyEngine_INFO, __FILE__, __LINE__, "Wrote scene cache '%s' with %llu bytes", filename.c_str(), static_cast<unsigned long long>(fileSize));
+
+	return true;
+}
+
+void SceneCache::write(const void* data, size_t size)
+{
+	if (!recording || size == 0)
+	{
+		return;
+	}
+
+	output.append(static_cast<const char*>(data), size);
+}
+
+void SceneCache::writeString(const std::string& value)
+{
+	writeValue(static_cast<uint64_t>(value.size()));
+	write(value.data(), value.size());
+}
+
+void SceneCache::writeBlob(const void* data, size_t size)
+{
+	writeValue(static_cast<uint64_t>(size));
+	align();
+	write(data, size);
+}
+
+bool SceneCache::read(void* data, size_t size)
+{
+	if (mappedFile.getData() == nullptr || offset > mappedFile.getSize() || size > mappedFile.getSize() - offset)
+	{
+		return false;
+	}
+
+	if (size > 0)
+	{
+		memcpy(data, mappedFile.getData() + offset, size);
+	}
+	offset += size;
+
+	return true;
+}
+
+bool SceneCache::readString(std::string& value)
+{
+	uint64_t size = 0;
+	if (!readValue(size) || size > mappedFile.getSize() - offset)
+	{
+		return false;
+	}
+
+	value.assign(reinterpret_cast<const char*>(mappedFile.getData() + offset), static_cast<size_t>(size));
+	offset += static_cast<size_t>(size);
+
+	return true;
+}
+
+bool SceneCache::readBlob(const uint8_t*& data, size_t& size)
+{
+	uint64_t blobSize = 0;
+	if (!readValue(blobSize))
+	{
+		return false;
+	}
+
+	align();
+	if (offset > mappedFile.getSize() || blobSize > mappedFile.getSize() - offset)
+	{
+		return false;
+	}
+
+	data = mappedFile.getData() + offset;
+	size = static_cast<size_t>(blobSize);
+	offset += size;
+
+	return true;
+}
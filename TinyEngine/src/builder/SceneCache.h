@@ -0,0 +1,110 @@
+#ifndef BUILDER_SCENECACHE_H_
+#define BUILDER_SCENECACHE_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "../gltf/GLTF.h"
+#include "../io/IO.h"
+
+// Build results of a world, written after the first build and mapped on later starts.
+// Values are read back in the order they were written. Blobs are aligned, so they are uploaded straight from the mapping.
+class SceneCache {
+
+private:
+
+	static constexpr uint32_t MAGIC = 0x43534554; // "TESC"
+	static constexpr uint32_t VERSION = 2;
+	static constexpr size_t ALIGNMENT = 16;
+
+	// Writing
+	std::string output = "";
+	bool recording = false;
+
+	// Reading
+	MappedFile mappedFile;
+	size_t offset = 0;
+	bool valid = false;
+
+	void align();
+
+public:
+
+	SceneCache();
+
+	// Hash of the glTF file, its buffers and the encoded external images.
+	static bool hashSource(uint64_t& sourceHash, const GLTF& glTF, const std::string& filename);
+
+	// Valid, if written with the same version and key. The compiled shaders are handed to the compiler.
+	bool open(const std::string& filename, uint64_t key);
+
+	bool isValid() const;
+
+	// Starts recording, if not valid.
+	void record(uint64_t key);
+
+	bool isRecording() const;
+
+	// Appends the compiled shaders and writes the recording.
+	bool save(const std::string& filename);
+
+	// Writing
+
+	void write(const void* data, size_t size);
+
+	template<typename T>
+	void writeValue(const T& value)
+	{
+		write(&value, sizeof(T));
+	}
+
+	void writeString(const std::string& value);
+
+	void writeBlob(const void* data, size_t size);
+
+	template<typename T>
+	void writeVector(const std::vector<T>& values)
+	{
+		writeBlob(values.data(), sizeof(T) * values.size());
+	}
+
+	// Reading
+
+	bool read(void* data, size_t size);
+
+	template<typename T>
+	bool readValue(T& value)
+	{
+		return read(&value, sizeof(T));
+	}
+
+	bool readString(std::string& value);
+
+	// Points into the mapping.
+	bool readBlob(const uint8_t*& data, size_t& size);
+
+	template<typename T>
+	bool readVector(std::vector<T>& values)
+	{
+		const uint8_t* data = nullptr;
+		size_t size = 0;
+		if (!readBlob(data, size) || size % sizeof(T) != 0)
+		{
+			return false;
+		}
+
+		values.resize(size / sizeof(T));
+		if (size > 0)
+		{
+			memcpy(values.data(), data, size);
+		}
+
+		return true;
+	}
+
+};
+
+#endif /* BUILDER_SCENECACHE_H_ */
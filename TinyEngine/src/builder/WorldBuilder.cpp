@@ -1,8 +1,8 @@
 #include "../shader/Shader.h"
 #include "WorldBuilder.h"
 
-WorldBuilder::WorldBuilder(const GLTF& glTF, const std::string& environment, RenderManager& resourceManager) :
-	glTF(glTF), environment(environment), renderManager(resourceManager)
+WorldBuilder::WorldBuilder(const GLTF& glTF, const std::string& environment, RenderManager& resourceManager, const WorldBuilderSettings& settings) :
+	glTF(glTF), environment(environment), renderManager(resourceManager), settings(settings)
 {
 }
 
@@ -41,6 +41,86 @@ bool WorldBuilder::buildAccessors()
 
 bool WorldBuilder::buildTextures()
 {
+	// Mip map settings of each image, chosen by its use in the materials.
+	std::vector<MipMapSettings> mipMapSettings(glTF.images.size());
+
+	auto useTexture = [&](const TextureInfo& textureInfo, bool srgb, float alphaCutoff) {
+		if (textureInfo.index < 0 || static_cast<size_t>(textureInfo.index) >= glTF.textures.size())
+		{
+			return;
+		}
+
+		MipMapSettings& settings = mipMapSettings[glTF.textures[textureInfo.index].source];
+		settings.srgb = settings.srgb || srgb;
+		if (alphaCutoff > settings.alphaCutoff)
+		{
+			settings.alphaCutoff = alphaCutoff;
+		}
+	};
+
+	for (const Material& material : glTF.materials)
+	{
+		// Alpha mode one is mask.
+		float alphaCutoff = (material.alphaMode == 1) ? material.alphaCutoff : -1.0f;
+
+		useTexture(material.pbrMetallicRoughness.baseColorTexture, true, alphaCutoff);
+		useTexture(material.emissiveTexture, true, -1.0f);
+	}
+
+	// Number of textures using each image. Unused images are neither processed nor recorded.
+	std::vector<uint32_t> imageUses(glTF.images.size(), 0);
+	for (const Texture& texture : glTF.textures)
+	{
+		imageUses[texture.source]++;
+	}
+
+	// Mip maps are generated on the CPU with one image per worker, so they are uploaded in one copy and stored with a recorded texture.
+	// Images, which can not be handled, are kept and get their mip maps on the GPU.
+	std::vector<ImageDataResources> mipMaps(glTF.images.size());
+	std::vector<uint8_t> mipMapResults(glTF.images.size(), 0);
+
+	auto generateMipMaps = [&](size_t begin, size_t end) {
+		for (size_t i = begin; i < end; i++)
+		{
+			if (imageUses[i] == 0)
+			{
+				continue;
+			}
+
+			mipMapSettings[i].filter = MipMapFilter_KAISER;
+
+			mipMapResults[i] = HelperMipMap::generate(mipMaps[i], glTF.images[i].imageDataResources, mipMapSettings[i]) ? 1 : 0;
+		}
+	};
+
+	if (workerPool)
+	{
+		workerPool->parallelFor(glTF.images.size(), generateMipMaps);
+	}
+	else
+	{
+		generateMipMaps(0, glTF.images.size());
+	}
+
+	// Images are recorded once and referenced by the textures.
+	if (isRecording())
+	{
+		sceneCache->writeValue(static_cast<uint32_t>(glTF.images.size()));
+		for (size_t i = 0; i < glTF.images.size(); i++)
+		{
+			if (imageUses[i] == 0)
+			{
+				recordImage(ImageDataResources());
+			}
+			else
+			{
+				recordImage(mipMapResults[i] ? mipMaps[i] : glTF.images[i].imageDataResources);
+			}
+		}
+
+		sceneCache->writeValue(static_cast<uint32_t>(glTF.textures.size()));
+	}
+
 	for (size_t i = 0; i < glTF.textures.size(); i++)
 	{
 		const Texture& texture = glTF.textures[i];
@@ -51,8 +131,20 @@ bool WorldBuilder::buildTextures()
 			return false;
 		}
 
+		// The last texture using the generated mip maps takes them over, so they are released with it.
 		TextureResourceCreateInfo textureResourceCreateInfo = {};
-		textureResourceCreateInfo.imageDataResources = glTF.images[texture.source].imageDataResources;
+		if (!mipMapResults[texture.source])
+		{
+			textureResourceCreateInfo.imageDataResources = glTF.images[texture.source].imageDataResources;
+		}
+		else if (--imageUses[texture.source] == 0)
+		{
+			textureResourceCreateInfo.imageDataResources = std::move(mipMaps[texture.source]);
+		}
+		else
+		{
+			textureResourceCreateInfo.imageDataResources = mipMaps[texture.source];
+		}
 		textureResourceCreateInfo.mipMap = true;
 
 		if (texture.sampler >= 0)
@@ -66,7 +158,12 @@ bool WorldBuilder::buildTextures()
 			textureResourceCreateInfo.samplerResourceCreateInfo.maxLod = glTF.samplers[texture.sampler].maxLod;
 		}
 
-		if (!renderManager.textureSetParameters(textureHandle, textureResourceCreateInfo))
+		if (isRecording())
+		{
+			recordTexture(texture.source, textureResourceCreateInfo);
+		}
+
+		if (!renderManager.textureSetParameters(textureHandle, std::move(textureResourceCreateInfo)))
 		{
 			return false;
 		}
@@ -193,6 +290,16 @@ bool WorldBuilder::buildMaterials()
 
 bool WorldBuilder::buildMeshes()
 {
+	if (settings.quantize && !isQuantize())
+	{
+		Logger::print(TinyEngine_WARNING, __FILE__, __LINE__, "Push constants can not hold the position dequantization, so vertex data is not quantized");
+	}
+
+	if (isRecording())
+	{
+		sceneCache->writeValue(static_cast<uint32_t>(glTF.meshes.size()));
+	}
+
 	for (size_t i = 0; i < glTF.meshes.size(); i++)
 	{
 		const Mesh& mesh = glTF.meshes[i];
@@ -203,6 +310,11 @@ bool WorldBuilder::buildMeshes()
 			return false;
 		}
 
+		if (isRecording())
+		{
+			sceneCache->writeValue(static_cast<uint32_t>(mesh.primitives.size()));
+		}
+
 		for (size_t k = 0; k < mesh.primitives.size(); k++)
 		{
 			const Primitive& primitive = mesh.primitives[k];
@@ -219,181 +331,89 @@ bool WorldBuilder::buildMeshes()
 				return false;
 			}
 
-			if (primitive.position >= 0)
-			{
-				const Accessor& accessor = glTF.accessors[primitive.position];
-
-				uint32_t stride = HelperAccess::getStride(accessor);
-
-				VkFormat format = VK_FORMAT_UNDEFINED;
-				if (!HelperVulkan::getFormat(format, accessor.componentTypeSize, accessor.componentTypeSigned, accessor.componentTypeInteger, accessor.typeCount, accessor.normalized))
-				{
-					return false;
-				}
-
-				if (!renderManager.geometrySetAttribute(geometryHandle, getBufferHandle(accessor), "POSITION", glTF.accessors[primitive.position].count, format, stride, HelperAccess::getOffset(accessor), HelperAccess::getRange(accessor)))
-				{
-					return false;
-				}
-			}
-
-			if (primitive.normal >= 0)
-			{
-				const Accessor& accessor = glTF.accessors[primitive.normal];
-
-				uint32_t stride = HelperAccess::getStride(accessor);
-
-				VkFormat format = VK_FORMAT_UNDEFINED;
-				if (!HelperVulkan::getFormat(format, accessor.componentTypeSize, accessor.componentTypeSigned, accessor.componentTypeInteger, accessor.typeCount, accessor.normalized))
-				{
-					return false;
-				}
-
-				if (!renderManager.geometrySetAttribute(geometryHandle, getBufferHandle(accessor), "NORMAL", glTF.accessors[primitive.normal].count, format, stride, HelperAccess::getOffset(accessor), HelperAccess::getRange(accessor)))
-				{
-					return false;
-				}
-			}
-
-			if (primitive.tangent >= 0)
-			{
-				const Accessor& accessor = glTF.accessors[primitive.tangent];
-
-				uint32_t stride = HelperAccess::getStride(accessor);
-
-				VkFormat format = VK_FORMAT_UNDEFINED;
-				if (!HelperVulkan::getFormat(format, accessor.componentTypeSize, accessor.componentTypeSigned, accessor.componentTypeInteger, accessor.typeCount, accessor.normalized))
-				{
-					return false;
-				}
-
-				if (!renderManager.geometrySetAttribute(geometryHandle, getBufferHandle(accessor), "TANGENT", glTF.accessors[primitive.tangent].count, format, stride, HelperAccess::getOffset(accessor), HelperAccess::getRange(accessor)))
-				{
-					return false;
-				}
-			}
-
-			if (primitive.texCoord0 >= 0)
-			{
-				const Accessor& accessor = glTF.accessors[primitive.texCoord0];
-
-				uint32_t stride = HelperAccess::getStride(accessor);
+			// Data has to stay valid until the geometry and geometry model is finalized.
+			GeometryData geometryData;
+			GeometryDeform geometryDeform;
+			GeometryTargets geometryTargets;
+			std::vector<uint8_t> indexData;
 
-				VkFormat format = VK_FORMAT_UNDEFINED;
-				if (!HelperVulkan::getFormat(format, accessor.componentTypeSize, accessor.componentTypeSigned, accessor.componentTypeInteger, accessor.typeCount, accessor.normalized))
-				{
-					return false;
-				}
+			// Source attributes of skinned and morphed geometry are decoded for the deformation pre-pass.
+			bool deform = renderManager.isDeformPrepass() && (primitive.joints0 >= 0 || primitive.targets.size() > 0);
 
-				if (!renderManager.geometrySetAttribute(geometryHandle, getBufferHandle(accessor), "TEXCOORD_0", glTF.accessors[primitive.texCoord0].count, format, stride, HelperAccess::getOffset(accessor), HelperAccess::getRange(accessor)))
-				{
-					return false;
-				}
-			}
+			// Recorded geometry is always processed, so it does not reference the buffer views.
+			bool processed = isQuantize() || settings.optimize || settings.lod || settings.meshlets || deform || isRecording() || HelperGeometry::requiresConversion(glTF, primitive);
 
-			if (primitive.texCoord1 >= 0)
+			if (processed)
 			{
-				const Accessor& accessor = glTF.accessors[primitive.texCoord1];
-
-				uint32_t stride = HelperAccess::getStride(accessor);
-
-				VkFormat format = VK_FORMAT_UNDEFINED;
-				if (!HelperVulkan::getFormat(format, accessor.componentTypeSize, accessor.componentTypeSigned, accessor.componentTypeInteger, accessor.typeCount, accessor.normalized))
+				if (!HelperGeometry::gather(geometryData, glTF, primitive))
 				{
 					return false;
 				}
 
-				if (!renderManager.geometrySetAttribute(geometryHandle, getBufferHandle(accessor), "TEXCOORD_1", glTF.accessors[primitive.texCoord1].count, format, stride, HelperAccess::getOffset(accessor), HelperAccess::getRange(accessor)))
+				if (settings.optimize)
 				{
-					return false;
-				}
-			}
-
-			if (primitive.color0 >= 0)
-			{
-				const Accessor& accessor = glTF.accessors[primitive.color0];
-
-				uint32_t stride = HelperAccess::getStride(accessor);
+					OptimizeReport optimizeReport = {};
+					if (!HelperOptimize::optimize(geometryData, primitive.mode, optimizeReport))
+					{
+						return false;
+					}
 
-				VkFormat format = VK_FORMAT_UNDEFINED;
-				if (!HelperVulkan::getFormat(format, accessor.componentTypeSize, accessor.componentTypeSigned, accessor.componentTypeInteger, accessor.typeCount, accessor.normalized))
-				{
-					return false;
+					Logger::print(TinyEngine_INFO, __FILE__, __LINE__, "Mesh %u primitive %u: ACMR %.3f -> %.3f, ATVR %.3f -> %.3f, vertices %u -> %u", static_cast<uint32_t>(i), static_cast<uint32_t>(k), optimizeReport.acmrBefore, optimizeReport.acmrAfter, optimizeReport.atvrBefore, optimizeReport.atvrAfter, optimizeReport.countBefore, optimizeReport.countAfter);
 				}
 
-				if (!renderManager.geometrySetAttribute(geometryHandle, getBufferHandle(accessor), "COLOR_0", glTF.accessors[primitive.color0].count, format, stride, HelperAccess::getOffset(accessor), HelperAccess::getRange(accessor)))
+				if (settings.lod && primitive.mode == 4 && geometryData.indices.size() > 0)
 				{
-					return false;
-				}
-			}
-
-			if (primitive.joints0 >= 0)
-			{
-				const Accessor& accessor = glTF.accessors[primitive.joints0];
-
-				uint32_t stride = HelperAccess::getStride(accessor);
+					if (!HelperSimplify::generateLods(geometryData))
+					{
+						return false;
+					}
 
-				VkFormat format = VK_FORMAT_UNDEFINED;
-				if (!HelperVulkan::getFormat(format, accessor.componentTypeSize, accessor.componentTypeSigned, accessor.componentTypeInteger, accessor.typeCount, accessor.normalized))
-				{
-					return false;
+					for (size_t l = 1; l < geometryData.lods.size(); l++)
+					{
+						Logger::print(TinyEngine_INFO, __FILE__, __LINE__, "Mesh %u primitive %u: LOD %u with %u triangles and error %f", static_cast<uint32_t>(i), static_cast<uint32_t>(k), static_cast<uint32_t>(l), geometryData.lods[l].indicesCount / 3, geometryData.lods[l].error);
+					}
 				}
 
-				if (!renderManager.geometrySetAttribute(geometryHandle, getBufferHandle(accessor), "JOINTS_0", glTF.accessors[primitive.joints0].count, format, stride, HelperAccess::getOffset(accessor), HelperAccess::getRange(accessor)))
+				if (settings.meshlets && primitive.mode == 4 && geometryData.indices.size() > 0)
 				{
-					return false;
+					if (!HelperMeshlet::build(geometryData))
+					{
+						return false;
+					}
 				}
-			}
-
-			if (primitive.joints1 >= 0)
-			{
-				const Accessor& accessor = glTF.accessors[primitive.joints1];
 
-				uint32_t stride = HelperAccess::getStride(accessor);
-
-				VkFormat format = VK_FORMAT_UNDEFINED;
-				if (!HelperVulkan::getFormat(format, accessor.componentTypeSize, accessor.componentTypeSigned, accessor.componentTypeInteger, accessor.typeCount, accessor.normalized))
+				if (deform)
 				{
-					return false;
+					if (!HelperGeometry::getDeform(geometryDeform, geometryData))
+					{
+						return false;
+					}
 				}
 
-				if (!renderManager.geometrySetAttribute(geometryHandle, getBufferHandle(accessor), "JOINTS_1", glTF.accessors[primitive.joints1].count, format, stride, HelperAccess::getOffset(accessor), HelperAccess::getRange(accessor)))
+				if (isQuantize())
 				{
-					return false;
+					if (!HelperQuantize::quantize(geometryData, quantizeReport))
+					{
+						return false;
+					}
 				}
-			}
-
-			if (primitive.weights0 >= 0)
-			{
-				const Accessor& accessor = glTF.accessors[primitive.weights0];
 
-				uint32_t stride = HelperAccess::getStride(accessor);
-
-				VkFormat format = VK_FORMAT_UNDEFINED;
-				if (!HelperVulkan::getFormat(format, accessor.componentTypeSize, accessor.componentTypeSigned, accessor.componentTypeInteger, accessor.typeCount, accessor.normalized))
+				if (!buildGeometryData(geometryHandle, geometryData))
 				{
 					return false;
 				}
 
-				if (!renderManager.geometrySetAttribute(geometryHandle, getBufferHandle(accessor), "WEIGHTS_0", glTF.accessors[primitive.weights0].count, format, stride, HelperAccess::getOffset(accessor), HelperAccess::getRange(accessor)))
+				if (deform)
 				{
-					return false;
+					if (!renderManager.geometrySetDeformData(geometryHandle, geometryDeform))
+					{
+						return false;
+					}
 				}
 			}
-
-			if (primitive.weights1 >= 0)
+			else
 			{
-				const Accessor& accessor = glTF.accessors[primitive.weights1];
-
-				uint32_t stride = HelperAccess::getStride(accessor);
-
-				VkFormat format = VK_FORMAT_UNDEFINED;
-				if (!HelperVulkan::getFormat(format, accessor.componentTypeSize, accessor.componentTypeSigned, accessor.componentTypeInteger, accessor.typeCount, accessor.normalized))
-				{
-					return false;
-				}
-
-				if (!renderManager.geometrySetAttribute(geometryHandle, getBufferHandle(accessor), "WEIGHTS_1", glTF.accessors[primitive.weights1].count, format, stride, HelperAccess::getOffset(accessor), HelperAccess::getRange(accessor)))
+				if (!buildAttributes(geometryHandle, primitive))
 				{
 					return false;
 				}
@@ -444,87 +464,46 @@ bool WorldBuilder::buildMeshes()
 
 			if (primitive.targets.size() > 0)
 			{
-				uint32_t targetsCount = static_cast<uint32_t>(primitive.targets.size());
-
-				if (primitive.targetPositionData.size() > 0)
+				// Only the non-zero deltas per vertex are uploaded. Processed geometry has them remapped with its vertices.
+				if (processed)
 				{
-					uint64_t targetHandle;
-					if (!renderManager.sharedDataCreate(targetHandle))
-					{
-						return false;
-					}
-
-					if (!renderManager.sharedDataCreateStorageBuffer(targetHandle, sizeof(glm::vec3) * primitive.targetPositionData.size(), primitive.targetPositionData.data()))
-					{
-						return false;
-					}
-
-					if (!renderManager.sharedDataFinalize(targetHandle))
-					{
-						return false;
-					}
-
-					if (!renderManager.geometryModelSetTarget(geometryModelHandle, targetHandle, "POSITION"))
-					{
-						return false;
-					}
+					geometryTargets = geometryData.targets;
 				}
-
-				if (primitive.targetNormalData.size() > 0)
+				else if (!HelperTarget::gather(geometryTargets, glTF, primitive))
 				{
-					uint64_t targetHandle;
-					if (!renderManager.sharedDataCreate(targetHandle))
-					{
-						return false;
-					}
-
-					if (!renderManager.sharedDataCreateStorageBuffer(targetHandle, sizeof(glm::vec3) * primitive.targetNormalData.size(), primitive.targetNormalData.data()))
-					{
-						return false;
-					}
-
-					if (!renderManager.sharedDataFinalize(targetHandle))
-					{
-						return false;
-					}
-
-					if (!renderManager.geometryModelSetTarget(geometryModelHandle, targetHandle, "NORMAL"))
-					{
-						return false;
-					}
+					return false;
 				}
 
-				if (primitive.targetTangentData.size() > 0)
+				uint64_t denseSize = 0;
+				for (const Target& target : primitive.targets)
 				{
-					uint64_t targetHandle;
-					if (!renderManager.sharedDataCreate(targetHandle))
-					{
-						return false;
-					}
-
-					if (!renderManager.sharedDataCreateStorageBuffer(targetHandle, sizeof(glm::vec3) * primitive.targetTangentData.size(), primitive.targetTangentData.data()))
-					{
-						return false;
-					}
-
-					if (!renderManager.sharedDataFinalize(targetHandle))
-					{
-						return false;
-					}
-
-					if (!renderManager.geometryModelSetTarget(geometryModelHandle, targetHandle, "TANGENT"))
-					{
-						return false;
-					}
+					uint64_t attributesCount = (target.position >= 0 ? 1 : 0) + (target.normal >= 0 ? 1 : 0) + (target.tangent >= 0 ? 1 : 0);
+					denseSize += sizeof(glm::vec3) * attributesCount * geometryTargets.count;
 				}
+				Logger::print(TinyEngine_INFO, __FILE__, __LINE__, "Mesh %u primitive %u: morph targets %llu -> %llu bytes", static_cast<uint32_t>(i), static_cast<uint32_t>(k), static_cast<unsigned long long>(denseSize), static_cast<unsigned long long>(HelperTarget::getSize(geometryTargets)));
 
-				renderManager.geometryModelSetTargetsCount(geometryModelHandle, targetsCount);
+				if (!renderManager.geometryModelSetTargets(geometryModelHandle, geometryTargets))
+				{
+					return false;
+				}
 			}
 
 			//
 
 			VkIndexType indexType = VK_INDEX_TYPE_NONE_KHR;
-			if (primitive.indices >= 0)
+			if (processed && geometryData.indices.size() > 0)
+			{
+				if (!HelperGeometry::packIndices(indexData, indexType, geometryData))
+				{
+					return false;
+				}
+
+				if (!buildIndices(geometryModelHandle, static_cast<uint32_t>(geometryData.indices.size()), indexType, indexData.data(), indexData.size()))
+				{
+					return false;
+				}
+			}
+			else if (primitive.indices >= 0)
 			{
 				indexType = VK_INDEX_TYPE_UINT8_EXT;
 				if (glTF.accessors[primitive.indices].componentTypeSize == 2)
@@ -536,14 +515,24 @@ bool WorldBuilder::buildMeshes()
 					indexType = VK_INDEX_TYPE_UINT32;
 				}
 
-				if (!renderManager.geometryModelSetIndices(geometryModelHandle, getBufferHandle(glTF.accessors[primitive.indices]), glTF.accessors[primitive.indices].count, indexType, HelperAccess::getOffset(glTF.accessors[primitive.indices]), HelperAccess::getRange(glTF.accessors[primitive.indices])))
+				if (renderManager.isGeometryArena())
 				{
-					return false;
+					if (!renderManager.geometryModelSetIndexData(geometryModelHandle, glTF.accessors[primitive.indices].count, indexType, HelperAccess::accessData(glTF.accessors[primitive.indices])))
+					{
+						return false;
+					}
+				}
+				else
+				{
+					if (!renderManager.geometryModelSetIndices(geometryModelHandle, getBufferHandle(glTF.accessors[primitive.indices]), glTF.accessors[primitive.indices].count, indexType, HelperAccess::getOffset(glTF.accessors[primitive.indices]), HelperAccess::getRange(glTF.accessors[primitive.indices])))
+					{
+						return false;
+					}
 				}
 			}
 			else
 			{
-				if (!renderManager.geometryModelSetVertexCount(geometryModelHandle, glTF.accessors[primitive.position].count))
+				if (!renderManager.geometryModelSetVertexCount(geometryModelHandle, processed ? geometryData.count : glTF.accessors[primitive.position].count))
 				{
 					return false;
 				}
@@ -554,6 +543,37 @@ bool WorldBuilder::buildMeshes()
 				return false;
 			}
 
+			glm::vec3 center = glm::vec3(0.0f, 0.0f, 0.0f);
+			float radius = 0.0f;
+			if (processed && geometryData.lods.size() > 0)
+			{
+				for (const GeometryLod& geometryLod : geometryData.lods)
+				{
+					if (!renderManager.geometryModelAddLod(geometryModelHandle, geometryLod.firstIndex, geometryLod.indicesCount, geometryLod.error))
+					{
+						return false;
+					}
+				}
+
+				if (!HelperGeometry::getBounds(center, radius, geometryData))
+				{
+					return false;
+				}
+
+				if (!renderManager.geometryModelSetBounds(geometryModelHandle, center, radius))
+				{
+					return false;
+				}
+			}
+
+			if (processed && geometryData.meshlets.size() > 0)
+			{
+				if (!renderManager.geometryModelSetMeshlets(geometryModelHandle, geometryData.meshlets, geometryData.meshletVertices, geometryData.meshletTriangles))
+				{
+					return false;
+				}
+			}
+
 			if (!renderManager.geometryModelFinalize(geometryModelHandle))
 			{
 				return false;
@@ -565,6 +585,11 @@ bool WorldBuilder::buildMeshes()
 			{
 				return false;
 			}
+
+			if (isRecording())
+			{
+				recordPrimitive(primitive, geometryData, deform ? &geometryDeform : nullptr, geometryTargets, indexType, indexData, center, radius);
+			}
 		}
 
 		//
@@ -580,15 +605,52 @@ bool WorldBuilder::buildMeshes()
 		groupHandles.push_back(groupHandle);
 	}
 
-	return true;
+	if (isQuantize())
+	{
+		Logger::print(TinyEngine_INFO, __FILE__, __LINE__, "Quantized vertex data from %llu to %llu bytes", static_cast<unsigned long long>(quantizeReport.originalSize), static_cast<unsigned long long>(quantizeReport.quantizedSize));
+		Logger::print(TinyEngine_INFO, __FILE__, __LINE__, "Maximum position error %g (%g relative to extent)", quantizeReport.positionError, quantizeReport.positionRelativeError);
+		Logger::print(TinyEngine_INFO, __FILE__, __LINE__, "Maximum normal error %g degrees, tangent error %g degrees", quantizeReport.normalError, quantizeReport.tangentError);
+		Logger::print(TinyEngine_INFO, __FILE__, __LINE__, "Maximum texture coordinate error %g", quantizeReport.texCoordError);
+	}
+
+	return true;
 }
 
 bool WorldBuilder::buildNodes()
 {
+	// Flattened node table with the mesh and world matrix of each node.
+	uint32_t nodesCount = static_cast<uint32_t>(glTF.nodes.size());
+	if (isRecording())
+	{
+		sceneCache->writeValue(nodesCount);
+	}
+	else if (isReplaying())
+	{
+		if (!sceneCache->readValue(nodesCount) || nodesCount != glTF.nodes.size())
+		{
+			return false;
+		}
+	}
+
 	for (size_t i = 0; i < glTF.nodes.size(); i++)
 	{
 		const Node& node = glTF.nodes[i];
 
+		int32_t mesh = node.mesh;
+		glm::mat4 worldMatrix = node.worldMatrix;
+		if (isRecording())
+		{
+			sceneCache->writeValue(mesh);
+			sceneCache->writeValue(worldMatrix);
+		}
+		else if (isReplaying())
+		{
+			if (!sceneCache->readValue(mesh) || !sceneCache->readValue(worldMatrix) || mesh != node.mesh)
+			{
+				return false;
+			}
+		}
+
 		uint64_t instanceHandle;
 		if (!renderManager.instanceCreate(instanceHandle))
 		{
@@ -599,14 +661,14 @@ bool WorldBuilder::buildNodes()
 
 		//
 
-		if (!renderManager.instanceSetWorldMatrix(instanceHandle, node.worldMatrix))
+		if (!renderManager.instanceSetWorldMatrix(instanceHandle, worldMatrix))
 		{
 			return false;
 		}
 
-		if (node.mesh >= 0)
+		if (mesh >= 0)
 		{
-			if (!renderManager.instanceSetGroup(instanceHandle, groupHandles[node.mesh]))
+			if (!renderManager.instanceSetGroup(instanceHandle, groupHandles[mesh]))
 			{
 				return false;
 			}
@@ -616,52 +678,48 @@ bool WorldBuilder::buildNodes()
 
 		if (node.weights.size() > 0)
 		{
-			uint64_t weightsHandle;
-			if (!renderManager.sharedDataCreate(weightsHandle))
-			{
-				return false;
-			}
-
-			if (!renderManager.sharedDataCreateDynamicUniformBuffer(weightsHandle, sizeof(float) * node.weights.size(), node.weights.data()))
-			{
-				return false;
-			}
-
-			if (!renderManager.sharedDataFinalize(weightsHandle))
-			{
-				return false;
-			}
-
-			if (!renderManager.instanceSetWeights(instanceHandle, weightsHandle))
+			if (!renderManager.instanceSetWeights(instanceHandle, node.weights))
 			{
 				return false;
 			}
-
 		}
 
-		if (node.jointMatrices.size() > 0)
+		auto baked = nodeToBakedJointMatrices.find(static_cast<int32_t>(i));
+		if (baked != nodeToBakedJointMatrices.end())
 		{
-			uint64_t jointMatricesHandle;
-			if (!renderManager.sharedDataCreate(jointMatricesHandle))
+			if (!buildBakedJointMatrices(instanceHandle, *baked->second))
 			{
 				return false;
 			}
 
-			if (!renderManager.sharedDataCreateDynamicUniformBuffer(jointMatricesHandle, sizeof(glm::mat4) * node.jointMatrices.size(), node.jointMatrices.data()))
+			if (settings.crowdCount > 0)
 			{
-				return false;
-			}
+				// Square grid around the node with spread out, but reproducible time offsets and speeds.
+				uint32_t side = static_cast<uint32_t>(glm::ceil(glm::sqrt(static_cast<float>(settings.crowdCount))));
+				float center = 0.5f * static_cast<float>(side - 1);
 
-			if (!renderManager.sharedDataFinalize(jointMatricesHandle))
-			{
-				return false;
-			}
+				std::vector<CrowdMember> crowdMembers(settings.crowdCount);
+				for (uint32_t k = 0; k < settings.crowdCount; k++)
+				{
+					glm::vec3 translation = glm::vec3(static_cast<float>(k % side) - center, 0.0f, static_cast<float>(k / side) - center) * settings.crowdSpacing;
+
+					crowdMembers[k].worldMatrix = glm::translate(translation);
+					crowdMembers[k].timeOffset = glm::fract(static_cast<float>(k) * 0.618034f) * baked->second->duration;
+					crowdMembers[k].speed = 0.8f + 0.4f * glm::fract(static_cast<float>(k) * 0.414214f);
+				}
 
-			if (!renderManager.instanceSetJointMatrices(instanceHandle, jointMatricesHandle, node.jointMatrices.size()))
+				if (!renderManager.instanceSetCrowd(instanceHandle, crowdMembers))
+				{
+					return false;
+				}
+			}
+		}
+		else if (node.jointMatrices.size() > 0)
+		{
+			if (!renderManager.instanceSetJointMatrices(instanceHandle, node.jointMatrices))
 			{
 				return false;
 			}
-
 		}
 
 		//
@@ -679,6 +737,40 @@ bool WorldBuilder::buildNodes()
 	return true;
 }
 
+bool WorldBuilder::buildBakedJointMatrices(uint64_t instanceHandle, const BakedJointMatrices& bakedJointMatrices)
+{
+	uint64_t textureHandle;
+	if (!renderManager.textureCreate(textureHandle))
+	{
+		return false;
+	}
+
+	// Fetched per texel, so no filtering and no mip maps.
+	TextureResourceCreateInfo textureResourceCreateInfo = {};
+	textureResourceCreateInfo.imageDataResources.images[0].width = bakedJointMatrices.jointsCount * 3;
+	textureResourceCreateInfo.imageDataResources.images[0].height = bakedJointMatrices.framesCount;
+	textureResourceCreateInfo.imageDataResources.images[0].format = VK_FORMAT_R32G32B32A32_SFLOAT;
+	const uint8_t* pixels = reinterpret_cast<const uint8_t*>(bakedJointMatrices.rows.data());
+	textureResourceCreateInfo.imageDataResources.images[0].pixels.assign(pixels, pixels + sizeof(glm::vec4) * bakedJointMatrices.rows.size());
+	textureResourceCreateInfo.samplerResourceCreateInfo.magFilter = VK_FILTER_NEAREST;
+	textureResourceCreateInfo.samplerResourceCreateInfo.minFilter = VK_FILTER_NEAREST;
+	textureResourceCreateInfo.samplerResourceCreateInfo.addressModeU = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+	textureResourceCreateInfo.samplerResourceCreateInfo.addressModeV = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+	textureResourceCreateInfo.samplerResourceCreateInfo.maxLod = 0.0f;
+
+	if (!renderManager.textureSetParameters(textureHandle, textureResourceCreateInfo))
+	{
+		return false;
+	}
+
+	if (!renderManager.textureFinalize(textureHandle))
+	{
+		return false;
+	}
+
+	return renderManager.instanceSetBakedJointMatrices(instanceHandle, textureHandle, bakedJointMatrices.jointsCount, bakedJointMatrices.framesCount, bakedJointMatrices.duration);
+}
+
 bool WorldBuilder::buildScene()
 {
 	if (glTF.defaultScene < glTF.scenes.size())
@@ -699,6 +791,34 @@ bool WorldBuilder::buildScene()
 	return true;
 }
 
+void WorldBuilder::setBakedJointMatrices(int32_t nodeIndex, const BakedJointMatrices& bakedJointMatrices)
+{
+	nodeToBakedJointMatrices[nodeIndex] = &bakedJointMatrices;
+}
+
+void WorldBuilder::setSceneCache(SceneCache& sceneCache)
+{
+	this->sceneCache = &sceneCache;
+}
+
+void WorldBuilder::setWorkerPool(WorkerPool& workerPool)
+{
+	this->workerPool = &workerPool;
+}
+
+uint64_t WorldBuilder::getSettingsHash() const
+{
+	uint64_t flags = 0;
+	flags |= isQuantize() ? 1 : 0;
+	flags |= settings.optimize ? 2 : 0;
+	flags |= settings.lod ? 4 : 0;
+	flags |= settings.meshlets ? 8 : 0;
+	flags |= renderManager.isGeometryArena() ? 16 : 0;
+	flags |= renderManager.isDeformPrepass() ? 32 : 0;
+
+	return HelperHash::combine(0, flags);
+}
+
 bool WorldBuilder::build()
 {
 	if (!renderManager.worldCreate())
@@ -749,25 +869,41 @@ bool WorldBuilder::build()
 		return false;
 	}
 
-	// BufferViews
+	// With a geometry arena, vertex and index data is copied from the accessors instead of referencing buffer views.
+	// Recorded and replayed geometry does not reference them either.
 
-	if (!buildBufferViews())
+	if (!renderManager.isGeometryArena() && !isRecording() && !isReplaying())
 	{
-		return false;
-	}
+		// BufferViews
+
+		if (!buildBufferViews())
+		{
+			return false;
+		}
 
-	// Accessors
+		// Accessors
 
-	if (!buildAccessors())
-	{
-		return false;
+		if (!buildAccessors())
+		{
+			return false;
+		}
 	}
 
 	// Textures
 
-	if (!buildTextures())
+	if (isReplaying())
 	{
-		return false;
+		if (!replayTextures())
+		{
+			return false;
+		}
+	}
+	else
+	{
+		if (!buildTextures())
+		{
+			return false;
+		}
 	}
 
 	// Materials
@@ -779,9 +915,19 @@ bool WorldBuilder::build()
 
 	// Meshes
 
-	if (!buildMeshes())
+	if (isReplaying())
 	{
-		return false;
+		if (!replayMeshes())
+		{
+			return false;
+		}
+	}
+	else
+	{
+		if (!buildMeshes())
+		{
+			return false;
+		}
 	}
 
 	// Nodes
@@ -822,6 +968,158 @@ uint64_t WorldBuilder::getBufferHandle(const Accessor& accessor)
 	return bufferViewToHandle[accessor.pBufferView];
 }
 
+bool WorldBuilder::buildAttributes(uint64_t geometryHandle, const Primitive& primitive)
+{
+	if (!buildAttribute(geometryHandle, primitive.position, "POSITION"))
+	{
+		return false;
+	}
+
+	if (!buildAttribute(geometryHandle, primitive.normal, "NORMAL"))
+	{
+		return false;
+	}
+
+	if (!buildAttribute(geometryHandle, primitive.tangent, "TANGENT"))
+	{
+		return false;
+	}
+
+	if (!buildAttribute(geometryHandle, primitive.texCoord0, "TEXCOORD_0"))
+	{
+		return false;
+	}
+
+	if (!buildAttribute(geometryHandle, primitive.texCoord1, "TEXCOORD_1"))
+	{
+		return false;
+	}
+
+	if (!buildAttribute(geometryHandle, primitive.color0, "COLOR_0"))
+	{
+		return false;
+	}
+
+	if (!buildAttribute(geometryHandle, primitive.joints0, "JOINTS_0"))
+	{
+		return false;
+	}
+
+	if (!buildAttribute(geometryHandle, primitive.joints1, "JOINTS_1"))
+	{
+		return false;
+	}
+
+	if (!buildAttribute(geometryHandle, primitive.weights0, "WEIGHTS_0"))
+	{
+		return false;
+	}
+
+	if (!buildAttribute(geometryHandle, primitive.weights1, "WEIGHTS_1"))
+	{
+		return false;
+	}
+	return true;
+}
+
+bool WorldBuilder::buildAttribute(uint64_t geometryHandle, int32_t accessorIndex, const std::string& description)
+{
+	if (accessorIndex < 0)
+	{
+		return true;
+	}
+
+	const Accessor& accessor = glTF.accessors[accessorIndex];
+
+	uint32_t stride = HelperAccess::getStride(accessor);
+
+	VkFormat format = VK_FORMAT_UNDEFINED;
+	if (!HelperVulkan::getFormat(format, accessor.componentTypeSize, accessor.componentTypeSigned, accessor.componentTypeInteger, accessor.typeCount, accessor.normalized))
+	{
+		return false;
+	}
+
+	if (renderManager.isGeometryArena())
+	{
+		return renderManager.geometrySetAttributeData(geometryHandle, description, accessor.count, format, stride, HelperAccess::accessData(accessor));
+	}
+
+	return renderManager.geometrySetAttribute(geometryHandle, getBufferHandle(accessor), description, accessor.count, format, stride, HelperAccess::getOffset(accessor), HelperAccess::getRange(accessor));
+}
+
+bool WorldBuilder::buildGeometryData(uint64_t geometryHandle, const GeometryData& geometryData)
+{
+	for (const GeometryAttribute& geometryAttribute : geometryData.attributes)
+	{
+		if (!buildAttributeData(geometryHandle, geometryAttribute.description, geometryData.count, geometryAttribute.format, geometryAttribute.stride, geometryAttribute.data.data(), geometryAttribute.data.size()))
+		{
+			return false;
+		}
+	}
+
+	if (geometryData.positionQuantized)
+	{
+		if (!renderManager.geometrySetPositionDequantization(geometryHandle, geometryData.positionScale, geometryData.positionOffset))
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+bool WorldBuilder::buildAttributeData(uint64_t geometryHandle, const std::string& description, uint32_t count, VkFormat format, uint32_t stride, const uint8_t* data, size_t size)
+{
+	if (renderManager.isGeometryArena())
+	{
+		return renderManager.geometrySetAttributeData(geometryHandle, description, count, format, stride, data);
+	}
+
+	uint64_t sharedDataHandle;
+	if (!renderManager.sharedDataCreate(sharedDataHandle))
+	{
+		return false;
+	}
+
+	if (!renderManager.sharedDataCreateVertexBuffer(sharedDataHandle, size, data))
+	{
+		return false;
+	}
+
+	if (!renderManager.sharedDataFinalize(sharedDataHandle))
+	{
+		return false;
+	}
+
+	return renderManager.geometrySetAttribute(geometryHandle, sharedDataHandle, description, count, format);
+}
+
+bool WorldBuilder::buildIndices(uint64_t geometryModelHandle, uint32_t indicesCount, VkIndexType indexType, const uint8_t* indexData, size_t size)
+{
+	if (renderManager.isGeometryArena())
+	{
+		return renderManager.geometryModelSetIndexData(geometryModelHandle, indicesCount, indexType, indexData);
+	}
+
+	uint64_t sharedDataHandle;
+	if (!renderManager.sharedDataCreate(sharedDataHandle))
+	{
+		return false;
+	}
+
+	if (!renderManager.sharedDataCreateIndexBuffer(sharedDataHandle, size, indexData))
+	{
+		return false;
+	}
+
+	if (!renderManager.sharedDataFinalize(sharedDataHandle))
+	{
+		return false;
+	}
+
+	return renderManager.geometryModelSetIndices(geometryModelHandle, sharedDataHandle, indicesCount, indexType, 0, static_cast<uint32_t>(size));
+}
+
 bool WorldBuilder::createSharedDataResource(const BufferView& bufferView)
 {
 	uint64_t sharedDataHandle;
@@ -855,6 +1153,454 @@ bool WorldBuilder::createSharedDataResource(const BufferView& bufferView)
 	return true;
 }
 
+bool WorldBuilder::isRecording() const
+{
+	return sceneCache != nullptr && sceneCache->isRecording();
+}
+
+bool WorldBuilder::isReplaying() const
+{
+	return sceneCache != nullptr && sceneCache->isValid();
+}
+
+bool WorldBuilder::isQuantize() const
+{
+	return settings.quantize && renderManager.isPositionDequantizeSupported();
+}
+
+void WorldBuilder::recordImage(const ImageDataResources& imageDataResources)
+{
+	sceneCache->writeValue(imageDataResources.mipLevels);
+	sceneCache->writeValue(imageDataResources.faceCount);
+
+	sceneCache->writeValue(static_cast<uint32_t>(imageDataResources.images.size()));
+	for (const ImageDataResource& imageDataResource : imageDataResources.images)
+	{
+		sceneCache->writeValue(imageDataResource.width);
+		sceneCache->writeValue(imageDataResource.height);
+		sceneCache->writeValue(imageDataResource.format);
+		sceneCache->writeValue(imageDataResource.mipLevel);
+		sceneCache->writeValue(imageDataResource.face);
+		sceneCache->writeVector(imageDataResource.pixels);
+	}
+}
+
+void WorldBuilder::recordTexture(int32_t source, const TextureResourceCreateInfo& textureResourceCreateInfo)
+{
+	sceneCache->writeValue(source);
+	sceneCache->writeValue(textureResourceCreateInfo.samplerResourceCreateInfo);
+	sceneCache->writeValue(textureResourceCreateInfo.mipMap);
+}
+
+void WorldBuilder::recordPrimitive(const Primitive& primitive, const GeometryData& geometryData, const GeometryDeform* geometryDeform, const GeometryTargets& geometryTargets, VkIndexType indexType, const std::vector<uint8_t>& indexData, const glm::vec3& center, float radius)
+{
+	sceneCache->writeValue(primitive.mode);
+	sceneCache->writeValue(primitive.material);
+
+	// Attributes
+
+	sceneCache->writeValue(geometryData.count);
+	sceneCache->writeValue(static_cast<uint32_t>(geometryData.attributes.size()));
+	for (const GeometryAttribute& geometryAttribute : geometryData.attributes)
+	{
+		sceneCache->writeString(geometryAttribute.description);
+		sceneCache->writeValue(geometryAttribute.format);
+		sceneCache->writeValue(geometryAttribute.stride);
+		sceneCache->writeVector(geometryAttribute.data);
+	}
+
+	sceneCache->writeValue(geometryData.positionQuantized);
+	sceneCache->writeValue(geometryData.positionScale);
+	sceneCache->writeValue(geometryData.positionOffset);
+
+	// Deformation and morph targets
+
+	sceneCache->writeValue(geometryDeform != nullptr);
+	if (geometryDeform != nullptr)
+	{
+		sceneCache->writeValue(geometryDeform->count);
+		sceneCache->writeValue(geometryDeform->jointGroups);
+		sceneCache->writeVector(geometryDeform->positions);
+		sceneCache->writeVector(geometryDeform->normals);
+		sceneCache->writeVector(geometryDeform->tangents);
+		sceneCache->writeVector(geometryDeform->joints);
+		sceneCache->writeVector(geometryDeform->weights);
+	}
+
+	sceneCache->writeValue(primitive.targets.size() > 0);
+	if (primitive.targets.size() > 0)
+	{
+		sceneCache->writeValue(geometryTargets.count);
+		sceneCache->writeValue(geometryTargets.targetsCount);
+		sceneCache->writeVector(geometryTargets.offsets);
+		sceneCache->writeVector(geometryTargets.positions);
+		sceneCache->writeVector(geometryTargets.normals);
+		sceneCache->writeVector(geometryTargets.tangents);
+	}
+
+	// Indices, level of details and meshlets
+
+	sceneCache->writeValue(static_cast<uint32_t>(geometryData.indices.size()));
+	sceneCache->writeValue(indexType);
+	sceneCache->writeVector(indexData);
+
+	sceneCache->writeVector(geometryData.lods);
+	sceneCache->writeValue(center);
+	sceneCache->writeValue(radius);
+
+	sceneCache->writeVector(geometryData.meshlets);
+	sceneCache->writeVector(geometryData.meshletVertices);
+	sceneCache->writeVector(geometryData.meshletTriangles);
+}
+
+bool WorldBuilder::replayImage(ImageDataResources& imageDataResources)
+{
+	uint32_t imagesCount = 0;
+	if (!sceneCache->readValue(imageDataResources.mipLevels) || !sceneCache->readValue(imageDataResources.faceCount) || !sceneCache->readValue(imagesCount))
+	{
+		return false;
+	}
+
+	// Pixels are uploaded straight from the mapping.
+	imageDataResources.images.resize(imagesCount);
+	for (ImageDataResource& imageDataResource : imageDataResources.images)
+	{
+		if (!sceneCache->readValue(imageDataResource.width) || !sceneCache->readValue(imageDataResource.height) || !sceneCache->readValue(imageDataResource.format) || !sceneCache->readValue(imageDataResource.mipLevel) || !sceneCache->readValue(imageDataResource.face) || !sceneCache->readBlob(imageDataResource.mapped, imageDataResource.mappedSize))
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+bool WorldBuilder::replayTextures()
+{
+	uint32_t imagesCount = 0;
+	if (!sceneCache->readValue(imagesCount) || imagesCount != glTF.images.size())
+	{
+		return false;
+	}
+
+	std::vector<ImageDataResources> images(imagesCount);
+	for (uint32_t i = 0; i < imagesCount; i++)
+	{
+		if (!replayImage(images[i]))
+		{
+			return false;
+		}
+	}
+
+	uint32_t texturesCount = 0;
+	if (!sceneCache->readValue(texturesCount) || texturesCount != glTF.textures.size())
+	{
+		return false;
+	}
+
+	for (uint32_t i = 0; i < texturesCount; i++)
+	{
+		uint64_t textureHandle;
+		if (!renderManager.textureCreate(textureHandle))
+		{
+			return false;
+		}
+
+		TextureResourceCreateInfo textureResourceCreateInfo = {};
+
+		int32_t source = -1;
+		if (!sceneCache->readValue(source) || !sceneCache->readValue(textureResourceCreateInfo.samplerResourceCreateInfo) || !sceneCache->readValue(textureResourceCreateInfo.mipMap))
+		{
+			return false;
+		}
+
+		if (source < 0 || source >= static_cast<int32_t>(imagesCount))
+		{
+			return false;
+		}
+
+		// Only the mapping is shared, not the pixels.
+		textureResourceCreateInfo.imageDataResources = images[source];
+
+		if (!renderManager.textureSetParameters(textureHandle, textureResourceCreateInfo))
+		{
+			return false;
+		}
+
+		if (!renderManager.textureFinalize(textureHandle))
+		{
+			return false;
+		}
+
+		//
+
+		textureHandles.push_back(textureHandle);
+	}
+
+	return true;
+}
+
+bool WorldBuilder::replayMeshes()
+{
+	uint32_t meshesCount = 0;
+	if (!sceneCache->readValue(meshesCount) || meshesCount != glTF.meshes.size())
+	{
+		return false;
+	}
+
+	for (uint32_t i = 0; i < meshesCount; i++)
+	{
+		uint64_t groupHandle;
+		if (!renderManager.groupCreate(groupHandle))
+		{
+			return false;
+		}
+
+		uint32_t primitivesCount = 0;
+		if (!sceneCache->readValue(primitivesCount))
+		{
+			return false;
+		}
+
+		for (uint32_t k = 0; k < primitivesCount; k++)
+		{
+			if (!replayPrimitive(groupHandle))
+			{
+				return false;
+			}
+		}
+
+		//
+
+		if (!renderManager.groupFinalize(groupHandle))
+		{
+			return false;
+		}
+
+		//
+
+		groupHandles.push_back(groupHandle);
+	}
+
+	return true;
+}
+
+bool WorldBuilder::replayPrimitive(uint64_t groupHandle)
+{
+	uint64_t geometryHandle;
+	if (!renderManager.geometryCreate(geometryHandle))
+	{
+		return false;
+	}
+
+	uint64_t geometryModelHandle;
+	if (!renderManager.geometryModelCreate(geometryModelHandle))
+	{
+		return false;
+	}
+
+	// Data has to stay valid until the geometry and geometry model is finalized.
+	GeometryDeform geometryDeform;
+	GeometryTargets geometryTargets;
+	std::vector<GeometryLod> lods;
+	std::vector<GeometryMeshlet> meshlets;
+	std::vector<uint32_t> meshletVertices;
+	std::vector<uint32_t> meshletTriangles;
+
+	uint32_t mode = 0;
+	int32_t material = -1;
+	if (!sceneCache->readValue(mode) || !sceneCache->readValue(material) || material >= static_cast<int32_t>(materialHandles.size()) - 1)
+	{
+		return false;
+	}
+
+	// Attributes
+
+	uint32_t count = 0;
+	uint32_t attributesCount = 0;
+	if (!sceneCache->readValue(count) || !sceneCache->readValue(attributesCount))
+	{
+		return false;
+	}
+
+	for (uint32_t i = 0; i < attributesCount; i++)
+	{
+		std::string description = "";
+		VkFormat format = VK_FORMAT_UNDEFINED;
+		uint32_t stride = 0;
+		const uint8_t* data = nullptr;
+		size_t size = 0;
+		if (!sceneCache->readString(description) || !sceneCache->readValue(format) || !sceneCache->readValue(stride) || !sceneCache->readBlob(data, size))
+		{
+			return false;
+		}
+
+		if (!buildAttributeData(geometryHandle, description, count, format, stride, data, size))
+		{
+			return false;
+		}
+	}
+
+	bool positionQuantized = false;
+	glm::vec3 positionScale;
+	glm::vec3 positionOffset;
+	if (!sceneCache->readValue(positionQuantized) || !sceneCache->readValue(positionScale) || !sceneCache->readValue(positionOffset))
+	{
+		return false;
+	}
+
+	if (positionQuantized)
+	{
+		if (!renderManager.geometrySetPositionDequantization(geometryHandle, positionScale, positionOffset))
+		{
+			return false;
+		}
+	}
+
+	// Deformation
+
+	bool deform = false;
+	if (!sceneCache->readValue(deform))
+	{
+		return false;
+	}
+
+	if (deform)
+	{
+		if (!sceneCache->readValue(geometryDeform.count) || !sceneCache->readValue(geometryDeform.jointGroups) || !sceneCache->readVector(geometryDeform.positions) || !sceneCache->readVector(geometryDeform.normals) || !sceneCache->readVector(geometryDeform.tangents) || !sceneCache->readVector(geometryDeform.joints) || !sceneCache->readVector(geometryDeform.weights))
+		{
+			return false;
+		}
+
+		if (!renderManager.geometrySetDeformData(geometryHandle, geometryDeform))
+		{
+			return false;
+		}
+	}
+
+	//
+
+	if (!renderManager.geometryFinalize(geometryHandle))
+	{
+		return false;
+	}
+
+	//
+
+	if (!renderManager.geometryModelSetGeometry(geometryModelHandle, geometryHandle))
+	{
+		return false;
+	}
+
+	if (!renderManager.geometryModelSetPrimitiveTopology(geometryModelHandle, mode))
+	{
+		return false;
+	}
+
+	if (!renderManager.geometryModelSetMaterial(geometryModelHandle, materialHandles[material >= 0 ? material : materialHandles.size() - 1]))
+	{
+		return false;
+	}
+
+	// Morph targets
+
+	bool targets = false;
+	if (!sceneCache->readValue(targets))
+	{
+		return false;
+	}
+
+	if (targets)
+	{
+		if (!sceneCache->readValue(geometryTargets.count) || !sceneCache->readValue(geometryTargets.targetsCount) || !sceneCache->readVector(geometryTargets.offsets) || !sceneCache->readVector(geometryTargets.positions) || !sceneCache->readVector(geometryTargets.normals) || !sceneCache->readVector(geometryTargets.tangents))
+		{
+			return false;
+		}
+
+		if (!renderManager.geometryModelSetTargets(geometryModelHandle, geometryTargets))
+		{
+			return false;
+		}
+	}
+
+	// Indices
+
+	uint32_t indicesCount = 0;
+	VkIndexType indexType = VK_INDEX_TYPE_NONE_KHR;
+	const uint8_t* indexData = nullptr;
+	size_t indexSize = 0;
+	if (!sceneCache->readValue(indicesCount) || !sceneCache->readValue(indexType) || !sceneCache->readBlob(indexData, indexSize))
+	{
+		return false;
+	}
+
+	if (indicesCount > 0)
+	{
+		if (!buildIndices(geometryModelHandle, indicesCount, indexType, indexData, indexSize))
+		{
+			return false;
+		}
+	}
+	else
+	{
+		if (!renderManager.geometryModelSetVertexCount(geometryModelHandle, count))
+		{
+			return false;
+		}
+	}
+
+	if (!renderManager.geometryModelSetCullMode(geometryModelHandle, VK_CULL_MODE_NONE))
+	{
+		return false;
+	}
+
+	// Level of details and meshlets
+
+	glm::vec3 center;
+	float radius = 0.0f;
+	if (!sceneCache->readVector(lods) || !sceneCache->readValue(center) || !sceneCache->readValue(radius))
+	{
+		return false;
+	}
+
+	if (lods.size() > 0)
+	{
+		for (const GeometryLod& geometryLod : lods)
+		{
+			if (!renderManager.geometryModelAddLod(geometryModelHandle, geometryLod.firstIndex, geometryLod.indicesCount, geometryLod.error))
+			{
+				return false;
+			}
+		}
+
+		if (!renderManager.geometryModelSetBounds(geometryModelHandle, center, radius))
+		{
+			return false;
+		}
+	}
+
+	if (!sceneCache->readVector(meshlets) || !sceneCache->readVector(meshletVertices) || !sceneCache->readVector(meshletTriangles))
+	{
+		return false;
+	}
+
+	if (meshlets.size() > 0)
+	{
+		if (!renderManager.geometryModelSetMeshlets(geometryModelHandle, meshlets, meshletVertices, meshletTriangles))
+		{
+			return false;
+		}
+	}
+
+	if (!renderManager.geometryModelFinalize(geometryModelHandle))
+	{
+		return false;
+	}
+
+	//
+
+	return renderManager.groupAddGeometryModel(groupHandle, geometryModelHandle);
+}
+
 std::map<const Node*, uint64_t> WorldBuilder::cloneNodeToHandles() const
 {
 	return nodeToHandles;
@@ -3,13 +3,38 @@
 
 #include <cstdint>
 #include <map>
+#include <utility>
 #include <vector>
 
+#include "../common/WorkerPool.h"
 #include "../composite/Composite.h"
+#include "../geometry/Geometry.h"
 #include "../gltf/GLTF.h"
 
 #include "../render/Render.h"
 
+#include "SceneCache.h"
+
+struct WorldBuilderSettings {
+
+	// Positions, normals, tangents and texture coordinates are quantized during import.
+	bool quantize = false;
+
+	// Triangles are reordered for vertex cache and overdraw, vertices for fetch locality.
+	bool optimize = false;
+
+	// Simplified index buffers are generated and selected by the projected screen space error.
+	bool lod = false;
+
+	// Triangles are split into meshlets with bounds for cluster culling.
+	bool meshlets = false;
+
+	// Nodes with baked joint matrices are drawn this many times on a grid, each with its own animation time.
+	uint32_t crowdCount = 0;
+	float crowdSpacing = 2.0f;
+
+};
+
 class WorldBuilder {
 
 private:
@@ -19,6 +44,10 @@ private:
 
 	RenderManager& renderManager;
 
+	const WorldBuilderSettings settings;
+
+	QuantizeReport quantizeReport = {};
+
 	std::map<const BufferView*, uint64_t> bufferViewToHandle;
 	std::map<const Node*, uint64_t> nodeToHandles;
 
@@ -27,6 +56,12 @@ private:
 	std::vector<uint64_t> groupHandles;
 	std::vector<uint64_t> instanceHandles;
 
+	std::map<int32_t, const BakedJointMatrices*> nodeToBakedJointMatrices;
+
+	SceneCache* sceneCache = nullptr;
+
+	WorkerPool* workerPool = nullptr;
+
 	bool buildBufferViews();
 
 	bool buildAccessors();
@@ -39,15 +74,60 @@ private:
 
 	bool buildNodes();
 
+	bool buildBakedJointMatrices(uint64_t instanceHandle, const BakedJointMatrices& bakedJointMatrices);
+
 	bool buildScene();
 
+	bool buildAttributes(uint64_t geometryHandle, const Primitive& primitive);
+
+	bool buildAttribute(uint64_t geometryHandle, int32_t accessorIndex, const std::string& description);
+
+	bool buildGeometryData(uint64_t geometryHandle, const GeometryData& geometryData);
+
+	bool buildAttributeData(uint64_t geometryHandle, const std::string& description, uint32_t count, VkFormat format, uint32_t stride, const uint8_t* data, size_t size);
+
+	bool buildIndices(uint64_t geometryModelHandle, uint32_t indicesCount, VkIndexType indexType, const uint8_t* indexData, size_t size);
+
+	bool isRecording() const;
+
+	bool isReplaying() const;
+
+	// Quantized positions need more push constants, than some devices provide.
+	bool isQuantize() const;
+
+	void recordImage(const ImageDataResources& imageDataResources);
+
+	void recordTexture(int32_t source, const TextureResourceCreateInfo& textureResourceCreateInfo);
+
+	void recordPrimitive(const Primitive& primitive, const GeometryData& geometryData, const GeometryDeform* geometryDeform, const GeometryTargets& geometryTargets, VkIndexType indexType, const std::vector<uint8_t>& indexData, const glm::vec3& center, float radius);
+
+	bool replayImage(ImageDataResources& imageDataResources);
+
+	bool replayTextures();
+
+	bool replayMeshes();
+
+	bool replayPrimitive(uint64_t groupHandle);
+
 	uint64_t getBufferHandle(const Accessor& accessor);
 
 	bool createSharedDataResource(const BufferView& bufferView);
 
 public:
 
-	WorldBuilder(const GLTF& glTF, const std::string& environment, RenderManager& resourceManager);
+	WorldBuilder(const GLTF& glTF, const std::string& environment, RenderManager& resourceManager, const WorldBuilderSettings& settings = WorldBuilderSettings());
+
+	// Skinning of the node is sampled from the baked joint matrices. The data has to stay valid until build.
+	void setBakedJointMatrices(int32_t nodeIndex, const BakedJointMatrices& bakedJointMatrices);
+
+	// Results are replayed from a valid scene cache or recorded into it. Has to stay valid until build.
+	void setSceneCache(SceneCache& sceneCache);
+
+	// Mip maps of the textures are generated on the workers. Has to stay valid until build.
+	void setWorkerPool(WorkerPool& workerPool);
+
+	// Settings and render modes, which change the build results.
+	uint64_t getSettingsHash() const;
 
 	bool build();
 
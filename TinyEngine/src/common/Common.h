@@ -4,6 +4,8 @@
 #define VK_ENABLE_BETA_EXTENSIONS
 #include "volk.h"
 
+#include "HelperHash.h"
 #include "Logger.h"
+#include "WorkerPool.h"
 
 #endif /* COMMON_COMMON_H_ */
@@ -0,0 +1,126 @@
+#include "HelperHash.h"
+
+#include <cstring>
+
+static const uint64_t PRIME64_1 = 0x9E3779B185EBCA87ull;
+static const uint64_t PRIME64_2 = 0xC2B2AE3D27D4EB4Full;
+static const uint64_t PRIME64_3 = 0x165667B19E3779F9ull;
+static const uint64_t PRIME64_4 = 0x85EBCA77C2B2AE63ull;
+static const uint64_t PRIME64_5 = 0x27D4EB2F165667C5ull;
+
+static uint64_t rotateLeft(uint64_t value, uint32_t bits)
+{
+	return (value << bits) | (value >> (64 - bits));
+}
+
+// Unaligned little endian reads.
+static uint64_t read64(const uint8_t* data)
+{
+	uint64_t value;
+	memcpy(&value, data, sizeof(value));
+
+	return value;
+}
+
+static uint32_t read32(const uint8_t* data)
+{
+	uint32_t value;
+	memcpy(&value, data, sizeof(value));
+
+	return value;
+}
+
+static uint64_t accumulate(uint64_t accumulator, uint64_t input)
+{
+	accumulator += input * PRIME64_2;
+	accumulator = rotateLeft(accumulator, 31);
+
+	return accumulator * PRIME64_1;
+}
+
+static uint64_t mergeRound(uint64_t accumulator, uint64_t value)
+{
+	accumulator ^= accumulate(0, value);
+
+	return accumulator * PRIME64_1 + PRIME64_4;
+}
+
+uint64_t HelperHash::hash(const void* data, size_t size, uint64_t seed)
+{
+	const uint8_t* current = static_cast<const uint8_t*>(data);
+	const uint8_t* end = current + size;
+
+	uint64_t result;
+
+	// Four independent lanes over blocks of 32 bytes.
+	if (size >= 32)
+	{
+		uint64_t v1 = seed + PRIME64_1 + PRIME64_2;
+		uint64_t v2 = seed + PRIME64_2;
+		uint64_t v3 = seed;
+		uint64_t v4 = seed - PRIME64_1;
+
+		const uint8_t* limit = end - 32;
+		do
+		{
+			v1 = accumulate(v1, read64(current));
+			v2 = accumulate(v2, read64(current + 8));
+			v3 = accumulate(v3, read64(current + 16));
+			v4 = accumulate(v4, read64(current + 24));
+			current += 32;
+		} while (current <= limit);
+
+		result = rotateLeft(v1, 1) + rotateLeft(v2, 7) + rotateLeft(v3, 12) + rotateLeft(v4, 18);
+		result = mergeRound(result, v1);
+		result = mergeRound(result, v2);
+		result = mergeRound(result, v3);
+		result = mergeRound(result, v4);
+	}
+	else
+	{
+		result = seed + PRIME64_5;
+	}
+
+	result += static_cast<uint64_t>(size);
+
+	// Remaining bytes
+	while (current + 8 <= end)
+	{
+		result ^= accumulate(0, read64(current));
+		result = rotateLeft(result, 27) * PRIME64_1 + PRIME64_4;
+		current += 8;
+	}
+
+	if (current + 4 <= end)
+	{
+		result ^= static_cast<uint64_t>(read32(current)) * PRIME64_1;
+		result = rotateLeft(result, 23) * PRIME64_2 + PRIME64_3;
+		current += 4;
+	}
+
+	while (current < end)
+	{
+		result ^= static_cast<uint64_t>(*current) * PRIME64_5;
+		result = rotateLeft(result, 11) * PRIME64_1;
+		current++;
+	}
+
+	// Avalanche
+	result ^= result >> 33;
+	result *= PRIME64_2;
+	result ^= result >> 29;
+	result *= PRIME64_3;
+	result ^= result >> 32;
+
+	return result;
+}
+
+uint64_t HelperHash::hash(const std::string& value, uint64_t seed)
+{
+	return hash(value.data(), value.size(), seed);
+}
+
+uint64_t HelperHash::combine(uint64_t seed, uint64_t value)
+{
+	return hash(&value, sizeof(value), seed);
+}
@@ -0,0 +1,22 @@
+#ifndef COMMON_HELPERHASH_H_
+#define COMMON_HELPERHASH_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// Fast, non cryptographic 64 bit hash with the same results as XXH64.
+class HelperHash
+{
+public:
+
+	static uint64_t hash(const void* data, size_t size, uint64_t seed = 0);
+
+	static uint64_t hash(const std::string& value, uint64_t seed = 0);
+
+	// Order dependent combination of two hashes.
+	static uint64_t combine(uint64_t seed, uint64_t value);
+
+};
+
+#endif /* COMMON_HELPERHASH_H_ */
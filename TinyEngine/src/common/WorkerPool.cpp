@@ -0,0 +1,124 @@
+#include "WorkerPool.h"
+
+#include <algorithm>
+
+void WorkerPool::run()
+{
+	uint64_t lastGeneration = 0;
+
+	while (true)
+	{
+		{
+			std::unique_lock<std::mutex> lock(mutex);
+
+			startCondition.wait(lock, [&] { return stop || generation != lastGeneration; });
+
+			if (stop)
+			{
+				return;
+			}
+
+			lastGeneration = generation;
+		}
+
+		execute();
+
+		{
+			std::unique_lock<std::mutex> lock(mutex);
+
+			working--;
+			if (working == 0)
+			{
+				doneCondition.notify_one();
+			}
+		}
+	}
+}
+
+void WorkerPool::execute()
+{
+	while (true)
+	{
+		size_t begin = next.fetch_add(grainSize);
+		if (begin >= count)
+		{
+			break;
+		}
+
+		(*function)(begin, std::min(begin + grainSize, count));
+	}
+}
+
+WorkerPool::WorkerPool(uint32_t threadsCount) :
+	next(0)
+{
+	if (threadsCount == 0)
+	{
+		threadsCount = std::max(std::thread::hardware_concurrency(), 1u) - 1;
+	}
+
+	for (uint32_t i = 0; i < threadsCount; i++)
+	{
+		threads.push_back(std::thread(&WorkerPool::run, this));
+	}
+}
+
+WorkerPool::~WorkerPool()
+{
+	{
+		std::unique_lock<std::mutex> lock(mutex);
+
+		stop = true;
+	}
+	startCondition.notify_all();
+
+	for (std::thread& thread : threads)
+	{
+		thread.join();
+	}
+}
+
+uint32_t WorkerPool::getThreadsCount() const
+{
+	return static_cast<uint32_t>(threads.size());
+}
+
+void WorkerPool::parallelFor(size_t count, const std::function<void(size_t begin, size_t end)>& function, size_t grainSize)
+{
+	if (count == 0)
+	{
+		return;
+	}
+
+	grainSize = std::max(grainSize, static_cast<size_t>(1));
+
+	if (threads.size() == 0 || count <= grainSize)
+	{
+		function(0, count);
+
+		return;
+	}
+
+	{
+		std::unique_lock<std::mutex> lock(mutex);
+
+		this->function = &function;
+		this->count = count;
+		this->grainSize = grainSize;
+		this->next.store(0);
+
+		working = static_cast<uint32_t>(threads.size());
+		generation++;
+	}
+	startCondition.notify_all();
+
+	execute();
+
+	{
+		std::unique_lock<std::mutex> lock(mutex);
+
+		doneCondition.wait(lock, [&] { return working == 0; });
+
+		this->function = nullptr;
+	}
+}
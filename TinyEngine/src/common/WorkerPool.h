@@ -0,0 +1,50 @@
+#ifndef COMMON_WORKERPOOL_H_
+#define COMMON_WORKERPOOL_H_
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Fixed set of threads, which split a range of work items. The calling thread works as well.
+class WorkerPool
+{
+private:
+
+	std::vector<std::thread> threads;
+
+	std::mutex mutex;
+	std::condition_variable startCondition;
+	std::condition_variable doneCondition;
+
+	const std::function<void(size_t, size_t)>* function = nullptr;
+	size_t count = 0;
+	size_t grainSize = 1;
+	std::atomic<size_t> next;
+
+	uint64_t generation = 0;
+	uint32_t working = 0;
+	bool stop = false;
+
+	void run();
+
+	void execute();
+
+public:
+
+	// Zero threads uses one thread less than the hardware concurrency.
+	WorkerPool(uint32_t threadsCount = 0);
+
+	~WorkerPool();
+
+	uint32_t getThreadsCount() const;
+
+	// Calls the function for consecutive ranges of at most grainSize items and returns, when all are done. Not reentrant.
+	void parallelFor(size_t count, const std::function<void(size_t begin, size_t end)>& function, size_t grainSize = 1);
+
+};
+
+#endif /* COMMON_WORKERPOOL_H_ */
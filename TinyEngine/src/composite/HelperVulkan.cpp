@@ -365,6 +365,10 @@ bool HelperVulkan::getTypeCount(uint32_t& typeCount, VkFormat format)
 		case VK_FORMAT_R16_UINT:
 		case VK_FORMAT_R32_SINT:
 		case VK_FORMAT_R32_UINT:
+		case VK_FORMAT_R8_SSCALED:
+		case VK_FORMAT_R8_USCALED:
+		case VK_FORMAT_R16_SSCALED:
+		case VK_FORMAT_R16_USCALED:
 		case VK_FORMAT_R16_SFLOAT:
 		case VK_FORMAT_R32_SFLOAT:
 			typeCount = 1;
@@ -380,6 +384,10 @@ bool HelperVulkan::getTypeCount(uint32_t& typeCount, VkFormat format)
 		case VK_FORMAT_R16G16_UINT:
 		case VK_FORMAT_R32G32_SINT:
 		case VK_FORMAT_R32G32_UINT:
+		case VK_FORMAT_R8G8_SSCALED:
+		case VK_FORMAT_R8G8_USCALED:
+		case VK_FORMAT_R16G16_SSCALED:
+		case VK_FORMAT_R16G16_USCALED:
 		case VK_FORMAT_R16G16_SFLOAT:
 		case VK_FORMAT_R32G32_SFLOAT:
 			typeCount = 2;
@@ -395,6 +403,10 @@ bool HelperVulkan::getTypeCount(uint32_t& typeCount, VkFormat format)
 		case VK_FORMAT_R16G16B16_UINT:
 		case VK_FORMAT_R32G32B32_SINT:
 		case VK_FORMAT_R32G32B32_UINT:
+		case VK_FORMAT_R8G8B8_SSCALED:
+		case VK_FORMAT_R8G8B8_USCALED:
+		case VK_FORMAT_R16G16B16_SSCALED:
+		case VK_FORMAT_R16G16B16_USCALED:
 		case VK_FORMAT_R16G16B16_SFLOAT:
 		case VK_FORMAT_R32G32B32_SFLOAT:
 			typeCount = 3;
@@ -410,6 +422,10 @@ bool HelperVulkan::getTypeCount(uint32_t& typeCount, VkFormat format)
 		case VK_FORMAT_R16G16B16A16_UINT:
 		case VK_FORMAT_R32G32B32A32_SINT:
 		case VK_FORMAT_R32G32B32A32_UINT:
+		case VK_FORMAT_R8G8B8A8_SSCALED:
+		case VK_FORMAT_R8G8B8A8_USCALED:
+		case VK_FORMAT_R16G16B16A16_SSCALED:
+		case VK_FORMAT_R16G16B16A16_USCALED:
 		case VK_FORMAT_R16G16B16A16_SFLOAT:
 		case VK_FORMAT_R32G32B32A32_SFLOAT:
 			typeCount = 4;
@@ -441,6 +457,14 @@ bool HelperVulkan::getComponentTypeSize(uint32_t& componentTypeSize, VkFormat fo
 		case VK_FORMAT_R8G8B8A8_UNORM:
 		case VK_FORMAT_R8G8B8A8_SINT:
 		case VK_FORMAT_R8G8B8A8_UINT:
+		case VK_FORMAT_R8_SSCALED:
+		case VK_FORMAT_R8_USCALED:
+		case VK_FORMAT_R8G8_SSCALED:
+		case VK_FORMAT_R8G8_USCALED:
+		case VK_FORMAT_R8G8B8_SSCALED:
+		case VK_FORMAT_R8G8B8_USCALED:
+		case VK_FORMAT_R8G8B8A8_SSCALED:
+		case VK_FORMAT_R8G8B8A8_USCALED:
 			componentTypeSize = 1;
 			return true;
 
@@ -453,6 +477,7 @@ bool HelperVulkan::getComponentTypeSize(uint32_t& componentTypeSize, VkFormat fo
 		case VK_FORMAT_R16G16_UNORM:
 		case VK_FORMAT_R16G16_SINT:
 		case VK_FORMAT_R16G16_UINT:
+		case VK_FORMAT_R16G16_SFLOAT:
 		case VK_FORMAT_R16G16B16_SNORM:
 		case VK_FORMAT_R16G16B16_UNORM:
 		case VK_FORMAT_R16G16B16_SINT:
@@ -463,6 +488,14 @@ bool HelperVulkan::getComponentTypeSize(uint32_t& componentTypeSize, VkFormat fo
 		case VK_FORMAT_R16G16B16A16_SINT:
 		case VK_FORMAT_R16G16B16A16_UINT:
 		case VK_FORMAT_R16G16B16A16_SFLOAT:
+		case VK_FORMAT_R16_SSCALED:
+		case VK_FORMAT_R16_USCALED:
+		case VK_FORMAT_R16G16_SSCALED:
+		case VK_FORMAT_R16G16_USCALED:
+		case VK_FORMAT_R16G16B16_SSCALED:
+		case VK_FORMAT_R16G16B16_USCALED:
+		case VK_FORMAT_R16G16B16A16_SSCALED:
+		case VK_FORMAT_R16G16B16A16_USCALED:
 			componentTypeSize = 2;
 			return true;
 
@@ -471,7 +504,6 @@ bool HelperVulkan::getComponentTypeSize(uint32_t& componentTypeSize, VkFormat fo
 		case VK_FORMAT_R32_SFLOAT:
 		case VK_FORMAT_R32G32_SINT:
 		case VK_FORMAT_R32G32_UINT:
-		case VK_FORMAT_R16G16_SFLOAT:
 		case VK_FORMAT_R32G32_SFLOAT:
 		case VK_FORMAT_R32G32B32_SINT:
 		case VK_FORMAT_R32G32B32_UINT:
@@ -488,6 +520,165 @@ bool HelperVulkan::getComponentTypeSize(uint32_t& componentTypeSize, VkFormat fo
 	return false;
 }
 
+bool HelperVulkan::getScaledFormat(VkFormat& scaledFormat, VkFormat format)
+{
+	// Integer attributes, which are not normalized, are converted to float by the vertex input stage.
+	switch (format)
+	{
+		case VK_FORMAT_R8_SINT:
+			scaledFormat = VK_FORMAT_R8_SSCALED;
+			return true;
+		case VK_FORMAT_R8_UINT:
+			scaledFormat = VK_FORMAT_R8_USCALED;
+			return true;
+		case VK_FORMAT_R8G8_SINT:
+			scaledFormat = VK_FORMAT_R8G8_SSCALED;
+			return true;
+		case VK_FORMAT_R8G8_UINT:
+			scaledFormat = VK_FORMAT_R8G8_USCALED;
+			return true;
+		case VK_FORMAT_R8G8B8_SINT:
+			scaledFormat = VK_FORMAT_R8G8B8_SSCALED;
+			return true;
+		case VK_FORMAT_R8G8B8_UINT:
+			scaledFormat = VK_FORMAT_R8G8B8_USCALED;
+			return true;
+		case VK_FORMAT_R8G8B8A8_SINT:
+			scaledFormat = VK_FORMAT_R8G8B8A8_SSCALED;
+			return true;
+		case VK_FORMAT_R8G8B8A8_UINT:
+			scaledFormat = VK_FORMAT_R8G8B8A8_USCALED;
+			return true;
+		case VK_FORMAT_R16_SINT:
+			scaledFormat = VK_FORMAT_R16_SSCALED;
+			return true;
+		case VK_FORMAT_R16_UINT:
+			scaledFormat = VK_FORMAT_R16_USCALED;
+			return true;
+		case VK_FORMAT_R16G16_SINT:
+			scaledFormat = VK_FORMAT_R16G16_SSCALED;
+			return true;
+		case VK_FORMAT_R16G16_UINT:
+			scaledFormat = VK_FORMAT_R16G16_USCALED;
+			return true;
+		case VK_FORMAT_R16G16B16_SINT:
+			scaledFormat = VK_FORMAT_R16G16B16_SSCALED;
+			return true;
+		case VK_FORMAT_R16G16B16_UINT:
+			scaledFormat = VK_FORMAT_R16G16B16_USCALED;
+			return true;
+		case VK_FORMAT_R16G16B16A16_SINT:
+			scaledFormat = VK_FORMAT_R16G16B16A16_SSCALED;
+			return true;
+		case VK_FORMAT_R16G16B16A16_UINT:
+			scaledFormat = VK_FORMAT_R16G16B16A16_USCALED;
+			return true;
+		default:
+			break;
+	}
+
+	return false;
+}
+
+bool HelperVulkan::getComponentType(bool& componentTypeSigned, bool& componentTypeInteger, bool& normalized, VkFormat format)
+{
+	switch (format)
+	{
+		case VK_FORMAT_R8_SNORM:
+		case VK_FORMAT_R8G8_SNORM:
+		case VK_FORMAT_R8G8B8_SNORM:
+		case VK_FORMAT_R8G8B8A8_SNORM:
+		case VK_FORMAT_R16_SNORM:
+		case VK_FORMAT_R16G16_SNORM:
+		case VK_FORMAT_R16G16B16_SNORM:
+		case VK_FORMAT_R16G16B16A16_SNORM:
+			componentTypeSigned = true;
+			componentTypeInteger = true;
+			normalized = true;
+			return true;
+
+		case VK_FORMAT_R8_UNORM:
+		case VK_FORMAT_R8G8_UNORM:
+		case VK_FORMAT_R8G8B8_UNORM:
+		case VK_FORMAT_R8G8B8A8_UNORM:
+		case VK_FORMAT_R16_UNORM:
+		case VK_FORMAT_R16G16_UNORM:
+		case VK_FORMAT_R16G16B16_UNORM:
+		case VK_FORMAT_R16G16B16A16_UNORM:
+			componentTypeSigned = false;
+			componentTypeInteger = true;
+			normalized = true;
+			return true;
+
+		case VK_FORMAT_R8_SINT:
+		case VK_FORMAT_R8G8_SINT:
+		case VK_FORMAT_R8G8B8_SINT:
+		case VK_FORMAT_R8G8B8A8_SINT:
+		case VK_FORMAT_R16_SINT:
+		case VK_FORMAT_R16G16_SINT:
+		case VK_FORMAT_R16G16B16_SINT:
+		case VK_FORMAT_R16G16B16A16_SINT:
+		case VK_FORMAT_R32_SINT:
+		case VK_FORMAT_R32G32_SINT:
+		case VK_FORMAT_R32G32B32_SINT:
+		case VK_FORMAT_R32G32B32A32_SINT:
+		case VK_FORMAT_R8_SSCALED:
+		case VK_FORMAT_R8G8_SSCALED:
+		case VK_FORMAT_R8G8B8_SSCALED:
+		case VK_FORMAT_R8G8B8A8_SSCALED:
+		case VK_FORMAT_R16_SSCALED:
+		case VK_FORMAT_R16G16_SSCALED:
+		case VK_FORMAT_R16G16B16_SSCALED:
+		case VK_FORMAT_R16G16B16A16_SSCALED:
+			componentTypeSigned = true;
+			componentTypeInteger = true;
+			normalized = false;
+			return true;
+
+		case VK_FORMAT_R8_UINT:
+		case VK_FORMAT_R8G8_UINT:
+		case VK_FORMAT_R8G8B8_UINT:
+		case VK_FORMAT_R8G8B8A8_UINT:
+		case VK_FORMAT_R16_UINT:
+		case VK_FORMAT_R16G16_UINT:
+		case VK_FORMAT_R16G16B16_UINT:
+		case VK_FORMAT_R16G16B16A16_UINT:
+		case VK_FORMAT_R32_UINT:
+		case VK_FORMAT_R32G32_UINT:
+		case VK_FORMAT_R32G32B32_UINT:
+		case VK_FORMAT_R32G32B32A32_UINT:
+		case VK_FORMAT_R8_USCALED:
+		case VK_FORMAT_R8G8_USCALED:
+		case VK_FORMAT_R8G8B8_USCALED:
+		case VK_FORMAT_R8G8B8A8_USCALED:
+		case VK_FORMAT_R16_USCALED:
+		case VK_FORMAT_R16G16_USCALED:
+		case VK_FORMAT_R16G16B16_USCALED:
+		case VK_FORMAT_R16G16B16A16_USCALED:
+			componentTypeSigned = false;
+			componentTypeInteger = true;
+			normalized = false;
+			return true;
+
+		case VK_FORMAT_R16_SFLOAT:
+		case VK_FORMAT_R16G16_SFLOAT:
+		case VK_FORMAT_R16G16B16_SFLOAT:
+		case VK_FORMAT_R16G16B16A16_SFLOAT:
+		case VK_FORMAT_R32_SFLOAT:
+		case VK_FORMAT_R32G32_SFLOAT:
+		case VK_FORMAT_R32G32B32_SFLOAT:
+		case VK_FORMAT_R32G32B32A32_SFLOAT:
+			componentTypeSigned = true;
+			componentTypeInteger = false;
+			normalized = false;
+			return true;
+		default:
+			break;
+	}
+
+	return false;
+}
+
 bool HelperVulkan::getAligenedSize(VkDeviceSize& alignedSize, VkDeviceSize unalignedSize, VkDeviceSize alignment)
 {
 	if (alignment <= 1)
@@ -509,6 +700,14 @@ bool HelperVulkan::getAligenedSize(VkDeviceSize& alignedSize, VkDeviceSize unali
 	return true;
 }
 
+bool HelperVulkan::hasFormatFeatures(VkPhysicalDevice physicalDevice, VkFormat format, VkFormatFeatureFlags formatFeatures)
+{
+	VkFormatProperties formatProperties = {};
+	vkGetPhysicalDeviceFormatProperties(physicalDevice, format, &formatProperties);
+
+	return (formatProperties.optimalTilingFeatures & formatFeatures) == formatFeatures;
+}
+
 bool HelperVulkan::findMemoryTypeIndex(uint32_t& memoryTypeIndex, VkPhysicalDevice physicalDevice, uint32_t memoryType, VkMemoryPropertyFlags memoryProperty)
 {
 	VkPhysicalDeviceMemoryProperties physicalDeviceMemoryProperties = {};
@@ -697,7 +896,7 @@ bool HelperVulkan::transitionImageLayout(VkDevice device, VkQueue queue, VkComma
 	return true;
 }
 
-bool HelperVulkan::copyBuffer(VkDevice device, VkQueue queue, VkCommandPool commandPool, VkBuffer srcBuffer, VkBuffer dstBuffer, VkDeviceSize size)
+bool HelperVulkan::copyBuffer(VkDevice device, VkQueue queue, VkCommandPool commandPool, VkBuffer srcBuffer, VkBuffer dstBuffer, VkDeviceSize size, VkDeviceSize srcOffset, VkDeviceSize dstOffset)
 {
 	VkCommandBuffer commandBuffer = VK_NULL_HANDLE;
 
@@ -709,6 +908,8 @@ bool HelperVulkan::copyBuffer(VkDevice device, VkQueue queue, VkCommandPool comm
 	//
 
 	VkBufferCopy copyRegion = {};
+	copyRegion.srcOffset = srcOffset;
+	copyRegion.dstOffset = dstOffset;
 	copyRegion.size = size;
 	vkCmdCopyBuffer(commandBuffer, srcBuffer, dstBuffer, 1, &copyRegion);
 
@@ -733,9 +934,10 @@ bool HelperVulkan::copyBufferToImage(VkDevice device, VkQueue queue, VkCommandPo
 
 	//
 
+	// Tightly packed, which also works for block compressed images smaller than a block.
 	VkBufferImageCopy bufferImageCopy = {};
-	bufferImageCopy.bufferRowLength = width;
-	bufferImageCopy.bufferImageHeight = height;
+	bufferImageCopy.bufferRowLength = 0;
+	bufferImageCopy.bufferImageHeight = 0;
 	bufferImageCopy.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
 	bufferImageCopy.imageSubresource.mipLevel = mipLevel;
 	bufferImageCopy.imageSubresource.baseArrayLayer = baseArrayLayer;
@@ -754,6 +956,34 @@ bool HelperVulkan::copyBufferToImage(VkDevice device, VkQueue queue, VkCommandPo
 	return true;
 }
 
+bool HelperVulkan::copyBufferToImage(VkDevice device, VkQueue queue, VkCommandPool commandPool, VkBuffer srcBuffer, VkImage dstImage, const std::vector<VkBufferImageCopy>& regions)
+{
+	if (regions.empty())
+	{
+		return false;
+	}
+
+	VkCommandBuffer commandBuffer = VK_NULL_HANDLE;
+
+	if (!beginOneTimeSubmitCommand(device, commandPool, commandBuffer))
+	{
+		return false;
+	}
+
+	//
+
+	vkCmdCopyBufferToImage(commandBuffer, srcBuffer, dstImage, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, static_cast<uint32_t>(regions.size()), regions.data());
+
+	//
+
+	if (!endOneTimeSubmitCommand(device, queue, commandPool, commandBuffer))
+	{
+		return false;
+	}
+
+	return true;
+}
+
 bool HelperVulkan::generateMipMap(VkDevice device, VkQueue queue, VkCommandPool commandPool, VkImage image, uint32_t width, uint32_t height, uint32_t levelCount, uint32_t layerCount)
 {
 	VkCommandBuffer commandBuffer = VK_NULL_HANDLE;
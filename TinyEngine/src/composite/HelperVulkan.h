@@ -18,8 +18,15 @@ public:
 
 	static bool getComponentTypeSize(uint32_t& componentTypeSize, VkFormat format);
 
+	static bool getScaledFormat(VkFormat& scaledFormat, VkFormat format);
+
+	static bool getComponentType(bool& componentTypeSigned, bool& componentTypeInteger, bool& normalized, VkFormat format);
+
 	static bool getAligenedSize(VkDeviceSize& alignedSize, VkDeviceSize unalignedSize, VkDeviceSize alignment);
 
+	// Optimal tiling features of the format on this device.
+	static bool hasFormatFeatures(VkPhysicalDevice physicalDevice, VkFormat format, VkFormatFeatureFlags formatFeatures);
+
 	static bool findMemoryTypeIndex(uint32_t& memoryTypeIndex, VkPhysicalDevice physicalDevice, uint32_t memoryType, VkMemoryPropertyFlags memoryProperty);
 
 	static bool beginOneTimeSubmitCommand(VkDevice device, VkCommandPool commandPool, VkCommandBuffer& commandBuffer);
@@ -28,10 +35,13 @@ public:
 
 	static bool transitionImageLayout(VkDevice device, VkQueue queue, VkCommandPool commandPool, VkImage image, VkImageLayout oldLayout, VkImageLayout newLayout, uint32_t baseMipLevel, uint32_t levelCount, uint32_t layerCount);
 
-	static bool copyBuffer(VkDevice device, VkQueue queue, VkCommandPool commandPool, VkBuffer srcBuffer, VkBuffer dstBuffer, VkDeviceSize size);
+	static bool copyBuffer(VkDevice device, VkQueue queue, VkCommandPool commandPool, VkBuffer srcBuffer, VkBuffer dstBuffer, VkDeviceSize size, VkDeviceSize srcOffset = 0, VkDeviceSize dstOffset = 0);
 
 	static bool copyBufferToImage(VkDevice device, VkQueue queue, VkCommandPool commandPool, VkBuffer srcBuffer, VkImage dstImage, uint32_t width, uint32_t height, uint32_t mipLevel, uint32_t baseArrayLayer);
 
+	// All regions are copied with one command.
+	static bool copyBufferToImage(VkDevice device, VkQueue queue, VkCommandPool commandPool, VkBuffer srcBuffer, VkImage dstImage, const std::vector<VkBufferImageCopy>& regions);
+
 	static bool generateMipMap(VkDevice device, VkQueue queue, VkCommandPool commandPool, VkImage image, uint32_t width, uint32_t height, uint32_t levelCount, uint32_t layerCount);
 
 };
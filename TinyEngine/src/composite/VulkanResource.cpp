@@ -1,11 +1,18 @@
 #include "VulkanResource.h"
 
 #include <cstring>
+#include <numeric>
+#include <tuple>
 
 #include "../math/Math.h"
 
 #include "HelperVulkan.h"
 
+bool operator <(const SamplerResourceCreateInfo& left, const SamplerResourceCreateInfo& right)
+{
+	return std::tie(left.magFilter, left.minFilter, left.mipmapMode, left.addressModeU, left.addressModeV, left.minLod, left.maxLod) < std::tie(right.magFilter, right.minFilter, right.mipmapMode, right.addressModeU, right.addressModeV, right.minLod, right.maxLod);
+}
+
 bool VulkanResource::copyHostToDevice(VkDevice device, BufferResource& bufferResource, const void* data, size_t size, VkDeviceSize offset)
 {
 	if (data == nullptr || size == 0)
@@ -353,17 +360,35 @@ void VulkanResource::destroyImageViewResource(VkDevice device, ImageViewResource
 	}
 }
 
-bool VulkanResource::createTextureResource(VkPhysicalDevice physicalDevice, VkDevice device, VkQueue queue, VkCommandPool commandPool, TextureResource& textureResource, const TextureResourceCreateInfo& textureResourceCreateInfo)
+bool VulkanResource::createTextureImageResource(VkPhysicalDevice physicalDevice, VkDevice device, VkQueue queue, VkCommandPool commandPool, ImageViewResource& imageViewResource, uint32_t& mipLevels, const TextureResourceCreateInfo& textureResourceCreateInfo)
 {
 	if (textureResourceCreateInfo.imageDataResources.images.size() != textureResourceCreateInfo.imageDataResources.mipLevels * textureResourceCreateInfo.imageDataResources.faceCount)
 	{
 		return false;
 	}
 
+	VkFormat format = textureResourceCreateInfo.imageDataResources.images[0].format;
+	bool blockCompressed = HelperFormat::isBlockCompressed(format);
+
+	if (!HelperVulkan::hasFormatFeatures(physicalDevice, format, VK_FORMAT_FEATURE_SAMPLED_IMAGE_BIT | VK_FORMAT_FEATURE_TRANSFER_DST_BIT))
+	{
+		Logger::print(TinyEngine_ERROR, __FILE__, __LINE__, "Format %d can not be sampled on this device", static_cast<int>(format));
+
+		return false;
+	}
+
+	if (textureResourceCreateInfo.samplerResourceCreateInfo.magFilter == VK_FILTER_LINEAR || textureResourceCreateInfo.samplerResourceCreateInfo.minFilter == VK_FILTER_LINEAR)
+	{
+		if (!HelperVulkan::hasFormatFeatures(physicalDevice, format, VK_FORMAT_FEATURE_SAMPLED_IMAGE_FILTER_LINEAR_BIT))
+		{
+			Logger::print(TinyEngine_WARNING, __FILE__, __LINE__, "Format %d can not be filtered linear on this device", static_cast<int>(format));
+		}
+	}
+
 	//
 
 	ImageViewResourceCreateInfo imageViewResourceCreateInfo = {};
-	imageViewResourceCreateInfo.format = textureResourceCreateInfo.imageDataResources.images[0].format;
+	imageViewResourceCreateInfo.format = format;
 	imageViewResourceCreateInfo.extent = {textureResourceCreateInfo.imageDataResources.images[0].width, textureResourceCreateInfo.imageDataResources.images[0].height, 1};
 	imageViewResourceCreateInfo.mipLevels = textureResourceCreateInfo.imageDataResources.mipLevels;
 	imageViewResourceCreateInfo.samples = VK_SAMPLE_COUNT_1_BIT;
@@ -376,8 +401,9 @@ bool VulkanResource::createTextureResource(VkPhysicalDevice physicalDevice, VkDe
 		imageViewResourceCreateInfo.imageViewType = VK_IMAGE_VIEW_TYPE_CUBE;
 	}
 
+	// Block compressed images can not be blitted, so only their stored levels are used.
 	bool creatMipMaps = false;
-	if (textureResourceCreateInfo.mipMap && imageViewResourceCreateInfo.mipLevels == 1)
+	if (textureResourceCreateInfo.mipMap && imageViewResourceCreateInfo.mipLevels == 1 && !blockCompressed && HelperVulkan::hasFormatFeatures(physicalDevice, format, VK_FORMAT_FEATURE_BLIT_SRC_BIT | VK_FORMAT_FEATURE_BLIT_DST_BIT | VK_FORMAT_FEATURE_SAMPLED_IMAGE_FILTER_LINEAR_BIT))
 	{
 		imageViewResourceCreateInfo.mipLevels = (uint32_t)glm::max(log2f((float)textureResourceCreateInfo.imageDataResources.images[0].width), log2f((float)textureResourceCreateInfo.imageDataResources.images[0].height)) + 1;
 		imageViewResourceCreateInfo.usage |= VK_IMAGE_USAGE_TRANSFER_SRC_BIT;
@@ -385,65 +411,115 @@ bool VulkanResource::createTextureResource(VkPhysicalDevice physicalDevice, VkDe
 		creatMipMaps = true;
 	}
 
-	if (!VulkanResource::createImageViewResource(physicalDevice, device, textureResource.imageViewResource, imageViewResourceCreateInfo))
+	if (!VulkanResource::createImageViewResource(physicalDevice, device, imageViewResource, imageViewResourceCreateInfo))
 	{
 		return false;
 	}
 
 	//
 
-	if (!HelperVulkan::transitionImageLayout(device, queue, commandPool, textureResource.imageViewResource.image, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 0, textureResourceCreateInfo.imageDataResources.mipLevels, textureResourceCreateInfo.imageDataResources.faceCount))
+	if (!HelperVulkan::transitionImageLayout(device, queue, commandPool, imageViewResource.image, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 0, textureResourceCreateInfo.imageDataResources.mipLevels, textureResourceCreateInfo.imageDataResources.faceCount))
 	{
-		destroyImageViewResource(device, textureResource.imageViewResource);
+		destroyImageViewResource(device, imageViewResource);
 
 		return false;
 	}
 
 	//
 
+	// All levels and faces are staged in one buffer and copied with one command.
+	// Offsets have to be a multiple of four and of the texel or block size.
+	std::vector<VkBufferImageCopy> bufferImageCopies;
+	VkDeviceSize stageSize = 0;
+
 	for (const ImageDataResource& currentImageDataResource : textureResourceCreateInfo.imageDataResources.images)
 	{
-		BufferResourceCreateInfo stageBufferResourceCreateInfo = {};
-		stageBufferResourceCreateInfo.size = currentImageDataResource.pixels.size();
-		stageBufferResourceCreateInfo.usage = VK_BUFFER_USAGE_TRANSFER_SRC_BIT;
-		stageBufferResourceCreateInfo.memoryProperty = VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT;
+		size_t pixelsSize = currentImageDataResource.mapped ? currentImageDataResource.mappedSize : currentImageDataResource.pixels.size();
 
-		BufferResource stageBufferResource = {};
-		if (!createBufferResource(physicalDevice, device, stageBufferResource, stageBufferResourceCreateInfo))
+		if (currentImageDataResource.format != format || pixelsSize == 0 || (blockCompressed && pixelsSize != HelperFormat::getImageSize(format, currentImageDataResource.width, currentImageDataResource.height)))
 		{
-			destroyImageViewResource(device, textureResource.imageViewResource);
+			destroyImageViewResource(device, imageViewResource);
 
 			return false;
 		}
 
-		if (!copyHostToDevice(device, stageBufferResource, currentImageDataResource.pixels.data(), currentImageDataResource.pixels.size()))
+		uint32_t blockWidth = 1;
+		uint32_t blockHeight = 1;
+		uint32_t elementSize = 1;
+		if (blockCompressed)
+		{
+			HelperFormat::getBlockInfo(blockWidth, blockHeight, elementSize, format);
+		}
+		else
 		{
-			destroyImageViewResource(device, textureResource.imageViewResource);
+			elementSize = static_cast<uint32_t>(pixelsSize / (static_cast<size_t>(currentImageDataResource.width) * static_cast<size_t>(currentImageDataResource.height)));
+		}
 
-			destroyBufferResource(device, stageBufferResource);
+		VkDeviceSize alignment = std::lcm(4u, glm::max(elementSize, 1u));
+		stageSize = (stageSize + alignment - 1) / alignment * alignment;
 
-			return false;
-		}
+		// Tightly packed, which also works for block compressed images smaller than a block.
+		VkBufferImageCopy bufferImageCopy = {};
+		bufferImageCopy.bufferOffset = stageSize;
+		bufferImageCopy.bufferRowLength = 0;
+		bufferImageCopy.bufferImageHeight = 0;
+		bufferImageCopy.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+		bufferImageCopy.imageSubresource.mipLevel = currentImageDataResource.mipLevel;
+		bufferImageCopy.imageSubresource.baseArrayLayer = currentImageDataResource.face;
+		bufferImageCopy.imageSubresource.layerCount = 1;
+		bufferImageCopy.imageExtent = {currentImageDataResource.width, currentImageDataResource.height, 1};
+
+		bufferImageCopies.push_back(bufferImageCopy);
+
+		stageSize += pixelsSize;
+	}
+
+	BufferResourceCreateInfo stageBufferResourceCreateInfo = {};
+	stageBufferResourceCreateInfo.size = stageSize;
+	stageBufferResourceCreateInfo.usage = VK_BUFFER_USAGE_TRANSFER_SRC_BIT;
+	stageBufferResourceCreateInfo.memoryProperty = VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT;
 
-		//
+	BufferResource stageBufferResource = {};
+	if (!createBufferResource(physicalDevice, device, stageBufferResource, stageBufferResourceCreateInfo))
+	{
+		destroyImageViewResource(device, imageViewResource);
 
-		if (!HelperVulkan::copyBufferToImage(device, queue, commandPool, stageBufferResource.buffer, textureResource.imageViewResource.image, currentImageDataResource.width, currentImageDataResource.height, currentImageDataResource.mipLevel, currentImageDataResource.face))
+		return false;
+	}
+
+	for (size_t i = 0; i < textureResourceCreateInfo.imageDataResources.images.size(); i++)
+	{
+		const ImageDataResource& currentImageDataResource = textureResourceCreateInfo.imageDataResources.images[i];
+
+		const uint8_t* pixels = currentImageDataResource.mapped ? currentImageDataResource.mapped : currentImageDataResource.pixels.data();
+		size_t pixelsSize = currentImageDataResource.mapped ? currentImageDataResource.mappedSize : currentImageDataResource.pixels.size();
+
+		if (!copyHostToDevice(device, stageBufferResource, pixels, pixelsSize, bufferImageCopies[i].bufferOffset))
 		{
-			destroyImageViewResource(device, textureResource.imageViewResource);
+			destroyImageViewResource(device, imageViewResource);
 
 			destroyBufferResource(device, stageBufferResource);
 
 			return false;
 		}
+	}
+
+	if (!HelperVulkan::copyBufferToImage(device, queue, commandPool, stageBufferResource.buffer, imageViewResource.image, bufferImageCopies))
+	{
+		destroyImageViewResource(device, imageViewResource);
 
 		destroyBufferResource(device, stageBufferResource);
+
+		return false;
 	}
 
+	destroyBufferResource(device, stageBufferResource);
+
 	//
 
-	if (!HelperVulkan::transitionImageLayout(device, queue, commandPool, textureResource.imageViewResource.image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, 0, textureResourceCreateInfo.imageDataResources.mipLevels, textureResourceCreateInfo.imageDataResources.faceCount))
+	if (!HelperVulkan::transitionImageLayout(device, queue, commandPool, imageViewResource.image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, 0, textureResourceCreateInfo.imageDataResources.mipLevels, textureResourceCreateInfo.imageDataResources.faceCount))
 	{
-		destroyImageViewResource(device, textureResource.imageViewResource);
+		destroyImageViewResource(device, imageViewResource);
 
 		return false;
 	}
@@ -452,18 +528,29 @@ bool VulkanResource::createTextureResource(VkPhysicalDevice physicalDevice, VkDe
 
 	if (creatMipMaps)
 	{
-		if (!HelperVulkan::generateMipMap(device, queue, commandPool, textureResource.imageViewResource.image, textureResourceCreateInfo.imageDataResources.images[0].width, textureResourceCreateInfo.imageDataResources.images[0].height, imageViewResourceCreateInfo.mipLevels, textureResourceCreateInfo.imageDataResources.faceCount))
+		if (!HelperVulkan::generateMipMap(device, queue, commandPool, imageViewResource.image, textureResourceCreateInfo.imageDataResources.images[0].width, textureResourceCreateInfo.imageDataResources.images[0].height, imageViewResourceCreateInfo.mipLevels, textureResourceCreateInfo.imageDataResources.faceCount))
 		{
-			destroyImageViewResource(device, textureResource.imageViewResource);
+			destroyImageViewResource(device, imageViewResource);
 
 			return false;
 		}
 	}
 
-	//
+	mipLevels = imageViewResourceCreateInfo.mipLevels;
+
+	return true;
+}
+
+bool VulkanResource::createTextureResource(VkPhysicalDevice physicalDevice, VkDevice device, VkQueue queue, VkCommandPool commandPool, TextureResource& textureResource, const TextureResourceCreateInfo& textureResourceCreateInfo)
+{
+	uint32_t mipLevels = 1;
+	if (!createTextureImageResource(physicalDevice, device, queue, commandPool, textureResource.imageViewResource, mipLevels, textureResourceCreateInfo))
+	{
+		return false;
+	}
 
 	SamplerResourceCreateInfo samplerResourceCreateInfo = textureResourceCreateInfo.samplerResourceCreateInfo;
-	samplerResourceCreateInfo.maxLod = (float)imageViewResourceCreateInfo.mipLevels;
+	samplerResourceCreateInfo.maxLod = (float)mipLevels;
 
 	if (!createSamplerResource(device, textureResource.samplerResource, samplerResourceCreateInfo))
 	{
@@ -93,6 +93,9 @@ struct SamplerResourceCreateInfo {
     float                   maxLod = 1.0f;
 };
 
+// Orders all parameters, so equal samplers can be found in a map.
+bool operator <(const SamplerResourceCreateInfo& left, const SamplerResourceCreateInfo& right);
+
 struct SamplerResource {
 	VkSampler sampler = VK_NULL_HANDLE;
 };
@@ -144,6 +147,9 @@ public:
 
 	static void destroySamplerResource(VkDevice device, SamplerResource& samplerResource);
 
+	// Creates and uploads the image only. The mip levels include the generated ones, which the sampler has to cover.
+	static bool createTextureImageResource(VkPhysicalDevice physicalDevice, VkDevice device, VkQueue queue, VkCommandPool commandPool, ImageViewResource& imageViewResource, uint32_t& mipLevels, const TextureResourceCreateInfo& textureResourceCreateInfo);
+
 	static bool createTextureResource(VkPhysicalDevice physicalDevice, VkDevice device, VkQueue queue, VkCommandPool commandPool, TextureResource& textureResource, const TextureResourceCreateInfo& textureResourceCreateInfo);
 
 	static void destroyTextureResource(VkDevice device, TextureResource& textureResource);
@@ -0,0 +1,12 @@
+#ifndef GEOMETRY_GEOMETRY_H_
+#define GEOMETRY_GEOMETRY_H_
+
+#include "GeometryData.h"
+#include "HelperGeometry.h"
+#include "HelperMeshlet.h"
+#include "HelperOptimize.h"
+#include "HelperQuantize.h"
+#include "HelperSimplify.h"
+#include "HelperTarget.h"
+
+#endif /* GEOMETRY_GEOMETRY_H_ */
@@ -0,0 +1,142 @@
+#ifndef GEOMETRY_GEOMETRYDATA_H_
+#define GEOMETRY_GEOMETRYDATA_H_
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "../composite/Composite.h"
+#include "../math/Math.h"
+
+struct GeometryLod {
+
+	uint32_t firstIndex = 0;
+	uint32_t indicesCount = 0;
+
+	// Geometric error in model units.
+	float error = 0.0f;
+
+};
+
+// Same memory layout as the meshlet in the cull shader.
+struct GeometryMeshlet {
+
+	// Bounding sphere in model space.
+	glm::vec3 center = glm::vec3(0.0f, 0.0f, 0.0f);
+	float radius = 0.0f;
+
+	// All triangles are back facing, if dot(center - camera, coneAxis) >= coneCutoff * length(center - camera) + radius.
+	glm::vec3 coneAxis = glm::vec3(0.0f, 0.0f, 1.0f);
+	float coneCutoff = 1.0f;
+
+	uint32_t vertexOffset = 0;
+	uint32_t triangleOffset = 0;
+	uint32_t vertexCount = 0;
+	uint32_t triangleCount = 0;
+
+};
+
+// Morph targets with only the non-zero deltas, grouped by vertex and sorted by target.
+// Deltas are three half floats in two values, with the target index in the upper 16 bits of the second value.
+struct GeometryTargets {
+
+	uint32_t count = 0;
+	uint32_t targetsCount = 0;
+
+	// Deltas of a vertex are in the range [offsets[vertex], offsets[vertex + 1]).
+	std::vector<uint32_t> offsets;
+
+	std::vector<glm::uvec2> positions;
+	std::vector<glm::uvec2> normals;
+	std::vector<glm::uvec2> tangents;
+
+};
+
+// Tightly packed vertex attribute, owned on the CPU side.
+struct GeometryAttribute {
+
+	std::string description = "";
+
+	VkFormat format = VK_FORMAT_UNDEFINED;
+	uint32_t stride = 0;
+
+	std::vector<uint8_t> data;
+
+};
+
+struct GeometryData {
+
+	uint32_t count = 0;
+
+	std::vector<GeometryAttribute> attributes;
+
+	// Indices are processed as 32 bit and packed for upload.
+	std::vector<uint32_t> indices;
+
+	// Level of details are stored one after another in the indices, starting with the full resolution.
+	std::vector<GeometryLod> lods;
+
+	// Meshlets of the full resolution. Vertices are indices into the geometry, triangles three 8 bit indices into the meshlet vertices.
+	std::vector<GeometryMeshlet> meshlets;
+	std::vector<uint32_t> meshletVertices;
+	std::vector<uint32_t> meshletTriangles;
+
+	// Morph targets, remapped together with the vertices.
+	GeometryTargets targets;
+
+	// Quantized positions are dequantized as position * positionScale + positionOffset.
+
+	bool positionQuantized = false;
+	glm::vec3 positionScale = glm::vec3(1.0f, 1.0f, 1.0f);
+	glm::vec3 positionOffset = glm::vec3(0.0f, 0.0f, 0.0f);
+
+};
+
+// Source of the deformation pre-pass, decoded to 32 bit and padded to four components.
+struct GeometryDeform {
+
+	uint32_t count = 0;
+
+	std::vector<glm::vec4> positions;
+	std::vector<glm::vec4> normals;
+	std::vector<glm::vec4> tangents;
+
+	// Up to two groups of four joints and weights per vertex, stored one vertex after another.
+	uint32_t jointGroups = 0;
+	std::vector<glm::uvec4> joints;
+	std::vector<glm::vec4> weights;
+
+};
+
+struct QuantizeReport {
+
+	// Maximum absolute position error, in model units and relative to the bounding box extent.
+	float positionError = 0.0f;
+	float positionRelativeError = 0.0f;
+
+	// Maximum angle error in degrees.
+	float normalError = 0.0f;
+	float tangentError = 0.0f;
+
+	// Maximum absolute texture coordinate error.
+	float texCoordError = 0.0f;
+
+	uint64_t originalSize = 0;
+	uint64_t quantizedSize = 0;
+
+};
+
+struct OptimizeReport {
+
+	// Average cache miss ratio per triangle and average transformed vertices ratio per vertex.
+	float acmrBefore = 0.0f;
+	float acmrAfter = 0.0f;
+	float atvrBefore = 0.0f;
+	float atvrAfter = 0.0f;
+
+	uint32_t countBefore = 0;
+	uint32_t countAfter = 0;
+
+};
+
+#endif /* GEOMETRY_GEOMETRYDATA_H_ */
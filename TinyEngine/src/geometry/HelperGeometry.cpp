@@ -0,0 +1,480 @@
+#include "HelperGeometry.h"
+
+#include <cstring>
+
+#include "../composite/HelperVulkan.h"
+
+#include "HelperTarget.h"
+
+std::vector<std::pair<std::string, int32_t>> HelperGeometry::getAttributes(const Primitive& primitive)
+{
+	return {
+		{"POSITION", primitive.position},
+		{"NORMAL", primitive.normal},
+		{"TANGENT", primitive.tangent},
+		{"TEXCOORD_0", primitive.texCoord0},
+		{"TEXCOORD_1", primitive.texCoord1},
+		{"COLOR_0", primitive.color0},
+		{"JOINTS_0", primitive.joints0},
+		{"JOINTS_1", primitive.joints1},
+		{"WEIGHTS_0", primitive.weights0},
+		{"WEIGHTS_1", primitive.weights1}
+	};
+}
+
+bool HelperGeometry::getPackedFormat(VkFormat& format, uint32_t& typeCount, const Accessor& accessor, const std::string& description)
+{
+	typeCount = accessor.typeCount;
+
+	// Three component 8 and 16 bit formats are rarely supported as vertex input, so these are widened.
+	if (typeCount == 3 && accessor.componentTypeSize < 4)
+	{
+		typeCount = 4;
+	}
+
+	if (!HelperVulkan::getFormat(format, accessor.componentTypeSize, accessor.componentTypeSigned, accessor.componentTypeInteger, typeCount, accessor.normalized))
+	{
+		return false;
+	}
+
+	// Only joints are consumed as integers, all other integer attributes are scaled to float.
+	if (accessor.componentTypeInteger && !accessor.normalized && description.find("JOINTS_") != 0)
+	{
+		if (!HelperVulkan::getScaledFormat(format, format))
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+bool HelperGeometry::requiresConversion(const GLTF& glTF, const Primitive& primitive)
+{
+	for (const auto& attribute : getAttributes(primitive))
+	{
+		if (attribute.second < 0)
+		{
+			continue;
+		}
+
+		const Accessor& accessor = glTF.accessors[attribute.second];
+
+		VkFormat format = VK_FORMAT_UNDEFINED;
+		if (!HelperVulkan::getFormat(format, accessor.componentTypeSize, accessor.componentTypeSigned, accessor.componentTypeInteger, accessor.typeCount, accessor.normalized))
+		{
+			return false;
+		}
+
+		VkFormat packedFormat = VK_FORMAT_UNDEFINED;
+		uint32_t packedTypeCount = 0;
+		if (!getPackedFormat(packedFormat, packedTypeCount, accessor, attribute.first))
+		{
+			return false;
+		}
+
+		if (format != packedFormat)
+		{
+			return true;
+		}
+	}
+
+	return false;
+}
+
+bool HelperGeometry::gather(GeometryData& geometryData, const GLTF& glTF, const Primitive& primitive)
+{
+	if (primitive.position < 0)
+	{
+		return false;
+	}
+
+	geometryData.count = glTF.accessors[primitive.position].count;
+	geometryData.attributes.clear();
+
+	for (const auto& attribute : getAttributes(primitive))
+	{
+		if (attribute.second < 0)
+		{
+			continue;
+		}
+
+		const Accessor& accessor = glTF.accessors[attribute.second];
+
+		if (accessor.count != geometryData.count)
+		{
+			return false;
+		}
+
+		GeometryAttribute geometryAttribute = {};
+		geometryAttribute.description = attribute.first;
+
+		uint32_t typeCount = 0;
+		if (!getPackedFormat(geometryAttribute.format, typeCount, accessor, attribute.first))
+		{
+			return false;
+		}
+
+		geometryAttribute.stride = typeCount * accessor.componentTypeSize;
+		geometryAttribute.data.resize(geometryAttribute.stride * geometryData.count);
+
+		// Widened colors need an opaque alpha, all other padding is zero.
+		if (typeCount != accessor.typeCount && attribute.first == "COLOR_0")
+		{
+			memset(geometryAttribute.data.data(), 0xFF, geometryAttribute.data.size());
+		}
+
+		const uint8_t* source = HelperAccess::accessData(accessor);
+		uint32_t sourceStride = HelperAccess::getStride(accessor);
+		uint32_t elementSize = accessor.typeCount * accessor.componentTypeSize;
+
+		for (uint32_t i = 0; i < geometryData.count; i++)
+		{
+			memcpy(&geometryAttribute.data[i * geometryAttribute.stride], source + i * sourceStride, elementSize);
+		}
+
+		geometryData.attributes.push_back(geometryAttribute);
+	}
+
+	//
+
+	geometryData.indices.clear();
+	if (primitive.indices >= 0)
+	{
+		const Accessor& accessor = glTF.accessors[primitive.indices];
+
+		const uint8_t* source = HelperAccess::accessData(accessor);
+		uint32_t sourceStride = HelperAccess::getStride(accessor);
+
+		geometryData.indices.resize(accessor.count);
+		for (uint32_t i = 0; i < accessor.count; i++)
+		{
+			if (accessor.componentTypeSize == 1)
+			{
+				geometryData.indices[i] = source[i * sourceStride];
+			}
+			else if (accessor.componentTypeSize == 2)
+			{
+				uint16_t index;
+				memcpy(&index, source + i * sourceStride, sizeof(index));
+				geometryData.indices[i] = index;
+			}
+			else
+			{
+				memcpy(&geometryData.indices[i], source + i * sourceStride, sizeof(uint32_t));
+			}
+		}
+	}
+
+	geometryData.targets = GeometryTargets();
+	if (primitive.targets.size() > 0 && !HelperTarget::gather(geometryData.targets, glTF, primitive))
+	{
+		return false;
+	}
+
+	return true;
+}
+
+GeometryAttribute* HelperGeometry::findAttribute(GeometryData& geometryData, const std::string& description)
+{
+	for (GeometryAttribute& geometryAttribute : geometryData.attributes)
+	{
+		if (geometryAttribute.description == description)
+		{
+			return &geometryAttribute;
+		}
+	}
+
+	return nullptr;
+}
+
+const GeometryAttribute* HelperGeometry::findAttribute(const GeometryData& geometryData, const std::string& description)
+{
+	for (const GeometryAttribute& geometryAttribute : geometryData.attributes)
+	{
+		if (geometryAttribute.description == description)
+		{
+			return &geometryAttribute;
+		}
+	}
+
+	return nullptr;
+}
+
+bool HelperGeometry::decode(std::vector<glm::vec4>& values, const GeometryAttribute& geometryAttribute)
+{
+	uint32_t typeCount = 0;
+	if (!HelperVulkan::getTypeCount(typeCount, geometryAttribute.format))
+	{
+		return false;
+	}
+
+	uint32_t componentTypeSize = 0;
+	if (!HelperVulkan::getComponentTypeSize(componentTypeSize, geometryAttribute.format))
+	{
+		return false;
+	}
+
+	bool componentTypeSigned = false;
+	bool componentTypeInteger = false;
+	bool normalized = false;
+	if (!HelperVulkan::getComponentType(componentTypeSigned, componentTypeInteger, normalized, geometryAttribute.format))
+	{
+		return false;
+	}
+
+	size_t count = geometryAttribute.data.size() / geometryAttribute.stride;
+
+	values.resize(count);
+	for (size_t i = 0; i < count; i++)
+	{
+		values[i] = glm::vec4(0.0f, 0.0f, 0.0f, 1.0f);
+
+		for (uint32_t k = 0; k < typeCount; k++)
+		{
+			const uint8_t* data = &geometryAttribute.data[i * geometryAttribute.stride + k * componentTypeSize];
+
+			float value = 0.0f;
+			if (!componentTypeInteger)
+			{
+				if (componentTypeSize == 2)
+				{
+					uint16_t half;
+					memcpy(&half, data, sizeof(half));
+					value = glm::unpackHalf1x16(half);
+				}
+				else
+				{
+					memcpy(&value, data, sizeof(value));
+				}
+			}
+			else if (componentTypeSize == 1)
+			{
+				if (componentTypeSigned)
+				{
+					value = static_cast<float>(static_cast<int8_t>(*data));
+					value = normalized ? glm::max(value / 127.0f, -1.0f) : value;
+				}
+				else
+				{
+					value = static_cast<float>(*data);
+					value = normalized ? value / 255.0f : value;
+				}
+			}
+			else if (componentTypeSize == 2)
+			{
+				if (componentTypeSigned)
+				{
+					int16_t component;
+					memcpy(&component, data, sizeof(component));
+					value = normalized ? glm::max(component / 32767.0f, -1.0f) : static_cast<float>(component);
+				}
+				else
+				{
+					uint16_t component;
+					memcpy(&component, data, sizeof(component));
+					value = normalized ? component / 65535.0f : static_cast<float>(component);
+				}
+			}
+			else
+			{
+				if (componentTypeSigned)
+				{
+					int32_t component;
+					memcpy(&component, data, sizeof(component));
+					value = static_cast<float>(component);
+				}
+				else
+				{
+					uint32_t component;
+					memcpy(&component, data, sizeof(component));
+					value = static_cast<float>(component);
+				}
+			}
+
+			values[i][k] = value;
+		}
+	}
+
+	return true;
+}
+
+bool HelperGeometry::getPositions(std::vector<glm::vec3>& positions, const GeometryData& geometryData)
+{
+	const GeometryAttribute* geometryAttribute = findAttribute(geometryData, "POSITION");
+	if (!geometryAttribute)
+	{
+		return false;
+	}
+
+	std::vector<glm::vec4> values;
+	if (!decode(values, *geometryAttribute))
+	{
+		return false;
+	}
+
+	positions.resize(values.size());
+	for (size_t i = 0; i < values.size(); i++)
+	{
+		positions[i] = glm::vec3(values[i]);
+
+		if (geometryData.positionQuantized)
+		{
+			positions[i] = positions[i] * geometryData.positionScale + geometryData.positionOffset;
+		}
+	}
+
+	return true;
+}
+
+bool HelperGeometry::getDeform(GeometryDeform& geometryDeform, const GeometryData& geometryData)
+{
+	const GeometryAttribute* normal = findAttribute(geometryData, "NORMAL");
+	const GeometryAttribute* tangent = findAttribute(geometryData, "TANGENT");
+
+	// Octahedral encoded normals are not decoded.
+	if (normal)
+	{
+		uint32_t typeCount = 0;
+		if (!HelperVulkan::getTypeCount(typeCount, normal->format) || typeCount < 3)
+		{
+			return false;
+		}
+	}
+
+	geometryDeform = GeometryDeform();
+	geometryDeform.count = geometryData.count;
+
+	std::vector<glm::vec3> positions;
+	if (!getPositions(positions, geometryData))
+	{
+		return false;
+	}
+
+	geometryDeform.positions.resize(positions.size());
+	for (size_t i = 0; i < positions.size(); i++)
+	{
+		geometryDeform.positions[i] = glm::vec4(positions[i], 1.0f);
+	}
+
+	if (normal)
+	{
+		if (!decode(geometryDeform.normals, *normal))
+		{
+			return false;
+		}
+
+		for (glm::vec4& value : geometryDeform.normals)
+		{
+			value.w = 0.0f;
+		}
+	}
+
+	if (tangent)
+	{
+		if (!decode(geometryDeform.tangents, *tangent))
+		{
+			return false;
+		}
+	}
+
+	//
+
+	const GeometryAttribute* joints[2] = {findAttribute(geometryData, "JOINTS_0"), findAttribute(geometryData, "JOINTS_1")};
+	const GeometryAttribute* weights[2] = {findAttribute(geometryData, "WEIGHTS_0"), findAttribute(geometryData, "WEIGHTS_1")};
+
+	while (geometryDeform.jointGroups < 2 && joints[geometryDeform.jointGroups] && weights[geometryDeform.jointGroups])
+	{
+		geometryDeform.jointGroups++;
+	}
+
+	geometryDeform.joints.resize(geometryDeform.count * geometryDeform.jointGroups);
+	geometryDeform.weights.resize(geometryDeform.count * geometryDeform.jointGroups);
+
+	for (uint32_t group = 0; group < geometryDeform.jointGroups; group++)
+	{
+		std::vector<glm::vec4> jointValues;
+		std::vector<glm::vec4> weightValues;
+		if (!decode(jointValues, *joints[group]) || !decode(weightValues, *weights[group]))
+		{
+			return false;
+		}
+
+		for (uint32_t i = 0; i < geometryDeform.count; i++)
+		{
+			geometryDeform.joints[i * geometryDeform.jointGroups + group] = glm::uvec4(jointValues[i]);
+			geometryDeform.weights[i * geometryDeform.jointGroups + group] = weightValues[i];
+		}
+	}
+
+	return true;
+}
+
+bool HelperGeometry::getBounds(glm::vec3& center, float& radius, const GeometryData& geometryData)
+{
+	std::vector<glm::vec3> positions;
+	if (!getPositions(positions, geometryData) || positions.size() == 0)
+	{
+		return false;
+	}
+
+	glm::vec3 minimum = positions[0];
+	glm::vec3 maximum = positions[0];
+	for (const glm::vec3& position : positions)
+	{
+		minimum = glm::min(minimum, position);
+		maximum = glm::max(maximum, position);
+	}
+
+	center = (minimum + maximum) * 0.5f;
+
+	radius = 0.0f;
+	for (const glm::vec3& position : positions)
+	{
+		radius = glm::max(radius, glm::length(position - center));
+	}
+
+	return true;
+}
+
+bool HelperGeometry::packIndices(std::vector<uint8_t>& indexData, VkIndexType& indexType, const GeometryData& geometryData)
+{
+	if (geometryData.indices.size() == 0)
+	{
+		return false;
+	}
+
+	// 16 bit indices are sufficient, if all vertices can be addressed. Last value is reserved for primitive restart.
+	if (geometryData.count < 0xFFFF)
+	{
+		indexType = VK_INDEX_TYPE_UINT16;
+
+		indexData.resize(geometryData.indices.size() * sizeof(uint16_t));
+		for (size_t i = 0; i < geometryData.indices.size(); i++)
+		{
+			uint16_t index = static_cast<uint16_t>(geometryData.indices[i]);
+			memcpy(&indexData[i * sizeof(uint16_t)], &index, sizeof(uint16_t));
+		}
+	}
+	else
+	{
+		indexType = VK_INDEX_TYPE_UINT32;
+
+		indexData.resize(geometryData.indices.size() * sizeof(uint32_t));
+		memcpy(indexData.data(), geometryData.indices.data(), indexData.size());
+	}
+
+	return true;
+}
+
+uint64_t HelperGeometry::getSize(const GeometryData& geometryData)
+{
+	uint64_t size = 0;
+
+	for (const GeometryAttribute& geometryAttribute : geometryData.attributes)
+	{
+		size += geometryAttribute.data.size();
+	}
+
+	return size;
+}
@@ -0,0 +1,45 @@
+#ifndef GEOMETRY_HELPERGEOMETRY_H_
+#define GEOMETRY_HELPERGEOMETRY_H_
+
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "../gltf/GLTF.h"
+
+#include "GeometryData.h"
+
+class HelperGeometry
+{
+private:
+
+	static std::vector<std::pair<std::string, int32_t>> getAttributes(const Primitive& primitive);
+
+	static bool getPackedFormat(VkFormat& format, uint32_t& typeCount, const Accessor& accessor, const std::string& description);
+
+public:
+
+	static bool requiresConversion(const GLTF& glTF, const Primitive& primitive);
+
+	static bool gather(GeometryData& geometryData, const GLTF& glTF, const Primitive& primitive);
+
+	static GeometryAttribute* findAttribute(GeometryData& geometryData, const std::string& description);
+	static const GeometryAttribute* findAttribute(const GeometryData& geometryData, const std::string& description);
+
+	static bool decode(std::vector<glm::vec4>& values, const GeometryAttribute& geometryAttribute);
+
+	static bool getPositions(std::vector<glm::vec3>& positions, const GeometryData& geometryData);
+
+	// Has to be gathered before quantization.
+	static bool getDeform(GeometryDeform& geometryDeform, const GeometryData& geometryData);
+
+	static bool getBounds(glm::vec3& center, float& radius, const GeometryData& geometryData);
+
+	static bool packIndices(std::vector<uint8_t>& indexData, VkIndexType& indexType, const GeometryData& geometryData);
+
+	static uint64_t getSize(const GeometryData& geometryData);
+
+};
+
+#endif /* GEOMETRY_HELPERGEOMETRY_H_ */
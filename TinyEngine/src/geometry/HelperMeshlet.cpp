@@ -0,0 +1,171 @@
+#include "HelperMeshlet.h"
+
+#include "HelperGeometry.h"
+
+void HelperMeshlet::computeBounds(GeometryMeshlet& meshlet, const std::vector<uint32_t>& meshletVertices, const std::vector<uint32_t>& meshletTriangles, const std::vector<glm::vec3>& positions)
+{
+	glm::vec3 minimum = positions[meshletVertices[meshlet.vertexOffset]];
+	glm::vec3 maximum = minimum;
+	for (uint32_t i = 1; i < meshlet.vertexCount; i++)
+	{
+		const glm::vec3& position = positions[meshletVertices[meshlet.vertexOffset + i]];
+
+		minimum = glm::min(minimum, position);
+		maximum = glm::max(maximum, position);
+	}
+
+	meshlet.center = (minimum + maximum) * 0.5f;
+	meshlet.radius = 0.0f;
+	for (uint32_t i = 0; i < meshlet.vertexCount; i++)
+	{
+		meshlet.radius = glm::max(meshlet.radius, glm::length(positions[meshletVertices[meshlet.vertexOffset + i]] - meshlet.center));
+	}
+
+	//
+
+	std::vector<glm::vec3> normals;
+	glm::vec3 axis = glm::vec3(0.0f, 0.0f, 0.0f);
+	for (uint32_t i = 0; i < meshlet.triangleCount; i++)
+	{
+		uint32_t triangle = meshletTriangles[meshlet.triangleOffset + i];
+
+		const glm::vec3& p0 = positions[meshletVertices[meshlet.vertexOffset + (triangle & 0xFF)]];
+		const glm::vec3& p1 = positions[meshletVertices[meshlet.vertexOffset + ((triangle >> 8) & 0xFF)]];
+		const glm::vec3& p2 = positions[meshletVertices[meshlet.vertexOffset + ((triangle >> 16) & 0xFF)]];
+
+		glm::vec3 normal = glm::cross(p1 - p0, p2 - p0);
+
+		float length = glm::length(normal);
+		if (length == 0.0f)
+		{
+			continue;
+		}
+
+		normals.push_back(normal / length);
+		axis += normals.back();
+	}
+
+	// No cone, if the normals span more than a hemisphere.
+	meshlet.coneAxis = glm::vec3(0.0f, 0.0f, 1.0f);
+	meshlet.coneCutoff = 1.0f;
+
+	float length = glm::length(axis);
+	if (normals.size() == 0 || length == 0.0f)
+	{
+		return;
+	}
+	axis /= length;
+
+	float minimumDot = 1.0f;
+	for (const glm::vec3& normal : normals)
+	{
+		minimumDot = glm::min(minimumDot, glm::dot(axis, normal));
+	}
+
+	if (minimumDot <= 0.0f)
+	{
+		return;
+	}
+
+	// Sine of the cone angle.
+	meshlet.coneAxis = axis;
+	meshlet.coneCutoff = glm::sqrt(1.0f - minimumDot * minimumDot);
+}
+
+bool HelperMeshlet::build(GeometryData& geometryData, uint32_t maxVertices, uint32_t maxTriangles)
+{
+	geometryData.meshlets.clear();
+	geometryData.meshletVertices.clear();
+	geometryData.meshletTriangles.clear();
+
+	// Local indices are stored as 8 bit.
+	if (maxVertices < 3 || maxVertices > 256 || maxTriangles == 0)
+	{
+		return false;
+	}
+
+	uint32_t indicesCount = static_cast<uint32_t>(geometryData.indices.size());
+	if (geometryData.lods.size() > 0)
+	{
+		indicesCount = geometryData.lods[0].indicesCount;
+	}
+
+	if (indicesCount == 0 || indicesCount % 3 != 0)
+	{
+		return true;
+	}
+
+	std::vector<glm::vec3> positions;
+	if (!HelperGeometry::getPositions(positions, geometryData))
+	{
+		return false;
+	}
+
+	std::vector<int32_t> localIndices(geometryData.count, -1);
+
+	GeometryMeshlet meshlet = {};
+
+	for (uint32_t i = 0; i < indicesCount; i += 3)
+	{
+		uint32_t newVertices = 0;
+		for (uint32_t k = 0; k < 3; k++)
+		{
+			uint32_t index = geometryData.indices[i + k];
+			if (index >= geometryData.count)
+			{
+				return false;
+			}
+
+			if (localIndices[index] < 0)
+			{
+				newVertices++;
+			}
+		}
+
+		// Start a new meshlet, if the triangle does not fit anymore.
+		if (meshlet.vertexCount + newVertices > maxVertices || meshlet.triangleCount + 1 > maxTriangles)
+		{
+			for (uint32_t k = 0; k < meshlet.vertexCount; k++)
+			{
+				localIndices[geometryData.meshletVertices[meshlet.vertexOffset + k]] = -1;
+			}
+
+			geometryData.meshlets.push_back(meshlet);
+
+			meshlet = {};
+			meshlet.vertexOffset = static_cast<uint32_t>(geometryData.meshletVertices.size());
+			meshlet.triangleOffset = static_cast<uint32_t>(geometryData.meshletTriangles.size());
+		}
+
+		uint32_t triangle = 0;
+		for (uint32_t k = 0; k < 3; k++)
+		{
+			uint32_t index = geometryData.indices[i + k];
+
+			if (localIndices[index] < 0)
+			{
+				localIndices[index] = static_cast<int32_t>(meshlet.vertexCount);
+
+				geometryData.meshletVertices.push_back(index);
+				meshlet.vertexCount++;
+			}
+
+			triangle |= static_cast<uint32_t>(localIndices[index]) << (8 * k);
+		}
+
+		geometryData.meshletTriangles.push_back(triangle);
+		meshlet.triangleCount++;
+	}
+
+	if (meshlet.triangleCount > 0)
+	{
+		geometryData.meshlets.push_back(meshlet);
+	}
+
+	for (GeometryMeshlet& currentMeshlet : geometryData.meshlets)
+	{
+		computeBounds(currentMeshlet, geometryData.meshletVertices, geometryData.meshletTriangles, positions);
+	}
+
+	return true;
+}
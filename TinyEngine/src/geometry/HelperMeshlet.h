@@ -0,0 +1,22 @@
+#ifndef GEOMETRY_HELPERMESHLET_H_
+#define GEOMETRY_HELPERMESHLET_H_
+
+#include <cstdint>
+#include <vector>
+
+#include "GeometryData.h"
+
+class HelperMeshlet
+{
+private:
+
+	static void computeBounds(GeometryMeshlet& meshlet, const std::vector<uint32_t>& meshletVertices, const std::vector<uint32_t>& meshletTriangles, const std::vector<glm::vec3>& positions);
+
+public:
+
+	// Splits the full resolution triangles in order into meshlets. Best results after the vertex cache optimization.
+	static bool build(GeometryData& geometryData, uint32_t maxVertices = 64, uint32_t maxTriangles = 124);
+
+};
+
+#endif /* GEOMETRY_HELPERMESHLET_H_ */
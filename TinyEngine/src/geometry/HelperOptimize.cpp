@@ -0,0 +1,480 @@
+#include "HelperOptimize.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include "HelperGeometry.h"
+#include "HelperTarget.h"
+
+float HelperOptimize::getVertexScore(int32_t cachePosition, uint32_t valence, uint32_t cacheSize)
+{
+	if (valence == 0)
+	{
+		return -1.0f;
+	}
+
+	float score = 0.0f;
+
+	if (cachePosition >= 0)
+	{
+		// Last triangle vertices get a fixed score, so the triangle is not reused immediately.
+		if (cachePosition < 3)
+		{
+			score = 0.75f;
+		}
+		else
+		{
+			score = powf(1.0f - static_cast<float>(cachePosition - 3) / static_cast<float>(cacheSize - 3), 1.5f);
+		}
+	}
+
+	// Vertices with few remaining triangles are preferred, to avoid leaving them behind.
+	score += 2.0f * powf(static_cast<float>(valence), -0.5f);
+
+	return score;
+}
+
+uint32_t HelperOptimize::simulateVertexCache(std::vector<uint32_t>& triangleMisses, const std::vector<uint32_t>& indices, uint32_t vertexCount, uint32_t cacheSize)
+{
+	std::vector<uint32_t> timestamps(vertexCount, 0);
+	uint32_t timestamp = cacheSize + 1;
+
+	uint32_t misses = 0;
+
+	triangleMisses.resize(indices.size() / 3);
+	for (size_t i = 0; i < indices.size() / 3; i++)
+	{
+		triangleMisses[i] = 0;
+
+		// FIFO cache, a vertex is cached if it was pushed within the last cache size misses.
+		for (uint32_t k = 0; k < 3; k++)
+		{
+			uint32_t index = indices[3 * i + k];
+
+			if (timestamp - timestamps[index] > cacheSize)
+			{
+				timestamps[index] = timestamp++;
+
+				triangleMisses[i]++;
+			}
+		}
+
+		misses += triangleMisses[i];
+	}
+
+	return misses;
+}
+
+bool HelperOptimize::optimizeVertexCache(std::vector<uint32_t>& indices, uint32_t vertexCount, uint32_t cacheSize)
+{
+	if (indices.size() % 3 != 0 || cacheSize < 4)
+	{
+		return false;
+	}
+
+	size_t triangleCount = indices.size() / 3;
+	if (triangleCount == 0)
+	{
+		return true;
+	}
+
+	// Triangle adjacency per vertex.
+
+	std::vector<uint32_t> valences(vertexCount, 0);
+	for (uint32_t index : indices)
+	{
+		if (index >= vertexCount)
+		{
+			return false;
+		}
+
+		valences[index]++;
+	}
+
+	std::vector<uint32_t> adjacencyOffsets(vertexCount + 1, 0);
+	for (uint32_t i = 0; i < vertexCount; i++)
+	{
+		adjacencyOffsets[i + 1] = adjacencyOffsets[i] + valences[i];
+	}
+
+	std::vector<uint32_t> adjacency(indices.size());
+	std::vector<uint32_t> adjacencyCounts(vertexCount, 0);
+	for (size_t i = 0; i < triangleCount; i++)
+	{
+		for (uint32_t k = 0; k < 3; k++)
+		{
+			uint32_t index = indices[3 * i + k];
+
+			adjacency[adjacencyOffsets[index] + adjacencyCounts[index]++] = static_cast<uint32_t>(i);
+		}
+	}
+
+	//
+
+	std::vector<int32_t> cachePositions(vertexCount, -1);
+	std::vector<float> vertexScores(vertexCount);
+	for (uint32_t i = 0; i < vertexCount; i++)
+	{
+		vertexScores[i] = getVertexScore(-1, adjacencyCounts[i], cacheSize);
+	}
+
+	std::vector<float> triangleScores(triangleCount);
+	for (size_t i = 0; i < triangleCount; i++)
+	{
+		triangleScores[i] = vertexScores[indices[3 * i + 0]] + vertexScores[indices[3 * i + 1]] + vertexScores[indices[3 * i + 2]];
+	}
+
+	std::vector<bool> emitted(triangleCount, false);
+
+	std::vector<uint32_t> cache;
+	std::vector<uint32_t> newCache;
+	cache.reserve(cacheSize + 3);
+	newCache.reserve(cacheSize + 3);
+
+	std::vector<uint32_t> result;
+	result.reserve(indices.size());
+
+	size_t scanPosition = 0;
+
+	int64_t bestTriangle = -1;
+	float bestScore = -1.0f;
+
+	while (result.size() < indices.size())
+	{
+		// No candidate in the cache, so continue with the next not emitted triangle.
+		if (bestTriangle < 0)
+		{
+			while (scanPosition < triangleCount && emitted[scanPosition])
+			{
+				scanPosition++;
+			}
+
+			bestTriangle = static_cast<int64_t>(scanPosition);
+		}
+
+		size_t triangle = static_cast<size_t>(bestTriangle);
+
+		emitted[triangle] = true;
+
+		// Emit and remove from the adjacency.
+
+		for (uint32_t k = 0; k < 3; k++)
+		{
+			uint32_t index = indices[3 * triangle + k];
+
+			result.push_back(index);
+
+			uint32_t* begin = &adjacency[adjacencyOffsets[index]];
+			uint32_t* end = begin + adjacencyCounts[index];
+			uint32_t* it = std::find(begin, end, static_cast<uint32_t>(triangle));
+			if (it != end)
+			{
+				*it = *(end - 1);
+				adjacencyCounts[index]--;
+			}
+		}
+
+		// Move the triangle vertices to the front of the cache.
+
+		newCache.clear();
+		for (uint32_t k = 0; k < 3; k++)
+		{
+			newCache.push_back(indices[3 * triangle + k]);
+		}
+		for (uint32_t index : cache)
+		{
+			if (index != newCache[0] && index != newCache[1] && index != newCache[2])
+			{
+				newCache.push_back(index);
+			}
+		}
+
+		for (size_t i = cacheSize; i < newCache.size(); i++)
+		{
+			cachePositions[newCache[i]] = -1;
+			vertexScores[newCache[i]] = getVertexScore(-1, adjacencyCounts[newCache[i]], cacheSize);
+		}
+		if (newCache.size() > cacheSize)
+		{
+			newCache.resize(cacheSize);
+		}
+
+		cache.swap(newCache);
+
+		// Update scores and find the best triangle touching the cache.
+
+		for (size_t i = 0; i < cache.size(); i++)
+		{
+			cachePositions[cache[i]] = static_cast<int32_t>(i);
+			vertexScores[cache[i]] = getVertexScore(static_cast<int32_t>(i), adjacencyCounts[cache[i]], cacheSize);
+		}
+
+		bestTriangle = -1;
+		bestScore = -1.0f;
+
+		for (uint32_t index : cache)
+		{
+			for (uint32_t i = 0; i < adjacencyCounts[index]; i++)
+			{
+				uint32_t adjacentTriangle = adjacency[adjacencyOffsets[index] + i];
+
+				triangleScores[adjacentTriangle] = vertexScores[indices[3 * adjacentTriangle + 0]] + vertexScores[indices[3 * adjacentTriangle + 1]] + vertexScores[indices[3 * adjacentTriangle + 2]];
+
+				if (triangleScores[adjacentTriangle] > bestScore)
+				{
+					bestScore = triangleScores[adjacentTriangle];
+					bestTriangle = adjacentTriangle;
+				}
+			}
+		}
+	}
+
+	indices.swap(result);
+
+	return true;
+}
+
+bool HelperOptimize::optimizeOverdraw(std::vector<uint32_t>& indices, const std::vector<glm::vec3>& positions, float threshold, uint32_t cacheSize)
+{
+	if (indices.size() % 3 != 0)
+	{
+		return false;
+	}
+
+	size_t triangleCount = indices.size() / 3;
+	if (triangleCount == 0)
+	{
+		return true;
+	}
+
+	uint32_t vertexCount = static_cast<uint32_t>(positions.size());
+
+	// Clusters start at triangles, where all vertices miss the cache. Reordering these keeps the cache efficiency.
+
+	std::vector<uint32_t> triangleMisses;
+	uint32_t misses = simulateVertexCache(triangleMisses, indices, vertexCount, cacheSize);
+
+	std::vector<size_t> clusterOffsets;
+	for (size_t i = 0; i < triangleCount; i++)
+	{
+		if (i == 0 || triangleMisses[i] == 3)
+		{
+			clusterOffsets.push_back(i);
+		}
+	}
+	clusterOffsets.push_back(triangleCount);
+
+	size_t clusterCount = clusterOffsets.size() - 1;
+	if (clusterCount <= 1)
+	{
+		return true;
+	}
+
+	// Mesh centroid weighted by triangle area.
+
+	glm::vec3 meshCentroid = glm::vec3(0.0f);
+	float meshArea = 0.0f;
+
+	std::vector<glm::vec3> clusterCentroids(clusterCount, glm::vec3(0.0f));
+	std::vector<glm::vec3> clusterNormals(clusterCount, glm::vec3(0.0f));
+
+	for (size_t cluster = 0; cluster < clusterCount; cluster++)
+	{
+		float clusterArea = 0.0f;
+
+		for (size_t i = clusterOffsets[cluster]; i < clusterOffsets[cluster + 1]; i++)
+		{
+			const glm::vec3& p0 = positions[indices[3 * i + 0]];
+			const glm::vec3& p1 = positions[indices[3 * i + 1]];
+			const glm::vec3& p2 = positions[indices[3 * i + 2]];
+
+			glm::vec3 normal = glm::cross(p1 - p0, p2 - p0);
+			float area = glm::length(normal);
+
+			glm::vec3 centroid = (p0 + p1 + p2) / 3.0f;
+
+			clusterCentroids[cluster] += centroid * area;
+			clusterNormals[cluster] += normal;
+			clusterArea += area;
+
+			meshCentroid += centroid * area;
+			meshArea += area;
+		}
+
+		if (clusterArea > 0.0f)
+		{
+			clusterCentroids[cluster] /= clusterArea;
+		}
+
+		if (glm::length(clusterNormals[cluster]) > 0.0f)
+		{
+			clusterNormals[cluster] = glm::normalize(clusterNormals[cluster]);
+		}
+	}
+
+	if (meshArea > 0.0f)
+	{
+		meshCentroid /= meshArea;
+	}
+
+	// Clusters facing away from the centroid occlude others, so these are drawn first.
+
+	std::vector<float> sortKeys(clusterCount);
+	std::vector<size_t> clusterOrder(clusterCount);
+	for (size_t cluster = 0; cluster < clusterCount; cluster++)
+	{
+		sortKeys[cluster] = glm::dot(clusterCentroids[cluster] - meshCentroid, clusterNormals[cluster]);
+		clusterOrder[cluster] = cluster;
+	}
+
+	std::stable_sort(clusterOrder.begin(), clusterOrder.end(), [&sortKeys](size_t a, size_t b) {
+		return sortKeys[a] > sortKeys[b];
+	});
+
+	std::vector<uint32_t> result;
+	result.reserve(indices.size());
+	for (size_t cluster : clusterOrder)
+	{
+		result.insert(result.end(), indices.begin() + 3 * clusterOffsets[cluster], indices.begin() + 3 * clusterOffsets[cluster + 1]);
+	}
+
+	std::vector<uint32_t> resultTriangleMisses;
+	uint32_t resultMisses = simulateVertexCache(resultTriangleMisses, result, vertexCount, cacheSize);
+
+	if (static_cast<float>(resultMisses) <= static_cast<float>(misses) * threshold)
+	{
+		indices.swap(result);
+	}
+
+	return true;
+}
+
+bool HelperOptimize::optimizeVertexFetch(GeometryData& geometryData)
+{
+	if (geometryData.indices.size() == 0)
+	{
+		return true;
+	}
+
+	std::vector<uint32_t> remap(geometryData.count, UINT32_MAX);
+	uint32_t newCount = 0;
+
+	for (uint32_t& index : geometryData.indices)
+	{
+		if (index >= geometryData.count)
+		{
+			return false;
+		}
+
+		if (remap[index] == UINT32_MAX)
+		{
+			remap[index] = newCount++;
+		}
+
+		index = remap[index];
+	}
+
+	for (GeometryAttribute& geometryAttribute : geometryData.attributes)
+	{
+		std::vector<uint8_t> remappedData(static_cast<size_t>(newCount) * geometryAttribute.stride);
+
+		for (uint32_t i = 0; i < geometryData.count; i++)
+		{
+			if (remap[i] != UINT32_MAX)
+			{
+				memcpy(&remappedData[remap[i] * geometryAttribute.stride], &geometryAttribute.data[i * geometryAttribute.stride], geometryAttribute.stride);
+			}
+		}
+
+		geometryAttribute.data.swap(remappedData);
+	}
+
+	if (geometryData.targets.targetsCount > 0 && !HelperTarget::remap(geometryData.targets, remap, newCount))
+	{
+		return false;
+	}
+
+	geometryData.count = newCount;
+
+	return true;
+}
+
+void HelperOptimize::analyzeVertexCache(float& acmr, float& atvr, const std::vector<uint32_t>& indices, uint32_t vertexCount, uint32_t cacheSize)
+{
+	acmr = 0.0f;
+	atvr = 0.0f;
+
+	if (indices.size() < 3)
+	{
+		return;
+	}
+
+	std::vector<uint32_t> triangleMisses;
+	uint32_t misses = simulateVertexCache(triangleMisses, indices, vertexCount, cacheSize);
+
+	std::vector<bool> referenced(vertexCount, false);
+	uint32_t uniqueVertices = 0;
+	for (uint32_t index : indices)
+	{
+		if (!referenced[index])
+		{
+			referenced[index] = true;
+			uniqueVertices++;
+		}
+	}
+
+	acmr = static_cast<float>(misses) / static_cast<float>(indices.size() / 3);
+	atvr = static_cast<float>(misses) / static_cast<float>(uniqueVertices);
+}
+
+bool HelperOptimize::optimize(GeometryData& geometryData, uint32_t mode, OptimizeReport& optimizeReport)
+{
+	if (geometryData.indices.size() == 0)
+	{
+		return true;
+	}
+
+	for (uint32_t index : geometryData.indices)
+	{
+		if (index >= geometryData.count)
+		{
+			return false;
+		}
+	}
+
+	// Triangles
+	bool triangles = (mode == 4) && (geometryData.indices.size() % 3 == 0);
+
+	optimizeReport.countBefore = geometryData.count;
+	if (triangles)
+	{
+		analyzeVertexCache(optimizeReport.acmrBefore, optimizeReport.atvrBefore, geometryData.indices, geometryData.count);
+
+		if (!optimizeVertexCache(geometryData.indices, geometryData.count))
+		{
+			return false;
+		}
+
+		std::vector<glm::vec3> positions;
+		if (HelperGeometry::getPositions(positions, geometryData))
+		{
+			if (!optimizeOverdraw(geometryData.indices, positions))
+			{
+				return false;
+			}
+		}
+	}
+
+	if (!optimizeVertexFetch(geometryData))
+	{
+		return false;
+	}
+
+	optimizeReport.countAfter = geometryData.count;
+	if (triangles)
+	{
+		analyzeVertexCache(optimizeReport.acmrAfter, optimizeReport.atvrAfter, geometryData.indices, geometryData.count);
+	}
+
+	return true;
+}
@@ -0,0 +1,35 @@
+#ifndef GEOMETRY_HELPEROPTIMIZE_H_
+#define GEOMETRY_HELPEROPTIMIZE_H_
+
+#include <cstdint>
+#include <vector>
+
+#include "GeometryData.h"
+
+class HelperOptimize
+{
+private:
+
+	static float getVertexScore(int32_t cachePosition, uint32_t valence, uint32_t cacheSize);
+
+	static uint32_t simulateVertexCache(std::vector<uint32_t>& triangleMisses, const std::vector<uint32_t>& indices, uint32_t vertexCount, uint32_t cacheSize);
+
+public:
+
+	// Reorders triangles for post transform cache locality, see Tom Forsyth "Linear-Speed Vertex Cache Optimisation".
+	static bool optimizeVertexCache(std::vector<uint32_t>& indices, uint32_t vertexCount, uint32_t cacheSize = 32);
+
+	// Reorders clusters of triangles from outside to inside, as long as the cache miss ratio does not grow above the threshold.
+	static bool optimizeOverdraw(std::vector<uint32_t>& indices, const std::vector<glm::vec3>& positions, float threshold = 1.05f, uint32_t cacheSize = 16);
+
+	// Reorders vertices in order of first use and removes unreferenced vertices. Targets are remapped as well.
+	static bool optimizeVertexFetch(GeometryData& geometryData);
+
+	static void analyzeVertexCache(float& acmr, float& atvr, const std::vector<uint32_t>& indices, uint32_t vertexCount, uint32_t cacheSize = 16);
+
+	// Indexed triangle lists get all optimizations, other indexed primitives only the vertex fetch optimization.
+	static bool optimize(GeometryData& geometryData, uint32_t mode, OptimizeReport& optimizeReport);
+
+};
+
+#endif /* GEOMETRY_HELPEROPTIMIZE_H_ */
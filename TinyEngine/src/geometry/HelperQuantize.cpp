@@ -0,0 +1,293 @@
+#include "HelperQuantize.h"
+
+#include <cstring>
+
+bool HelperQuantize::quantizePosition(GeometryData& geometryData, GeometryAttribute& geometryAttribute, QuantizeReport& quantizeReport)
+{
+	std::vector<glm::vec3> positions(geometryData.count);
+	memcpy(positions.data(), geometryAttribute.data.data(), sizeof(glm::vec3) * positions.size());
+
+	glm::vec3 minimum = positions[0];
+	glm::vec3 maximum = positions[0];
+	for (const glm::vec3& position : positions)
+	{
+		minimum = glm::min(minimum, position);
+		maximum = glm::max(maximum, position);
+	}
+
+	glm::vec3 extent = maximum - minimum;
+	for (uint32_t k = 0; k < 3; k++)
+	{
+		if (extent[k] <= 0.0f)
+		{
+			extent[k] = 1.0f;
+		}
+	}
+
+	// Fourth component is padding, as three component 16 bit formats are rarely supported.
+	std::vector<uint16_t> quantizedPositions(4 * positions.size(), 0);
+
+	float positionError = 0.0f;
+	for (size_t i = 0; i < positions.size(); i++)
+	{
+		glm::vec3 dequantized;
+		for (uint32_t k = 0; k < 3; k++)
+		{
+			quantizedPositions[4 * i + k] = packUnorm16((positions[i][k] - minimum[k]) / extent[k]);
+
+			dequantized[k] = unpackUnorm16(quantizedPositions[4 * i + k]) * extent[k] + minimum[k];
+		}
+
+		positionError = glm::max(positionError, glm::length(dequantized - positions[i]));
+	}
+
+	quantizeReport.positionError = glm::max(quantizeReport.positionError, positionError);
+	quantizeReport.positionRelativeError = glm::max(quantizeReport.positionRelativeError, positionError / glm::max(extent.x, glm::max(extent.y, extent.z)));
+
+	//
+
+	geometryAttribute.format = VK_FORMAT_R16G16B16A16_UNORM;
+	geometryAttribute.stride = 4 * sizeof(uint16_t);
+	geometryAttribute.data.resize(quantizedPositions.size() * sizeof(uint16_t));
+	memcpy(geometryAttribute.data.data(), quantizedPositions.data(), geometryAttribute.data.size());
+
+	geometryData.positionQuantized = true;
+	geometryData.positionScale = extent;
+	geometryData.positionOffset = minimum;
+
+	return true;
+}
+
+bool HelperQuantize::quantizeNormal(GeometryAttribute& geometryAttribute, QuantizeReport& quantizeReport)
+{
+	size_t count = geometryAttribute.data.size() / sizeof(glm::vec3);
+
+	std::vector<glm::vec3> normals(count);
+	memcpy(normals.data(), geometryAttribute.data.data(), sizeof(glm::vec3) * count);
+
+	std::vector<int16_t> quantizedNormals(2 * count);
+
+	float normalError = 0.0f;
+	for (size_t i = 0; i < count; i++)
+	{
+		glm::vec3 normal = glm::vec3(0.0f, 0.0f, 1.0f);
+		if (glm::length(normals[i]) > 0.0f)
+		{
+			normal = glm::normalize(normals[i]);
+		}
+
+		glm::vec2 octahedral = encodeOctahedral(normal);
+
+		quantizedNormals[2 * i + 0] = packSnorm16(octahedral.x);
+		quantizedNormals[2 * i + 1] = packSnorm16(octahedral.y);
+
+		glm::vec3 dequantized = decodeOctahedral(glm::vec2(unpackSnorm16(quantizedNormals[2 * i + 0]), unpackSnorm16(quantizedNormals[2 * i + 1])));
+
+		normalError = glm::max(normalError, glm::degrees(glm::acos(glm::clamp(glm::dot(normal, dequantized), -1.0f, 1.0f))));
+	}
+
+	quantizeReport.normalError = glm::max(quantizeReport.normalError, normalError);
+
+	//
+
+	geometryAttribute.format = VK_FORMAT_R16G16_SNORM;
+	geometryAttribute.stride = 2 * sizeof(int16_t);
+	geometryAttribute.data.resize(quantizedNormals.size() * sizeof(int16_t));
+	memcpy(geometryAttribute.data.data(), quantizedNormals.data(), geometryAttribute.data.size());
+
+	return true;
+}
+
+bool HelperQuantize::quantizeTangent(GeometryAttribute& geometryAttribute, QuantizeReport& quantizeReport)
+{
+	size_t count = geometryAttribute.data.size() / sizeof(glm::vec4);
+
+	std::vector<glm::vec4> tangents(count);
+	memcpy(tangents.data(), geometryAttribute.data.data(), sizeof(glm::vec4) * count);
+
+	std::vector<int16_t> quantizedTangents(4 * count);
+
+	float tangentError = 0.0f;
+	for (size_t i = 0; i < count; i++)
+	{
+		glm::vec3 tangent = glm::vec3(1.0f, 0.0f, 0.0f);
+		if (glm::length(glm::vec3(tangents[i])) > 0.0f)
+		{
+			tangent = glm::normalize(glm::vec3(tangents[i]));
+		}
+
+		glm::vec3 dequantized;
+		for (uint32_t k = 0; k < 3; k++)
+		{
+			quantizedTangents[4 * i + k] = packSnorm16(tangent[k]);
+
+			dequantized[k] = unpackSnorm16(quantizedTangents[4 * i + k]);
+		}
+		quantizedTangents[4 * i + 3] = packSnorm16(tangents[i].w < 0.0f ? -1.0f : 1.0f);
+
+		if (glm::length(dequantized) > 0.0f)
+		{
+			dequantized = glm::normalize(dequantized);
+		}
+
+		tangentError = glm::max(tangentError, glm::degrees(glm::acos(glm::clamp(glm::dot(tangent, dequantized), -1.0f, 1.0f))));
+	}
+
+	quantizeReport.tangentError = glm::max(quantizeReport.tangentError, tangentError);
+
+	//
+
+	geometryAttribute.format = VK_FORMAT_R16G16B16A16_SNORM;
+	geometryAttribute.stride = 4 * sizeof(int16_t);
+	geometryAttribute.data.resize(quantizedTangents.size() * sizeof(int16_t));
+	memcpy(geometryAttribute.data.data(), quantizedTangents.data(), geometryAttribute.data.size());
+
+	return true;
+}
+
+bool HelperQuantize::quantizeTexCoord(GeometryAttribute& geometryAttribute, QuantizeReport& quantizeReport)
+{
+	size_t count = geometryAttribute.data.size() / sizeof(float);
+
+	std::vector<float> texCoords(count);
+	memcpy(texCoords.data(), geometryAttribute.data.data(), sizeof(float) * count);
+
+	bool normalized = true;
+	for (float texCoord : texCoords)
+	{
+		if (texCoord < 0.0f || texCoord > 1.0f)
+		{
+			normalized = false;
+		}
+
+		// Out of half float range, so keep the data.
+		if (glm::abs(texCoord) > 65504.0f)
+		{
+			return true;
+		}
+	}
+
+	std::vector<uint16_t> quantizedTexCoords(count);
+
+	float texCoordError = 0.0f;
+	for (size_t i = 0; i < count; i++)
+	{
+		float dequantized = 0.0f;
+		if (normalized)
+		{
+			quantizedTexCoords[i] = packUnorm16(texCoords[i]);
+
+			dequantized = unpackUnorm16(quantizedTexCoords[i]);
+		}
+		else
+		{
+			quantizedTexCoords[i] = glm::packHalf1x16(texCoords[i]);
+
+			dequantized = glm::unpackHalf1x16(quantizedTexCoords[i]);
+		}
+
+		texCoordError = glm::max(texCoordError, glm::abs(dequantized - texCoords[i]));
+	}
+
+	quantizeReport.texCoordError = glm::max(quantizeReport.texCoordError, texCoordError);
+
+	//
+
+	geometryAttribute.format = normalized ? VK_FORMAT_R16G16_UNORM : VK_FORMAT_R16G16_SFLOAT;
+	geometryAttribute.stride = 2 * sizeof(uint16_t);
+	geometryAttribute.data.resize(quantizedTexCoords.size() * sizeof(uint16_t));
+	memcpy(geometryAttribute.data.data(), quantizedTexCoords.data(), geometryAttribute.data.size());
+
+	return true;
+}
+
+glm::vec2 HelperQuantize::encodeOctahedral(const glm::vec3& normal)
+{
+	glm::vec3 n = normal / (glm::abs(normal.x) + glm::abs(normal.y) + glm::abs(normal.z));
+
+	glm::vec2 octahedral = glm::vec2(n.x, n.y);
+	if (n.z < 0.0f)
+	{
+		octahedral.x = (1.0f - glm::abs(n.y)) * (n.x >= 0.0f ? 1.0f : -1.0f);
+		octahedral.y = (1.0f - glm::abs(n.x)) * (n.y >= 0.0f ? 1.0f : -1.0f);
+	}
+
+	return octahedral;
+}
+
+glm::vec3 HelperQuantize::decodeOctahedral(const glm::vec2& octahedral)
+{
+	glm::vec3 n = glm::vec3(octahedral.x, octahedral.y, 1.0f - glm::abs(octahedral.x) - glm::abs(octahedral.y));
+
+	float t = glm::max(-n.z, 0.0f);
+	n.x += n.x >= 0.0f ? -t : t;
+	n.y += n.y >= 0.0f ? -t : t;
+
+	return glm::normalize(n);
+}
+
+int16_t HelperQuantize::packSnorm16(float value)
+{
+	return static_cast<int16_t>(glm::round(glm::clamp(value, -1.0f, 1.0f) * 32767.0f));
+}
+
+float HelperQuantize::unpackSnorm16(int16_t value)
+{
+	return glm::max(static_cast<float>(value) / 32767.0f, -1.0f);
+}
+
+uint16_t HelperQuantize::packUnorm16(float value)
+{
+	return static_cast<uint16_t>(glm::round(glm::clamp(value, 0.0f, 1.0f) * 65535.0f));
+}
+
+float HelperQuantize::unpackUnorm16(uint16_t value)
+{
+	return static_cast<float>(value) / 65535.0f;
+}
+
+bool HelperQuantize::quantize(GeometryData& geometryData, QuantizeReport& quantizeReport)
+{
+	if (geometryData.count == 0)
+	{
+		return false;
+	}
+
+	for (GeometryAttribute& geometryAttribute : geometryData.attributes)
+	{
+		quantizeReport.originalSize += geometryAttribute.data.size();
+
+		if (geometryAttribute.description == "POSITION" && geometryAttribute.format == VK_FORMAT_R32G32B32_SFLOAT)
+		{
+			if (!quantizePosition(geometryData, geometryAttribute, quantizeReport))
+			{
+				return false;
+			}
+		}
+		else if (geometryAttribute.description == "NORMAL" && geometryAttribute.format == VK_FORMAT_R32G32B32_SFLOAT)
+		{
+			if (!quantizeNormal(geometryAttribute, quantizeReport))
+			{
+				return false;
+			}
+		}
+		else if (geometryAttribute.description == "TANGENT" && geometryAttribute.format == VK_FORMAT_R32G32B32A32_SFLOAT)
+		{
+			if (!quantizeTangent(geometryAttribute, quantizeReport))
+			{
+				return false;
+			}
+		}
+		else if ((geometryAttribute.description == "TEXCOORD_0" || geometryAttribute.description == "TEXCOORD_1") && geometryAttribute.format == VK_FORMAT_R32G32_SFLOAT)
+		{
+			if (!quantizeTexCoord(geometryAttribute, quantizeReport))
+			{
+				return false;
+			}
+		}
+
+		quantizeReport.quantizedSize += geometryAttribute.data.size();
+	}
+
+	return true;
+}
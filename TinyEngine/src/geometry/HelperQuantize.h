@@ -0,0 +1,39 @@
+#ifndef GEOMETRY_HELPERQUANTIZE_H_
+#define GEOMETRY_HELPERQUANTIZE_H_
+
+#include <cstdint>
+
+#include "GeometryData.h"
+
+class HelperQuantize
+{
+private:
+
+	static bool quantizePosition(GeometryData& geometryData, GeometryAttribute& geometryAttribute, QuantizeReport& quantizeReport);
+
+	static bool quantizeNormal(GeometryAttribute& geometryAttribute, QuantizeReport& quantizeReport);
+
+	static bool quantizeTangent(GeometryAttribute& geometryAttribute, QuantizeReport& quantizeReport);
+
+	static bool quantizeTexCoord(GeometryAttribute& geometryAttribute, QuantizeReport& quantizeReport);
+
+public:
+
+	static glm::vec2 encodeOctahedral(const glm::vec3& normal);
+
+	static glm::vec3 decodeOctahedral(const glm::vec2& octahedral);
+
+	static int16_t packSnorm16(float value);
+
+	static float unpackSnorm16(int16_t value);
+
+	static uint16_t packUnorm16(float value);
+
+	static float unpackUnorm16(uint16_t value);
+
+	// Only 32 bit float attributes are quantized, all others are kept.
+	static bool quantize(GeometryData& geometryData, QuantizeReport& quantizeReport);
+
+};
+
+#endif /* GEOMETRY_HELPERQUANTIZE_H_ */
@@ -0,0 +1,501 @@
+#include "HelperSimplify.h"
+
+#include <algorithm>
+#include <cfloat>
+#include <map>
+#include <tuple>
+#include <unordered_map>
+
+#include "HelperGeometry.h"
+#include "HelperOptimize.h"
+
+glm::dmat4 HelperSimplify::getQuadric(const glm::vec3& p0, const glm::vec3& p1, const glm::vec3& p2)
+{
+	glm::dvec3 normal = glm::cross(glm::dvec3(p1) - glm::dvec3(p0), glm::dvec3(p2) - glm::dvec3(p0));
+
+	double length = glm::length(normal);
+	if (length == 0.0)
+	{
+		return glm::dmat4(0.0);
+	}
+	normal /= length;
+
+	glm::dvec4 plane = glm::dvec4(normal, -glm::dot(normal, glm::dvec3(p0)));
+
+	// Weighted by the triangle area.
+	return glm::outerProduct(plane, plane) * (0.5 * length);
+}
+
+double HelperSimplify::getQuadricError(const glm::dmat4& quadric, const glm::vec3& position)
+{
+	glm::dvec4 point = glm::dvec4(glm::dvec3(position), 1.0);
+
+	return glm::max(glm::dot(point, quadric * point), 0.0);
+}
+
+uint32_t HelperSimplify::getClosestVertex(float& penalty, uint32_t vertex, const std::vector<uint32_t>& candidates, const std::vector<glm::vec3>& normals)
+{
+	penalty = 0.0f;
+
+	if (normals.size() == 0)
+	{
+		return candidates[0];
+	}
+
+	uint32_t closestVertex = candidates[0];
+	float closestDot = -2.0f;
+	for (uint32_t candidate : candidates)
+	{
+		float currentDot = glm::dot(normals[vertex], normals[candidate]);
+		if (currentDot > closestDot)
+		{
+			closestDot = currentDot;
+			closestVertex = candidate;
+		}
+	}
+
+	penalty = 0.5f * (1.0f - glm::clamp(closestDot, -1.0f, 1.0f));
+
+	return closestVertex;
+}
+
+bool HelperSimplify::simplify(std::vector<uint32_t>& destination, float& error, const std::vector<uint32_t>& indices, const std::vector<glm::vec3>& positions, const std::vector<glm::vec3>& normals, size_t targetIndexCount, float targetError)
+{
+	error = 0.0f;
+
+	if (indices.size() % 3 != 0 || (normals.size() > 0 && normals.size() != positions.size()))
+	{
+		return false;
+	}
+
+	uint32_t vertexCount = static_cast<uint32_t>(positions.size());
+
+	for (uint32_t index : indices)
+	{
+		if (index >= vertexCount)
+		{
+			return false;
+		}
+	}
+
+	// Vertices with the same position form one topological vertex.
+
+	std::vector<uint32_t> positionVertex(vertexCount);
+	std::vector<std::vector<uint32_t>> positionGroups;
+	std::vector<uint32_t> groupOfVertex(vertexCount);
+	{
+		std::map<std::tuple<float, float, float>, uint32_t> positionToGroup;
+		for (uint32_t i = 0; i < vertexCount; i++)
+		{
+			auto key = std::make_tuple(positions[i].x, positions[i].y, positions[i].z);
+
+			auto it = positionToGroup.find(key);
+			if (it == positionToGroup.end())
+			{
+				it = positionToGroup.insert({key, static_cast<uint32_t>(positionGroups.size())}).first;
+				positionGroups.push_back({});
+			}
+
+			groupOfVertex[i] = it->second;
+			positionGroups[it->second].push_back(i);
+		}
+	}
+	uint32_t groupCount = static_cast<uint32_t>(positionGroups.size());
+
+	// Groups on a border edge are locked.
+
+	std::vector<bool> locked(groupCount, false);
+	{
+		std::unordered_map<uint64_t, uint32_t> edgeCounts;
+		for (size_t i = 0; i < indices.size(); i += 3)
+		{
+			// Degenerated triangles are removed anyway.
+			if (groupOfVertex[indices[i + 0]] == groupOfVertex[indices[i + 1]] || groupOfVertex[indices[i + 1]] == groupOfVertex[indices[i + 2]] || groupOfVertex[indices[i + 2]] == groupOfVertex[indices[i + 0]])
+			{
+				continue;
+			}
+
+			for (uint32_t k = 0; k < 3; k++)
+			{
+				uint64_t a = groupOfVertex[indices[i + k]];
+				uint64_t b = groupOfVertex[indices[i + (k + 1) % 3]];
+
+				edgeCounts[(glm::min(a, b) << 32) | glm::max(a, b)]++;
+			}
+		}
+
+		for (const auto& edgeCount : edgeCounts)
+		{
+			// Border and non manifold edges.
+			if (edgeCount.second != 2)
+			{
+				locked[static_cast<uint32_t>(edgeCount.first >> 32)] = true;
+				locked[static_cast<uint32_t>(edgeCount.first & 0xFFFFFFFF)] = true;
+			}
+		}
+	}
+
+	// Quadrics per group.
+
+	std::vector<glm::dmat4> quadrics(groupCount, glm::dmat4(0.0));
+	std::vector<double> quadricWeights(groupCount, 0.0);
+	for (size_t i = 0; i < indices.size(); i += 3)
+	{
+		const glm::vec3& p0 = positions[indices[i + 0]];
+		const glm::vec3& p1 = positions[indices[i + 1]];
+		const glm::vec3& p2 = positions[indices[i + 2]];
+
+		glm::dmat4 quadric = getQuadric(p0, p1, p2);
+		double area = 0.5 * glm::length(glm::cross(glm::dvec3(p1) - glm::dvec3(p0), glm::dvec3(p2) - glm::dvec3(p0)));
+
+		for (uint32_t k = 0; k < 3; k++)
+		{
+			quadrics[groupOfVertex[indices[i + k]]] += quadric;
+			quadricWeights[groupOfVertex[indices[i + k]]] += area;
+		}
+	}
+
+	//
+
+	std::vector<uint32_t> vertexRemap(vertexCount);
+	for (uint32_t i = 0; i < vertexCount; i++)
+	{
+		vertexRemap[i] = i;
+	}
+
+	std::vector<uint32_t> triangles = indices;
+
+	double maximumError = 0.0;
+	double targetQuadricError = static_cast<double>(targetError) * static_cast<double>(targetError);
+
+	while (triangles.size() > targetIndexCount)
+	{
+		// Apply previous collapses and remove degenerated triangles.
+
+		std::vector<uint32_t> remainingTriangles;
+		remainingTriangles.reserve(triangles.size());
+		for (size_t i = 0; i < triangles.size(); i += 3)
+		{
+			uint32_t v[3];
+			for (uint32_t k = 0; k < 3; k++)
+			{
+				v[k] = triangles[i + k];
+				while (vertexRemap[v[k]] != v[k])
+				{
+					v[k] = vertexRemap[v[k]];
+				}
+			}
+
+			if (groupOfVertex[v[0]] == groupOfVertex[v[1]] || groupOfVertex[v[1]] == groupOfVertex[v[2]] || groupOfVertex[v[2]] == groupOfVertex[v[0]])
+			{
+				continue;
+			}
+
+			remainingTriangles.insert(remainingTriangles.end(), {v[0], v[1], v[2]});
+		}
+		triangles.swap(remainingTriangles);
+
+		if (triangles.size() <= targetIndexCount)
+		{
+			break;
+		}
+
+		// Group adjacency.
+
+		std::vector<std::vector<uint32_t>> adjacency(groupCount);
+		for (size_t i = 0; i < triangles.size(); i += 3)
+		{
+			for (uint32_t k = 0; k < 3; k++)
+			{
+				adjacency[groupOfVertex[triangles[i + k]]].push_back(static_cast<uint32_t>(i / 3));
+			}
+		}
+
+		// Collapse candidates, cheaper direction of every edge.
+
+		struct Collapse {
+			uint32_t source;
+			uint32_t target;
+			double quadricError;
+			double cost;
+		};
+
+		std::vector<Collapse> collapses;
+		collapses.reserve(triangles.size());
+
+		for (size_t i = 0; i < triangles.size(); i += 3)
+		{
+			for (uint32_t k = 0; k < 3; k++)
+			{
+				uint32_t a = groupOfVertex[triangles[i + k]];
+				uint32_t b = groupOfVertex[triangles[i + (k + 1) % 3]];
+
+				// Every inner edge is seen twice, so only one direction is processed.
+				if (a > b)
+				{
+					continue;
+				}
+
+				// Normalized by the area, so the error is an average squared distance.
+				glm::dmat4 quadric = quadrics[a] + quadrics[b];
+				double quadricWeight = glm::max(quadricWeights[a] + quadricWeights[b], DBL_MIN);
+
+				double edgeLength2 = glm::dot(positions[positionGroups[a][0]] - positions[positionGroups[b][0]], positions[positionGroups[a][0]] - positions[positionGroups[b][0]]);
+
+				Collapse best = {0, 0, DBL_MAX, DBL_MAX};
+
+				for (uint32_t direction = 0; direction < 2; direction++)
+				{
+					uint32_t source = direction == 0 ? a : b;
+					uint32_t target = direction == 0 ? b : a;
+
+					if (locked[source])
+					{
+						continue;
+					}
+
+					double quadricError = getQuadricError(quadric, positions[positionGroups[target][0]]) / quadricWeight;
+
+					// Attribute penalty, if vertices of the source do not have a matching vertex at the target.
+					float penalty = 0.0f;
+					for (uint32_t vertex : positionGroups[source])
+					{
+						float currentPenalty = 0.0f;
+						getClosestVertex(currentPenalty, vertex, positionGroups[target], normals);
+
+						penalty = glm::max(penalty, currentPenalty);
+					}
+
+					double cost = quadricError + static_cast<double>(penalty) * edgeLength2;
+
+					if (cost < best.cost)
+					{
+						best = {source, target, quadricError, cost};
+					}
+				}
+
+				if (best.cost < DBL_MAX && best.quadricError <= targetQuadricError)
+				{
+					collapses.push_back(best);
+				}
+			}
+		}
+
+		if (collapses.size() == 0)
+		{
+			break;
+		}
+
+		std::sort(collapses.begin(), collapses.end(), [](const Collapse& a, const Collapse& b) {
+			return a.cost < b.cost;
+		});
+
+		// Collapse in order, every group only once per pass.
+
+		std::vector<bool> touched(groupCount, false);
+
+		size_t removedIndices = 0;
+		size_t requiredIndices = triangles.size() - targetIndexCount;
+
+		for (const Collapse& collapse : collapses)
+		{
+			if (removedIndices >= requiredIndices)
+			{
+				break;
+			}
+
+			if (touched[collapse.source] || touched[collapse.target])
+			{
+				continue;
+			}
+
+			// Reject collapses flipping a triangle.
+
+			bool flipped = false;
+			uint32_t removedTriangles = 0;
+			for (uint32_t triangle : adjacency[collapse.source])
+			{
+				glm::vec3 p[3];
+				bool containsTarget = false;
+				uint32_t sourceCorner = 0;
+				for (uint32_t k = 0; k < 3; k++)
+				{
+					uint32_t group = groupOfVertex[triangles[3 * triangle + k]];
+
+					if (group == collapse.target)
+					{
+						containsTarget = true;
+					}
+					if (group == collapse.source)
+					{
+						sourceCorner = k;
+					}
+
+					p[k] = positions[positionGroups[group][0]];
+				}
+
+				if (containsTarget)
+				{
+					removedTriangles++;
+
+					continue;
+				}
+
+				glm::vec3 oldNormal = glm::cross(p[1] - p[0], p[2] - p[0]);
+				p[sourceCorner] = positions[positionGroups[collapse.target][0]];
+				glm::vec3 newNormal = glm::cross(p[1] - p[0], p[2] - p[0]);
+
+				if (glm::dot(oldNormal, newNormal) <= 0.0f)
+				{
+					flipped = true;
+
+					break;
+				}
+			}
+
+			if (flipped)
+			{
+				continue;
+			}
+
+			for (uint32_t vertex : positionGroups[collapse.source])
+			{
+				float penalty = 0.0f;
+				vertexRemap[vertex] = getClosestVertex(penalty, vertex, positionGroups[collapse.target], normals);
+			}
+
+			quadrics[collapse.target] += quadrics[collapse.source];
+			quadricWeights[collapse.target] += quadricWeights[collapse.source];
+
+			// Neighbors of both groups are touched, as their triangles change.
+			touched[collapse.source] = true;
+			touched[collapse.target] = true;
+			for (uint32_t triangle : adjacency[collapse.source])
+			{
+				for (uint32_t k = 0; k < 3; k++)
+				{
+					touched[groupOfVertex[triangles[3 * triangle + k]]] = true;
+				}
+			}
+
+			maximumError = glm::max(maximumError, collapse.quadricError);
+
+			removedIndices += 3 * removedTriangles;
+		}
+
+		if (removedIndices == 0)
+		{
+			break;
+		}
+	}
+
+	// Final remap.
+
+	destination.clear();
+	destination.reserve(triangles.size());
+	for (size_t i = 0; i < triangles.size(); i += 3)
+	{
+		uint32_t v[3];
+		for (uint32_t k = 0; k < 3; k++)
+		{
+			v[k] = triangles[i + k];
+			while (vertexRemap[v[k]] != v[k])
+			{
+				v[k] = vertexRemap[v[k]];
+			}
+		}
+
+		if (groupOfVertex[v[0]] == groupOfVertex[v[1]] || groupOfVertex[v[1]] == groupOfVertex[v[2]] || groupOfVertex[v[2]] == groupOfVertex[v[0]])
+		{
+			continue;
+		}
+
+		destination.insert(destination.end(), {v[0], v[1], v[2]});
+	}
+
+	error = static_cast<float>(glm::sqrt(maximumError));
+
+	return true;
+}
+
+bool HelperSimplify::generateLods(GeometryData& geometryData, uint32_t maxLods, float ratio)
+{
+	geometryData.lods.clear();
+
+	if (geometryData.indices.size() == 0 || geometryData.indices.size() % 3 != 0)
+	{
+		return true;
+	}
+
+	std::vector<glm::vec3> positions;
+	if (!HelperGeometry::getPositions(positions, geometryData))
+	{
+		return false;
+	}
+
+	std::vector<glm::vec3> normals;
+	const GeometryAttribute* normalAttribute = HelperGeometry::findAttribute(geometryData, "NORMAL");
+	if (normalAttribute && normalAttribute->format != VK_FORMAT_R16G16_SNORM)
+	{
+		std::vector<glm::vec4> values;
+		if (HelperGeometry::decode(values, *normalAttribute))
+		{
+			normals.resize(values.size());
+			for (size_t i = 0; i < values.size(); i++)
+			{
+				normals[i] = glm::vec3(values[i]);
+				if (glm::length(normals[i]) > 0.0f)
+				{
+					normals[i] = glm::normalize(normals[i]);
+				}
+			}
+		}
+	}
+
+	const std::vector<uint32_t> baseIndices = geometryData.indices;
+
+	geometryData.lods.push_back({0, static_cast<uint32_t>(baseIndices.size()), 0.0f});
+
+	size_t previousIndexCount = baseIndices.size();
+	for (uint32_t level = 1; level < maxLods; level++)
+	{
+		// Every level is simplified from the full resolution, so the error is relative to the original.
+		size_t targetIndexCount = 3 * static_cast<size_t>(static_cast<double>(baseIndices.size() / 3) * glm::pow(static_cast<double>(ratio), static_cast<double>(level)));
+
+		// Not worth an additional level.
+		if (targetIndexCount < 3 * 32)
+		{
+			break;
+		}
+
+		std::vector<uint32_t> lodIndices;
+		float error = 0.0f;
+		if (!HelperSimplify::simplify(lodIndices, error, baseIndices, positions, normals, targetIndexCount, FLT_MAX))
+		{
+			return false;
+		}
+
+		if (lodIndices.size() == 0 || static_cast<double>(lodIndices.size()) > 0.9 * static_cast<double>(previousIndexCount))
+		{
+			break;
+		}
+
+		if (!HelperOptimize::optimizeVertexCache(lodIndices, geometryData.count))
+		{
+			return false;
+		}
+
+		geometryData.lods.push_back({static_cast<uint32_t>(geometryData.indices.size()), static_cast<uint32_t>(lodIndices.size()), glm::max(error, geometryData.lods.back().error)});
+		geometryData.indices.insert(geometryData.indices.end(), lodIndices.begin(), lodIndices.end());
+
+		previousIndexCount = lodIndices.size();
+	}
+
+	// Only the full resolution.
+	if (geometryData.lods.size() == 1)
+	{
+		geometryData.lods.clear();
+	}
+
+	return true;
+}
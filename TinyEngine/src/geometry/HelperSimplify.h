@@ -0,0 +1,30 @@
+#ifndef GEOMETRY_HELPERSIMPLIFY_H_
+#define GEOMETRY_HELPERSIMPLIFY_H_
+
+#include <cstdint>
+#include <vector>
+
+#include "GeometryData.h"
+
+class HelperSimplify
+{
+private:
+
+	static glm::dmat4 getQuadric(const glm::vec3& p0, const glm::vec3& p1, const glm::vec3& p2);
+
+	static double getQuadricError(const glm::dmat4& quadric, const glm::vec3& position);
+
+	static uint32_t getClosestVertex(float& penalty, uint32_t vertex, const std::vector<uint32_t>& candidates, const std::vector<glm::vec3>& normals);
+
+public:
+
+	// Quadric edge collapse onto existing vertices, so the result indexes the same vertex data. Border vertices are locked.
+	// Vertices sharing a position are collapsed together, picking the target vertex with the closest normal. Error is in model units.
+	static bool simplify(std::vector<uint32_t>& destination, float& error, const std::vector<uint32_t>& indices, const std::vector<glm::vec3>& positions, const std::vector<glm::vec3>& normals, size_t targetIndexCount, float targetError);
+
+	// Appends simplified index buffers to the geometry, each one with ratio times the triangles of the previous level.
+	static bool generateLods(GeometryData& geometryData, uint32_t maxLods = 4, float ratio = 0.5f);
+
+};
+
+#endif /* GEOMETRY_HELPERSIMPLIFY_H_ */
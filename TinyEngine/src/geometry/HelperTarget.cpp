@@ -0,0 +1,225 @@
+#include "HelperTarget.h"
+
+#include <algorithm>
+#include <cstring>
+#include <utility>
+
+glm::uvec2 HelperTarget::packDelta(const glm::vec3& delta, uint32_t target)
+{
+	return glm::uvec2(glm::packHalf2x16(glm::vec2(delta.x, delta.y)), static_cast<uint32_t>(glm::packHalf1x16(delta.z)) | (target << 16));
+}
+
+bool HelperTarget::gather(GeometryTargets& geometryTargets, const GLTF& glTF, const Primitive& primitive)
+{
+	// Target index has to fit into 16 bits.
+	if (primitive.targets.size() == 0 || primitive.targets.size() > 0xFFFF || primitive.position < 0)
+	{
+		return false;
+	}
+
+	uint32_t count = glTF.accessors[primitive.position].count;
+	uint32_t targetsCount = static_cast<uint32_t>(primitive.targets.size());
+
+	glm::vec3 zero = glm::vec3(0.0f, 0.0f, 0.0f);
+
+	// Non-zero deltas, keyed by vertex, target and attribute, so sorting groups them by vertex.
+	std::vector<std::pair<uint64_t, glm::vec3>> deltas;
+	bool hasAttributes[3] = {false, false, false};
+
+	for (uint32_t target = 0; target < targetsCount; target++)
+	{
+		const int32_t attributes[] = {primitive.targets[target].position, primitive.targets[target].normal, primitive.targets[target].tangent};
+
+		for (uint32_t attribute = 0; attribute < 3; attribute++)
+		{
+			if (attributes[attribute] < 0)
+			{
+				continue;
+			}
+			hasAttributes[attribute] = true;
+
+			const Accessor& accessor = glTF.accessors[attributes[attribute]];
+			if (accessor.count != count || accessor.typeCount != 3)
+			{
+				return false;
+			}
+
+			uint64_t key = (static_cast<uint64_t>(target) << 2) | attribute;
+
+			// Only the sparse elements differ from zero.
+			if (accessor.sparse.count > 0 && accessor.bufferView < 0)
+			{
+				for (uint32_t k = 0; k < accessor.sparse.count; k++)
+				{
+					uint32_t vertex = HelperAccess::getSparseIndex(accessor, k);
+					if (vertex >= count)
+					{
+						return false;
+					}
+
+					const uint8_t* data = HelperAccess::accessSparseValue(accessor, k);
+
+					glm::vec3 delta = glm::vec3(HelperAccess::getFloat(accessor, data, 0), HelperAccess::getFloat(accessor, data, 1), HelperAccess::getFloat(accessor, data, 2));
+					if (delta != zero)
+					{
+						deltas.push_back(std::make_pair((static_cast<uint64_t>(vertex) << 18) | key, delta));
+					}
+				}
+
+				continue;
+			}
+
+			for (uint32_t vertex = 0; vertex < count; vertex++)
+			{
+				glm::vec3 delta = glm::vec3(HelperAccess::getFloat(accessor, vertex, 0), HelperAccess::getFloat(accessor, vertex, 1), HelperAccess::getFloat(accessor, vertex, 2));
+				if (delta != zero)
+				{
+					deltas.push_back(std::make_pair((static_cast<uint64_t>(vertex) << 18) | key, delta));
+				}
+			}
+		}
+	}
+
+	std::sort(deltas.begin(), deltas.end(), [](const std::pair<uint64_t, glm::vec3>& a, const std::pair<uint64_t, glm::vec3>& b) {
+		return a.first < b.first;
+	});
+
+	geometryTargets = GeometryTargets();
+	geometryTargets.count = count;
+	geometryTargets.targetsCount = targetsCount;
+
+	geometryTargets.offsets.resize(count + 1, 0);
+
+	std::vector<glm::uvec2>* attributeData[] = {&geometryTargets.positions, &geometryTargets.normals, &geometryTargets.tangents};
+
+	uint32_t entries = 0;
+
+	size_t i = 0;
+	for (uint32_t vertex = 0; vertex < count; vertex++)
+	{
+		geometryTargets.offsets[vertex] = entries;
+
+		while (i < deltas.size() && (deltas[i].first >> 18) == vertex)
+		{
+			uint64_t entry = deltas[i].first >> 2;
+			uint32_t target = static_cast<uint32_t>(entry & 0xFFFF);
+
+			glm::vec3 values[3] = {zero, zero, zero};
+			for (; i < deltas.size() && (deltas[i].first >> 2) == entry; i++)
+			{
+				values[deltas[i].first & 3] = deltas[i].second;
+			}
+
+			// All attributes share the same entries.
+			for (uint32_t attribute = 0; attribute < 3; attribute++)
+			{
+				if (hasAttributes[attribute])
+				{
+					attributeData[attribute]->push_back(packDelta(values[attribute], target));
+				}
+			}
+
+			entries++;
+		}
+	}
+
+	geometryTargets.offsets[count] = entries;
+
+	return true;
+}
+
+bool HelperTarget::remap(GeometryTargets& geometryTargets, const std::vector<uint32_t>& remap, uint32_t newCount)
+{
+	if (geometryTargets.offsets.size() != geometryTargets.count + 1 || remap.size() != geometryTargets.count)
+	{
+		return false;
+	}
+
+	std::vector<uint32_t> sources(newCount, UINT32_MAX);
+	for (uint32_t vertex = 0; vertex < geometryTargets.count; vertex++)
+	{
+		if (remap[vertex] != UINT32_MAX)
+		{
+			if (remap[vertex] >= newCount)
+			{
+				return false;
+			}
+
+			sources[remap[vertex]] = vertex;
+		}
+	}
+
+	GeometryTargets remappedTargets;
+	remappedTargets.count = newCount;
+	remappedTargets.targetsCount = geometryTargets.targetsCount;
+
+	remappedTargets.offsets.resize(newCount + 1, 0);
+
+	const std::vector<glm::uvec2>* attributeData[] = {&geometryTargets.positions, &geometryTargets.normals, &geometryTargets.tangents};
+	std::vector<glm::uvec2>* remappedData[] = {&remappedTargets.positions, &remappedTargets.normals, &remappedTargets.tangents};
+
+	uint32_t entries = 0;
+	for (uint32_t vertex = 0; vertex < newCount; vertex++)
+	{
+		remappedTargets.offsets[vertex] = entries;
+
+		if (sources[vertex] == UINT32_MAX)
+		{
+			continue;
+		}
+
+		uint32_t begin = geometryTargets.offsets[sources[vertex]];
+		uint32_t end = geometryTargets.offsets[sources[vertex] + 1];
+
+		for (uint32_t attribute = 0; attribute < 3; attribute++)
+		{
+			if (attributeData[attribute]->size() > 0)
+			{
+				remappedData[attribute]->insert(remappedData[attribute]->end(), attributeData[attribute]->begin() + begin, attributeData[attribute]->begin() + end);
+			}
+		}
+
+		entries += end - begin;
+	}
+
+	remappedTargets.offsets[newCount] = entries;
+
+	geometryTargets = remappedTargets;
+
+	return true;
+}
+
+uint64_t HelperTarget::getSize(const GeometryTargets& geometryTargets)
+{
+	return sizeof(uint32_t) * geometryTargets.offsets.size() + sizeof(glm::uvec2) * (geometryTargets.positions.size() + geometryTargets.normals.size() + geometryTargets.tangents.size());
+}
+
+uint32_t HelperTarget::getPackedWeightsCount(uint32_t targetsCount)
+{
+	return 1 + (targetsCount + 1) / 2;
+}
+
+void HelperTarget::packWeights(std::vector<glm::uvec4>& packedWeights, const std::vector<float>& weights)
+{
+	packedWeights.assign(getPackedWeightsCount(static_cast<uint32_t>(weights.size())), glm::uvec4(0, 0, 0, 0));
+
+	uint32_t activeCount = 0;
+	for (uint32_t target = 0; target < static_cast<uint32_t>(weights.size()); target++)
+	{
+		if (weights[target] == 0.0f)
+		{
+			continue;
+		}
+
+		uint32_t weight;
+		memcpy(&weight, &weights[target], sizeof(weight));
+
+		glm::uvec4& packedWeight = packedWeights[1 + activeCount / 2];
+		packedWeight[2 * (activeCount % 2) + 0] = target;
+		packedWeight[2 * (activeCount % 2) + 1] = weight;
+
+		activeCount++;
+	}
+
+	packedWeights[0].x = activeCount;
+}
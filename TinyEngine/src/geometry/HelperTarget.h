@@ -0,0 +1,35 @@
+#ifndef GEOMETRY_HELPERTARGET_H_
+#define GEOMETRY_HELPERTARGET_H_
+
+#include <cstdint>
+#include <vector>
+
+#include "../gltf/GLTF.h"
+
+#include "GeometryData.h"
+
+class HelperTarget
+{
+private:
+
+	static glm::uvec2 packDelta(const glm::vec3& delta, uint32_t target);
+
+public:
+
+	// Reads the morph targets of the primitive into the sparse layout. Sparse accessors without base data are read without expanding them.
+	static bool gather(GeometryTargets& geometryTargets, const GLTF& glTF, const Primitive& primitive);
+
+	// Moves the deltas of each vertex to remap[vertex]. Vertices mapped to UINT32_MAX are removed.
+	static bool remap(GeometryTargets& geometryTargets, const std::vector<uint32_t>& remap, uint32_t newCount);
+
+	static uint64_t getSize(const GeometryTargets& geometryTargets);
+
+	// Number of vectors of the packed weights. First one holds the active count, then two target index and weight pairs per vector.
+	static uint32_t getPackedWeightsCount(uint32_t targetsCount);
+
+	// Only non-zero weights are kept, in target order.
+	static void packWeights(std::vector<glm::uvec4>& packedWeights, const std::vector<float>& weights);
+
+};
+
+#endif /* GEOMETRY_HELPERTARGET_H_ */
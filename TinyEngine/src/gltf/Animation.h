@@ -36,6 +36,16 @@ struct AnimationSampler {
 	std::vector<float> inputTime;
 
 	std::vector<float> outputValues;
+
+	// Key times are evenly spaced, so the key is found in constant time.
+	bool uniform = false;
+	float uniformInterval = 0.0f;
+
+	// Output values are replaced by 16 bit values. Rotations are stored as the smallest three components, others relative to the range.
+	bool compressed = false;
+	std::vector<uint16_t> quantizedValues;
+	std::vector<float> quantizationMinimum;
+	std::vector<float> quantizationExtent;
 };
 
 struct AnimationChannel {
@@ -45,6 +55,9 @@ struct AnimationChannel {
 	// Generic helper
 
 	AnimationSampler* targetSampler = nullptr;
+
+	// Last found key, as playback is mostly monotonic.
+	int32_t cursor = 0;
 };
 
 struct Animation {
@@ -1,9 +1,13 @@
 #ifndef GLTF_BUFFER_H_
 #define GLTF_BUFFER_H_
 
+#include <cstdint>
+#include <memory>
 #include <string>
 #include <vector>
 
+#include "../io/MappedFile.h"
+
 struct Buffer {
 	std::string uri = "";
 	uint32_t byteLength = 0;
@@ -11,6 +15,10 @@ struct Buffer {
 	// Generic helper
 
 	std::vector<uint8_t> binary;
+
+	// Points into the mapped file instead of the binary, if set.
+	std::shared_ptr<MappedFile> mappedFile;
+	const uint8_t* mapped = nullptr;
 };
 
 #endif /* GLTF_BUFFER_H_ */
@@ -18,9 +18,11 @@
 #include "Skin.h"
 #include "Animation.h"
 #include "Scene.h"
+#include "Hierarchy.h"
 #include "HelperAccess.h"
 #include "HelperAnimate.h"
 #include "HelperLoad.h"
+#include "HelperParse.h"
 #include "HelperUpdate.h"
 
 struct GLTF {
@@ -37,6 +39,10 @@ struct GLTF {
 	std::vector<Skin> skins;
 	std::vector<Scene> scenes;
 	uint32_t defaultScene = 0;
+
+	// Generic helper
+
+	Hierarchy hierarchy;
 };
 
 #endif /* GLTF_GLTF_H_ */
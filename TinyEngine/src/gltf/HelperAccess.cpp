@@ -1,7 +1,14 @@
 #include "HelperAccess.h"
 
+#include <cstring>
+
 const uint8_t* HelperAccess::accessData(const Buffer& buffer)
 {
+	if (buffer.mapped != nullptr)
+	{
+		return buffer.mapped;
+	}
+
 	return buffer.binary.data();
 }
 
@@ -56,6 +63,91 @@ uint32_t HelperAccess::getStride(const Accessor& accessor)
 	return glm::max(accessor.typeCount * accessor.componentTypeSize, stride);
 }
 
+float HelperAccess::getFloat(const Accessor& accessor, uint32_t element, uint32_t component)
+{
+	return HelperAccess::getFloat(accessor, HelperAccess::accessData(accessor) + element * HelperAccess::getStride(accessor), component);
+}
+
+float HelperAccess::getFloat(const Accessor& accessor, const uint8_t* data, uint32_t component)
+{
+	data += component * accessor.componentTypeSize;
+
+	switch (accessor.componentType)
+	{
+		case 5120:
+		{
+			int8_t value;
+			memcpy(&value, data, sizeof(value));
+			return accessor.normalized ? glm::max(value / 127.0f, -1.0f) : static_cast<float>(value);
+		}
+		case 5121:
+		{
+			uint8_t value;
+			memcpy(&value, data, sizeof(value));
+			return accessor.normalized ? value / 255.0f : static_cast<float>(value);
+		}
+		case 5122:
+		{
+			int16_t value;
+			memcpy(&value, data, sizeof(value));
+			return accessor.normalized ? glm::max(value / 32767.0f, -1.0f) : static_cast<float>(value);
+		}
+		case 5123:
+		{
+			uint16_t value;
+			memcpy(&value, data, sizeof(value));
+			return accessor.normalized ? value / 65535.0f : static_cast<float>(value);
+		}
+		case 5125:
+		{
+			uint32_t value;
+			memcpy(&value, data, sizeof(value));
+			return static_cast<float>(value);
+		}
+		case 5126:
+		{
+			float value;
+			memcpy(&value, data, sizeof(value));
+			return value;
+		}
+	}
+
+	return 0.0f;
+}
+
+uint32_t HelperAccess::getSparseIndex(const Accessor& accessor, uint32_t k)
+{
+	const uint8_t* data = HelperAccess::accessData(*accessor.sparse.indices.pBufferView) + accessor.sparse.indices.byteOffset + k * accessor.sparse.indices.componentTypeSize;
+
+	switch (accessor.sparse.indices.componentTypeSize)
+	{
+		case 1:
+		{
+			return static_cast<uint32_t>(data[0]);
+		}
+		case 2:
+		{
+			uint16_t index;
+			memcpy(&index, data, sizeof(index));
+			return static_cast<uint32_t>(index);
+		}
+		case 4:
+		{
+			uint32_t index;
+			memcpy(&index, data, sizeof(index));
+			return index;
+		}
+	}
+
+	return 0;
+}
+
+const uint8_t* HelperAccess::accessSparseValue(const Accessor& accessor, uint32_t k)
+{
+	// Sparse values are tightly packed.
+	return HelperAccess::accessData(*accessor.sparse.values.pBufferView) + accessor.sparse.values.byteOffset + k * accessor.componentTypeSize * accessor.typeCount;
+}
+
 const uint8_t* HelperAccess::accessData(const Image& image, uint32_t index)
 {
 	if (index >= image.imageDataResources.images.size())
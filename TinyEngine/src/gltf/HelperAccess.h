@@ -17,6 +17,12 @@ public:
 	static uint32_t getOffset(const Accessor& accessor);
 	static uint32_t getRange(const Accessor& accessor);
 	static uint32_t getStride(const Accessor& accessor);
+	static float getFloat(const Accessor& accessor, uint32_t element, uint32_t component);
+	static float getFloat(const Accessor& accessor, const uint8_t* data, uint32_t component);
+
+	// Elements given by a sparse accessor, without applying them to the base data.
+	static uint32_t getSparseIndex(const Accessor& accessor, uint32_t k);
+	static const uint8_t* accessSparseValue(const Accessor& accessor, uint32_t k);
 
 	static const uint8_t* accessData(const Image& image, uint32_t index = 0);
 };
@@ -1,38 +1,22 @@
 #include "HelperAnimate.h"
 
+#include <algorithm>
+
 #include "../activity/Interpolator.h"
 
-bool HelperAnimate::update(GLTF& glTF, const AnimationChannel& channel, int32_t startIndex, int32_t stopIndex, float currentTime)
+void HelperAnimate::interpolate(float* values, const AnimationSampler& sampler, uint32_t typeCount, bool rotation, int32_t startIndex, int32_t stopIndex, float currentTime)
 {
-	const AnimationSampler& sampler = *channel.targetSampler;
-
 	float t = 0.0f;
 	if (stopIndex != -1)
 	{
 		t = (currentTime - sampler.inputTime[startIndex]) / (sampler.inputTime[stopIndex] - sampler.inputTime[startIndex]);
 	}
 
-	Node& node = *channel.target.targetNode;
-
 	const float* x = nullptr;
 	const float* y = nullptr;
 	const float* xout = nullptr;
 	const float* yin = nullptr;
 
-	uint32_t typeCount = 1;
-	if (channel.target.path == translation || channel.target.path == scale)
-	{
-		typeCount = 3;
-	}
-	else if (channel.target.path == rotation)
-	{
-		typeCount = 4;
-	}
-	else
-	{
-		typeCount = static_cast<uint32_t>(node.weights.size());
-	}
-
 	uint32_t elementCount = 1;
 	uint32_t elementOffset = 0;
 	if (sampler.interpolation == CUBICSPLINE)
@@ -42,52 +26,49 @@ bool HelperAnimate::update(GLTF& glTF, const AnimationChannel& channel, int32_t
 	}
 	uint32_t offset = typeCount * elementCount;
 
-	x = &sampler.outputValues[startIndex * offset + elementOffset];
-	if (sampler.interpolation == CUBICSPLINE)
+	float startValues[4];
+	float stopValues[4];
+	std::vector<float> decodedValues;
+
+	if (sampler.compressed)
 	{
-		xout = &sampler.outputValues[startIndex * offset + elementOffset * 2];
+		float* decodedStart = startValues;
+		float* decodedStop = stopValues;
+		if (typeCount > 4)
+		{
+			decodedValues.resize(typeCount * 2);
+			decodedStart = &decodedValues[0];
+			decodedStop = &decodedValues[typeCount];
+		}
+
+		decode(decodedStart, sampler, typeCount, rotation, startIndex);
+		x = decodedStart;
+		if (stopIndex != -1)
+		{
+			decode(decodedStop, sampler, typeCount, rotation, stopIndex);
+			y = decodedStop;
+		}
 	}
-	if (stopIndex != -1)
+	else
 	{
-		y = &sampler.outputValues[stopIndex * offset + elementOffset];
+		x = &sampler.outputValues[startIndex * offset + elementOffset];
 		if (sampler.interpolation == CUBICSPLINE)
 		{
-			yin = &sampler.outputValues[stopIndex * offset];
+			xout = &sampler.outputValues[startIndex * offset + elementOffset * 2];
 		}
-	}
-
-	//
-
-	if (channel.target.path == translation || channel.target.path == scale)
-	{
-		glm::vec3 value(x[0], x[1], x[2]);
-
 		if (stopIndex != -1)
 		{
+			y = &sampler.outputValues[stopIndex * offset + elementOffset];
 			if (sampler.interpolation == CUBICSPLINE)
 			{
-				value = Interpolator::cubicspline(glm::vec3(x[0], x[1], x[2]), glm::vec3(xout[0], xout[1], xout[2]), glm::vec3(yin[0], yin[1], yin[2]), glm::vec3(y[0], y[1], y[2]), t);
-			}
-			else if (sampler.interpolation == LINEAR)
-			{
-				value = Interpolator::linear(glm::vec3(x[0], x[1], x[2]), glm::vec3(y[0], y[1], y[2]), t);
-			}
-			else
-			{
-				value = Interpolator::step(glm::vec3(x[0], x[1], x[2]), glm::vec3(y[0], y[1], y[2]), t);
+				yin = &sampler.outputValues[stopIndex * offset];
 			}
 		}
-
-		if (channel.target.path == translation)
-		{
-			node.translation = value;
-		}
-		else if (channel.target.path == scale)
-		{
-			node.scale = value;
-		}
 	}
-	else if (channel.target.path == rotation)
+
+	//
+
+	if (rotation)
 	{
 		glm::quat value(x[3], x[0], x[1], x[2]);
 
@@ -107,11 +88,14 @@ bool HelperAnimate::update(GLTF& glTF, const AnimationChannel& channel, int32_t
 			}
 		}
 
-		node.rotation = value;
+		values[0] = value.x;
+		values[1] = value.y;
+		values[2] = value.z;
+		values[3] = value.w;
 	}
 	else
 	{
-		for (size_t i = 0; i < node.weights.size(); i++)
+		for (uint32_t i = 0; i < typeCount; i++)
 		{
 			float value = x[i];
 
@@ -131,13 +115,353 @@ bool HelperAnimate::update(GLTF& glTF, const AnimationChannel& channel, int32_t
 				}
 			}
 
-			node.weights[i] = value;
+			values[i] = value;
+		}
+	}
+}
+
+void HelperAnimate::decode(float* values, const AnimationSampler& sampler, uint32_t typeCount, bool rotation, int32_t index)
+{
+	if (rotation)
+	{
+		const uint16_t* data = &sampler.quantizedValues[index * 3];
+
+		// The index of the largest component is stored in the upper bits.
+		uint32_t largest = (data[0] >> 15) | ((data[1] >> 15) << 1);
+
+		float sum = 0.0f;
+		uint32_t component = 0;
+		for (uint32_t i = 0; i < 4; i++)
+		{
+			if (i == largest)
+			{
+				continue;
+			}
+
+			values[i] = (static_cast<float>(data[component] & 0x7FFF) / 32767.0f * 2.0f - 1.0f) * glm::one_over_root_two<float>();
+			sum += values[i] * values[i];
+
+			component++;
+		}
+
+		values[largest] = glm::sqrt(glm::max(1.0f - sum, 0.0f));
+
+		return;
+	}
+
+	const uint16_t* data = &sampler.quantizedValues[index * typeCount];
+
+	for (uint32_t i = 0; i < typeCount; i++)
+	{
+		values[i] = sampler.quantizationMinimum[i] + sampler.quantizationExtent[i] * static_cast<float>(data[i]) / 65535.0f;
+	}
+}
+
+float HelperAnimate::measure(const float* x, const float* y, uint32_t typeCount, bool rotation)
+{
+	if (rotation)
+	{
+		float sign = (x[0] * y[0] + x[1] * y[1] + x[2] * y[2] + x[3] * y[3] < 0.0f) ? -1.0f : 1.0f;
+
+		// Angle from the chord length, as the arc cosine is imprecise for small angles.
+		float chord = 0.0f;
+		for (uint32_t i = 0; i < 4; i++)
+		{
+			chord += (x[i] - sign * y[i]) * (x[i] - sign * y[i]);
+		}
+
+		return 4.0f * glm::asin(glm::min(glm::sqrt(chord) * 0.5f, 1.0f));
+	}
+
+	float error = 0.0f;
+	for (uint32_t i = 0; i < typeCount; i++)
+	{
+		error = glm::max(error, glm::abs(x[i] - y[i]));
+	}
+
+	return error;
+}
+
+void HelperAnimate::reduce(std::vector<uint32_t>& keys, const AnimationSampler& sampler, uint32_t typeCount, bool rotation, float tolerance)
+{
+	uint32_t keysCount = static_cast<uint32_t>(sampler.inputTime.size());
+
+	keys.clear();
+	keys.push_back(0);
+
+	if (keysCount == 1)
+	{
+		return;
+	}
+
+	std::vector<float> values(typeCount);
+
+	uint32_t startKey = 0;
+	for (uint32_t stopKey = 2; stopKey < keysCount; stopKey++)
+	{
+		// Limited, as every key in between is tested again for a longer segment.
+		bool removable = (stopKey - startKey) <= 256;
+
+		for (uint32_t k = startKey + 1; k < stopKey && removable; k++)
+		{
+			const float* value = &sampler.outputValues[k * typeCount];
+
+			if (sampler.interpolation == STEP)
+			{
+				removable = measure(&sampler.outputValues[startKey * typeCount], value, typeCount, rotation) <= tolerance;
+			}
+			else
+			{
+				interpolate(values.data(), sampler, typeCount, rotation, static_cast<int32_t>(startKey), static_cast<int32_t>(stopKey), sampler.inputTime[k]);
+
+				removable = measure(values.data(), value, typeCount, rotation) <= tolerance;
+			}
+		}
+
+		if (!removable)
+		{
+			startKey = stopKey - 1;
+
+			keys.push_back(startKey);
+		}
+	}
+
+	keys.push_back(keysCount - 1);
+}
+
+void HelperAnimate::quantize(AnimationSampler& sampler, const std::vector<uint32_t>& keys, uint32_t typeCount, bool rotation)
+{
+	std::vector<float> inputTime(keys.size());
+	for (size_t i = 0; i < keys.size(); i++)
+	{
+		inputTime[i] = sampler.inputTime[keys[i]];
+	}
+
+	sampler.quantizedValues.clear();
+	sampler.quantizationMinimum.clear();
+	sampler.quantizationExtent.clear();
+
+	if (rotation)
+	{
+		sampler.quantizedValues.resize(keys.size() * 3);
+
+		for (size_t i = 0; i < keys.size(); i++)
+		{
+			const float* value = &sampler.outputValues[keys[i] * 4];
+
+			float length = glm::sqrt(value[0] * value[0] + value[1] * value[1] + value[2] * value[2] + value[3] * value[3]);
+			if (length == 0.0f)
+			{
+				length = 1.0f;
+			}
+
+			uint32_t largest = 0;
+			for (uint32_t k = 1; k < 4; k++)
+			{
+				if (glm::abs(value[k]) > glm::abs(value[largest]))
+				{
+					largest = k;
+				}
+			}
+
+			// q and -q are the same rotation, so the largest component is always positive.
+			float sign = (value[largest] < 0.0f) ? -1.0f : 1.0f;
+
+			uint16_t* data = &sampler.quantizedValues[i * 3];
+
+			uint32_t component = 0;
+			for (uint32_t k = 0; k < 4; k++)
+			{
+				if (k == largest)
+				{
+					continue;
+				}
+
+				float normalized = glm::clamp(sign * value[k] / length * glm::root_two<float>() * 0.5f + 0.5f, 0.0f, 1.0f);
+
+				data[component] = static_cast<uint16_t>(glm::round(normalized * 32767.0f));
+
+				component++;
+			}
+
+			data[0] |= static_cast<uint16_t>((largest & 1) << 15);
+			data[1] |= static_cast<uint16_t>((largest >> 1) << 15);
+		}
+	}
+	else
+	{
+		sampler.quantizationMinimum.resize(typeCount);
+		sampler.quantizationExtent.resize(typeCount);
+
+		for (uint32_t k = 0; k < typeCount; k++)
+		{
+			float minimum = sampler.outputValues[keys[0] * typeCount + k];
+			float maximum = minimum;
+			for (size_t i = 1; i < keys.size(); i++)
+			{
+				minimum = glm::min(minimum, sampler.outputValues[keys[i] * typeCount + k]);
+				maximum = glm::max(maximum, sampler.outputValues[keys[i] * typeCount + k]);
+			}
+
+			sampler.quantizationMinimum[k] = minimum;
+			sampler.quantizationExtent[k] = maximum - minimum;
+		}
+
+		sampler.quantizedValues.resize(keys.size() * typeCount);
+
+		for (size_t i = 0; i < keys.size(); i++)
+		{
+			for (uint32_t k = 0; k < typeCount; k++)
+			{
+				float normalized = 0.0f;
+				if (sampler.quantizationExtent[k] > 0.0f)
+				{
+					normalized = glm::clamp((sampler.outputValues[keys[i] * typeCount + k] - sampler.quantizationMinimum[k]) / sampler.quantizationExtent[k], 0.0f, 1.0f);
+				}
+
+				sampler.quantizedValues[i * typeCount + k] = static_cast<uint16_t>(glm::round(normalized * 65535.0f));
+			}
+		}
+	}
+
+	sampler.inputTime = inputTime;
+	sampler.outputValues = std::vector<float>();
+	sampler.compressed = true;
+
+	checkUniform(sampler);
+}
+
+bool HelperAnimate::findKeys(int32_t& startIndex, int32_t& stopIndex, int32_t& cursor, const AnimationSampler& sampler, float currentTime)
+{
+	const std::vector<float>& inputTime = sampler.inputTime;
+
+	if (inputTime.size() == 0)
+	{
+		return false;
+	}
+
+	int32_t lastIndex = static_cast<int32_t>(inputTime.size()) - 1;
+
+	if (currentTime < inputTime.front())
+	{
+		startIndex = 0;
+		stopIndex = -1;
+	}
+	else if (currentTime >= inputTime.back())
+	{
+		startIndex = lastIndex;
+		stopIndex = -1;
+	}
+	else if (sampler.uniform)
+	{
+		startIndex = glm::min(static_cast<int32_t>((currentTime - inputTime.front()) / sampler.uniformInterval), lastIndex - 1);
+
+		// Rounding errors at the key times.
+		if (currentTime < inputTime[startIndex])
+		{
+			startIndex--;
+		}
+		else if (currentTime >= inputTime[startIndex + 1])
+		{
+			startIndex++;
+		}
+		stopIndex = startIndex + 1;
+	}
+	else
+	{
+		cursor = glm::clamp(cursor, 0, lastIndex - 1);
+
+		if (currentTime >= inputTime[cursor] && currentTime < inputTime[cursor + 1])
+		{
+			startIndex = cursor;
+		}
+		else if (cursor + 2 <= lastIndex && currentTime >= inputTime[cursor + 1] && currentTime < inputTime[cursor + 2])
+		{
+			startIndex = cursor + 1;
+		}
+		else
+		{
+			// Seek, so search for the first key after the current time.
+			startIndex = static_cast<int32_t>(std::upper_bound(inputTime.begin(), inputTime.end(), currentTime) - inputTime.begin()) - 1;
+		}
+		stopIndex = startIndex + 1;
+
+		cursor = startIndex;
+	}
+
+	return true;
+}
+
+bool HelperAnimate::update(GLTF& glTF, const AnimationChannel& channel, int32_t startIndex, int32_t stopIndex, float currentTime)
+{
+	const AnimationSampler& sampler = *channel.targetSampler;
+
+	Node& node = *channel.target.targetNode;
+
+	if (channel.target.path == translation || channel.target.path == scale)
+	{
+		float values[3];
+		interpolate(values, sampler, 3, false, startIndex, stopIndex, currentTime);
+
+		if (channel.target.path == translation)
+		{
+			node.translation = glm::vec3(values[0], values[1], values[2]);
+		}
+		else
+		{
+			node.scale = glm::vec3(values[0], values[1], values[2]);
 		}
+
+		HelperUpdate::setDirty(glTF, channel.target.node);
+	}
+	else if (channel.target.path == rotation)
+	{
+		float values[4];
+		interpolate(values, sampler, 4, true, startIndex, stopIndex, currentTime);
+
+		node.rotation = glm::quat(values[3], values[0], values[1], values[2]);
+
+		HelperUpdate::setDirty(glTF, channel.target.node);
+	}
+	else if (node.weights.size() > 0)
+	{
+		interpolate(node.weights.data(), sampler, static_cast<uint32_t>(node.weights.size()), false, startIndex, stopIndex, currentTime);
 	}
 
 	return true;
 }
 
+void HelperAnimate::checkUniform(AnimationSampler& sampler)
+{
+	sampler.uniform = false;
+	sampler.uniformInterval = 0.0f;
+
+	if (sampler.inputTime.size() < 2)
+	{
+		return;
+	}
+
+	float interval = (sampler.inputTime.back() - sampler.inputTime.front()) / static_cast<float>(sampler.inputTime.size() - 1);
+	if (interval <= 0.0f)
+	{
+		return;
+	}
+
+	for (size_t i = 1; i < sampler.inputTime.size(); i++)
+	{
+		float expected = sampler.inputTime.front() + interval * static_cast<float>(i);
+
+		// Has to be close enough, that the correction in findKeys is sufficient.
+		if (glm::abs(sampler.inputTime[i] - expected) > interval * 0.01f)
+		{
+			return;
+		}
+	}
+
+	sampler.uniform = true;
+	sampler.uniformInterval = interval;
+}
+
 bool HelperAnimate::gatherStop(float& stop, const GLTF& glTF, uint32_t animationIndex)
 {
 	if (animationIndex >= static_cast<uint32_t>(glTF.animations.size()))
@@ -167,48 +491,319 @@ bool HelperAnimate::gatherStop(float& stop, const GLTF& glTF, uint32_t animation
 	return true;
 }
 
-bool HelperAnimate::update(GLTF& glTF, uint32_t animationIndex, float currentTime)
+bool HelperAnimate::update(GLTF& glTF, uint32_t animationIndex, float currentTime, const std::vector<uint8_t>& nodeMask)
 {
 	if (animationIndex >= static_cast<uint32_t>(glTF.animations.size()))
 	{
 		return false;
 	}
 
-	const Animation& animation = glTF.animations[animationIndex];
+	Animation& animation = glTF.animations[animationIndex];
 
 	for (uint32_t i = 0; i < animation.channels.size(); i++)
 	{
-		const AnimationChannel& channel = animation.channels[i];
-		const AnimationSampler& sampler = *channel.targetSampler;
+		AnimationChannel& channel = animation.channels[i];
 
-		const std::vector<float>& inputTime = sampler.inputTime;
+		if (nodeMask.size() > 0 && (channel.target.node < 0 || channel.target.node >= static_cast<int32_t>(nodeMask.size()) || !nodeMask[channel.target.node]))
+		{
+			continue;
+		}
 
-		if (inputTime.size() == 0)
+		int32_t startIndex = 0;
+		int32_t stopIndex = -1;
+		if (!findKeys(startIndex, stopIndex, channel.cursor, *channel.targetSampler, currentTime))
 		{
 			return false;
 		}
 
-		if (currentTime < inputTime.front())
+		update(glTF, channel, startIndex, stopIndex, currentTime);
+	}
+
+	return true;
+}
+
+bool HelperAnimate::resample(GLTF& glTF, float framesPerSecond)
+{
+	if (framesPerSecond <= 0.0f)
+	{
+		return false;
+	}
+
+	for (Animation& animation : glTF.animations)
+	{
+		for (uint32_t i = 0; i < animation.samplers.size(); i++)
 		{
-			update(glTF, channel, 0, -1, currentTime);
+			AnimationSampler& sampler = animation.samplers[i];
+
+			checkUniform(sampler);
+
+			// Step interpolation would move the steps.
+			if (sampler.uniform || sampler.compressed || sampler.interpolation == STEP || sampler.inputTime.size() < 2)
+			{
+				continue;
+			}
+
+			const AnimationChannel* channel = nullptr;
+			for (const AnimationChannel& currentChannel : animation.channels)
+			{
+				if (currentChannel.targetSampler == &sampler)
+				{
+					channel = &currentChannel;
+
+					break;
+				}
+			}
+
+			if (channel == nullptr)
+			{
+				continue;
+			}
+
+			uint32_t typeCount = 0;
+			if (channel->target.path == translation || channel->target.path == scale)
+			{
+				typeCount = 3;
+			}
+			else if (channel->target.path == rotation)
+			{
+				typeCount = 4;
+			}
+			else
+			{
+				typeCount = static_cast<uint32_t>(channel->target.targetNode->weights.size());
+			}
+
+			if (typeCount == 0)
+			{
+				continue;
+			}
+
+			float start = sampler.inputTime.front();
+			float duration = sampler.inputTime.back() - start;
+
+			size_t keysCount = static_cast<size_t>(glm::ceil(duration * framesPerSecond)) + 1;
+
+			std::vector<float> inputTime(keysCount);
+			std::vector<float> outputValues(keysCount * typeCount);
+
+			int32_t cursor = 0;
+			for (size_t k = 0; k < keysCount; k++)
+			{
+				inputTime[k] = (k == keysCount - 1) ? sampler.inputTime.back() : start + duration * static_cast<float>(k) / static_cast<float>(keysCount - 1);
+
+				int32_t startIndex = 0;
+				int32_t stopIndex = -1;
+				if (!findKeys(startIndex, stopIndex, cursor, sampler, inputTime[k]))
+				{
+					return false;
+				}
+
+				interpolate(&outputValues[k * typeCount], sampler, typeCount, channel->target.path == rotation, startIndex, stopIndex, inputTime[k]);
+			}
+
+			sampler.inputTime = inputTime;
+			sampler.outputValues = outputValues;
+			sampler.interpolation = LINEAR;
+
+			sampler.uniform = true;
+			sampler.uniformInterval = duration / static_cast<float>(keysCount - 1);
 		}
-		else if (currentTime >= inputTime.back())
+
+		for (AnimationChannel& channel : animation.channels)
 		{
-			update(glTF, channel, static_cast<int32_t>(inputTime.size() - 1), -1, currentTime);
+			channel.cursor = 0;
 		}
-		else
+	}
+
+	return true;
+}
+
+bool HelperAnimate::compress(std::vector<AnimationCompressionReport>& reports, GLTF& glTF, const AnimationCompression& animationCompression)
+{
+	reports.clear();
+
+	std::vector<uint32_t> keys;
+	std::vector<float> values;
+
+	for (uint32_t animationIndex = 0; animationIndex < glTF.animations.size(); animationIndex++)
+	{
+		Animation& animation = glTF.animations[animationIndex];
+
+		for (uint32_t channelIndex = 0; channelIndex < animation.channels.size(); channelIndex++)
 		{
-			for (int32_t startIndex = 0; startIndex < static_cast<int32_t>(inputTime.size()); startIndex++)
+			AnimationChannel& channel = animation.channels[channelIndex];
+			if (channel.targetSampler == nullptr || channel.target.targetNode == nullptr)
 			{
-				if (currentTime < inputTime[startIndex])
-				{
-					update(glTF, channel, startIndex - 1, startIndex, currentTime);
+				continue;
+			}
 
-					break;
+			AnimationSampler& sampler = *channel.targetSampler;
+
+			// Shared samplers are only compressed once.
+			if (sampler.compressed || sampler.interpolation == CUBICSPLINE || sampler.inputTime.size() == 0)
+			{
+				continue;
+			}
+
+			bool rotate = channel.target.path == rotation;
+
+			uint32_t typeCount = 0;
+			float tolerance = 0.0f;
+			if (channel.target.path == translation)
+			{
+				typeCount = 3;
+				tolerance = animationCompression.translationTolerance;
+			}
+			else if (channel.target.path == rotation)
+			{
+				typeCount = 4;
+				tolerance = animationCompression.rotationTolerance;
+			}
+			else if (channel.target.path == scale)
+			{
+				typeCount = 3;
+				tolerance = animationCompression.scaleTolerance;
+			}
+			else
+			{
+				typeCount = static_cast<uint32_t>(channel.target.targetNode->weights.size());
+				tolerance = animationCompression.weightsTolerance;
+			}
+
+			if (typeCount == 0 || sampler.outputValues.size() != sampler.inputTime.size() * typeCount)
+			{
+				continue;
+			}
+
+			AnimationSampler original = sampler;
+
+			AnimationCompressionReport report;
+			report.animationIndex = animationIndex;
+			report.channelIndex = channelIndex;
+			report.path = channel.target.path;
+			report.keysCountBefore = static_cast<uint32_t>(original.inputTime.size());
+			report.byteSizeBefore = (original.inputTime.size() + original.outputValues.size()) * sizeof(float);
+
+			reduce(keys, sampler, typeCount, rotate, tolerance);
+			quantize(sampler, keys, typeCount, rotate);
+
+			channel.cursor = 0;
+
+			report.keysCountAfter = static_cast<uint32_t>(sampler.inputTime.size());
+			report.byteSizeAfter = (sampler.inputTime.size() + sampler.quantizationMinimum.size() + sampler.quantizationExtent.size()) * sizeof(float) + sampler.quantizedValues.size() * sizeof(uint16_t);
+
+			// Measure the error of the key reduction and quantization together.
+			values.resize(typeCount);
+
+			int32_t cursor = 0;
+			for (size_t k = 0; k < original.inputTime.size(); k++)
+			{
+				int32_t startIndex = 0;
+				int32_t stopIndex = -1;
+				if (!findKeys(startIndex, stopIndex, cursor, sampler, original.inputTime[k]))
+				{
+					return false;
 				}
+
+				interpolate(values.data(), sampler, typeCount, rotate, startIndex, stopIndex, original.inputTime[k]);
+
+				report.maximumError = glm::max(report.maximumError, measure(values.data(), &original.outputValues[k * typeCount], typeCount, rotate));
 			}
+
+			reports.push_back(report);
 		}
 	}
 
 	return true;
 }
+
+void HelperAnimate::blendJointMatrices(std::vector<glm::mat4>& jointMatrices, const Node& node, float t)
+{
+	if (t >= 1.0f || node.previousJointMatrices.size() != node.jointMatrices.size())
+	{
+		jointMatrices = node.jointMatrices;
+
+		return;
+	}
+
+	jointMatrices.resize(node.jointMatrices.size());
+	for (size_t i = 0; i < jointMatrices.size(); i++)
+	{
+		jointMatrices[i] = node.previousJointMatrices[i] * (1.0f - t) + node.jointMatrices[i] * t;
+	}
+}
+
+bool HelperAnimate::bakeJointMatrices(BakedJointMatrices& bakedJointMatrices, GLTF& glTF, int32_t nodeIndex, uint32_t animationIndex, float framesPerSecond)
+{
+	if (nodeIndex < 0 || nodeIndex >= static_cast<int32_t>(glTF.nodes.size()) || glTF.nodes[nodeIndex].skin < 0)
+	{
+		return false;
+	}
+
+	float stop = 0.0f;
+	if (framesPerSecond <= 0.0f || !gatherStop(stop, glTF, animationIndex))
+	{
+		return false;
+	}
+
+	const Animation& animation = glTF.animations[animationIndex];
+
+	std::vector<int32_t> animatedNodes;
+	for (const AnimationChannel& channel : animation.channels)
+	{
+		if (channel.target.node >= 0 && channel.target.node < static_cast<int32_t>(glTF.nodes.size()) && std::find(animatedNodes.begin(), animatedNodes.end(), channel.target.node) == animatedNodes.end())
+		{
+			animatedNodes.push_back(channel.target.node);
+		}
+	}
+
+	std::vector<Node> restNodes(animatedNodes.size());
+	for (size_t i = 0; i < animatedNodes.size(); i++)
+	{
+		restNodes[i].translation = glTF.nodes[animatedNodes[i]].translation;
+		restNodes[i].rotation = glTF.nodes[animatedNodes[i]].rotation;
+		restNodes[i].scale = glTF.nodes[animatedNodes[i]].scale;
+		restNodes[i].weights = glTF.nodes[animatedNodes[i]].weights;
+	}
+
+	bakedJointMatrices = BakedJointMatrices();
+	bakedJointMatrices.jointsCount = static_cast<uint32_t>(glTF.skins[glTF.nodes[nodeIndex].skin].joints.size());
+	bakedJointMatrices.framesCount = static_cast<uint32_t>(glm::ceil(stop * framesPerSecond)) + 1;
+	bakedJointMatrices.duration = stop;
+	bakedJointMatrices.rows.resize(static_cast<size_t>(bakedJointMatrices.framesCount) * bakedJointMatrices.jointsCount * 3);
+
+	// The first and last frame are the start and the stop of the animation, so looping blends between them.
+	float interval = bakedJointMatrices.framesCount > 1 ? stop / static_cast<float>(bakedJointMatrices.framesCount - 1) : 0.0f;
+
+	bool result = true;
+	for (uint32_t k = 0; k < bakedJointMatrices.framesCount && result; k++)
+	{
+		float currentTime = (k == bakedJointMatrices.framesCount - 1) ? stop : interval * static_cast<float>(k);
+
+		result = update(glTF, animationIndex, currentTime) && HelperUpdate::update(glTF, glm::mat4(1.0f));
+
+		const Node& node = glTF.nodes[nodeIndex];
+		if (result && node.jointMatrices.size() == bakedJointMatrices.jointsCount)
+		{
+			Matrix::toRows3x4(&bakedJointMatrices.rows[static_cast<size_t>(k) * bakedJointMatrices.jointsCount * 3], node.jointMatrices.data(), node.jointMatrices.size());
+		}
+		else
+		{
+			result = false;
+		}
+	}
+
+	for (size_t i = 0; i < animatedNodes.size(); i++)
+	{
+		Node& node = glTF.nodes[animatedNodes[i]];
+
+		node.translation = restNodes[i].translation;
+		node.rotation = restNodes[i].rotation;
+		node.scale = restNodes[i].scale;
+		node.weights = restNodes[i].weights;
+
+		HelperUpdate::setDirty(glTF, animatedNodes[i]);
+	}
+
+	return result;
+}
@@ -2,6 +2,7 @@
 #define GLTF_HELPERANIMATE_H_
 
 #include <cstdint>
+#include <vector>
 
 #include "../math/Math.h"
 
@@ -9,17 +10,78 @@
 
 struct GLTF;
 
+struct AnimationCompression {
+	// Maximum error of a removed key, rotation in radians.
+	float translationTolerance = 0.0001f;
+	float rotationTolerance = 0.0001f;
+	float scaleTolerance = 0.0001f;
+	float weightsTolerance = 0.0001f;
+};
+
+struct AnimationCompressionReport {
+	uint32_t animationIndex = 0;
+	uint32_t channelIndex = 0;
+	NodePath path = translation;
+
+	uint32_t keysCountBefore = 0;
+	uint32_t keysCountAfter = 0;
+
+	size_t byteSizeBefore = 0;
+	size_t byteSizeAfter = 0;
+
+	// Maximum error at the original keys, rotation in radians.
+	float maximumError = 0.0f;
+};
+
+// Joint matrices of a skinned node sampled over a whole animation. Every frame is one row of three texels per joint, holding the first three matrix rows.
+struct BakedJointMatrices {
+	uint32_t jointsCount = 0;
+	uint32_t framesCount = 0;
+
+	float duration = 0.0f;
+
+	std::vector<glm::vec4> rows;
+};
+
 class HelperAnimate {
 
 private:
 
 	static bool update(GLTF& glTF, const AnimationChannel& channel, int32_t startIndex, int32_t stopIndex, float currentTime);
 
+	static void interpolate(float* values, const AnimationSampler& sampler, uint32_t typeCount, bool rotation, int32_t startIndex, int32_t stopIndex, float currentTime);
+
+	static void decode(float* values, const AnimationSampler& sampler, uint32_t typeCount, bool rotation, int32_t index);
+
+	static float measure(const float* x, const float* y, uint32_t typeCount, bool rotation);
+
+	static void reduce(std::vector<uint32_t>& keys, const AnimationSampler& sampler, uint32_t typeCount, bool rotation, float tolerance);
+
+	static void quantize(AnimationSampler& sampler, const std::vector<uint32_t>& keys, uint32_t typeCount, bool rotation);
+
+	static bool findKeys(int32_t& startIndex, int32_t& stopIndex, int32_t& cursor, const AnimationSampler& sampler, float currentTime);
+
 public:
 
+	// Marks the sampler as uniform, if the key times are evenly spaced.
+	static void checkUniform(AnimationSampler& sampler);
+
 	static bool gatherStop(float& stop, const GLTF& glTF, uint32_t animationIndex);
 
-	static bool update(GLTF& glTF, uint32_t animationIndex, float currentTime);
+	// Only channels targeting a node set in the mask are evaluated, all with an empty mask.
+	static bool update(GLTF& glTF, uint32_t animationIndex, float currentTime, const std::vector<uint8_t>& nodeMask = std::vector<uint8_t>());
+
+	// Resamples all linear and cubic spline samplers with the given rate, so the keys can be found in constant time.
+	static bool resample(GLTF& glTF, float framesPerSecond);
+
+	// Removes keys, which can be interpolated within the tolerance, and quantizes the remaining ones. Cubic spline samplers are kept.
+	static bool compress(std::vector<AnimationCompressionReport>& reports, GLTF& glTF, const AnimationCompression& animationCompression = AnimationCompression());
+
+	// Blends from the stored to the current joint matrices, when the animation is evaluated at a reduced rate.
+	static void blendJointMatrices(std::vector<glm::mat4>& jointMatrices, const Node& node, float t);
+
+	// Samples the joint matrices of a skinned node with the given rate, e.g. to draw crowds without skinning on the host. The nodes keep their current transforms.
+	static bool bakeJointMatrices(BakedJointMatrices& bakedJointMatrices, GLTF& glTF, int32_t nodeIndex, uint32_t animationIndex, float framesPerSecond = 30.0f);
 
 };
 
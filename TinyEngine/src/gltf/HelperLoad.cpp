@@ -58,19 +58,19 @@ static std::string ExpandFilePath(const std::string &filepath, void *user_data)
 	return filepath;
 }
 
+// Files in a mounted archive are copied straight from the archive.
 static bool ReadWholeFile(std::vector<unsigned char> *out, std::string *err, const std::string &filepath, void *user_data)
 {
-	std::string output = "";
+	MappedFile file;
 
-	if (!FileIO::open(output, filepath))
+	if (!file.open(filepath))
 	{
 		return false;
 	}
 
 	if (out)
 	{
-		out->resize(output.size());
-		memcpy(out->data(), output.data(), output.size());
+		out->assign(file.getData(), file.getData() + file.getSize());
 	}
 
 	return true;
@@ -81,20 +81,134 @@ HelperLoad::HelperLoad() :
 {
 }
 
-bool HelperLoad::initBuffers(GLTF& glTF)
+bool HelperLoad::initGlb(const char*& json, size_t& jsonLength, const uint8_t*& binaryChunk, size_t& binaryChunkLength)
 {
-	glTF.buffers.resize(model.buffers.size());
+	const uint8_t* data = mappedFile->getData();
+	size_t size = mappedFile->getSize();
 
-	for (size_t i = 0; i < model.buffers.size(); i++)
+	// Header with magic, version and length, followed by the JSON chunk header.
+	if (size < 20)
 	{
-		Buffer& buffer = glTF.buffers[i];
+		return false;
+	}
+
+	uint32_t header[5];
+	memcpy(header, data, sizeof(header));
+
+	if (header[0] != 0x46546C67 || header[1] != 2 || header[2] > size || header[4] != 0x4E4F534A)
+	{
+		return false;
+	}
+
+	size_t length = header[2];
+
+	if (20 + static_cast<size_t>(header[3]) > length)
+	{
+		return false;
+	}
+
+	json = reinterpret_cast<const char*>(data + 20);
+	jsonLength = header[3];
+
+	// Optional binary chunk, chunks are 4 byte aligned.
+	size_t offset = 20 + ((jsonLength + 3) & ~static_cast<size_t>(3));
+	if (offset + 8 <= length)
+	{
+		uint32_t chunkHeader[2];
+		memcpy(chunkHeader, data + offset, sizeof(chunkHeader));
+
+		if (chunkHeader[1] == 0x004E4942 && offset + 8 + chunkHeader[0] <= length)
+		{
+			binaryChunk = data + offset + 8;
+			binaryChunkLength = chunkHeader[0];
+		}
+	}
+
+	return true;
+}
+
+bool HelperLoad::initBuffers(GLTF& glTF, nlohmann::json& document, const uint8_t* binaryChunk, size_t binaryChunkLength, const std::string& path)
+{
+	auto buffers = document.find("buffers");
+	if (buffers != document.end() && buffers->is_array())
+	{
+		glTF.buffers.resize(buffers->size());
+
+		for (size_t i = 0; i < buffers->size(); i++)
+		{
+			const nlohmann::json& source = (*buffers)[i];
+
+			Buffer& buffer = glTF.buffers[i];
+
+			if (source.contains("uri") && source["uri"].is_string())
+			{
+				buffer.uri = source["uri"].get<std::string>();
+			}
+
+			if (!source.contains("byteLength") || !source["byteLength"].is_number_unsigned())
+			{
+				return false;
+			}
+			buffer.byteLength = source["byteLength"].get<uint32_t>();
 
-		buffer.uri = model.buffers[i].uri;
+			if (buffer.uri.empty())
+			{
+				// Only the first buffer of a GLB may refer to the binary chunk.
+				if (i != 0 || binaryChunk == nullptr || buffer.byteLength > binaryChunkLength)
+				{
+					Logger::print(TinyEngine_ERROR, __FILE__, __LINE__, "Buffer %u has no binary data", static_cast<uint32_t>(i));
 
-		buffer.byteLength = static_cast<uint32_t>(model.buffers[i].data.size());
+					return false;
+				}
 
-		buffer.binary.resize(buffer.byteLength);
-		memcpy(buffer.binary.data(), model.buffers[i].data.data(), buffer.byteLength);
+				buffer.mappedFile = mappedFile;
+				buffer.mapped = binaryChunk;
+			}
+			else if (tinygltf::IsDataURI(buffer.uri))
+			{
+				std::string mimeType = "";
+				if (!tinygltf::DecodeDataURI(&buffer.binary, mimeType, buffer.uri, buffer.byteLength, true))
+				{
+					return false;
+				}
+			}
+			else
+			{
+				buffer.mappedFile = std::make_shared<MappedFile>();
+				if (!buffer.mappedFile->open(path + buffer.uri) || buffer.byteLength > buffer.mappedFile->getSize())
+				{
+					Logger::print(TinyEngine_ERROR, __FILE__, __LINE__, "Could not map buffer '%s'", buffer.uri.c_str());
+
+					return false;
+				}
+
+				buffer.mapped = buffer.mappedFile->getData();
+			}
+		}
+
+		// Not loaded again by tinygltf.
+		document.erase("buffers");
+	}
+
+	// Images in buffer views are decoded from the mapping as well, so tinygltf only keeps an empty uri.
+	auto images = document.find("images");
+	if (images != document.end() && images->is_array())
+	{
+		imageBufferViews.resize(images->size(), -1);
+
+		for (size_t i = 0; i < images->size(); i++)
+		{
+			nlohmann::json& image = (*images)[i];
+
+			if (image.contains("bufferView") && image["bufferView"].is_number_integer())
+			{
+				imageBufferViews[i] = image["bufferView"].get<int32_t>();
+
+				image.erase("bufferView");
+				image.erase("mimeType");
+				image["uri"] = "";
+			}
+		}
 	}
 
 	return true;
@@ -109,7 +223,7 @@ bool HelperLoad::initBufferViews(GLTF& glTF)
 		BufferView& bufferView = glTF.bufferViews[i];
 
 		bufferView.buffer = model.bufferViews[i].buffer;
-		if (bufferView.buffer >= 0)
+		if (bufferView.buffer >= 0 && bufferView.buffer < static_cast<int32_t>(glTF.buffers.size()))
 		{
 			bufferView.pBuffer = &glTF.buffers[bufferView.buffer];
 		}
@@ -122,6 +236,12 @@ bool HelperLoad::initBufferViews(GLTF& glTF)
 		bufferView.byteLength = static_cast<uint32_t>(model.bufferViews[i].byteLength);
 		bufferView.byteStride = static_cast<uint32_t>(model.bufferViews[i].byteStride);
 
+		// Mapped buffers must not be read past their end.
+		if (static_cast<uint64_t>(bufferView.byteOffset) + bufferView.byteLength > bufferView.pBuffer->byteLength)
+		{
+			return false;
+		}
+
 		bufferView.target = model.bufferViews[i].target;
 	}
 
@@ -332,7 +452,21 @@ bool HelperLoad::initImages(GLTF& glTF, const std::string& path)
 
 		image.uri = model.images[i].uri;
 
-		if (model.images[i].image.size() > 0)
+		if (i < imageBufferViews.size() && imageBufferViews[i] >= 0)
+		{
+			if (imageBufferViews[i] >= static_cast<int32_t>(glTF.bufferViews.size()))
+			{
+				return false;
+			}
+
+			const BufferView& bufferView = glTF.bufferViews[imageBufferViews[i]];
+
+			if (!ImageDataIO::open(image.imageDataResources, HelperAccess::accessData(bufferView), bufferView.byteLength))
+			{
+				return false;
+			}
+		}
+		else if (model.images[i].image.size() > 0)
 		{
 			image.imageDataResources.faceCount = 1;
 			image.imageDataResources.mipLevels = 1;
@@ -638,12 +772,10 @@ bool HelperLoad::initMeshes(GLTF& glTF)
 					{
 						primitive.targets[m].position = static_cast<int32_t>(postionIt->second);
 
-						if (m == 0)
+						if (primitive.position < 0 || !checkTargetData(glTF.accessors[primitive.targets[m].position], glTF.accessors[primitive.position].count))
 						{
-							primitive.targetPositionData.resize(glTF.accessors[primitive.position].count * primitive.targets.size());
+							return false;
 						}
-
-						memcpy(&primitive.targetPositionData.data()[m * glTF.accessors[primitive.position].count], HelperAccess::accessData(glTF.accessors[primitive.targets[m].position]), sizeof(glm::vec3) * glTF.accessors[primitive.position].count);
 					}
 
 					const auto normalIt = currentTarget.find("NORMAL");
@@ -651,12 +783,10 @@ bool HelperLoad::initMeshes(GLTF& glTF)
 					{
 						primitive.targets[m].normal = static_cast<int32_t>(normalIt->second);
 
-						if (m == 0)
+						if (primitive.normal < 0 || !checkTargetData(glTF.accessors[primitive.targets[m].normal], glTF.accessors[primitive.normal].count))
 						{
-							primitive.targetNormalData.resize(glTF.accessors[primitive.normal].count * primitive.targets.size());
+							return false;
 						}
-
-						memcpy(&primitive.targetNormalData.data()[m * glTF.accessors[primitive.normal].count], HelperAccess::accessData(glTF.accessors[primitive.targets[m].normal]), sizeof(glm::vec3) * glTF.accessors[primitive.normal].count);
 					}
 
 					const auto tangentIt = currentTarget.find("TANGENT");
@@ -664,12 +794,10 @@ bool HelperLoad::initMeshes(GLTF& glTF)
 					{
 						primitive.targets[m].tangent = static_cast<int32_t>(tangentIt->second);
 
-						if (m == 0)
+						if (primitive.tangent < 0 || !checkTargetData(glTF.accessors[primitive.targets[m].tangent], glTF.accessors[primitive.tangent].count))
 						{
-							primitive.targetTangentData.resize(glTF.accessors[primitive.tangent].count * primitive.targets.size());
+							return false;
 						}
-
-						memcpy(&primitive.targetTangentData.data()[m * glTF.accessors[primitive.tangent].count], HelperAccess::accessData(glTF.accessors[primitive.targets[m].tangent]), sizeof(glm::vec3) * glTF.accessors[primitive.tangent].count);
 					}
 				}
 			}
@@ -859,6 +987,8 @@ bool HelperLoad::initAnimations(GLTF& glTF)
 
 				sampler.inputTime.resize(size);
 				memcpy(sampler.inputTime.data(), HelperAccess::accessData(glTF.accessors[sampler.input]), byteSize);
+
+				HelperAnimate::checkUniform(sampler);
 			}
 			else
 			{
@@ -988,16 +1118,57 @@ bool HelperLoad::initScenes(GLTF& glTF)
 	return true;
 }
 
+bool HelperLoad::checkTargetData(const Accessor& accessor, uint32_t count)
+{
+	// KHR_mesh_quantization allows integer target data, which is converted when the deltas are gathered.
+	return accessor.count == count && accessor.typeCount == 3;
+}
+
 bool HelperLoad::open(GLTF& glTF, const std::string& filename)
 {
-	std::string output = "";
-	if (!FileIO::open(output, filename))
+	mappedFile = std::make_shared<MappedFile>();
+	if (!mappedFile->open(filename))
 	{
 		return false;
 	}
 
 	std::string path = HelperFile::getPath(filename);
 
+	const char* json = reinterpret_cast<const char*>(mappedFile->getData());
+	size_t jsonLength = mappedFile->getSize();
+
+	const uint8_t* binaryChunk = nullptr;
+	size_t binaryChunkLength = 0;
+
+	if (HelperFile::getExtension(filename) == "glb")
+	{
+		if (!initGlb(json, jsonLength, binaryChunk, binaryChunkLength))
+		{
+			Logger::print(TinyEngine_ERROR, __FILE__, __LINE__, "Invalid GLB '%s'", filename.c_str());
+
+			return false;
+		}
+	}
+	else if (HelperFile::getExtension(filename) != "gltf")
+	{
+		return false;
+	}
+
+	// Buffers are taken out of the JSON, so tinygltf does not copy them.
+
+	nlohmann::json document = nlohmann::json::parse(json, json + jsonLength, nullptr, false);
+	if (document.is_discarded() || !document.is_object())
+	{
+		return false;
+	}
+
+	if (!initBuffers(glTF, document, binaryChunk, binaryChunkLength, path))
+	{
+		return false;
+	}
+
+	std::string output = document.dump();
+
 	// Load glTF
 
 	std::string err = "";
@@ -1012,25 +1183,25 @@ bool HelperLoad::open(GLTF& glTF, const std::string& filename)
 	tinyGLTF.SetImageLoader(::LoadImageData, nullptr);
 	tinyGLTF.SetFsCallbacks(tinygltfCallbacks);
 
-	bool status = false;
-	if (HelperFile::getExtension(filename) == "gltf")
+	if (!tinyGLTF.LoadASCIIFromString(&model, &err, &warn, output.c_str(), static_cast<uint32_t>(output.length()), path))
 	{
-		status = tinyGLTF.LoadASCIIFromString(&model, &err, &warn, output.c_str(), static_cast<uint32_t>(output.length()), path);
-	}
-	else if (HelperFile::getExtension(filename) == "glb")
-	{
-		status = tinyGLTF.LoadBinaryFromMemory(&model, &err, &warn, (const unsigned char*)output.c_str(), static_cast<uint32_t>(output.length()), path);
+		return false;
 	}
 
-	if (!status)
+	for (const std::string& extension : model.extensionsUsed)
 	{
-		return false;
+		if (extension != "KHR_mesh_quantization")
+		{
+			Logger::print(TinyEngine_ERROR, __FILE__, __LINE__, "glTF extension '%s' not supported.", extension.c_str());
+
+			return false;
+		}
 	}
 
-	if (model.extensionsUsed.size() > 0)
-	{
-		Logger::print(TinyEngine_ERROR, __FILE__, __LINE__, "No glTF extensions supported.");
+	// BufferViews
 
+	if (!initBufferViews(glTF))
+	{
 		return false;
 	}
 
@@ -1062,20 +1233,6 @@ bool HelperLoad::open(GLTF& glTF, const std::string& filename)
 		return false;
 	}
 
-	// Buffers
-
-	if (!initBuffers(glTF))
-	{
-		return false;
-	}
-
-	// BufferViews
-
-	if (!initBufferViews(glTF))
-	{
-		return false;
-	}
-
 	// Accessors
 
 	if (!initAccessors(glTF))
@@ -1,7 +1,9 @@
 #ifndef GLTF_HELPERLOAD_H_
 #define GLTF_HELPERLOAD_H_
 
+#include <memory>
 #include <string>
+#include <vector>
 
 #define TINYGLTF_NO_EXTERNAL_IMAGE
 #define TINYGLTF_NO_STB_IMAGE
@@ -22,7 +24,13 @@ private:
 
 	tinygltf::Model model;
 
-	bool initBuffers(GLTF& glTF);
+	// Buffers point into the mapping of the GLB or the binary files, instead of being copied.
+	std::shared_ptr<MappedFile> mappedFile;
+	std::vector<int32_t> imageBufferViews;
+
+	bool initGlb(const char*& json, size_t& jsonLength, const uint8_t*& binaryChunk, size_t& binaryChunkLength);
+
+	bool initBuffers(GLTF& glTF, nlohmann::json& document, const uint8_t* binaryChunk, size_t binaryChunkLength, const std::string& path);
 
 	bool initBufferViews(GLTF& glTF);
 
@@ -46,6 +54,8 @@ private:
 
 	bool initScenes(GLTF& glTF);
 
+	bool checkTargetData(const Accessor& accessor, uint32_t count);
+
 public:
 
 	HelperLoad();
@@ -0,0 +1,2445 @@
+#include "HelperParse.h"
+
+#include <algorithm>
+#include <cinttypes>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+#include "HelperAccess.h"
+
+// Key value entry of cached images, which holds the hash of the source.
+static const char* IMAGE_CACHE_KEY = "TinyEngineSource";
+
+static bool isValid(int32_t index, size_t size)
+{
+	return index >= 0 && static_cast<size_t>(index) < size;
+}
+
+static bool isDataUri(const std::string& uri)
+{
+	return uri.compare(0, 5, "data:") == 0;
+}
+
+static int32_t decodeBase64(char c)
+{
+	if (c >= 'A' && c <= 'Z')
+	{
+		return c - 'A';
+	}
+	else if (c >= 'a' && c <= 'z')
+	{
+		return c - 'a' + 26;
+	}
+	else if (c >= '0' && c <= '9')
+	{
+		return c - '0' + 52;
+	}
+	else if (c == '+')
+	{
+		return 62;
+	}
+	else if (c == '/')
+	{
+		return 63;
+	}
+
+	return -1;
+}
+
+// Only base64 encoded data URIs are allowed by glTF.
+static bool decodeDataUri(std::vector<uint8_t>& output, const std::string& uri)
+{
+	size_t comma = uri.find(',');
+	if (!isDataUri(uri) || comma == std::string::npos || comma < 12 || uri.compare(comma - 7, 7, ";base64") != 0)
+	{
+		return false;
+	}
+
+	output.clear();
+	output.reserve((uri.size() - comma - 1) / 4 * 3);
+
+	uint32_t bits = 0;
+	uint32_t bitsCount = 0;
+	for (size_t i = comma + 1; i < uri.size() && uri[i] != '='; i++)
+	{
+		int32_t value = decodeBase64(uri[i]);
+		if (value < 0)
+		{
+			return false;
+		}
+
+		bits = (bits << 6) | static_cast<uint32_t>(value);
+		bitsCount += 6;
+
+		if (bitsCount >= 8)
+		{
+			bitsCount -= 8;
+			output.push_back(static_cast<uint8_t>(bits >> bitsCount));
+		}
+	}
+
+	return true;
+}
+
+static bool readIndices(std::vector<int32_t>& output, JsonReader& reader)
+{
+	output.clear();
+
+	if (!reader.beginArray())
+	{
+		return false;
+	}
+
+	while (reader.nextElement())
+	{
+		int32_t value = -1;
+		if (!reader.readInt32(value))
+		{
+			return false;
+		}
+		output.push_back(value);
+	}
+
+	return !reader.hasFailed();
+}
+
+static bool readFloats(std::vector<float>& output, JsonReader& reader)
+{
+	output.clear();
+
+	if (!reader.beginArray())
+	{
+		return false;
+	}
+
+	while (reader.nextElement())
+	{
+		float value = 0.0f;
+		if (!reader.readFloat(value))
+		{
+			return false;
+		}
+		output.push_back(value);
+	}
+
+	return !reader.hasFailed();
+}
+
+// Exactly count values are expected.
+static bool readFloats(float* output, uint32_t count, JsonReader& reader)
+{
+	if (!reader.beginArray())
+	{
+		return false;
+	}
+
+	uint32_t index = 0;
+	while (reader.nextElement())
+	{
+		if (index == count || !reader.readFloat(output[index]))
+		{
+			return false;
+		}
+		index++;
+	}
+
+	return !reader.hasFailed() && index == count;
+}
+
+HelperParse::HelperParse()
+{
+}
+
+bool HelperParse::initGlb(const char*& json, size_t& jsonLength, const uint8_t*& binaryChunk, size_t& binaryChunkLength)
+{
+	const uint8_t* data = mappedFile->getData();
+	size_t size = mappedFile->getSize();
+
+	// Header with magic, version and length, followed by the JSON chunk header.
+	if (size < 20)
+	{
+		return false;
+	}
+
+	uint32_t header[5];
+	memcpy(header, data, sizeof(header));
+
+	if (header[0] != 0x46546C67 || header[1] != 2 || header[2] > size || header[4] != 0x4E4F534A)
+	{
+		return false;
+	}
+
+	size_t length = header[2];
+
+	if (20 + static_cast<size_t>(header[3]) > length)
+	{
+		return false;
+	}
+
+	json = reinterpret_cast<const char*>(data + 20);
+	jsonLength = header[3];
+
+	// Optional binary chunk, chunks are 4 byte aligned.
+	size_t offset = 20 + ((jsonLength + 3) & ~static_cast<size_t>(3));
+	if (offset + 8 <= length)
+	{
+		uint32_t chunkHeader[2];
+		memcpy(chunkHeader, data + offset, sizeof(chunkHeader));
+
+		if (chunkHeader[1] == 0x004E4942 && offset + 8 + chunkHeader[0] <= length)
+		{
+			binaryChunk = data + offset + 8;
+			binaryChunkLength = chunkHeader[0];
+		}
+	}
+
+	return true;
+}
+
+bool HelperParse::parseDocument(GLTF& glTF, JsonReader& reader)
+{
+	std::string key = "";
+
+	if (!reader.beginObject())
+	{
+		return false;
+	}
+
+	// Top level properties may come in any order.
+	while (reader.nextMember(key))
+	{
+		bool result = true;
+
+		if (key == "asset")
+		{
+			result = parseAsset(reader);
+		}
+		else if (key == "buffers")
+		{
+			result = parseBuffers(glTF, reader);
+		}
+		else if (key == "bufferViews")
+		{
+			result = parseBufferViews(glTF, reader);
+		}
+		else if (key == "accessors")
+		{
+			result = parseAccessors(glTF, reader);
+		}
+		else if (key == "images")
+		{
+			result = parseImages(glTF, reader);
+		}
+		else if (key == "samplers")
+		{
+			result = parseSamplers(glTF, reader);
+		}
+		else if (key == "textures")
+		{
+			result = parseTextures(glTF, reader);
+		}
+		else if (key == "materials")
+		{
+			result = parseMaterials(glTF, reader);
+		}
+		else if (key == "meshes")
+		{
+			result = parseMeshes(glTF, reader);
+		}
+		else if (key == "skins")
+		{
+			result = parseSkins(glTF, reader);
+		}
+		else if (key == "nodes")
+		{
+			result = parseNodes(glTF, reader);
+		}
+		else if (key == "animations")
+		{
+			result = parseAnimations(glTF, reader);
+		}
+		else if (key == "scenes")
+		{
+			result = parseScenes(glTF, reader);
+		}
+		else if (key == "scene")
+		{
+			result = reader.readInt32(defaultScene);
+		}
+		else if (key == "extensionsUsed")
+		{
+			result = reader.beginArray();
+			while (result && reader.nextElement())
+			{
+				extensionsUsed.emplace_back();
+				result = reader.readString(extensionsUsed.back());
+			}
+		}
+		else
+		{
+			result = reader.skipValue();
+		}
+
+		if (!result)
+		{
+			return false;
+		}
+	}
+
+	return reader.finish();
+}
+
+bool HelperParse::parseAsset(JsonReader& reader)
+{
+	std::string key = "";
+
+	if (!reader.beginObject())
+	{
+		return false;
+	}
+
+	while (reader.nextMember(key))
+	{
+		if (key == "version")
+		{
+			std::string version = "";
+			if (!reader.readString(version))
+			{
+				return false;
+			}
+
+			hasVersion = true;
+		}
+		else if (!reader.skipValue())
+		{
+			return false;
+		}
+	}
+
+	return !reader.hasFailed();
+}
+
+bool HelperParse::parseBuffers(GLTF& glTF, JsonReader& reader)
+{
+	std::string key = "";
+
+	if (!reader.beginArray())
+	{
+		return false;
+	}
+
+	while (reader.nextElement())
+	{
+		glTF.buffers.emplace_back();
+		Buffer& buffer = glTF.buffers.back();
+
+		bool hasByteLength = false;
+
+		if (!reader.beginObject())
+		{
+			return false;
+		}
+
+		while (reader.nextMember(key))
+		{
+			bool result = true;
+
+			if (key == "uri")
+			{
+				result = reader.readString(buffer.uri);
+			}
+			else if (key == "byteLength")
+			{
+				result = reader.readUint32(buffer.byteLength);
+				hasByteLength = true;
+			}
+			else
+			{
+				result = reader.skipValue();
+			}
+
+			if (!result)
+			{
+				return false;
+			}
+		}
+
+		if (reader.hasFailed() || !hasByteLength)
+		{
+			return false;
+		}
+	}
+
+	return !reader.hasFailed();
+}
+
+bool HelperParse::parseBufferViews(GLTF& glTF, JsonReader& reader)
+{
+	std::string key = "";
+
+	if (!reader.beginArray())
+	{
+		return false;
+	}
+
+	while (reader.nextElement())
+	{
+		glTF.bufferViews.emplace_back();
+		BufferView& bufferView = glTF.bufferViews.back();
+
+		// Zero, if not given in the JSON.
+		bufferView.byteStride = 0;
+		bufferView.target = 0;
+
+		bool hasByteLength = false;
+
+		if (!reader.beginObject())
+		{
+			return false;
+		}
+
+		while (reader.nextMember(key))
+		{
+			bool result = true;
+
+			if (key == "buffer")
+			{
+				result = reader.readInt32(bufferView.buffer);
+			}
+			else if (key == "byteOffset")
+			{
+				result = reader.readUint32(bufferView.byteOffset);
+			}
+			else if (key == "byteLength")
+			{
+				result = reader.readUint32(bufferView.byteLength);
+				hasByteLength = true;
+			}
+			else if (key == "byteStride")
+			{
+				result = reader.readUint32(bufferView.byteStride);
+			}
+			else if (key == "target")
+			{
+				result = reader.readInt32(bufferView.target);
+			}
+			else
+			{
+				result = reader.skipValue();
+			}
+
+			if (!result)
+			{
+				return false;
+			}
+		}
+
+		if (reader.hasFailed() || !hasByteLength)
+		{
+			return false;
+		}
+	}
+
+	return !reader.hasFailed();
+}
+
+bool HelperParse::parseAccessors(GLTF& glTF, JsonReader& reader)
+{
+	std::string key = "";
+	std::string type = "";
+
+	if (!reader.beginArray())
+	{
+		return false;
+	}
+
+	while (reader.nextElement())
+	{
+		glTF.accessors.emplace_back();
+		Accessor& accessor = glTF.accessors.back();
+
+		bool hasCount = false;
+
+		if (!reader.beginObject())
+		{
+			return false;
+		}
+
+		while (reader.nextMember(key))
+		{
+			bool result = true;
+
+			if (key == "bufferView")
+			{
+				result = reader.readInt32(accessor.bufferView);
+			}
+			else if (key == "byteOffset")
+			{
+				result = reader.readUint32(accessor.byteOffset);
+			}
+			else if (key == "normalized")
+			{
+				result = reader.readBool(accessor.normalized);
+			}
+			else if (key == "count")
+			{
+				result = reader.readUint32(accessor.count);
+				hasCount = true;
+			}
+			else if (key == "componentType")
+			{
+				result = reader.readInt32(accessor.componentType);
+			}
+			else if (key == "type")
+			{
+				result = reader.readString(type);
+
+				// Same values as in tinygltf.
+				if (type == "SCALAR")
+				{
+					accessor.type = 65;
+				}
+				else if (type == "VEC2")
+				{
+					accessor.type = 2;
+				}
+				else if (type == "VEC3")
+				{
+					accessor.type = 3;
+				}
+				else if (type == "VEC4")
+				{
+					accessor.type = 4;
+				}
+				else if (type == "MAT2")
+				{
+					accessor.type = 34;
+				}
+				else if (type == "MAT3")
+				{
+					accessor.type = 35;
+				}
+				else if (type == "MAT4")
+				{
+					accessor.type = 36;
+				}
+				else
+				{
+					result = false;
+				}
+			}
+			else if (key == "sparse")
+			{
+				result = parseAccessorSparse(accessor.sparse, reader);
+			}
+			else
+			{
+				result = reader.skipValue();
+			}
+
+			if (!result)
+			{
+				return false;
+			}
+		}
+
+		if (reader.hasFailed() || !hasCount || accessor.componentType < 0 || accessor.type < 0)
+		{
+			return false;
+		}
+	}
+
+	return !reader.hasFailed();
+}
+
+bool HelperParse::parseAccessorSparse(AccessorSparse& sparse, JsonReader& reader)
+{
+	std::string key = "";
+	std::string innerKey = "";
+
+	// Sparse accessors are told apart by a count of at least one.
+	bool hasCount = false;
+
+	if (!reader.beginObject())
+	{
+		return false;
+	}
+
+	while (reader.nextMember(key))
+	{
+		bool result = true;
+
+		if (key == "count")
+		{
+			result = reader.readUint32(sparse.count);
+			hasCount = true;
+		}
+		else if (key == "indices")
+		{
+			result = reader.beginObject();
+			while (result && reader.nextMember(innerKey))
+			{
+				if (innerKey == "bufferView")
+				{
+					result = reader.readInt32(sparse.indices.bufferView);
+				}
+				else if (innerKey == "byteOffset")
+				{
+					result = reader.readUint32(sparse.indices.byteOffset);
+				}
+				else if (innerKey == "componentType")
+				{
+					result = reader.readInt32(sparse.indices.componentType);
+				}
+				else
+				{
+					result = reader.skipValue();
+				}
+			}
+		}
+		else if (key == "values")
+		{
+			result = reader.beginObject();
+			while (result && reader.nextMember(innerKey))
+			{
+				if (innerKey == "bufferView")
+				{
+					result = reader.readInt32(sparse.values.bufferView);
+				}
+				else if (innerKey == "byteOffset")
+				{
+					result = reader.readUint32(sparse.values.byteOffset);
+				}
+				else
+				{
+					result = reader.skipValue();
+				}
+			}
+		}
+		else
+		{
+			result = reader.skipValue();
+		}
+
+		if (!result || reader.hasFailed())
+		{
+			return false;
+		}
+	}
+
+	return !reader.hasFailed() && hasCount && sparse.count > 0;
+}
+
+bool HelperParse::parseImages(GLTF& glTF, JsonReader& reader)
+{
+	std::string key = "";
+
+	if (!reader.beginArray())
+	{
+		return false;
+	}
+
+	while (reader.nextElement())
+	{
+		glTF.images.emplace_back();
+		Image& image = glTF.images.back();
+
+		imageBufferViews.push_back(-1);
+
+		if (!reader.beginObject())
+		{
+			return false;
+		}
+
+		while (reader.nextMember(key))
+		{
+			bool result = true;
+
+			if (key == "uri")
+			{
+				result = reader.readString(image.uri);
+			}
+			else if (key == "bufferView")
+			{
+				result = reader.readInt32(imageBufferViews.back());
+			}
+			else
+			{
+				result = reader.skipValue();
+			}
+
+			if (!result)
+			{
+				return false;
+			}
+		}
+
+		// The data is taken from the buffer view.
+		if (imageBufferViews.back() >= 0)
+		{
+			image.uri = "";
+		}
+	}
+
+	return !reader.hasFailed();
+}
+
+bool HelperParse::parseSamplers(GLTF& glTF, JsonReader& reader)
+{
+	std::string key = "";
+
+	if (!reader.beginArray())
+	{
+		return false;
+	}
+
+	while (reader.nextElement())
+	{
+		glTF.samplers.emplace_back();
+		Sampler& sampler = glTF.samplers.back();
+
+		if (!reader.beginObject())
+		{
+			return false;
+		}
+
+		while (reader.nextMember(key))
+		{
+			int32_t value = -1;
+
+			if (key != "magFilter" && key != "minFilter" && key != "wrapS" && key != "wrapT")
+			{
+				if (!reader.skipValue())
+				{
+					return false;
+				}
+
+				continue;
+			}
+
+			if (!reader.readInt32(value))
+			{
+				return false;
+			}
+
+			if (key == "magFilter")
+			{
+				switch (value)
+				{
+					case 9728: //NEAREST
+						sampler.magFilter = VK_FILTER_NEAREST;
+						break;
+					case 9729: //LINEAR
+						sampler.magFilter = VK_FILTER_LINEAR;
+						break;
+				}
+			}
+			else if (key == "minFilter")
+			{
+				switch (value)
+				{
+					case 9728: //NEAREST
+						sampler.minFilter = VK_FILTER_NEAREST;
+						sampler.maxLod = 0.25f;	// see Mapping of OpenGL to Vulkan filter modes
+						break;
+					case 9729: //LINEAR
+						sampler.minFilter = VK_FILTER_LINEAR;
+						sampler.maxLod = 0.25f;
+						break;
+					case 9984: //NEAREST_MIPMAP_NEAREST
+						sampler.minFilter = VK_FILTER_NEAREST;
+						sampler.mipmapMode = VK_SAMPLER_MIPMAP_MODE_NEAREST;
+						break;
+					case 9985: //LINEAR_MIPMAP_NEAREST
+						sampler.minFilter = VK_FILTER_LINEAR;
+						sampler.mipmapMode = VK_SAMPLER_MIPMAP_MODE_NEAREST;
+						break;
+					case 9986: //NEAREST_MIPMAP_LINEAR
+						sampler.minFilter = VK_FILTER_NEAREST;
+						sampler.mipmapMode = VK_SAMPLER_MIPMAP_MODE_LINEAR;
+						break;
+					case 9987: //LINEAR_MIPMAP_LINEAR
+						sampler.minFilter = VK_FILTER_LINEAR;
+						sampler.mipmapMode = VK_SAMPLER_MIPMAP_MODE_LINEAR;
+						break;
+				}
+			}
+			else
+			{
+				VkSamplerAddressMode& addressMode = (key == "wrapS") ? sampler.addressModeU : sampler.addressModeV;
+
+				switch (value)
+				{
+					case 33071:	//CLAMP_TO_EDGE
+						addressMode = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+						break;
+					case 33648:	//MIRRORED_REPEAT
+						addressMode = VK_SAMPLER_ADDRESS_MODE_MIRRORED_REPEAT;
+						break;
+					case 10497:	//REPEAT
+						addressMode = VK_SAMPLER_ADDRESS_MODE_REPEAT;
+						break;
+				}
+			}
+		}
+	}
+
+	return !reader.hasFailed();
+}
+
+bool HelperParse::parseTextures(GLTF& glTF, JsonReader& reader)
+{
+	std::string key = "";
+
+	if (!reader.beginArray())
+	{
+		return false;
+	}
+
+	while (reader.nextElement())
+	{
+		glTF.textures.emplace_back();
+		Texture& texture = glTF.textures.back();
+
+		if (!reader.beginObject())
+		{
+			return false;
+		}
+
+		while (reader.nextMember(key))
+		{
+			bool result = true;
+
+			if (key == "source")
+			{
+				result = reader.readInt32(texture.source);
+			}
+			else if (key == "sampler")
+			{
+				result = reader.readInt32(texture.sampler);
+			}
+			else
+			{
+				result = reader.skipValue();
+			}
+
+			if (!result)
+			{
+				return false;
+			}
+		}
+	}
+
+	return !reader.hasFailed();
+}
+
+bool HelperParse::parseMaterials(GLTF& glTF, JsonReader& reader)
+{
+	std::string key = "";
+	std::string innerKey = "";
+	std::string alphaMode = "";
+
+	if (!reader.beginArray())
+	{
+		return false;
+	}
+
+	while (reader.nextElement())
+	{
+		glTF.materials.emplace_back();
+		Material& material = glTF.materials.back();
+
+		if (!reader.beginObject())
+		{
+			return false;
+		}
+
+		while (reader.nextMember(key))
+		{
+			bool result = true;
+
+			if (key == "pbrMetallicRoughness")
+			{
+				// Metallic Roughness
+				result = reader.beginObject();
+				while (result && reader.nextMember(innerKey))
+				{
+					if (innerKey == "baseColorFactor")
+					{
+						result = readFloats(&material.pbrMetallicRoughness.baseColorFactor[0], 4, reader);
+					}
+					else if (innerKey == "baseColorTexture")
+					{
+						result = parseTextureInfo(material.pbrMetallicRoughness.baseColorTexture, nullptr, reader);
+					}
+					else if (innerKey == "metallicFactor")
+					{
+						result = reader.readFloat(material.pbrMetallicRoughness.metallicFactor);
+					}
+					else if (innerKey == "roughnessFactor")
+					{
+						result = reader.readFloat(material.pbrMetallicRoughness.roughnessFactor);
+					}
+					else if (innerKey == "metallicRoughnessTexture")
+					{
+						result = parseTextureInfo(material.pbrMetallicRoughness.metallicRoughnessTexture, nullptr, reader);
+					}
+					else
+					{
+						result = reader.skipValue();
+					}
+				}
+			}
+			// Base Material
+			else if (key == "normalTexture")
+			{
+				result = parseTextureInfo(material.normalTexture, &material.normalTexture.scale, reader);
+			}
+			else if (key == "occlusionTexture")
+			{
+				result = parseTextureInfo(material.occlusionTexture, &material.occlusionTexture.strength, reader);
+			}
+			else if (key == "emissiveTexture")
+			{
+				result = parseTextureInfo(material.emissiveTexture, nullptr, reader);
+			}
+			else if (key == "emissiveFactor")
+			{
+				result = readFloats(&material.emissiveFactor[0], 3, reader);
+			}
+			else if (key == "alphaMode")
+			{
+				result = reader.readString(alphaMode);
+
+				if (alphaMode == "OPAQUE")
+				{
+					material.alphaMode = 0;
+				}
+				else if (alphaMode == "MASK")
+				{
+					material.alphaMode = 1;
+				}
+				else if (alphaMode == "BLEND")
+				{
+					material.alphaMode = 2;
+				}
+			}
+			else if (key == "alphaCutoff")
+			{
+				result = reader.readFloat(material.alphaCutoff);
+			}
+			else if (key == "doubleSided")
+			{
+				result = reader.readBool(material.doubleSided);
+			}
+			else
+			{
+				result = reader.skipValue();
+			}
+
+			if (!result || reader.hasFailed())
+			{
+				return false;
+			}
+		}
+	}
+
+	return !reader.hasFailed();
+}
+
+bool HelperParse::parseTextureInfo(TextureInfo& textureInfo, float* scaleOrStrength, JsonReader& reader)
+{
+	std::string key = "";
+
+	if (!reader.beginObject())
+	{
+		return false;
+	}
+
+	while (reader.nextMember(key))
+	{
+		bool result = true;
+
+		if (key == "index")
+		{
+			result = reader.readInt32(textureInfo.index);
+		}
+		else if (key == "texCoord")
+		{
+			result = reader.readUint32(textureInfo.texCoord);
+		}
+		else if (scaleOrStrength && (key == "scale" || key == "strength"))
+		{
+			result = reader.readFloat(*scaleOrStrength);
+		}
+		else
+		{
+			result = reader.skipValue();
+		}
+
+		if (!result)
+		{
+			return false;
+		}
+	}
+
+	return !reader.hasFailed();
+}
+
+bool HelperParse::parseMeshes(GLTF& glTF, JsonReader& reader)
+{
+	std::string key = "";
+
+	if (!reader.beginArray())
+	{
+		return false;
+	}
+
+	while (reader.nextElement())
+	{
+		glTF.meshes.emplace_back();
+		Mesh& mesh = glTF.meshes.back();
+
+		meshWeights.emplace_back();
+
+		if (!reader.beginObject())
+		{
+			return false;
+		}
+
+		while (reader.nextMember(key))
+		{
+			bool result = true;
+
+			if (key == "primitives")
+			{
+				result = reader.beginArray();
+				while (result && reader.nextElement())
+				{
+					mesh.primitives.emplace_back();
+					result = parsePrimitive(mesh.primitives.back(), reader);
+				}
+			}
+			else if (key == "weights")
+			{
+				result = readFloats(meshWeights.back(), reader);
+			}
+			else
+			{
+				result = reader.skipValue();
+			}
+
+			if (!result || reader.hasFailed())
+			{
+				return false;
+			}
+		}
+	}
+
+	return !reader.hasFailed();
+}
+
+bool HelperParse::parsePrimitive(Primitive& primitive, JsonReader& reader)
+{
+	std::string key = "";
+	std::string attribute = "";
+
+	if (!reader.beginObject())
+	{
+		return false;
+	}
+
+	while (reader.nextMember(key))
+	{
+		bool result = true;
+
+		if (key == "attributes")
+		{
+			result = reader.beginObject();
+			while (result && reader.nextMember(attribute))
+			{
+				int32_t accessorIndex = -1;
+				if (!reader.readInt32(accessorIndex))
+				{
+					return false;
+				}
+
+				primitive.attributesCount++;
+
+				if (attribute == "POSITION")
+				{
+					primitive.position = accessorIndex;
+				}
+				else if (attribute == "NORMAL")
+				{
+					primitive.normal = accessorIndex;
+				}
+				else if (attribute == "TANGENT")
+				{
+					primitive.tangent = accessorIndex;
+				}
+				else if (attribute == "TEXCOORD_0")
+				{
+					primitive.texCoord0 = accessorIndex;
+				}
+				else if (attribute == "TEXCOORD_1")
+				{
+					primitive.texCoord1 = accessorIndex;
+				}
+				else if (attribute == "COLOR_0")
+				{
+					primitive.color0 = accessorIndex;
+				}
+				else if (attribute == "JOINTS_0")
+				{
+					primitive.joints0 = accessorIndex;
+				}
+				else if (attribute == "JOINTS_1")
+				{
+					primitive.joints1 = accessorIndex;
+				}
+				else if (attribute == "WEIGHTS_0")
+				{
+					primitive.weights0 = accessorIndex;
+				}
+				else if (attribute == "WEIGHTS_1")
+				{
+					primitive.weights1 = accessorIndex;
+				}
+				else
+				{
+					Logger::print(TinyEngine_ERROR, __FILE__, __LINE__, "Attribute '%s' not supported.", attribute.c_str());
+
+					return false;
+				}
+			}
+		}
+		else if (key == "indices")
+		{
+			result = reader.readInt32(primitive.indices);
+		}
+		else if (key == "material")
+		{
+			result = reader.readInt32(primitive.material);
+		}
+		else if (key == "mode")
+		{
+			result = reader.readUint32(primitive.mode);
+		}
+		else if (key == "targets")
+		{
+			result = reader.beginArray();
+			while (result && reader.nextElement())
+			{
+				primitive.targets.emplace_back();
+				Target& target = primitive.targets.back();
+
+				result = reader.beginObject();
+				while (result && reader.nextMember(attribute))
+				{
+					if (attribute == "POSITION")
+					{
+						result = reader.readInt32(target.position);
+					}
+					else if (attribute == "NORMAL")
+					{
+						result = reader.readInt32(target.normal);
+					}
+					else if (attribute == "TANGENT")
+					{
+						result = reader.readInt32(target.tangent);
+					}
+					else
+					{
+						result = reader.skipValue();
+					}
+				}
+			}
+		}
+		else
+		{
+			result = reader.skipValue();
+		}
+
+		if (!result || reader.hasFailed())
+		{
+			return false;
+		}
+	}
+
+	return !reader.hasFailed() && primitive.position >= 0;
+}
+
+bool HelperParse::parseSkins(GLTF& glTF, JsonReader& reader)
+{
+	std::string key = "";
+
+	if (!reader.beginArray())
+	{
+		return false;
+	}
+
+	while (reader.nextElement())
+	{
+		glTF.skins.emplace_back();
+		Skin& skin = glTF.skins.back();
+
+		skinInverseBindMatrices.push_back(-1);
+
+		if (!reader.beginObject())
+		{
+			return false;
+		}
+
+		while (reader.nextMember(key))
+		{
+			bool result = true;
+
+			if (key == "inverseBindMatrices")
+			{
+				result = reader.readInt32(skinInverseBindMatrices.back());
+			}
+			else if (key == "skeleton")
+			{
+				result = reader.readInt32(skin.skeleton);
+			}
+			else if (key == "joints")
+			{
+				result = readIndices(skin.joints, reader);
+			}
+			else
+			{
+				result = reader.skipValue();
+			}
+
+			if (!result)
+			{
+				return false;
+			}
+		}
+	}
+
+	return !reader.hasFailed();
+}
+
+bool HelperParse::parseNodes(GLTF& glTF, JsonReader& reader)
+{
+	std::string key = "";
+
+	if (!reader.beginArray())
+	{
+		return false;
+	}
+
+	while (reader.nextElement())
+	{
+		glTF.nodes.emplace_back();
+		Node& node = glTF.nodes.back();
+
+		nodeWeights.emplace_back();
+		nodeMatrices.push_back(false);
+
+		if (!reader.beginObject())
+		{
+			return false;
+		}
+
+		while (reader.nextMember(key))
+		{
+			bool result = true;
+
+			if (key == "translation")
+			{
+				result = readFloats(&node.translation[0], 3, reader);
+			}
+			else if (key == "rotation")
+			{
+				float rotation[4];
+				result = readFloats(rotation, 4, reader);
+
+				node.rotation = glm::quat(rotation[3], rotation[0], rotation[1], rotation[2]);
+			}
+			else if (key == "scale")
+			{
+				result = readFloats(&node.scale[0], 3, reader);
+			}
+			else if (key == "matrix")
+			{
+				// Decomposed, after all nodes are read.
+				result = readFloats(&node.matrix[0][0], 16, reader);
+
+				nodeMatrices.back() = true;
+			}
+			else if (key == "mesh")
+			{
+				result = reader.readInt32(node.mesh);
+			}
+			else if (key == "skin")
+			{
+				result = reader.readInt32(node.skin);
+			}
+			else if (key == "weights")
+			{
+				result = readFloats(nodeWeights.back(), reader);
+			}
+			else if (key == "children")
+			{
+				result = readIndices(node.children, reader);
+			}
+			else
+			{
+				result = reader.skipValue();
+			}
+
+			if (!result)
+			{
+				return false;
+			}
+		}
+	}
+
+	return !reader.hasFailed();
+}
+
+bool HelperParse::parseAnimations(GLTF& glTF, JsonReader& reader)
+{
+	std::string key = "";
+	std::string innerKey = "";
+	std::string targetKey = "";
+	std::string value = "";
+
+	if (!reader.beginArray())
+	{
+		return false;
+	}
+
+	while (reader.nextElement())
+	{
+		glTF.animations.emplace_back();
+		Animation& animation = glTF.animations.back();
+
+		if (!reader.beginObject())
+		{
+			return false;
+		}
+
+		while (reader.nextMember(key))
+		{
+			bool result = true;
+
+			if (key == "samplers")
+			{
+				result = reader.beginArray();
+				while (result && reader.nextElement())
+				{
+					animation.samplers.emplace_back();
+					AnimationSampler& sampler = animation.samplers.back();
+
+					result = reader.beginObject();
+					while (result && reader.nextMember(innerKey))
+					{
+						if (innerKey == "input")
+						{
+							result = reader.readInt32(sampler.input);
+						}
+						else if (innerKey == "output")
+						{
+							result = reader.readInt32(sampler.output);
+						}
+						else if (innerKey == "interpolation")
+						{
+							result = reader.readString(value);
+
+							if (value == "LINEAR")
+							{
+								sampler.interpolation = LINEAR;
+							}
+							else if (value == "STEP")
+							{
+								sampler.interpolation = STEP;
+							}
+							else if (value == "CUBICSPLINE")
+							{
+								sampler.interpolation = CUBICSPLINE;
+							}
+						}
+						else
+						{
+							result = reader.skipValue();
+						}
+					}
+				}
+			}
+			else if (key == "channels")
+			{
+				result = reader.beginArray();
+				while (result && reader.nextElement())
+				{
+					animation.channels.emplace_back();
+					AnimationChannel& channel = animation.channels.back();
+
+					result = reader.beginObject();
+					while (result && reader.nextMember(innerKey))
+					{
+						if (innerKey == "sampler")
+						{
+							result = reader.readInt32(channel.sampler);
+						}
+						else if (innerKey == "target")
+						{
+							result = reader.beginObject();
+							while (result && reader.nextMember(targetKey))
+							{
+								if (targetKey == "node")
+								{
+									result = reader.readInt32(channel.target.node);
+								}
+								else if (targetKey == "path")
+								{
+									result = reader.readString(value);
+
+									if (value == "translation")
+									{
+										channel.target.path = translation;
+									}
+									else if (value == "rotation")
+									{
+										channel.target.path = rotation;
+									}
+									else if (value == "scale")
+									{
+										channel.target.path = scale;
+									}
+									else if (value == "weights")
+									{
+										channel.target.path = weights;
+									}
+								}
+								else
+								{
+									result = reader.skipValue();
+								}
+							}
+						}
+						else
+						{
+							result = reader.skipValue();
+						}
+					}
+				}
+			}
+			else
+			{
+				result = reader.skipValue();
+			}
+
+			if (!result || reader.hasFailed())
+			{
+				return false;
+			}
+		}
+	}
+
+	return !reader.hasFailed();
+}
+
+bool HelperParse::parseScenes(GLTF& glTF, JsonReader& reader)
+{
+	std::string key = "";
+
+	if (!reader.beginArray())
+	{
+		return false;
+	}
+
+	while (reader.nextElement())
+	{
+		glTF.scenes.emplace_back();
+		Scene& scene = glTF.scenes.back();
+
+		if (!reader.beginObject())
+		{
+			return false;
+		}
+
+		while (reader.nextMember(key))
+		{
+			bool result = true;
+
+			if (key == "nodes")
+			{
+				result = readIndices(scene.nodes, reader);
+			}
+			else
+			{
+				result = reader.skipValue();
+			}
+
+			if (!result)
+			{
+				return false;
+			}
+		}
+	}
+
+	return !reader.hasFailed();
+}
+
+bool HelperParse::initBuffers(GLTF& glTF, const uint8_t* binaryChunk, size_t binaryChunkLength, const std::string& path)
+{
+	for (size_t i = 0; i < glTF.buffers.size(); i++)
+	{
+		Buffer& buffer = glTF.buffers[i];
+
+		if (buffer.uri.empty())
+		{
+			// Only the first buffer of a GLB may refer to the binary chunk.
+			if (i != 0 || binaryChunk == nullptr || buffer.byteLength > binaryChunkLength)
+			{
+				Logger::print(TinyEngine_ERROR, __FILE__, __LINE__, "Buffer %u has no binary data", static_cast<uint32_t>(i));
+
+				return false;
+			}
+
+			buffer.mappedFile = mappedFile;
+			buffer.mapped = binaryChunk;
+		}
+		else if (isDataUri(buffer.uri))
+		{
+			if (!decodeDataUri(buffer.binary, buffer.uri) || buffer.binary.size() != buffer.byteLength)
+			{
+				return false;
+			}
+		}
+		else
+		{
+			buffer.mappedFile = std::make_shared<MappedFile>();
+			if (!buffer.mappedFile->open(path + buffer.uri) || buffer.byteLength > buffer.mappedFile->getSize())
+			{
+				Logger::print(TinyEngine_ERROR, __FILE__, __LINE__, "Could not map buffer '%s'", buffer.uri.c_str());
+
+				return false;
+			}
+
+			buffer.mapped = buffer.mappedFile->getData();
+		}
+	}
+
+	return true;
+}
+
+bool HelperParse::initBufferViews(GLTF& glTF)
+{
+	for (size_t i = 0; i < glTF.bufferViews.size(); i++)
+	{
+		BufferView& bufferView = glTF.bufferViews[i];
+
+		if (!isValid(bufferView.buffer, glTF.buffers.size()))
+		{
+			return false;
+		}
+		bufferView.pBuffer = &glTF.buffers[bufferView.buffer];
+
+		// Mapped buffers must not be read past their end.
+		if (static_cast<uint64_t>(bufferView.byteOffset) + bufferView.byteLength > bufferView.pBuffer->byteLength)
+		{
+			return false;
+		}
+	}
+
+	// Targets follow the usage in the primitives, as with HelperLoad.
+	for (const Mesh& mesh : glTF.meshes)
+	{
+		for (const Primitive& primitive : mesh.primitives)
+		{
+			if (primitive.indices >= 0)
+			{
+				if (!isValid(primitive.indices, glTF.accessors.size()) || !isValid(glTF.accessors[primitive.indices].bufferView, glTF.bufferViews.size()))
+				{
+					return false;
+				}
+
+				glTF.bufferViews[glTF.accessors[primitive.indices].bufferView].target = 34963;
+			}
+
+			const int32_t attributes[] = {primitive.position, primitive.normal, primitive.tangent, primitive.texCoord0, primitive.texCoord1, primitive.color0, primitive.joints0, primitive.joints1, primitive.weights0, primitive.weights1};
+			for (int32_t attribute : attributes)
+			{
+				if (isValid(attribute, glTF.accessors.size()) && isValid(glTF.accessors[attribute].bufferView, glTF.bufferViews.size()))
+				{
+					glTF.bufferViews[glTF.accessors[attribute].bufferView].target = 34962;
+				}
+			}
+
+			for (const Target& target : primitive.targets)
+			{
+				const int32_t targetAttributes[] = {target.position, target.normal, target.tangent};
+				for (int32_t attribute : targetAttributes)
+				{
+					if (isValid(attribute, glTF.accessors.size()) && isValid(glTF.accessors[attribute].bufferView, glTF.bufferViews.size()))
+					{
+						glTF.bufferViews[glTF.accessors[attribute].bufferView].target = 34962;
+					}
+				}
+			}
+		}
+	}
+
+	return true;
+}
+
+bool HelperParse::initAccessors(GLTF& glTF)
+{
+	for (size_t i = 0; i < glTF.accessors.size(); i++)
+	{
+		Accessor& accessor = glTF.accessors[i];
+
+		bool isSparse = (accessor.sparse.count > 0);
+
+		if (accessor.bufferView >= 0)
+		{
+			if (!isValid(accessor.bufferView, glTF.bufferViews.size()))
+			{
+				return false;
+			}
+
+			accessor.pBufferView = &glTF.bufferViews[accessor.bufferView];
+		}
+		else
+		{
+			if (!isSparse)
+			{
+				return false;
+			}
+		}
+
+		switch (accessor.componentType)
+		{
+			case 5120: // BYTE
+				accessor.componentTypeSize = 1;
+				accessor.componentTypeSigned = true;
+				accessor.componentTypeInteger = true;
+			break;
+			case 5121: // UNSIGNED_BYTE
+				accessor.componentTypeSize = 1;
+				accessor.componentTypeSigned = false;
+				accessor.componentTypeInteger = true;
+			break;
+			case 5122: // SHORT
+				accessor.componentTypeSize = 2;
+				accessor.componentTypeSigned = true;
+				accessor.componentTypeInteger = true;
+			break;
+			case 5123: // UNSIGNED_SHORT
+				accessor.componentTypeSize = 2;
+				accessor.componentTypeSigned = false;
+				accessor.componentTypeInteger = true;
+			break;
+			case 5125: // UNSIGNED_INT
+				accessor.componentTypeSize = 4;
+				accessor.componentTypeSigned = false;
+				accessor.componentTypeInteger = true;
+			break;
+			case 5126: // FLOAT
+				accessor.componentTypeSize = 4;
+				accessor.componentTypeSigned = true;
+				accessor.componentTypeInteger = false;
+			break;
+			default:
+				return false;
+		}
+
+		switch (accessor.type)
+		{
+			case 65: // SCALAR
+				accessor.typeCount = 1;
+			break;
+			case 2: // VEC2
+				accessor.typeCount = 2;
+			break;
+			case 3: // VEC3
+				accessor.typeCount = 3;
+			break;
+			case 4: // VEC4
+				accessor.typeCount = 4;
+			break;
+			case 34: // MAT2
+				accessor.typeCount = 4;
+			break;
+			case 35: // MAT3
+				accessor.typeCount = 9;
+			break;
+			case 36: // MAT4
+				accessor.typeCount = 16;
+			break;
+		}
+
+		// Sparse
+
+		if (isSparse)
+		{
+			// Indices
+
+			if (!isValid(accessor.sparse.indices.bufferView, glTF.bufferViews.size()))
+			{
+				return false;
+			}
+			accessor.sparse.indices.pBufferView = &glTF.bufferViews[accessor.sparse.indices.bufferView];
+
+			switch (accessor.sparse.indices.componentType)
+			{
+				case 5121: // UNSIGNED_BYTE
+					accessor.sparse.indices.componentTypeSize = 1;
+					accessor.sparse.indices.componentTypeSigned = false;
+					accessor.sparse.indices.componentTypeInteger = true;
+				break;
+				case 5123: // UNSIGNED_SHORT
+					accessor.sparse.indices.componentTypeSize = 2;
+					accessor.sparse.indices.componentTypeSigned = false;
+					accessor.sparse.indices.componentTypeInteger = true;
+				break;
+				case 5125: // UNSIGNED_INT
+					accessor.sparse.indices.componentTypeSize = 4;
+					accessor.sparse.indices.componentTypeSigned = false;
+					accessor.sparse.indices.componentTypeInteger = true;
+				break;
+				default:
+					return false;
+			}
+
+			// Values
+
+			if (!isValid(accessor.sparse.values.bufferView, glTF.bufferViews.size()))
+			{
+				return false;
+			}
+			accessor.sparse.values.pBufferView = &glTF.bufferViews[accessor.sparse.values.bufferView];
+
+			// Initialize binary data.
+			accessor.sparse.buffer.byteLength = accessor.count * accessor.componentTypeSize * accessor.typeCount;
+			accessor.sparse.buffer.binary.resize(accessor.sparse.buffer.byteLength);
+
+			accessor.sparse.bufferView.byteOffset = 0;
+			accessor.sparse.bufferView.byteLength = accessor.sparse.buffer.byteLength;
+			accessor.sparse.bufferView.pBuffer = &accessor.sparse.buffer;
+
+			if (accessor.pBufferView)
+			{
+				memcpy(accessor.sparse.buffer.binary.data(), HelperAccess::accessData(*accessor.pBufferView) + accessor.byteOffset, accessor.sparse.buffer.byteLength);
+
+				//
+
+				accessor.sparse.bufferView.target = accessor.pBufferView->target;
+				accessor.sparse.bufferView.byteStride = accessor.pBufferView->byteStride;
+			}
+
+			const uint8_t* indices = HelperAccess::accessData(*accessor.sparse.indices.pBufferView) + accessor.sparse.indices.byteOffset;
+			const uint8_t* values = HelperAccess::accessData(*accessor.sparse.values.pBufferView) + accessor.sparse.values.byteOffset;
+			for (uint32_t k = 0; k < accessor.sparse.count; k++)
+			{
+				uint32_t index = 0;
+
+				switch (accessor.sparse.indices.componentTypeSize)
+				{
+					case 1:
+						index = static_cast<uint32_t>(indices[k]);
+						break;
+					case 2:
+						index = static_cast<uint32_t>(*reinterpret_cast<const uint16_t*>(&indices[k * 2]));
+						break;
+					case 4:
+						index = *reinterpret_cast<const uint32_t*>(&indices[k * 4]);
+						break;
+				}
+
+				if (index >= accessor.count)
+				{
+					return false;
+				}
+
+				//
+
+				uint32_t offsetBinary = index * accessor.componentTypeSize * accessor.typeCount;
+				uint32_t offsetValues = k * accessor.componentTypeSize * accessor.typeCount;
+
+				memcpy(&accessor.sparse.buffer.binary.data()[offsetBinary], &values[offsetValues], accessor.componentTypeSize * accessor.typeCount);
+			}
+		}
+	}
+
+	return true;
+}
+
+void HelperParse::submitImages(const GLTF& glTF, AsyncIO& asyncIO)
+{
+	imageRequests.assign(glTF.images.size(), 0);
+	imageData.assign(glTF.images.size(), "");
+	imageHashes.assign(glTF.images.size(), 0);
+	imageEncodes.assign(glTF.images.size(), 0);
+
+	initImageFormats(glTF);
+
+	for (size_t i = 0; i < glTF.images.size(); i++)
+	{
+		const Image& image = glTF.images[i];
+
+		if (imageBufferViews[i] < 0 && !isDataUri(image.uri))
+		{
+			imageRequests[i] = asyncIO.submit(path + image.uri, imageData[i]);
+		}
+	}
+}
+
+bool HelperParse::initImage(GLTF& glTF, size_t index, AsyncIO& asyncIO)
+{
+	Image& image = glTF.images[index];
+
+	const uint8_t* data = nullptr;
+	size_t length = 0;
+
+	// Pixels are decoded straight into the image data resources.
+	std::vector<uint8_t> dataUri;
+	if (imageBufferViews[index] >= 0)
+	{
+		if (!isValid(imageBufferViews[index], glTF.bufferViews.size()))
+		{
+			return false;
+		}
+
+		const BufferView& bufferView = glTF.bufferViews[imageBufferViews[index]];
+
+		data = HelperAccess::accessData(bufferView);
+		length = bufferView.byteLength;
+	}
+	else if (isDataUri(image.uri))
+	{
+		if (!decodeDataUri(dataUri, image.uri))
+		{
+			return false;
+		}
+
+		data = dataUri.data();
+		length = dataUri.size();
+	}
+	else
+	{
+		if (!asyncIO.complete(imageRequests[index]))
+		{
+			return false;
+		}
+
+		data = reinterpret_cast<const uint8_t*>(imageData[index].data());
+		length = imageData[index].size();
+	}
+
+	bool result = openImage(image.imageDataResources, glTF, index, data, length);
+
+	imageData[index].clear();
+	imageData[index].shrink_to_fit();
+
+	return result;
+}
+
+void HelperParse::initImageFormats(const GLTF& glTF)
+{
+	imageFormats.assign(glTF.images.size(), VK_FORMAT_UNDEFINED);
+	imageMipMapSettings.assign(glTF.images.size(), MipMapSettings());
+
+	if (!compressTextures)
+	{
+		return;
+	}
+
+	auto useImage = [&](const TextureInfo& textureInfo, VkFormat format, bool srgb, float alphaCutoff) {
+		if (!isValid(textureInfo.index, glTF.textures.size()) || !isValid(glTF.textures[textureInfo.index].source, glTF.images.size()))
+		{
+			return;
+		}
+
+		int32_t source = glTF.textures[textureInfo.index].source;
+
+		// Color is filtered in linear space and alpha tested images keep their coverage.
+		MipMapSettings& mipMapSettings = imageMipMapSettings[source];
+		mipMapSettings.filter = MipMapFilter_KAISER;
+		mipMapSettings.srgb = mipMapSettings.srgb || srgb;
+		mipMapSettings.alphaCutoff = std::max(mipMapSettings.alphaCutoff, alphaCutoff);
+
+		VkFormat& imageFormat = imageFormats[source];
+
+		// Images shared between different uses keep all channels.
+		if (imageFormat == VK_FORMAT_UNDEFINED || imageFormat == format)
+		{
+			imageFormat = format;
+		}
+		else
+		{
+			imageFormat = VK_FORMAT_BC7_UNORM_BLOCK;
+		}
+	};
+
+	for (const Material& material : glTF.materials)
+	{
+		// Alpha mode one is mask.
+		float alphaCutoff = (material.alphaMode == 1) ? material.alphaCutoff : -1.0f;
+
+		useImage(material.pbrMetallicRoughness.baseColorTexture, VK_FORMAT_BC7_UNORM_BLOCK, true, alphaCutoff);
+		useImage(material.pbrMetallicRoughness.metallicRoughnessTexture, VK_FORMAT_BC7_UNORM_BLOCK, false, -1.0f);
+		useImage(material.emissiveTexture, VK_FORMAT_BC7_UNORM_BLOCK, true, -1.0f);
+		useImage(material.occlusionTexture, VK_FORMAT_BC4_UNORM_BLOCK, false, -1.0f);
+		useImage(material.normalTexture, VK_FORMAT_BC5_UNORM_BLOCK, false, -1.0f);
+	}
+}
+
+std::string HelperParse::getImageCacheFilename(const GLTF& glTF, size_t index) const
+{
+	std::string extension = ".bc7.ktx2";
+	if (imageFormats[index] == VK_FORMAT_BC5_UNORM_BLOCK)
+	{
+		extension = ".bc5.ktx2";
+	}
+	else if (imageFormats[index] == VK_FORMAT_BC4_UNORM_BLOCK)
+	{
+		extension = ".bc4.ktx2";
+	}
+
+	// Embedded images are cached next to the glTF.
+	if (imageBufferViews[index] >= 0 || isDataUri(glTF.images[index].uri))
+	{
+		return filename + ".image" + std::to_string(index) + extension;
+	}
+
+	return path + glTF.images[index].uri + extension;
+}
+
+bool HelperParse::openImage(ImageDataResources& output, const GLTF& glTF, size_t index, const uint8_t* data, size_t length)
+{
+	if (imageFormats[index] == VK_FORMAT_UNDEFINED)
+	{
+		return ImageDataIO::open(output, data, length);
+	}
+
+	imageHashes[index] = HelperHash::combine(HelperHash::hash(data, length), HelperBlockCompression::VERSION);
+
+	char source[17];
+	snprintf(source, sizeof(source), "%016" PRIx64, imageHashes[index]);
+
+	MappedFile cacheFile;
+	std::string cacheSource;
+	if (cacheFile.open(getImageCacheFilename(glTF, index)) && ImageDataIO::getKeyValue(cacheSource, cacheFile.getData(), cacheFile.getSize(), IMAGE_CACHE_KEY) && cacheSource == source)
+	{
+		if (ImageDataIO::open(output, cacheFile.getData(), cacheFile.getSize()))
+		{
+			return true;
+		}
+	}
+
+	if (!ImageDataIO::open(output, data, length))
+	{
+		return false;
+	}
+
+	imageEncodes[index] = 1;
+
+	return true;
+}
+
+void HelperParse::encodeImages(GLTF& glTF, WorkerPool* workerPool)
+{
+	// Images, which already are compressed or have levels, are kept as they are.
+	for (size_t i = 0; i < glTF.images.size(); i++)
+	{
+		const ImageDataResources& imageDataResources = glTF.images[i].imageDataResources;
+		if (imageDataResources.images.size() != 1 || imageDataResources.images[0].format != VK_FORMAT_R8G8B8A8_UNORM)
+		{
+			imageEncodes[i] = 0;
+		}
+	}
+
+	// Mip maps are generated with one image per worker, then each image is encoded on all workers.
+	std::vector<ImageDataResources> mipMaps(glTF.images.size());
+	std::vector<uint8_t> mipMapResults(glTF.images.size(), 0);
+
+	auto generateMipMaps = [&](size_t begin, size_t end) {
+		for (size_t i = begin; i < end; i++)
+		{
+			if (imageEncodes[i])
+			{
+				mipMapResults[i] = HelperMipMap::generate(mipMaps[i], glTF.images[i].imageDataResources, imageMipMapSettings[i]) ? 1 : 0;
+			}
+		}
+	};
+
+	if (workerPool)
+	{
+		workerPool->parallelFor(glTF.images.size(), generateMipMaps);
+	}
+	else
+	{
+		generateMipMaps(0, glTF.images.size());
+	}
+
+	for (size_t i = 0; i < glTF.images.size(); i++)
+	{
+		if (!imageEncodes[i])
+		{
+			continue;
+		}
+
+		ImageDataResources compressed;
+		if (!mipMapResults[i] || !HelperBlockCompression::encode(compressed, mipMaps[i], imageFormats[i], workerPool))
+		{
+			Logger::print(TinyEngine_WARNING, __FILE__, __LINE__, "Could not compress image %u", static_cast<uint32_t>(i));
+
+			continue;
+		}
+
+		mipMaps[i] = ImageDataResources();
+
+		char source[17];
+		snprintf(source, sizeof(source), "%016" PRIx64, imageHashes[i]);
+
+		// Read only assets are compressed on every start, but not cached.
+		std::string cacheFilename = getImageCacheFilename(glTF, i);
+		if (!HelperFile::isWritable(HelperFile::getPath(cacheFilename)))
+		{
+			Logger::print(TinyEngine_INFO, __FILE__, __LINE__, "Not caching compressed image '%s', as the directory is not writable", cacheFilename.c_str());
+		}
+		else if (!ImageDataIO::save(compressed, cacheFilename, {{IMAGE_CACHE_KEY, source}}))
+		{
+			Logger::print(TinyEngine_WARNING, __FILE__, __LINE__, "Could not cache compressed image '%s'", cacheFilename.c_str());
+		}
+
+		glTF.images[i].imageDataResources = std::move(compressed);
+		imageEncodes[i] = 0;
+	}
+}
+
+bool HelperParse::initMeshes(GLTF& glTF)
+{
+	for (size_t i = 0; i < glTF.meshes.size(); i++)
+	{
+		Mesh& mesh = glTF.meshes[i];
+
+		uint32_t weightsCount = 0;
+
+		for (Primitive& primitive : mesh.primitives)
+		{
+			const int32_t attributes[] = {primitive.position, primitive.normal, primitive.tangent, primitive.texCoord0, primitive.texCoord1, primitive.color0, primitive.joints0, primitive.joints1, primitive.weights0, primitive.weights1};
+			for (int32_t attribute : attributes)
+			{
+				if (attribute >= 0 && !isValid(attribute, glTF.accessors.size()))
+				{
+					return false;
+				}
+			}
+
+			//
+
+			weightsCount += static_cast<uint32_t>(primitive.targets.size());
+
+			for (uint32_t m = 0; m < primitive.targets.size(); m++)
+			{
+				const Target& target = primitive.targets[m];
+
+				const int32_t targetAttributes[] = {target.position, target.normal, target.tangent};
+				const int32_t baseAttributes[] = {primitive.position, primitive.normal, primitive.tangent};
+
+				// Deltas are gathered by the builder straight from the accessors.
+				for (uint32_t n = 0; n < 3; n++)
+				{
+					if (targetAttributes[n] < 0)
+					{
+						continue;
+					}
+
+					if (!isValid(targetAttributes[n], glTF.accessors.size()) || baseAttributes[n] < 0)
+					{
+						return false;
+					}
+
+					if (!checkTargetData(glTF.accessors[targetAttributes[n]], glTF.accessors[baseAttributes[n]].count))
+					{
+						return false;
+					}
+				}
+			}
+		}
+
+		//
+
+		if (weightsCount > 0)
+		{
+			mesh.weights.resize(weightsCount, 0.0f);
+
+			if (meshWeights[i].size() > 0)
+			{
+				if (mesh.weights.size() != meshWeights[i].size())
+				{
+					return false;
+				}
+
+				mesh.weights = meshWeights[i];
+			}
+		}
+	}
+
+	return true;
+}
+
+bool HelperParse::initSkins(GLTF& glTF)
+{
+	for (size_t i = 0; i < glTF.skins.size(); i++)
+	{
+		Skin& skin = glTF.skins[i];
+
+		if (skinInverseBindMatrices[i] >= 0)
+		{
+			if (!isValid(skinInverseBindMatrices[i], glTF.accessors.size()) || glTF.accessors[skinInverseBindMatrices[i]].count < skin.joints.size())
+			{
+				return false;
+			}
+
+			const glm::mat4* inverseBindMatrices = reinterpret_cast<const glm::mat4*>(HelperAccess::accessData(glTF.accessors[skinInverseBindMatrices[i]]));
+
+			skin.inverseBindMatrices.assign(inverseBindMatrices, inverseBindMatrices + skin.joints.size());
+		}
+		else
+		{
+			skin.inverseBindMatrices.resize(skin.joints.size(), glm::mat4(1.0f));
+		}
+	}
+
+	return true;
+}
+
+bool HelperParse::initNodes(GLTF& glTF)
+{
+	for (size_t i = 0; i < glTF.nodes.size(); i++)
+	{
+		Node& node = glTF.nodes[i];
+
+		if (nodeMatrices[i])
+		{
+			glm::vec3 skew;
+			glm::vec4 perspective;
+			glm::decompose(node.matrix, node.scale, node.rotation, node.translation, skew, perspective);
+
+			node.matrix = glm::mat4(1.0f);
+		}
+
+		if (node.mesh >= 0)
+		{
+			if (!isValid(node.mesh, glTF.meshes.size()))
+			{
+				return false;
+			}
+
+			const Mesh& mesh = glTF.meshes[node.mesh];
+
+			if (mesh.weights.size() > 0)
+			{
+				node.weights = mesh.weights;
+
+				if (nodeWeights[i].size() > 0)
+				{
+					if (node.weights.size() != nodeWeights[i].size())
+					{
+						return false;
+					}
+
+					node.weights = nodeWeights[i];
+				}
+			}
+		}
+
+		if (node.skin >= 0)
+		{
+			if (!isValid(node.skin, glTF.skins.size()))
+			{
+				return false;
+			}
+
+			node.jointMatrices.resize(glTF.skins[node.skin].inverseBindMatrices.size());
+		}
+	}
+
+	return true;
+}
+
+bool HelperParse::initAnimations(GLTF& glTF)
+{
+	for (Animation& animation : glTF.animations)
+	{
+		for (AnimationSampler& sampler : animation.samplers)
+		{
+			if (isValid(sampler.input, glTF.accessors.size()) && glTF.accessors[sampler.input].componentType == 5126 && glTF.accessors[sampler.input].typeCount == 1)
+			{
+				uint32_t count = glTF.accessors[sampler.input].count;
+				uint32_t size = count * glTF.accessors[sampler.input].typeCount;
+				uint32_t byteSize = size * glTF.accessors[sampler.input].componentTypeSize;
+
+				sampler.inputTime.resize(size);
+				memcpy(sampler.inputTime.data(), HelperAccess::accessData(glTF.accessors[sampler.input]), byteSize);
+
+				HelperAnimate::checkUniform(sampler);
+			}
+			else
+			{
+				return false;
+			}
+
+			if (isValid(sampler.output, glTF.accessors.size()))
+			{
+				const Accessor& accessor = glTF.accessors[sampler.output];
+
+				uint32_t size = accessor.count * accessor.typeCount;
+
+				sampler.outputValues.resize(size);
+
+				if (accessor.componentType == 5126)
+				{
+					memcpy(sampler.outputValues.data(), HelperAccess::accessData(accessor), size * accessor.componentTypeSize);
+				}
+				else if (accessor.componentType == 5123)
+				{
+					const uint16_t* data = reinterpret_cast<const uint16_t*>(HelperAccess::accessData(accessor));
+					for (size_t m = 0; m < sampler.outputValues.size(); m++)
+					{
+						sampler.outputValues[m] = data[m] / 65535.0f;
+					}
+				}
+				else if (accessor.componentType == 5122)
+				{
+					const int16_t* data = reinterpret_cast<const int16_t*>(HelperAccess::accessData(accessor));
+					for (size_t m = 0; m < sampler.outputValues.size(); m++)
+					{
+						sampler.outputValues[m] = glm::max(data[m] / 32767.0f, -1.0f);
+					}
+				}
+				else if (accessor.componentType == 5121)
+				{
+					const uint8_t* data = reinterpret_cast<const uint8_t*>(HelperAccess::accessData(accessor));
+					for (size_t m = 0; m < sampler.outputValues.size(); m++)
+					{
+						sampler.outputValues[m] = data[m] / 255.0f;
+					}
+				}
+				else if (accessor.componentType == 5120)
+				{
+					const int8_t* data = reinterpret_cast<const int8_t*>(HelperAccess::accessData(accessor));
+					for (size_t m = 0; m < sampler.outputValues.size(); m++)
+					{
+						sampler.outputValues[m] = glm::max(data[m] / 127.0f, -1.0f);
+					}
+				}
+				else
+				{
+					sampler.outputValues.clear();
+				}
+			}
+			else
+			{
+				return false;
+			}
+		}
+
+		//
+
+		for (AnimationChannel& channel : animation.channels)
+		{
+			if (channel.sampler >= 0)
+			{
+				if (!isValid(channel.sampler, animation.samplers.size()))
+				{
+					return false;
+				}
+
+				channel.targetSampler = &animation.samplers[channel.sampler];
+			}
+
+			if (channel.target.node >= 0)
+			{
+				if (!isValid(channel.target.node, glTF.nodes.size()))
+				{
+					return false;
+				}
+
+				channel.target.targetNode = &glTF.nodes[channel.target.node];
+			}
+		}
+	}
+
+	return true;
+}
+
+bool HelperParse::initScenes(GLTF& glTF)
+{
+	for (const Scene& scene : glTF.scenes)
+	{
+		for (int32_t node : scene.nodes)
+		{
+			if (!isValid(node, glTF.nodes.size()))
+			{
+				return false;
+			}
+		}
+	}
+
+	if (defaultScene >= 0)
+	{
+		glTF.defaultScene = static_cast<uint32_t>(defaultScene);
+	}
+
+	return true;
+}
+
+bool HelperParse::checkTargetData(const Accessor& accessor, uint32_t count)
+{
+	// KHR_mesh_quantization allows integer target data, which is converted when the deltas are gathered.
+	return accessor.count == count && accessor.typeCount == 3;
+}
+
+bool HelperParse::checkImages(const std::vector<uint8_t>& imageResults)
+{
+	for (size_t i = 0; i < imageResults.size(); i++)
+	{
+		if (!imageResults[i])
+		{
+			Logger::print(TinyEngine_ERROR, __FILE__, __LINE__, "Could not decode image %u", static_cast<uint32_t>(i));
+
+			return false;
+		}
+	}
+
+	return true;
+}
+
+bool HelperParse::open(GLTF& glTF, const std::string& filename, WorkerPool* workerPool, const std::function<bool(const GLTF& glTF)>& skipImages)
+{
+	mappedFile = std::make_shared<MappedFile>();
+	if (!mappedFile->open(filename))
+	{
+		return false;
+	}
+
+	path = HelperFile::getPath(filename);
+	this->filename = filename;
+
+	const char* json = reinterpret_cast<const char*>(mappedFile->getData());
+	size_t jsonLength = mappedFile->getSize();
+
+	const uint8_t* binaryChunk = nullptr;
+	size_t binaryChunkLength = 0;
+
+	if (HelperFile::getExtension(filename) == "glb")
+	{
+		if (!initGlb(json, jsonLength, binaryChunk, binaryChunkLength))
+		{
+			Logger::print(TinyEngine_ERROR, __FILE__, __LINE__, "Invalid GLB '%s'", filename.c_str());
+
+			return false;
+		}
+	}
+	else if (HelperFile::getExtension(filename) != "gltf")
+	{
+		return false;
+	}
+
+	// Parse glTF
+
+	JsonReader reader(json, jsonLength);
+	if (!parseDocument(glTF, reader) || !hasVersion)
+	{
+		Logger::print(TinyEngine_ERROR, __FILE__, __LINE__, "Invalid glTF '%s'", filename.c_str());
+
+		return false;
+	}
+
+	for (const std::string& extension : extensionsUsed)
+	{
+		if (extension != "KHR_mesh_quantization")
+		{
+			Logger::print(TinyEngine_ERROR, __FILE__, __LINE__, "glTF extension '%s' not supported.", extension.c_str());
+
+			return false;
+		}
+	}
+
+	// Buffers
+
+	if (!initBuffers(glTF, binaryChunk, binaryChunkLength, path))
+	{
+		return false;
+	}
+
+	// BufferViews
+
+	if (!initBufferViews(glTF))
+	{
+		return false;
+	}
+
+	// Accessors
+
+	if (!initAccessors(glTF))
+	{
+		return false;
+	}
+
+	if (skipImages && skipImages(glTF))
+	{
+		return initMeshes(glTF) && initSkins(glTF) && initNodes(glTF) && initAnimations(glTF) && initScenes(glTF);
+	}
+
+	// Images are decoded on the worker pool, driven from a separate thread, while the rest is resolved here.
+
+	AsyncIO asyncIO;
+	submitImages(glTF, asyncIO);
+
+	std::vector<uint8_t> imageResults(glTF.images.size(), 0);
+
+	auto decodeImages = [&](size_t begin, size_t end) {
+		for (size_t i = begin; i < end; i++)
+		{
+			imageResults[i] = initImage(glTF, i, asyncIO) ? 1 : 0;
+		}
+	};
+
+	std::thread imageThread;
+	if (workerPool && glTF.images.size() > 1)
+	{
+		imageThread = std::thread([&]() {
+			workerPool->parallelFor(glTF.images.size(), decodeImages);
+		});
+	}
+	else
+	{
+		decodeImages(0, glTF.images.size());
+	}
+
+	// Meshes, skins, nodes, animations and scenes
+
+	bool result = initMeshes(glTF) && initSkins(glTF) && initNodes(glTF) && initAnimations(glTF) && initScenes(glTF);
+
+	if (imageThread.joinable())
+	{
+		imageThread.join();
+	}
+
+	if (!result || !checkImages(imageResults))
+	{
+		return false;
+	}
+
+	encodeImages(glTF, workerPool);
+
+	return true;
+}
+
+void HelperParse::setCompressTextures(bool compressTextures)
+{
+	this->compressTextures = compressTextures;
+}
@@ -0,0 +1,128 @@
+#ifndef GLTF_HELPERPARSE_H_
+#define GLTF_HELPERPARSE_H_
+
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "../common/WorkerPool.h"
+#include "../io/HelperMipMap.h"
+
+#include "GLTF.h"
+
+struct GLTF;
+
+// Parses the glTF JSON in one pass straight into GLTF, without an intermediate document. Results are the same as with HelperLoad.
+class HelperParse {
+
+private:
+
+	std::shared_ptr<MappedFile> mappedFile;
+	std::string path = "";
+	std::string filename = "";
+
+	// Parsed values, which are only resolved after the whole document is read.
+	std::vector<int32_t> imageBufferViews;
+
+	// Image files are read asynchronously, all at once, and decoded as they arrive.
+	std::vector<uint64_t> imageRequests;
+	std::vector<std::string> imageData;
+
+	// Block compressed format and mip map settings of each image, chosen by its use in the materials. Undefined, if not compressed.
+	std::vector<VkFormat> imageFormats;
+	std::vector<MipMapSettings> imageMipMapSettings;
+	std::vector<uint64_t> imageHashes;
+	std::vector<uint8_t> imageEncodes;
+	bool compressTextures = false;
+	std::vector<int32_t> skinInverseBindMatrices;
+	std::vector<std::vector<float>> meshWeights;
+	std::vector<std::vector<float>> nodeWeights;
+	std::vector<bool> nodeMatrices;
+	std::vector<std::string> extensionsUsed;
+	int32_t defaultScene = -1;
+	bool hasVersion = false;
+
+	bool initGlb(const char*& json, size_t& jsonLength, const uint8_t*& binaryChunk, size_t& binaryChunkLength);
+
+	bool parseDocument(GLTF& glTF, JsonReader& reader);
+
+	bool parseAsset(JsonReader& reader);
+
+	bool parseBuffers(GLTF& glTF, JsonReader& reader);
+
+	bool parseBufferViews(GLTF& glTF, JsonReader& reader);
+
+	bool parseAccessors(GLTF& glTF, JsonReader& reader);
+
+	bool parseAccessorSparse(AccessorSparse& sparse, JsonReader& reader);
+
+	bool parseImages(GLTF& glTF, JsonReader& reader);
+
+	bool parseSamplers(GLTF& glTF, JsonReader& reader);
+
+	bool parseTextures(GLTF& glTF, JsonReader& reader);
+
+	bool parseMaterials(GLTF& glTF, JsonReader& reader);
+
+	bool parseTextureInfo(TextureInfo& textureInfo, float* scaleOrStrength, JsonReader& reader);
+
+	bool parseMeshes(GLTF& glTF, JsonReader& reader);
+
+	bool parsePrimitive(Primitive& primitive, JsonReader& reader);
+
+	bool parseSkins(GLTF& glTF, JsonReader& reader);
+
+	bool parseNodes(GLTF& glTF, JsonReader& reader);
+
+	bool parseAnimations(GLTF& glTF, JsonReader& reader);
+
+	bool parseScenes(GLTF& glTF, JsonReader& reader);
+
+	bool initBuffers(GLTF& glTF, const uint8_t* binaryChunk, size_t binaryChunkLength, const std::string& path);
+
+	bool initBufferViews(GLTF& glTF);
+
+	bool initAccessors(GLTF& glTF);
+
+	void submitImages(const GLTF& glTF, AsyncIO& asyncIO);
+
+	bool initImage(GLTF& glTF, size_t index, AsyncIO& asyncIO);
+
+	void initImageFormats(const GLTF& glTF);
+
+	std::string getImageCacheFilename(const GLTF& glTF, size_t index) const;
+
+	bool openImage(ImageDataResources& output, const GLTF& glTF, size_t index, const uint8_t* data, size_t length);
+
+	void encodeImages(GLTF& glTF, WorkerPool* workerPool);
+
+	bool checkImages(const std::vector<uint8_t>& imageResults);
+
+	bool initMeshes(GLTF& glTF);
+
+	bool initSkins(GLTF& glTF);
+
+	bool initNodes(GLTF& glTF);
+
+	bool initAnimations(GLTF& glTF);
+
+	bool initScenes(GLTF& glTF);
+
+	bool checkTargetData(const Accessor& accessor, uint32_t count);
+
+public:
+
+	HelperParse();
+
+	// Images are decoded in parallel, if a worker pool is given, while meshes, skins, nodes and animations are resolved.
+	// Skipped, if the given function returns true. It is called with the resolved buffers, e.g. to check a cache of the build results.
+	bool open(GLTF& glTF, const std::string& filename, WorkerPool* workerPool = nullptr, const std::function<bool(const GLTF& glTF)>& skipImages = nullptr);
+
+	// Color textures are compressed to BC7, normal maps to BC5 and occlusion to BC4 at import, including the mip maps.
+	// Results are cached as KTX2 next to the source and only encoded again, if the source changes.
+	void setCompressTextures(bool compressTextures);
+
+};
+
+#endif /* GLTF_HELPERPARSE_H_ */
@@ -1,5 +1,7 @@
 #include "HelperUpdate.h"
 
+#include <algorithm>
+
 #include "HelperAccess.h"
 
 bool HelperUpdate::update(Node& node, GLTF& glTF, const glm::mat4& parentWorldMatrix)
@@ -36,32 +38,265 @@ bool HelperUpdate::update(Scene& scene, GLTF& glTF, const glm::mat4& parentWorld
 	return true;
 }
 
-bool HelperUpdate::update(GLTF& glTF, const glm::mat4& parentWorldMatrix)
+bool HelperUpdate::build(Hierarchy& hierarchy, GLTF& glTF)
 {
+	hierarchy = Hierarchy();
+
+	hierarchy.scene = glTF.defaultScene;
+	hierarchy.dirty.resize(glTF.nodes.size(), 1);
+	hierarchy.changed.resize(glTF.nodes.size(), 0);
+
 	if (glTF.defaultScene < glTF.scenes.size())
 	{
-		if (!HelperUpdate::update(glTF.scenes[glTF.defaultScene], glTF, parentWorldMatrix))
+		std::vector<uint8_t> visited(glTF.nodes.size(), 0);
+
+		for (int32_t nodeIndex : glTF.scenes[glTF.defaultScene].nodes)
 		{
-			return false;
+			if (nodeIndex < 0 || nodeIndex >= static_cast<int32_t>(glTF.nodes.size()) || visited[nodeIndex])
+			{
+				return false;
+			}
+			visited[nodeIndex] = 1;
+
+			hierarchy.nodes.push_back(nodeIndex);
+			hierarchy.parents.push_back(-1);
+		}
+
+		// Breadth first, so no recursion is needed for deep hierarchies.
+		for (size_t i = 0; i < hierarchy.nodes.size(); i++)
+		{
+			const Node& node = glTF.nodes[hierarchy.nodes[i]];
+
+			for (int32_t childIndex : node.children)
+			{
+				if (childIndex < 0 || childIndex >= static_cast<int32_t>(glTF.nodes.size()) || visited[childIndex])
+				{
+					return false;
+				}
+				visited[childIndex] = 1;
+
+				hierarchy.nodes.push_back(childIndex);
+				hierarchy.parents.push_back(static_cast<int32_t>(i));
+			}
 		}
 	}
 
-	//
+	hierarchy.matrices.resize(hierarchy.nodes.size(), glm::mat4(1.0f));
+	hierarchy.worldMatrices.resize(hierarchy.nodes.size(), glm::mat4(1.0f));
 
 	for (size_t i = 0; i < glTF.nodes.size(); i++)
 	{
-		Node& node = glTF.nodes[i];
+		if (glTF.nodes[i].skin >= 0)
+		{
+			hierarchy.skinNodes.push_back(static_cast<int32_t>(i));
+		}
+	}
+	hierarchy.skinJointDepths.resize(hierarchy.skinNodes.size(), 0);
+
+	//
+
+	std::vector<int32_t> parentNodes(glTF.nodes.size(), -1);
+	for (size_t i = 0; i < hierarchy.nodes.size(); i++)
+	{
+		if (hierarchy.parents[i] >= 0)
+		{
+			parentNodes[hierarchy.nodes[i]] = hierarchy.nodes[hierarchy.parents[i]];
+		}
+	}
 
-		if (node.skin >= 0)
+	std::vector<int32_t> jointIndices(glTF.nodes.size(), -1);
+	for (Skin& skin : glTF.skins)
+	{
+		for (size_t k = 0; k < skin.joints.size(); k++)
 		{
-			Skin& skin = glTF.skins[node.skin];
+			if (skin.joints[k] < 0 || skin.joints[k] >= static_cast<int32_t>(glTF.nodes.size()))
+			{
+				return false;
+			}
+
+			jointIndices[skin.joints[k]] = static_cast<int32_t>(k);
+		}
 
-			glm::mat4 inverseWorldMatrix = glm::inverse(node.worldMatrix);
+		skin.jointParents.resize(skin.joints.size());
+		skin.jointDepths.resize(skin.joints.size());
 
-			for (size_t k = 0; k < node.jointMatrices.size(); k++)
+		for (size_t k = 0; k < skin.joints.size(); k++)
+		{
+			int32_t parentNode = parentNodes[skin.joints[k]];
+			while (parentNode >= 0 && jointIndices[parentNode] < 0)
 			{
-				node.jointMatrices[k] = inverseWorldMatrix * glTF.nodes[skin.joints[k]].worldMatrix * skin.inverseBindMatrices[k];
+				parentNode = parentNodes[parentNode];
 			}
+
+			skin.jointParents[k] = (parentNode >= 0) ? jointIndices[parentNode] : -1;
+		}
+
+		for (size_t k = 0; k < skin.joints.size(); k++)
+		{
+			skin.jointDepths[k] = 0;
+			for (int32_t parent = skin.jointParents[k]; parent >= 0; parent = skin.jointParents[parent])
+			{
+				skin.jointDepths[k]++;
+			}
+		}
+
+		for (int32_t joint : skin.joints)
+		{
+			jointIndices[joint] = -1;
+		}
+	}
+
+	hierarchy.valid = true;
+
+	return true;
+}
+
+void HelperUpdate::updateSkin(GLTF& glTF, size_t skinNodeIndex)
+{
+	Hierarchy& hierarchy = glTF.hierarchy;
+
+	int32_t nodeIndex = hierarchy.skinNodes[skinNodeIndex];
+
+	Node& node = glTF.nodes[nodeIndex];
+
+	const Skin& skin = glTF.skins[node.skin];
+
+	// Only, if the skinned node or one of the joints did move.
+	bool skinChanged = hierarchy.changed[nodeIndex] != 0 || hierarchy.skinJointDepths[skinNodeIndex] != node.jointDepth;
+	for (size_t k = 0; k < skin.joints.size() && !skinChanged; k++)
+	{
+		skinChanged = hierarchy.changed[skin.joints[k]] != 0;
+	}
+
+	if (!skinChanged)
+	{
+		return;
+	}
+
+	hierarchy.skinJointDepths[skinNodeIndex] = node.jointDepth;
+
+	size_t count = node.jointMatrices.size();
+
+	for (size_t k = 0; k < count; k++)
+	{
+		node.jointMatrices[k] = glTF.nodes[skin.joints[k]].worldMatrix;
+	}
+
+	// Batched, as all joints share the inverse world matrix.
+	Matrix::multiply(node.jointMatrices.data(), Matrix::inverseAffine(node.worldMatrix), node.jointMatrices.data(), count);
+	Matrix::multiply(node.jointMatrices.data(), node.jointMatrices.data(), skin.inverseBindMatrices.data(), count);
+
+	if (node.jointDepth == 0)
+	{
+		return;
+	}
+
+	// Deeper joints are moved rigidly by their ancestor at the limit, which is the ancestor's joint matrix.
+	for (size_t k = 0; k < count; k++)
+	{
+		if (skin.jointDepths[k] < node.jointDepth)
+		{
+			continue;
+		}
+
+		int32_t ancestor = skin.jointParents[k];
+		while (skin.jointDepths[ancestor] >= node.jointDepth)
+		{
+			ancestor = skin.jointParents[ancestor];
+		}
+
+		node.jointMatrices[k] = node.jointMatrices[ancestor];
+	}
+}
+
+void HelperUpdate::setDirty(GLTF& glTF, int32_t nodeIndex)
+{
+	if (nodeIndex >= 0 && nodeIndex < static_cast<int32_t>(glTF.hierarchy.dirty.size()))
+	{
+		glTF.hierarchy.dirty[nodeIndex] = 1;
+	}
+}
+
+bool HelperUpdate::update(GLTF& glTF, const glm::mat4& parentWorldMatrix, WorkerPool* workerPool)
+{
+	Hierarchy& hierarchy = glTF.hierarchy;
+
+	bool rootChanged = false;
+
+	if (!hierarchy.valid || hierarchy.scene != glTF.defaultScene || hierarchy.dirty.size() != glTF.nodes.size())
+	{
+		if (!build(hierarchy, glTF))
+		{
+			return false;
+		}
+
+		rootChanged = true;
+	}
+
+	if (hierarchy.parentWorldMatrix != parentWorldMatrix)
+	{
+		hierarchy.parentWorldMatrix = parentWorldMatrix;
+
+		rootChanged = true;
+	}
+
+	std::fill(hierarchy.changed.begin(), hierarchy.changed.end(), 0);
+
+	// Parents are always updated before their children.
+	for (size_t i = 0; i < hierarchy.nodes.size(); i++)
+	{
+		int32_t nodeIndex = hierarchy.nodes[i];
+		int32_t parentIndex = hierarchy.parents[i];
+
+		Node& node = glTF.nodes[nodeIndex];
+
+		bool localChanged = hierarchy.dirty[nodeIndex] != 0;
+		if (localChanged)
+		{
+			hierarchy.matrices[i] = glm::translate(node.translation) * glm::toMat4(node.rotation) * glm::scale(node.scale);
+			hierarchy.dirty[nodeIndex] = 0;
+
+			node.matrix = hierarchy.matrices[i];
+		}
+
+		bool parentChanged = rootChanged;
+		if (parentIndex >= 0)
+		{
+			parentChanged = hierarchy.changed[hierarchy.nodes[parentIndex]] != 0;
+		}
+
+		if (localChanged || parentChanged)
+		{
+			if (parentIndex >= 0)
+			{
+				hierarchy.worldMatrices[i] = hierarchy.worldMatrices[parentIndex] * hierarchy.matrices[i];
+			}
+			else
+			{
+				hierarchy.worldMatrices[i] = parentWorldMatrix * hierarchy.matrices[i];
+			}
+			hierarchy.changed[nodeIndex] = 1;
+
+			node.worldMatrix = hierarchy.worldMatrices[i];
+		}
+	}
+
+	//
+
+	if (workerPool)
+	{
+		workerPool->parallelFor(hierarchy.skinNodes.size(), [&](size_t begin, size_t end) {
+			for (size_t i = begin; i < end; i++)
+			{
+				updateSkin(glTF, i);
+			}
+		}, 16);
+	}
+	else
+	{
+		for (size_t i = 0; i < hierarchy.skinNodes.size(); i++)
+		{
+			updateSkin(glTF, i);
 		}
 	}
 
@@ -1,6 +1,7 @@
 #ifndef GLTF_HELPERUPDATE_H_
 #define GLTF_HELPERUPDATE_H_
 
+#include "../common/WorkerPool.h"
 #include "../math/Math.h"
 
 #include "GLTF.h"
@@ -8,13 +9,24 @@
 struct GLTF;
 
 class HelperUpdate {
+
+private:
+
+	static bool build(Hierarchy& hierarchy, GLTF& glTF);
+
+	static void updateSkin(GLTF& glTF, size_t skinNodeIndex);
+
 public:
 
+	// Has to be called after the translation, rotation or scale of a node was changed.
+	static void setDirty(GLTF& glTF, int32_t nodeIndex);
+
 	static bool update(Node& node, GLTF& glTF, const glm::mat4& parentWorldMatrix);
 
 	static bool update(Scene& scene, GLTF& glTF, const glm::mat4& parentWorldMatrix);
 
-	static bool update(GLTF& glTF, const glm::mat4& parentWorldMatrix);
+	// Only the dirty nodes of the default scene and their children are updated. Skins are updated in parallel, if a worker pool is given.
+	static bool update(GLTF& glTF, const glm::mat4& parentWorldMatrix, WorkerPool* workerPool = nullptr);
 };
 
 #endif /* GLTF_HELPERUPDATE_H_ */
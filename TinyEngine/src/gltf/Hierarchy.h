@@ -0,0 +1,31 @@
+#ifndef GLTF_HIERARCHY_H_
+#define GLTF_HIERARCHY_H_
+
+#include <cstdint>
+#include <vector>
+
+#include "../math/Math.h"
+
+// Flattened nodes of the default scene. Nodes are sorted topologically, so every parent is stored before its children.
+struct Hierarchy {
+	bool valid = false;
+
+	uint32_t scene = 0;
+
+	// Indexed by the sorted position.
+	std::vector<int32_t> nodes;
+	std::vector<int32_t> parents;
+	std::vector<glm::mat4> matrices;
+	std::vector<glm::mat4> worldMatrices;
+
+	// Indexed by node. Dirty is set, if the local transform was changed, changed after the world matrix was updated.
+	std::vector<uint8_t> dirty;
+	std::vector<uint8_t> changed;
+
+	std::vector<int32_t> skinNodes;
+	std::vector<uint32_t> skinJointDepths;
+
+	glm::mat4 parentWorldMatrix = glm::mat4(1.0f);
+};
+
+#endif /* GLTF_HIERARCHY_H_ */
@@ -25,6 +25,11 @@ struct Node {
 	glm::mat4 worldMatrix;
 
 	std::vector<glm::mat4> jointMatrices;
+
+	// Joints at or below this depth follow their ancestor, zero uses all joints.
+	uint32_t jointDepth = 0;
+
+	std::vector<glm::mat4> previousJointMatrices;
 };
 
 #endif /* GLTF_NODE_H_ */
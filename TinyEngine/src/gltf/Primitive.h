@@ -35,10 +35,6 @@ struct Primitive {
 	// Generic Helper
 
 	uint32_t attributesCount = 0;
-
-	std::vector<glm::vec3> targetPositionData;
-	std::vector<glm::vec3> targetNormalData;
-	std::vector<glm::vec3> targetTangentData;
 };
 
 #endif /* GLTF_PRIMITIVE_H_ */
@@ -12,6 +12,12 @@ struct Skin {
 	int32_t skeleton = -1;
 
 	std::vector<int32_t> joints;
+
+	// Generic helper
+
+	// Index of the nearest ancestor in joints, -1 for a root joint.
+	std::vector<int32_t> jointParents;
+	std::vector<uint32_t> jointDepths;
 };
 
 #endif /* GLTF_SKIN_H_ */
@@ -0,0 +1,540 @@
+#include "AsyncIO.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <fstream>
+
+#if defined(__linux__) && defined(__has_include)
+#if __has_include(<linux/io_uring.h>)
+#include <fcntl.h>
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#if defined(__NR_io_uring_setup) && defined(__NR_io_uring_enter)
+#define TINYENGINE_IO_URING
+#endif
+#endif
+#endif
+
+#include "VirtualFile.h"
+
+// Larger reads are split, as the result of a read is a 32 bit value.
+static const size_t MAX_READ_SIZE = 1 << 30;
+
+AsyncIO::AsyncIO(uint32_t queueDepth, uint32_t threadsCount)
+{
+	if (setupRing(queueDepth))
+	{
+		return;
+	}
+
+	if (threadsCount == 0)
+	{
+		threadsCount = 4;
+	}
+
+	for (uint32_t i = 0; i < threadsCount; i++)
+	{
+		threads.push_back(std::thread(&AsyncIO::run, this));
+	}
+}
+
+AsyncIO::~AsyncIO()
+{
+	{
+		std::unique_lock<std::mutex> lock(mutex);
+
+		stop = true;
+
+		// The kernel must not write into buffers after they are released.
+		while (ring >= 0 && inFlight > 0)
+		{
+			reap(lock, true);
+		}
+
+		for (Request* request : waiting)
+		{
+			finish(request, false);
+		}
+		waiting.clear();
+	}
+	startCondition.notify_all();
+
+	for (std::thread& thread : threads)
+	{
+		thread.join();
+	}
+
+	closeRing();
+}
+
+bool AsyncIO::setupRing(uint32_t queueDepth)
+{
+#if defined(TINYENGINE_IO_URING)
+	io_uring_params params = {};
+
+	int fileDescriptor = static_cast<int>(syscall(__NR_io_uring_setup, queueDepth, &params));
+	if (fileDescriptor < 0)
+	{
+		return false;
+	}
+
+	// Plain reads are supported from the same kernel version on, as fast poll.
+	if ((params.features & IORING_FEAT_FAST_POLL) == 0)
+	{
+		close(fileDescriptor);
+
+		return false;
+	}
+
+	ring = fileDescriptor;
+	entries = params.sq_entries;
+
+	submissionRingSize = params.sq_off.array + params.sq_entries * sizeof(uint32_t);
+	completionRingSize = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+	if (params.features & IORING_FEAT_SINGLE_MMAP)
+	{
+		submissionRingSize = std::max(submissionRingSize, completionRingSize);
+		completionRingSize = 0;
+	}
+
+	void* memory = mmap(nullptr, submissionRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring, IORING_OFF_SQ_RING);
+	if (memory == MAP_FAILED)
+	{
+		closeRing();
+
+		return false;
+	}
+	submissionRing = memory;
+
+	if (completionRingSize > 0)
+	{
+		memory = mmap(nullptr, completionRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring, IORING_OFF_CQ_RING);
+		if (memory == MAP_FAILED)
+		{
+			closeRing();
+
+			return false;
+		}
+		completionRing = memory;
+	}
+	else
+	{
+		completionRing = submissionRing;
+	}
+
+	submissionEntriesSize = params.sq_entries * sizeof(io_uring_sqe);
+	memory = mmap(nullptr, submissionEntriesSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring, IORING_OFF_SQES);
+	if (memory == MAP_FAILED)
+	{
+		closeRing();
+
+		return false;
+	}
+	submissionEntries = memory;
+
+	uint8_t* submission = static_cast<uint8_t*>(submissionRing);
+	submissionTail = reinterpret_cast<uint32_t*>(submission + params.sq_off.tail);
+	submissionMask = reinterpret_cast<uint32_t*>(submission + params.sq_off.ring_mask);
+	submissionArray = reinterpret_cast<uint32_t*>(submission + params.sq_off.array);
+
+	uint8_t* completion = static_cast<uint8_t*>(completionRing);
+	completionHead = reinterpret_cast<uint32_t*>(completion + params.cq_off.head);
+	completionTail = reinterpret_cast<uint32_t*>(completion + params.cq_off.tail);
+	completionMask = reinterpret_cast<uint32_t*>(completion + params.cq_off.ring_mask);
+	completionEntries = completion + params.cq_off.cqes;
+
+	return true;
+#else
+	(void)queueDepth;
+
+	return false;
+#endif
+}
+
+void AsyncIO::closeRing()
+{
+#if defined(TINYENGINE_IO_URING)
+	if (submissionEntries)
+	{
+		munmap(submissionEntries, submissionEntriesSize);
+		submissionEntries = nullptr;
+	}
+
+	if (completionRing && completionRing != submissionRing)
+	{
+		munmap(completionRing, completionRingSize);
+	}
+	completionRing = nullptr;
+
+	if (submissionRing)
+	{
+		munmap(submissionRing, submissionRingSize);
+		submissionRing = nullptr;
+	}
+
+	if (ring >= 0)
+	{
+		close(ring);
+		ring = -1;
+	}
+#endif
+}
+
+void AsyncIO::start(Request* request)
+{
+#if defined(TINYENGINE_IO_URING)
+	if (ring >= 0)
+	{
+		request->fileDescriptor = open(request->filename.c_str(), O_RDONLY);
+		if (request->fileDescriptor < 0)
+		{
+			finish(request, false);
+
+			return;
+		}
+
+		if (request->output)
+		{
+			struct stat fileStat = {};
+			if (fstat(request->fileDescriptor, &fileStat) != 0)
+			{
+				finish(request, false);
+
+				return;
+			}
+
+			request->output->resize(static_cast<size_t>(fileStat.st_size));
+			request->buffer = reinterpret_cast<uint8_t*>(&(*request->output)[0]);
+			request->size = request->output->size();
+		}
+
+		if (request->size == 0)
+		{
+			finish(request, true);
+
+			return;
+		}
+
+		// Requests beyond the queue depth start, when others are done.
+		if (inFlight == entries)
+		{
+			waiting.push_back(request);
+
+			return;
+		}
+
+		inFlight++;
+		queueRead(request);
+
+		return;
+	}
+#endif
+
+	queue.push_back(request);
+	startCondition.notify_one();
+}
+
+void AsyncIO::queueRead(Request* request)
+{
+#if defined(TINYENGINE_IO_URING)
+	// Only this side writes the tail, always with the mutex locked.
+	uint32_t tail = *submissionTail;
+	uint32_t index = tail & *submissionMask;
+
+	io_uring_sqe* submissionEntry = static_cast<io_uring_sqe*>(submissionEntries) + index;
+	memset(submissionEntry, 0, sizeof(io_uring_sqe));
+	submissionEntry->opcode = IORING_OP_READ;
+	submissionEntry->fd = request->fileDescriptor;
+	submissionEntry->addr = reinterpret_cast<uint64_t>(request->buffer + request->bytesRead);
+	submissionEntry->len = static_cast<uint32_t>(std::min(request->size - request->bytesRead, MAX_READ_SIZE));
+	submissionEntry->off = request->offset + request->bytesRead;
+	submissionEntry->user_data = reinterpret_cast<uint64_t>(request);
+
+	submissionArray[index] = index;
+	__atomic_store_n(submissionTail, tail + 1, __ATOMIC_RELEASE);
+
+	// Submitted right away, so the read is in flight while the caller continues. A published entry can not be taken back,
+	// so interrupted submits are retried. All entries left over are submitted by the next wait for completions.
+	while (syscall(__NR_io_uring_enter, ring, entries, 0, 0, nullptr, 0) < 0 && (errno == EINTR || errno == EAGAIN || errno == EBUSY))
+	{
+	}
+#else
+	(void)request;
+#endif
+}
+
+void AsyncIO::reap(std::unique_lock<std::mutex>& lock, bool wait)
+{
+#if defined(TINYENGINE_IO_URING)
+	if (reaping)
+	{
+		if (wait)
+		{
+			doneCondition.wait(lock);
+		}
+
+		return;
+	}
+
+	uint32_t head = *completionHead;
+	uint32_t tail = __atomic_load_n(completionTail, __ATOMIC_ACQUIRE);
+
+	if (head == tail)
+	{
+		if (!wait)
+		{
+			return;
+		}
+
+		reaping = true;
+
+		lock.unlock();
+		syscall(__NR_io_uring_enter, ring, entries, 1, IORING_ENTER_GETEVENTS, nullptr, 0);
+		lock.lock();
+
+		reaping = false;
+
+		tail = __atomic_load_n(completionTail, __ATOMIC_ACQUIRE);
+	}
+
+	std::vector<Request*> started;
+
+	while (head != tail)
+	{
+		const io_uring_cqe* completionEntry = static_cast<const io_uring_cqe*>(completionEntries) + (head & *completionMask);
+
+		Request* request = reinterpret_cast<Request*>(completionEntry->user_data);
+		int32_t result = completionEntry->res;
+
+		head++;
+
+		if (result == -EINTR || result == -EAGAIN)
+		{
+			started.push_back(request);
+		}
+		else if (result < 0)
+		{
+			inFlight--;
+			finish(request, false);
+		}
+		else
+		{
+			request->bytesRead += static_cast<size_t>(result);
+
+			// Short reads continue, unless the end of the file is reached.
+			if (result > 0 && request->bytesRead < request->size)
+			{
+				started.push_back(request);
+			}
+			else
+			{
+				inFlight--;
+				finish(request, request->bytesRead == request->size);
+			}
+		}
+	}
+
+	__atomic_store_n(completionHead, head, __ATOMIC_RELEASE);
+
+	for (Request* request : started)
+	{
+		queueRead(request);
+	}
+
+	while (inFlight < entries && waiting.size() > 0)
+	{
+		Request* request = waiting.front();
+		waiting.pop_front();
+
+		inFlight++;
+		queueRead(request);
+	}
+
+	// Threads waiting for another request check it again or take over reaping.
+	doneCondition.notify_all();
+#else
+	(void)lock;
+	(void)wait;
+#endif
+}
+
+void AsyncIO::finish(Request* request, bool success)
+{
+#if defined(TINYENGINE_IO_URING)
+	if (request->fileDescriptor >= 0)
+	{
+		close(request->fileDescriptor);
+		request->fileDescriptor = -1;
+	}
+#endif
+
+	request->done = true;
+	request->success = success;
+
+	doneCondition.notify_all();
+}
+
+void AsyncIO::run()
+{
+	while (true)
+	{
+		Request* request = nullptr;
+
+		{
+			std::unique_lock<std::mutex> lock(mutex);
+
+			startCondition.wait(lock, [&] { return stop || queue.size() > 0; });
+
+			if (queue.size() == 0)
+			{
+				return;
+			}
+
+			request = queue.front();
+			queue.pop_front();
+		}
+
+		bool success = readFile(*request);
+
+		{
+			std::unique_lock<std::mutex> lock(mutex);
+
+			finish(request, success);
+		}
+	}
+}
+
+bool AsyncIO::readFile(Request& request)
+{
+	std::ifstream file(request.filename, std::ios::binary);
+	if (!file.is_open())
+	{
+		return false;
+	}
+
+	if (request.output)
+	{
+		file.seekg(0, std::ios::end);
+		request.output->resize(static_cast<size_t>(file.tellg()));
+		request.buffer = reinterpret_cast<uint8_t*>(&(*request.output)[0]);
+		request.size = request.output->size();
+	}
+
+	file.seekg(static_cast<std::streamoff>(request.offset));
+	file.read(reinterpret_cast<char*>(request.buffer), static_cast<std::streamsize>(request.size));
+
+	request.bytesRead = static_cast<size_t>(file.gcount());
+
+	return request.bytesRead == request.size;
+}
+
+bool AsyncIO::readVirtual(Request& request)
+{
+	if (request.output)
+	{
+		return VirtualFile::open(*request.output, request.filename);
+	}
+
+	const uint8_t* data = nullptr;
+	size_t size = 0;
+	std::vector<uint8_t> buffer;
+	if (!VirtualFile::map(data, size, buffer, request.filename) || request.offset > size)
+	{
+		return false;
+	}
+
+	request.bytesRead = std::min(request.size, size - static_cast<size_t>(request.offset));
+	if (request.bytesRead > 0)
+	{
+		memcpy(request.buffer, data + request.offset, request.bytesRead);
+	}
+
+	return request.bytesRead == request.size;
+}
+
+uint64_t AsyncIO::submit(const std::string& filename, void* buffer, size_t size, uint64_t offset)
+{
+	std::unique_lock<std::mutex> lock(mutex);
+
+	uint64_t request = ++requestsCount;
+
+	std::unique_ptr<Request>& newRequest = requests[request];
+	newRequest = std::make_unique<Request>();
+	newRequest->filename = filename;
+	newRequest->buffer = static_cast<uint8_t*>(buffer);
+	newRequest->size = size;
+	newRequest->offset = offset;
+
+	if (VirtualFile::exists(filename))
+	{
+		finish(newRequest.get(), readVirtual(*newRequest));
+
+		return request;
+	}
+
+	start(newRequest.get());
+
+	return request;
+}
+
+uint64_t AsyncIO::submit(const std::string& filename, std::string& output)
+{
+	std::unique_lock<std::mutex> lock(mutex);
+
+	uint64_t request = ++requestsCount;
+
+	std::unique_ptr<Request>& newRequest = requests[request];
+	newRequest = std::make_unique<Request>();
+	newRequest->filename = filename;
+	newRequest->output = &output;
+
+	if (VirtualFile::exists(filename))
+	{
+		finish(newRequest.get(), readVirtual(*newRequest));
+
+		return request;
+	}
+
+	start(newRequest.get());
+
+	return request;
+}
+
+bool AsyncIO::complete(uint64_t request)
+{
+	std::unique_lock<std::mutex> lock(mutex);
+
+	auto it = requests.find(request);
+	if (it == requests.end())
+	{
+		return false;
+	}
+
+	Request* currentRequest = it->second.get();
+	while (!currentRequest->done)
+	{
+		if (ring >= 0)
+		{
+			reap(lock, true);
+		}
+		else
+		{
+			doneCondition.wait(lock);
+		}
+	}
+
+	bool success = currentRequest->success;
+
+	requests.erase(it);
+
+	return success;
+}
+
+bool AsyncIO::isUring() const
+{
+	return ring >= 0;
+}
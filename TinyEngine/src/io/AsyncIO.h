@@ -0,0 +1,118 @@
+#ifndef IO_ASYNCIO_H_
+#define IO_ASYNCIO_H_
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Asynchronous file reads with many requests in flight. Uses io_uring, if available, otherwise a pool of reading threads.
+// Files in a mounted archive are already mapped and copied, when submitted.
+class AsyncIO
+{
+private:
+
+	struct Request {
+		std::string filename = "";
+
+		// Either into the buffer of the caller or the whole file into the output.
+		uint8_t* buffer = nullptr;
+		size_t size = 0;
+		uint64_t offset = 0;
+		std::string* output = nullptr;
+
+		int fileDescriptor = -1;
+		size_t bytesRead = 0;
+
+		bool done = false;
+		bool success = false;
+	};
+
+	std::mutex mutex;
+	std::condition_variable doneCondition;
+
+	uint64_t requestsCount = 0;
+	std::map<uint64_t, std::unique_ptr<Request>> requests;
+
+	// Thread pool
+
+	std::vector<std::thread> threads;
+	std::condition_variable startCondition;
+	std::deque<Request*> queue;
+	bool stop = false;
+
+	// io_uring, if the ring is valid
+
+	int ring = -1;
+	uint32_t entries = 0;
+	uint32_t inFlight = 0;
+	std::deque<Request*> waiting;
+
+	// Only one thread reads the completion ring, while the others wait for it.
+	bool reaping = false;
+
+	void* submissionRing = nullptr;
+	size_t submissionRingSize = 0;
+	void* completionRing = nullptr;
+	size_t completionRingSize = 0;
+	void* submissionEntries = nullptr;
+	size_t submissionEntriesSize = 0;
+
+	uint32_t* submissionTail = nullptr;
+	uint32_t* submissionMask = nullptr;
+	uint32_t* submissionArray = nullptr;
+	uint32_t* completionHead = nullptr;
+	uint32_t* completionTail = nullptr;
+	uint32_t* completionMask = nullptr;
+	void* completionEntries = nullptr;
+
+	bool setupRing(uint32_t queueDepth);
+
+	void closeRing();
+
+	void start(Request* request);
+
+	// Once queued, a request is in flight until its completion arrives.
+	void queueRead(Request* request);
+
+	// Waits without the lock, so other threads keep submitting and completing meanwhile.
+	void reap(std::unique_lock<std::mutex>& lock, bool wait);
+
+	void finish(Request* request, bool success);
+
+	void run();
+
+	static bool readFile(Request& request);
+
+	static bool readVirtual(Request& request);
+
+public:
+
+	// Zero threads for the fallback uses four threads.
+	AsyncIO(uint32_t queueDepth = 64, uint32_t threadsCount = 0);
+
+	~AsyncIO();
+
+	AsyncIO(const AsyncIO&) = delete;
+	AsyncIO& operator=(const AsyncIO&) = delete;
+
+	// Reads size bytes at the offset into the buffer of the caller, which has to stay valid until completed.
+	uint64_t submit(const std::string& filename, void* buffer, size_t size, uint64_t offset = 0);
+
+	// Reads the whole file into the output, which must not be accessed until completed.
+	uint64_t submit(const std::string& filename, std::string& output);
+
+	// Waits for the request and returns, if all bytes were read. Every request has to be completed once.
+	bool complete(uint64_t request);
+
+	bool isUring() const;
+
+};
+
+#endif /* IO_ASYNCIO_H_ */
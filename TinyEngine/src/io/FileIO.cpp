@@ -2,8 +2,15 @@
 
 #include <fstream>
 
+#include "VirtualFile.h"
+
 bool FileIO::open(std::string& output, const std::string& filename)
 {
+	if (VirtualFile::exists(filename))
+	{
+		return VirtualFile::open(output, filename);
+	}
+
 	std::ifstream file(filename, std::ios::ate | std::ios::binary);
 	if (!file.is_open())
 	{
@@ -20,3 +27,17 @@ bool FileIO::open(std::string& output, const std::string& filename)
 
 	return true;
 }
+
+bool FileIO::save(const std::string& output, const std::string& filename)
+{
+	std::ofstream file(filename, std::ios::binary);
+	if (!file.is_open())
+	{
+		return false;
+	}
+
+	file.write(output.data(), output.size());
+	file.close();
+
+	return !file.fail();
+}
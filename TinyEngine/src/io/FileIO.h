@@ -9,6 +9,8 @@ public:
 
 	static bool open(std::string& output, const std::string& filename);
 
+	static bool save(const std::string& output, const std::string& filename);
+
 };
 
 #endif /* IO_FILEIO_H_ */
@@ -0,0 +1,419 @@
+#include "HelperBlockCompression.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#include "HelperFormat.h"
+
+// Interpolation weights of BC7 with four bit indices.
+static const int32_t BC7_WEIGHTS[16] = {0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64};
+
+static void writeBits(uint8_t* block, uint32_t& offset, uint32_t value, uint32_t count)
+{
+	for (uint32_t i = 0; i < count; i++)
+	{
+		if ((value >> i) & 1)
+		{
+			block[(offset + i) >> 3] |= static_cast<uint8_t>(1 << ((offset + i) & 7));
+		}
+	}
+	offset += count;
+}
+
+// Eight interpolated values between the maximum and minimum of the block.
+static void encodeBC4Block(uint8_t* output, const uint8_t* pixels, uint32_t channel)
+{
+	int32_t maximum = 0;
+	int32_t minimum = 255;
+	for (uint32_t i = 0; i < 16; i++)
+	{
+		maximum = std::max(maximum, static_cast<int32_t>(pixels[i * 4 + channel]));
+		minimum = std::min(minimum, static_cast<int32_t>(pixels[i * 4 + channel]));
+	}
+
+	memset(output, 0, 8);
+	output[0] = static_cast<uint8_t>(maximum);
+	output[1] = static_cast<uint8_t>(minimum);
+
+	if (maximum == minimum)
+	{
+		return;
+	}
+
+	int32_t palette[8];
+	palette[0] = maximum;
+	palette[1] = minimum;
+	for (int32_t i = 2; i < 8; i++)
+	{
+		palette[i] = ((8 - i) * maximum + (i - 1) * minimum + 3) / 7;
+	}
+
+	uint64_t indices = 0;
+	for (uint32_t i = 0; i < 16; i++)
+	{
+		int32_t value = pixels[i * 4 + channel];
+
+		uint64_t bestIndex = 0;
+		int32_t bestError = 256;
+		for (uint32_t k = 0; k < 8; k++)
+		{
+			int32_t error = std::abs(palette[k] - value);
+			if (error < bestError)
+			{
+				bestIndex = k;
+				bestError = error;
+			}
+		}
+
+		indices |= bestIndex << (3 * i);
+	}
+
+	for (uint32_t i = 0; i < 6; i++)
+	{
+		output[2 + i] = static_cast<uint8_t>(indices >> (8 * i));
+	}
+}
+
+// Seven bits per channel plus a shared bit per endpoint, as stored in BC7 mode 6.
+static void quantizeEndpoint(int32_t quantized[4], uint32_t& pBit, const float endpoint[4], bool opaque)
+{
+	float bestError = 0.0f;
+
+	// Opaque blocks keep an alpha of 255, which needs the bit set.
+	for (uint32_t p = opaque ? 1 : 0; p < 2; p++)
+	{
+		int32_t candidate[4];
+		float error = 0.0f;
+		for (uint32_t c = 0; c < 4; c++)
+		{
+			int32_t value = static_cast<int32_t>(std::lround((endpoint[c] - static_cast<float>(p)) * 0.5f));
+			candidate[c] = std::min(std::max(value, 0), 127);
+
+			float difference = static_cast<float>(candidate[c] * 2 + static_cast<int32_t>(p)) - endpoint[c];
+			error += difference * difference;
+		}
+
+		if (p == (opaque ? 1u : 0u) || error < bestError)
+		{
+			bestError = error;
+			pBit = p;
+			memcpy(quantized, candidate, sizeof(candidate));
+		}
+	}
+}
+
+static int32_t evaluateBC7(uint32_t indices[16], const uint8_t* pixels, const int32_t endpoint0[4], const int32_t endpoint1[4])
+{
+	int32_t palette[16][4];
+	for (uint32_t k = 0; k < 16; k++)
+	{
+		for (uint32_t c = 0; c < 4; c++)
+		{
+			palette[k][c] = ((64 - BC7_WEIGHTS[k]) * endpoint0[c] + BC7_WEIGHTS[k] * endpoint1[c] + 32) >> 6;
+		}
+	}
+
+	int32_t totalError = 0;
+	for (uint32_t i = 0; i < 16; i++)
+	{
+		int32_t bestError = 0x7FFFFFFF;
+		for (uint32_t k = 0; k < 16; k++)
+		{
+			int32_t error = 0;
+			for (uint32_t c = 0; c < 4; c++)
+			{
+				int32_t difference = palette[k][c] - pixels[i * 4 + c];
+				error += difference * difference;
+			}
+
+			if (error < bestError)
+			{
+				bestError = error;
+				indices[i] = k;
+			}
+		}
+
+		totalError += bestError;
+	}
+
+	return totalError;
+}
+
+// Mode 6 with one subset: endpoints along the principal axis, refined by least squares on the chosen indices.
+static void encodeBC7Block(uint8_t* output, const uint8_t* pixels)
+{
+	bool opaque = true;
+
+	float mean[4] = {0.0f, 0.0f, 0.0f, 0.0f};
+	for (uint32_t i = 0; i < 16; i++)
+	{
+		for (uint32_t c = 0; c < 4; c++)
+		{
+			mean[c] += pixels[i * 4 + c];
+		}
+		opaque = opaque && pixels[i * 4 + 3] == 255;
+	}
+	for (uint32_t c = 0; c < 4; c++)
+	{
+		mean[c] /= 16.0f;
+	}
+
+	float covariance[4][4] = {};
+	for (uint32_t i = 0; i < 16; i++)
+	{
+		for (uint32_t r = 0; r < 4; r++)
+		{
+			for (uint32_t c = 0; c < 4; c++)
+			{
+				covariance[r][c] += (pixels[i * 4 + r] - mean[r]) * (pixels[i * 4 + c] - mean[c]);
+			}
+		}
+	}
+
+	// Power iteration with a fixed count, so the axis is the same on every run.
+	float axis[4] = {1.0f, 1.0f, 1.0f, 1.0f};
+	for (uint32_t iteration = 0; iteration < 8; iteration++)
+	{
+		float next[4] = {0.0f, 0.0f, 0.0f, 0.0f};
+		float length = 0.0f;
+		for (uint32_t r = 0; r < 4; r++)
+		{
+			for (uint32_t c = 0; c < 4; c++)
+			{
+				next[r] += covariance[r][c] * axis[c];
+			}
+			length = std::max(length, std::fabs(next[r]));
+		}
+
+		if (length < 1e-6f)
+		{
+			break;
+		}
+
+		for (uint32_t c = 0; c < 4; c++)
+		{
+			axis[c] = next[c] / length;
+		}
+	}
+
+	float axisLength = std::sqrt(axis[0] * axis[0] + axis[1] * axis[1] + axis[2] * axis[2] + axis[3] * axis[3]);
+	for (uint32_t c = 0; c < 4; c++)
+	{
+		axis[c] /= axisLength;
+	}
+
+	float minimum = 0.0f;
+	float maximum = 0.0f;
+	for (uint32_t i = 0; i < 16; i++)
+	{
+		float t = 0.0f;
+		for (uint32_t c = 0; c < 4; c++)
+		{
+			t += (pixels[i * 4 + c] - mean[c]) * axis[c];
+		}
+		minimum = std::min(minimum, t);
+		maximum = std::max(maximum, t);
+	}
+
+	float endpoints[2][4];
+	for (uint32_t c = 0; c < 4; c++)
+	{
+		endpoints[0][c] = std::min(std::max(mean[c] + minimum * axis[c], 0.0f), 255.0f);
+		endpoints[1][c] = std::min(std::max(mean[c] + maximum * axis[c], 0.0f), 255.0f);
+	}
+
+	int32_t bestQuantized[2][4];
+	uint32_t bestPBits[2];
+	uint32_t bestIndices[16];
+	int32_t bestError = 0x7FFFFFFF;
+
+	for (uint32_t iteration = 0; iteration < 3; iteration++)
+	{
+		int32_t quantized[2][4];
+		uint32_t pBits[2];
+		quantizeEndpoint(quantized[0], pBits[0], endpoints[0], opaque);
+		quantizeEndpoint(quantized[1], pBits[1], endpoints[1], opaque);
+
+		int32_t endpoint0[4];
+		int32_t endpoint1[4];
+		for (uint32_t c = 0; c < 4; c++)
+		{
+			endpoint0[c] = quantized[0][c] * 2 + static_cast<int32_t>(pBits[0]);
+			endpoint1[c] = quantized[1][c] * 2 + static_cast<int32_t>(pBits[1]);
+		}
+
+		uint32_t indices[16];
+		int32_t error = evaluateBC7(indices, pixels, endpoint0, endpoint1);
+		if (error < bestError)
+		{
+			bestError = error;
+			memcpy(bestQuantized, quantized, sizeof(quantized));
+			memcpy(bestPBits, pBits, sizeof(pBits));
+			memcpy(bestIndices, indices, sizeof(indices));
+		}
+
+		if (bestError == 0)
+		{
+			break;
+		}
+
+		// Least squares fit of both endpoints for the current indices.
+		float a = 0.0f;
+		float b = 0.0f;
+		float d = 0.0f;
+		float sum0[4] = {0.0f, 0.0f, 0.0f, 0.0f};
+		float sum1[4] = {0.0f, 0.0f, 0.0f, 0.0f};
+		for (uint32_t i = 0; i < 16; i++)
+		{
+			float w = BC7_WEIGHTS[indices[i]] / 64.0f;
+
+			a += (1.0f - w) * (1.0f - w);
+			b += (1.0f - w) * w;
+			d += w * w;
+			for (uint32_t c = 0; c < 4; c++)
+			{
+				sum0[c] += (1.0f - w) * pixels[i * 4 + c];
+				sum1[c] += w * pixels[i * 4 + c];
+			}
+		}
+
+		float determinant = a * d - b * b;
+		if (std::fabs(determinant) < 1e-6f)
+		{
+			break;
+		}
+
+		for (uint32_t c = 0; c < 4; c++)
+		{
+			endpoints[0][c] = std::min(std::max((d * sum0[c] - b * sum1[c]) / determinant, 0.0f), 255.0f);
+			endpoints[1][c] = std::min(std::max((a * sum1[c] - b * sum0[c]) / determinant, 0.0f), 255.0f);
+		}
+	}
+
+	// The most significant bit of the first index is implied to be zero.
+	if (bestIndices[0] >= 8)
+	{
+		for (uint32_t c = 0; c < 4; c++)
+		{
+			std::swap(bestQuantized[0][c], bestQuantized[1][c]);
+		}
+		std::swap(bestPBits[0], bestPBits[1]);
+
+		for (uint32_t i = 0; i < 16; i++)
+		{
+			bestIndices[i] = 15 - bestIndices[i];
+		}
+	}
+
+	memset(output, 0, 16);
+
+	uint32_t offset = 0;
+	writeBits(output, offset, 1 << 6, 7);
+	for (uint32_t c = 0; c < 4; c++)
+	{
+		writeBits(output, offset, static_cast<uint32_t>(bestQuantized[0][c]), 7);
+		writeBits(output, offset, static_cast<uint32_t>(bestQuantized[1][c]), 7);
+	}
+	writeBits(output, offset, bestPBits[0], 1);
+	writeBits(output, offset, bestPBits[1], 1);
+	for (uint32_t i = 0; i < 16; i++)
+	{
+		writeBits(output, offset, bestIndices[i], i == 0 ? 3 : 4);
+	}
+}
+
+bool HelperBlockCompression::encode(ImageDataResources& output, const ImageDataResources& input, VkFormat format, WorkerPool* workerPool)
+{
+	if (format != VK_FORMAT_BC4_UNORM_BLOCK && format != VK_FORMAT_BC5_UNORM_BLOCK && format != VK_FORMAT_BC7_UNORM_BLOCK)
+	{
+		return false;
+	}
+
+	if (input.images.size() != input.mipLevels * input.faceCount)
+	{
+		return false;
+	}
+
+	for (const ImageDataResource& image : input.images)
+	{
+		if ((image.format != VK_FORMAT_R8G8B8A8_UNORM && image.format != VK_FORMAT_R8G8B8A8_SRGB) || image.pixels.size() != static_cast<size_t>(image.width) * image.height * 4)
+		{
+			return false;
+		}
+	}
+
+	uint32_t blockWidth = 0;
+	uint32_t blockHeight = 0;
+	uint32_t blockSize = 0;
+	HelperFormat::getBlockInfo(blockWidth, blockHeight, blockSize, format);
+
+	output.images.clear();
+	output.images.resize(input.images.size());
+	output.mipLevels = input.mipLevels;
+	output.faceCount = input.faceCount;
+
+	for (size_t i = 0; i < input.images.size(); i++)
+	{
+		const ImageDataResource& source = input.images[i];
+		ImageDataResource& destination = output.images[i];
+
+		destination.width = source.width;
+		destination.height = source.height;
+		destination.format = format;
+		destination.mipLevel = source.mipLevel;
+		destination.face = source.face;
+
+		uint32_t blocksX = (source.width + blockWidth - 1) / blockWidth;
+		uint32_t blocksY = (source.height + blockHeight - 1) / blockHeight;
+		destination.pixels.resize(static_cast<size_t>(blocksX) * blocksY * blockSize);
+
+		auto encodeRows = [&](size_t begin, size_t end) {
+			uint8_t pixels[16 * 4];
+
+			for (size_t blockY = begin; blockY < end; blockY++)
+			{
+				for (uint32_t blockX = 0; blockX < blocksX; blockX++)
+				{
+					// Partial blocks at the border repeat the last row and column.
+					for (uint32_t y = 0; y < 4; y++)
+					{
+						uint32_t sourceY = std::min(static_cast<uint32_t>(blockY) * 4 + y, source.height - 1);
+						for (uint32_t x = 0; x < 4; x++)
+						{
+							uint32_t sourceX = std::min(blockX * 4 + x, source.width - 1);
+
+							memcpy(&pixels[(y * 4 + x) * 4], &source.pixels[(static_cast<size_t>(sourceY) * source.width + sourceX) * 4], 4);
+						}
+					}
+
+					uint8_t* block = &destination.pixels[(blockY * blocksX + blockX) * blockSize];
+					switch (format)
+					{
+						case VK_FORMAT_BC4_UNORM_BLOCK:
+							encodeBC4Block(block, pixels, 0);
+							break;
+						case VK_FORMAT_BC5_UNORM_BLOCK:
+							encodeBC4Block(block, pixels, 0);
+							encodeBC4Block(block + 8, pixels, 1);
+							break;
+						default:
+							encodeBC7Block(block, pixels);
+							break;
+					}
+				}
+			}
+		};
+
+		if (workerPool)
+		{
+			workerPool->parallelFor(blocksY, encodeRows, 4);
+		}
+		else
+		{
+			encodeRows(0, blocksY);
+		}
+	}
+
+	return true;
+}
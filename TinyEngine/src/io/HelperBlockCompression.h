@@ -0,0 +1,22 @@
+#ifndef IO_HELPERBLOCKCOMPRESSION_H_
+#define IO_HELPERBLOCKCOMPRESSION_H_
+
+#include <cstdint>
+
+#include "ImageDataResources.h"
+
+// Encodes 8 bit RGBA images into BC4, BC5 or BC7 blocks on the CPU.
+// Every block is encoded on its own with the same arithmetic, so the result does not depend on the threads.
+class HelperBlockCompression
+{
+public:
+
+	// Changes, whenever the encoded blocks change, so cached results can be checked.
+	static constexpr uint32_t VERSION = 2;
+
+	// BC4 keeps red, BC5 red and green and BC7 all channels. All images and levels of the input are encoded.
+	static bool encode(ImageDataResources& output, const ImageDataResources& input, VkFormat format, WorkerPool* workerPool = nullptr);
+
+};
+
+#endif /* IO_HELPERBLOCKCOMPRESSION_H_ */
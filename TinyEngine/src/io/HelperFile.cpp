@@ -2,6 +2,15 @@
 
 #include <algorithm>
 #include <cstdio>
+#include <vector>
+
+#if defined(_WIN32)
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+#include "VirtualFile.h"
 
 std::string HelperFile::getPath(const std::string& filename)
 {
@@ -33,8 +42,56 @@ std::string HelperFile::getExtension(const std::string& filename)
 	return "";
 }
 
+std::string HelperFile::normalize(const std::string& filename)
+{
+	std::vector<std::string> parts;
+
+	size_t start = 0;
+	while (start <= filename.size())
+	{
+		size_t end = filename.find_first_of("/\\", start);
+		if (end == std::string::npos)
+		{
+			end = filename.size();
+		}
+
+		std::string part = filename.substr(start, end - start);
+		if (part == "..")
+		{
+			// Leading parent directories can not be resolved.
+			if (parts.size() > 0 && parts.back() != ".." && parts.back() != "")
+			{
+				parts.pop_back();
+			}
+			else
+			{
+				parts.push_back(part);
+			}
+		}
+		else if (part != "." && (part != "" || parts.size() == 0))
+		{
+			parts.push_back(part);
+		}
+
+		start = end + 1;
+	}
+
+	std::string result = "";
+	for (size_t i = 0; i < parts.size(); i++)
+	{
+		result += (i > 0 ? "/" : "") + parts[i];
+	}
+
+	return result;
+}
+
 bool HelperFile::exists(const std::string& filename)
 {
+	if (VirtualFile::exists(filename))
+	{
+		return true;
+	}
+
 	FILE* file = fopen(filename.c_str(), "rb");
 
 	if (file)
@@ -46,3 +103,13 @@ bool HelperFile::exists(const std::string& filename)
 	return false;
 }
 
+bool HelperFile::isWritable(const std::string& path)
+{
+	std::string directory = (path == "") ? "." : path;
+
+#if defined(_WIN32)
+	return _access(directory.c_str(), 2) == 0;
+#else
+	return access(directory.c_str(), W_OK) == 0;
+#endif
+}
@@ -10,7 +10,14 @@ public:
 
 	static std::string getExtension(const std::string& filename);
 
+	// Resolves '.' and '..' and uses '/' as separator.
+	static std::string normalize(const std::string& filename);
+
+	// Also true for files in a mounted archive.
 	static bool exists(const std::string& filename);
+
+	// False for directories, which only exist in a mounted archive. An empty path is the working directory.
+	static bool isWritable(const std::string& path);
 };
 
 #endif /* IO_HELPERFILE_H_ */
@@ -0,0 +1,176 @@
+#include "HelperFormat.h"
+
+bool HelperFormat::isBlockCompressed(VkFormat format)
+{
+	uint32_t blockWidth = 0;
+	uint32_t blockHeight = 0;
+	uint32_t blockSize = 0;
+
+	return getBlockInfo(blockWidth, blockHeight, blockSize, format);
+}
+
+bool HelperFormat::getBlockInfo(uint32_t& blockWidth, uint32_t& blockHeight, uint32_t& blockSize, VkFormat format)
+{
+	blockWidth = 4;
+	blockHeight = 4;
+	blockSize = 16;
+
+	switch (format)
+	{
+		case VK_FORMAT_BC1_RGB_UNORM_BLOCK:
+		case VK_FORMAT_BC1_RGB_SRGB_BLOCK:
+		case VK_FORMAT_BC1_RGBA_UNORM_BLOCK:
+		case VK_FORMAT_BC1_RGBA_SRGB_BLOCK:
+		case VK_FORMAT_BC4_UNORM_BLOCK:
+		case VK_FORMAT_BC4_SNORM_BLOCK:
+			blockSize = 8;
+			return true;
+		case VK_FORMAT_BC2_UNORM_BLOCK:
+		case VK_FORMAT_BC2_SRGB_BLOCK:
+		case VK_FORMAT_BC3_UNORM_BLOCK:
+		case VK_FORMAT_BC3_SRGB_BLOCK:
+		case VK_FORMAT_BC5_UNORM_BLOCK:
+		case VK_FORMAT_BC5_SNORM_BLOCK:
+		case VK_FORMAT_BC6H_UFLOAT_BLOCK:
+		case VK_FORMAT_BC6H_SFLOAT_BLOCK:
+		case VK_FORMAT_BC7_UNORM_BLOCK:
+		case VK_FORMAT_BC7_SRGB_BLOCK:
+		case VK_FORMAT_ASTC_4x4_UNORM_BLOCK:
+		case VK_FORMAT_ASTC_4x4_SRGB_BLOCK:
+			return true;
+		case VK_FORMAT_ASTC_5x4_UNORM_BLOCK:
+		case VK_FORMAT_ASTC_5x4_SRGB_BLOCK:
+			blockWidth = 5;
+			return true;
+		case VK_FORMAT_ASTC_5x5_UNORM_BLOCK:
+		case VK_FORMAT_ASTC_5x5_SRGB_BLOCK:
+			blockWidth = 5;
+			blockHeight = 5;
+			return true;
+		case VK_FORMAT_ASTC_6x5_UNORM_BLOCK:
+		case VK_FORMAT_ASTC_6x5_SRGB_BLOCK:
+			blockWidth = 6;
+			blockHeight = 5;
+			return true;
+		case VK_FORMAT_ASTC_6x6_UNORM_BLOCK:
+		case VK_FORMAT_ASTC_6x6_SRGB_BLOCK:
+			blockWidth = 6;
+			blockHeight = 6;
+			return true;
+		case VK_FORMAT_ASTC_8x5_UNORM_BLOCK:
+		case VK_FORMAT_ASTC_8x5_SRGB_BLOCK:
+			blockWidth = 8;
+			blockHeight = 5;
+			return true;
+		case VK_FORMAT_ASTC_8x6_UNORM_BLOCK:
+		case VK_FORMAT_ASTC_8x6_SRGB_BLOCK:
+			blockWidth = 8;
+			blockHeight = 6;
+			return true;
+		case VK_FORMAT_ASTC_8x8_UNORM_BLOCK:
+		case VK_FORMAT_ASTC_8x8_SRGB_BLOCK:
+			blockWidth = 8;
+			blockHeight = 8;
+			return true;
+		case VK_FORMAT_ASTC_10x5_UNORM_BLOCK:
+		case VK_FORMAT_ASTC_10x5_SRGB_BLOCK:
+			blockWidth = 10;
+			blockHeight = 5;
+			return true;
+		case VK_FORMAT_ASTC_10x6_UNORM_BLOCK:
+		case VK_FORMAT_ASTC_10x6_SRGB_BLOCK:
+			blockWidth = 10;
+			blockHeight = 6;
+			return true;
+		case VK_FORMAT_ASTC_10x8_UNORM_BLOCK:
+		case VK_FORMAT_ASTC_10x8_SRGB_BLOCK:
+			blockWidth = 10;
+			blockHeight = 8;
+			return true;
+		case VK_FORMAT_ASTC_10x10_UNORM_BLOCK:
+		case VK_FORMAT_ASTC_10x10_SRGB_BLOCK:
+			blockWidth = 10;
+			blockHeight = 10;
+			return true;
+		case VK_FORMAT_ASTC_12x10_UNORM_BLOCK:
+		case VK_FORMAT_ASTC_12x10_SRGB_BLOCK:
+			blockWidth = 12;
+			blockHeight = 10;
+			return true;
+		case VK_FORMAT_ASTC_12x12_UNORM_BLOCK:
+		case VK_FORMAT_ASTC_12x12_SRGB_BLOCK:
+			blockWidth = 12;
+			blockHeight = 12;
+			return true;
+		default:
+			break;
+	}
+
+	blockWidth = 0;
+	blockHeight = 0;
+	blockSize = 0;
+
+	return false;
+}
+
+size_t HelperFormat::getImageSize(VkFormat format, uint32_t width, uint32_t height)
+{
+	uint32_t blockWidth = 0;
+	uint32_t blockHeight = 0;
+	uint32_t blockSize = 0;
+	if (!getBlockInfo(blockWidth, blockHeight, blockSize, format))
+	{
+		return 0;
+	}
+
+	// Partial blocks at the border are stored as whole blocks.
+	size_t blocksX = (static_cast<size_t>(width) + blockWidth - 1) / blockWidth;
+	size_t blocksY = (static_cast<size_t>(height) + blockHeight - 1) / blockHeight;
+
+	return blocksX * blocksY * blockSize;
+}
+
+VkFormat HelperFormat::getUnormFormat(VkFormat format)
+{
+	switch (format)
+	{
+		case VK_FORMAT_R8G8B8A8_SRGB:
+			return VK_FORMAT_R8G8B8A8_UNORM;
+		case VK_FORMAT_BC1_RGB_SRGB_BLOCK:
+			return VK_FORMAT_BC1_RGB_UNORM_BLOCK;
+		case VK_FORMAT_BC1_RGBA_SRGB_BLOCK:
+			return VK_FORMAT_BC1_RGBA_UNORM_BLOCK;
+		case VK_FORMAT_BC2_SRGB_BLOCK:
+			return VK_FORMAT_BC2_UNORM_BLOCK;
+		case VK_FORMAT_BC3_SRGB_BLOCK:
+			return VK_FORMAT_BC3_UNORM_BLOCK;
+		case VK_FORMAT_BC7_SRGB_BLOCK:
+			return VK_FORMAT_BC7_UNORM_BLOCK;
+		default:
+			break;
+	}
+
+	// ASTC formats alternate between UNORM and SRGB.
+	if (format >= VK_FORMAT_ASTC_4x4_UNORM_BLOCK && format <= VK_FORMAT_ASTC_12x12_SRGB_BLOCK && (format - VK_FORMAT_ASTC_4x4_UNORM_BLOCK) % 2 == 1)
+	{
+		return static_cast<VkFormat>(format - 1);
+	}
+
+	return format;
+}
+
+size_t HelperFormat::getUncompressedSize(VkFormat format, size_t size)
+{
+	uint32_t blockWidth = 0;
+	uint32_t blockHeight = 0;
+	uint32_t blockSize = 0;
+	if (!getBlockInfo(blockWidth, blockHeight, blockSize, format))
+	{
+		return size;
+	}
+
+	// BC6H would be half float RGBA, all others RGBA8.
+	size_t pixelSize = (format == VK_FORMAT_BC6H_UFLOAT_BLOCK || format == VK_FORMAT_BC6H_SFLOAT_BLOCK) ? 8 : 4;
+
+	return size * pixelSize * blockWidth * blockHeight / blockSize;
+}
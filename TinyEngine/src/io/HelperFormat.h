@@ -0,0 +1,29 @@
+#ifndef IO_HELPERFORMAT_H_
+#define IO_HELPERFORMAT_H_
+
+#include <cstddef>
+#include <cstdint>
+
+#include "../common/Common.h"
+
+// Block layout of the BCn and ASTC formats.
+class HelperFormat
+{
+public:
+
+	static bool isBlockCompressed(VkFormat format);
+
+	static bool getBlockInfo(uint32_t& blockWidth, uint32_t& blockHeight, uint32_t& blockSize, VkFormat format);
+
+	// Size of one image in bytes, zero if the format is not block compressed.
+	static size_t getImageSize(VkFormat format, uint32_t width, uint32_t height);
+
+	// Same layout, but without the sRGB decode on sampling.
+	static VkFormat getUnormFormat(VkFormat format);
+
+	// Bytes, if the image would be uploaded uncompressed instead.
+	static size_t getUncompressedSize(VkFormat format, size_t size);
+
+};
+
+#endif /* IO_HELPERFORMAT_H_ */
@@ -0,0 +1,452 @@
+#include "HelperMipMap.h"
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+// Kaiser windowed sinc with a radius of two target pixels.
+static const float KAISER_RADIUS = 2.0f;
+static const float KAISER_ALPHA = 4.0f;
+
+static const float PI = 3.14159265358979f;
+
+struct FilterTap {
+	uint32_t index = 0;
+	float weight = 0.0f;
+};
+
+static float besselI0(float x)
+{
+	float sum = 1.0f;
+	float term = 1.0f;
+	for (uint32_t k = 1; k < 20; k++)
+	{
+		float factor = x / (2.0f * static_cast<float>(k));
+		term *= factor * factor;
+		sum += term;
+	}
+
+	return sum;
+}
+
+static float kaiser(float t)
+{
+	if (std::fabs(t) >= KAISER_RADIUS)
+	{
+		return 0.0f;
+	}
+
+	float x = t / KAISER_RADIUS;
+	float window = besselI0(KAISER_ALPHA * std::sqrt(1.0f - x * x)) / besselI0(KAISER_ALPHA);
+
+	if (std::fabs(t) < 1e-6f)
+	{
+		return window;
+	}
+
+	return window * std::sin(PI * t) / (PI * t);
+}
+
+static const float* getLinearTable()
+{
+	static const std::vector<float> table = []() {
+		std::vector<float> result(256);
+		for (uint32_t i = 0; i < 256; i++)
+		{
+			float value = static_cast<float>(i) / 255.0f;
+			result[i] = (value <= 0.04045f) ? value / 12.92f : std::pow((value + 0.055f) / 1.055f, 2.4f);
+		}
+		return result;
+	}();
+
+	return table.data();
+}
+
+// Linear values are looked up with 12 bit precision.
+static const uint8_t* getSrgbTable()
+{
+	static const std::vector<uint8_t> table = []() {
+		std::vector<uint8_t> result(4096);
+		for (uint32_t i = 0; i < 4096; i++)
+		{
+			float value = static_cast<float>(i) / 4095.0f;
+			float srgb = (value <= 0.0031308f) ? value * 12.92f : 1.055f * std::pow(value, 1.0f / 2.4f) - 0.055f;
+			result[i] = static_cast<uint8_t>(std::lround(std::min(std::max(srgb, 0.0f), 1.0f) * 255.0f));
+		}
+		return result;
+	}();
+
+	return table.data();
+}
+
+static float getCoverage(const std::vector<float>& pixels, float alphaCutoff, float alphaScale)
+{
+	size_t count = pixels.size() / 4;
+	if (count == 0)
+	{
+		return 0.0f;
+	}
+
+	size_t passed = 0;
+	for (size_t i = 0; i < count; i++)
+	{
+		if (std::min(pixels[i * 4 + 3] * alphaScale, 1.0f) >= alphaCutoff)
+		{
+			passed++;
+		}
+	}
+
+	return static_cast<float>(passed) / static_cast<float>(count);
+}
+
+// Coverage grows with the scale, so it is found by bisection. Whichever bound is closer wins, as coverage changes in steps.
+static float getAlphaScale(const std::vector<float>& pixels, float alphaCutoff, float coverage)
+{
+	float low = 0.0f;
+	float high = 1.0f;
+	while (getCoverage(pixels, alphaCutoff, high) < coverage && high < 256.0f)
+	{
+		high *= 2.0f;
+	}
+
+	for (uint32_t i = 0; i < 16; i++)
+	{
+		float middle = 0.5f * (low + high);
+		if (getCoverage(pixels, alphaCutoff, middle) < coverage)
+		{
+			low = middle;
+		}
+		else
+		{
+			high = middle;
+		}
+	}
+
+	if (coverage - getCoverage(pixels, alphaCutoff, low) < getCoverage(pixels, alphaCutoff, high) - coverage)
+	{
+		return low;
+	}
+
+	return high;
+}
+
+// Sum of the weighted pixels, which are four floats each and the given count of floats apart.
+static void filterPixel(float* target, const float* source, size_t stride, const FilterTap* tap, uint32_t count)
+{
+#if defined(__SSE2__)
+	__m128 sum = _mm_setzero_ps();
+	for (uint32_t i = 0; i < count; i++)
+	{
+		sum = _mm_add_ps(sum, _mm_mul_ps(_mm_loadu_ps(source + tap[i].index * stride), _mm_set1_ps(tap[i].weight)));
+	}
+	_mm_storeu_ps(target, sum);
+#else
+	float sum[4] = {0.0f, 0.0f, 0.0f, 0.0f};
+	for (uint32_t i = 0; i < count; i++)
+	{
+		for (uint32_t c = 0; c < 4; c++)
+		{
+			sum[c] += source[tap[i].index * stride + c] * tap[i].weight;
+		}
+	}
+	for (uint32_t c = 0; c < 4; c++)
+	{
+		target[c] = sum[c];
+	}
+#endif
+}
+
+// Taps of each target pixel along one axis, normalized to a sum of one.
+static void getFilterTaps(std::vector<FilterTap>& taps, std::vector<uint32_t>& tapOffsets, uint32_t sourceSize, uint32_t targetSize, MipMapFilter filter)
+{
+	taps.clear();
+	tapOffsets.assign(targetSize + 1, 0);
+
+	float scale = static_cast<float>(sourceSize) / static_cast<float>(targetSize);
+
+	for (uint32_t x = 0; x < targetSize; x++)
+	{
+		tapOffsets[x] = static_cast<uint32_t>(taps.size());
+
+		if (sourceSize == targetSize)
+		{
+			taps.push_back({x, 1.0f});
+
+			continue;
+		}
+
+		float center = (static_cast<float>(x) + 0.5f) * scale;
+		float radius = (filter == MipMapFilter_KAISER) ? KAISER_RADIUS * scale : 0.5f * scale;
+
+		int32_t first = static_cast<int32_t>(std::floor(center - radius));
+		int32_t last = static_cast<int32_t>(std::ceil(center + radius));
+
+		float sum = 0.0f;
+		for (int32_t i = first; i <= last; i++)
+		{
+			float weight = 0.0f;
+			if (filter == MipMapFilter_KAISER)
+			{
+				weight = kaiser((static_cast<float>(i) + 0.5f - center) / scale);
+			}
+			else
+			{
+				// Area of the source pixel inside the target pixel.
+				weight = std::max(std::min(static_cast<float>(i + 1), center + radius) - std::max(static_cast<float>(i), center - radius), 0.0f);
+			}
+
+			if (weight == 0.0f)
+			{
+				continue;
+			}
+
+			// Borders are clamped, so outside pixels add to the edge.
+			uint32_t index = static_cast<uint32_t>(std::min(std::max(i, 0), static_cast<int32_t>(sourceSize) - 1));
+			taps.push_back({index, weight});
+			sum += weight;
+		}
+
+		for (uint32_t i = tapOffsets[x]; i < taps.size(); i++)
+		{
+			taps[i].weight /= sum;
+		}
+	}
+
+	tapOffsets[targetSize] = static_cast<uint32_t>(taps.size());
+}
+
+void HelperMipMap::generateBox(ImageDataResources& output, uint32_t pixelSize)
+{
+	for (uint32_t level = 1; level < output.mipLevels; level++)
+	{
+		const ImageDataResource& source = output.images[level - 1];
+		ImageDataResource& destination = output.images[level];
+
+		// Odd sizes clamp the second sample to the last row or column.
+		for (uint32_t y = 0; y < destination.height; y++)
+		{
+			uint32_t y0 = std::min(y * 2, source.height - 1);
+			uint32_t y1 = std::min(y * 2 + 1, source.height - 1);
+
+			const uint8_t* row0 = source.pixels.data() + static_cast<size_t>(y0) * source.width * pixelSize;
+			const uint8_t* row1 = source.pixels.data() + static_cast<size_t>(y1) * source.width * pixelSize;
+
+			uint8_t* target = destination.pixels.data() + static_cast<size_t>(y) * destination.width * pixelSize;
+
+			uint32_t x = 0;
+
+#if defined(__SSE2__)
+			// Two RGBA target pixels from four source pixels of both rows, with the same rounding as below.
+			if (pixelSize == 4)
+			{
+				const __m128i zero = _mm_setzero_si128();
+				const __m128i two = _mm_set1_epi16(2);
+
+				for (; x + 1 < destination.width && x * 2 + 3 < source.width; x += 2)
+				{
+					__m128i pixels0 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(row0 + x * 8));
+					__m128i pixels1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(row1 + x * 8));
+
+					__m128i low = _mm_add_epi16(_mm_unpacklo_epi8(pixels0, zero), _mm_unpacklo_epi8(pixels1, zero));
+					__m128i high = _mm_add_epi16(_mm_unpackhi_epi8(pixels0, zero), _mm_unpackhi_epi8(pixels1, zero));
+
+					low = _mm_add_epi16(low, _mm_srli_si128(low, 8));
+					high = _mm_add_epi16(high, _mm_srli_si128(high, 8));
+
+					__m128i sum = _mm_srli_epi16(_mm_add_epi16(_mm_unpacklo_epi64(low, high), two), 2);
+
+					_mm_storel_epi64(reinterpret_cast<__m128i*>(target + x * 4), _mm_packus_epi16(sum, zero));
+				}
+			}
+#endif
+
+			for (; x < destination.width; x++)
+			{
+				uint32_t x0 = std::min(x * 2, source.width - 1) * pixelSize;
+				uint32_t x1 = std::min(x * 2 + 1, source.width - 1) * pixelSize;
+
+				for (uint32_t c = 0; c < pixelSize; c++)
+				{
+					uint32_t sum = row0[x0 + c] + row0[x1 + c] + row1[x0 + c] + row1[x1 + c];
+
+					target[x * pixelSize + c] = static_cast<uint8_t>((sum + 2) / 4);
+				}
+			}
+		}
+	}
+}
+
+void HelperMipMap::generateFiltered(ImageDataResources& output, uint32_t pixelSize, const MipMapSettings& settings)
+{
+	const float* linearTable = getLinearTable();
+	const uint8_t* srgbTable = getSrgbTable();
+
+	// Only red, green and blue are color, alpha and the channels of smaller formats stay linear.
+	uint32_t srgbChannels = (settings.srgb && pixelSize >= 3) ? 3 : 0;
+	bool alphaTest = settings.alphaCutoff >= 0.0f && pixelSize == 4;
+
+	// Levels are filtered from the unquantized previous level, as four floats per pixel.
+	const ImageDataResource& base = output.images[0];
+
+	std::vector<float> current(static_cast<size_t>(base.width) * base.height * 4, 1.0f);
+	for (size_t i = 0; i < static_cast<size_t>(base.width) * base.height; i++)
+	{
+		for (uint32_t c = 0; c < pixelSize; c++)
+		{
+			uint8_t value = base.pixels[i * pixelSize + c];
+			current[i * 4 + c] = (c < srgbChannels) ? linearTable[value] : static_cast<float>(value) / 255.0f;
+		}
+	}
+
+	float coverage = alphaTest ? getCoverage(current, settings.alphaCutoff, 1.0f) : 0.0f;
+
+	std::vector<float> horizontal;
+	std::vector<float> next;
+	std::vector<FilterTap> tapsX;
+	std::vector<FilterTap> tapsY;
+	std::vector<uint32_t> tapOffsetsX;
+	std::vector<uint32_t> tapOffsetsY;
+
+	for (uint32_t level = 1; level < output.mipLevels; level++)
+	{
+		const ImageDataResource& source = output.images[level - 1];
+		ImageDataResource& destination = output.images[level];
+
+		getFilterTaps(tapsX, tapOffsetsX, source.width, destination.width, settings.filter);
+		getFilterTaps(tapsY, tapOffsetsY, source.height, destination.height, settings.filter);
+
+		// Separable, first along the rows, then along the columns.
+		horizontal.resize(static_cast<size_t>(destination.width) * source.height * 4);
+		for (uint32_t y = 0; y < source.height; y++)
+		{
+			const float* row = current.data() + static_cast<size_t>(y) * source.width * 4;
+			for (uint32_t x = 0; x < destination.width; x++)
+			{
+				filterPixel(&horizontal[(static_cast<size_t>(y) * destination.width + x) * 4], row, 4, &tapsX[tapOffsetsX[x]], tapOffsetsX[x + 1] - tapOffsetsX[x]);
+			}
+		}
+
+		next.resize(static_cast<size_t>(destination.width) * destination.height * 4);
+		for (uint32_t y = 0; y < destination.height; y++)
+		{
+			for (uint32_t x = 0; x < destination.width; x++)
+			{
+				filterPixel(&next[(static_cast<size_t>(y) * destination.width + x) * 4], &horizontal[static_cast<size_t>(x) * 4], static_cast<size_t>(destination.width) * 4, &tapsY[tapOffsetsY[y]], tapOffsetsY[y + 1] - tapOffsetsY[y]);
+			}
+		}
+
+		float alphaScale = alphaTest ? getAlphaScale(next, settings.alphaCutoff, coverage) : 1.0f;
+
+		for (size_t i = 0; i < static_cast<size_t>(destination.width) * destination.height; i++)
+		{
+			for (uint32_t c = 0; c < pixelSize; c++)
+			{
+				// Sharper filters overshoot, so the values are clamped.
+				float value = next[i * 4 + c];
+				if (alphaTest && c == 3)
+				{
+					value *= alphaScale;
+				}
+				value = std::min(std::max(value, 0.0f), 1.0f);
+
+				if (c < srgbChannels)
+				{
+					destination.pixels[i * pixelSize + c] = srgbTable[std::lround(value * 4095.0f)];
+				}
+				else
+				{
+					destination.pixels[i * pixelSize + c] = static_cast<uint8_t>(std::lround(value * 255.0f));
+				}
+			}
+		}
+
+		current.swap(next);
+	}
+}
+
+uint32_t HelperMipMap::getPixelSize(VkFormat format)
+{
+	switch (format)
+	{
+		case VK_FORMAT_R8_UNORM:
+			return 1;
+		case VK_FORMAT_R8G8_UNORM:
+			return 2;
+		case VK_FORMAT_R8G8B8_UNORM:
+			return 3;
+		case VK_FORMAT_R8G8B8A8_UNORM:
+		case VK_FORMAT_R8G8B8A8_SRGB:
+			return 4;
+		default:
+			break;
+	}
+
+	return 0;
+}
+
+uint32_t HelperMipMap::getMipLevels(uint32_t width, uint32_t height)
+{
+	uint32_t mipLevels = 1;
+
+	uint32_t size = std::max(width, height);
+	while (size > 1)
+	{
+		size >>= 1;
+		mipLevels++;
+	}
+
+	return mipLevels;
+}
+
+bool HelperMipMap::generate(ImageDataResources& output, const ImageDataResources& input, const MipMapSettings& settings)
+{
+	if (input.images.size() != 1 || input.mipLevels != 1 || input.faceCount != 1)
+	{
+		return false;
+	}
+
+	const ImageDataResource& base = input.images[0];
+
+	uint32_t pixelSize = getPixelSize(base.format);
+	if (pixelSize == 0 || base.width == 0 || base.height == 0 || base.pixels.size() != static_cast<size_t>(base.width) * base.height * pixelSize)
+	{
+		return false;
+	}
+
+	output.mipLevels = getMipLevels(base.width, base.height);
+	output.faceCount = 1;
+	output.images.resize(output.mipLevels);
+	output.images[0] = base;
+
+	for (uint32_t level = 1; level < output.mipLevels; level++)
+	{
+		ImageDataResource& destination = output.images[level];
+
+		destination.width = std::max(output.images[level - 1].width >> 1, 1u);
+		destination.height = std::max(output.images[level - 1].height >> 1, 1u);
+		destination.format = base.format;
+		destination.mipLevel = level;
+		destination.face = 0;
+		destination.mapped = nullptr;
+		destination.mappedSize = 0;
+		destination.pixels.resize(static_cast<size_t>(destination.width) * destination.height * pixelSize);
+	}
+
+	MipMapSettings currentSettings = settings;
+	currentSettings.srgb = settings.srgb || base.format == VK_FORMAT_R8G8B8A8_SRGB;
+
+	if (currentSettings.filter == MipMapFilter_BOX && !currentSettings.srgb && currentSettings.alphaCutoff < 0.0f)
+	{
+		generateBox(output, pixelSize);
+	}
+	else
+	{
+		generateFiltered(output, pixelSize, currentSettings);
+	}
+
+	return true;
+}
@@ -0,0 +1,44 @@
+#ifndef IO_HELPERMIPMAP_H_
+#define IO_HELPERMIPMAP_H_
+
+#include <cstdint>
+
+#include "ImageDataResources.h"
+
+enum MipMapFilter {
+	MipMapFilter_BOX = 0,
+	MipMapFilter_KAISER = 1
+};
+
+struct MipMapSettings {
+	MipMapFilter filter = MipMapFilter_BOX;
+
+	// Color channels are filtered in linear space and stored as sRGB again. Always done for sRGB formats.
+	bool srgb = false;
+
+	// Alpha is scaled per level, so the same share of pixels passes the alpha test as in the base level. Negative disables.
+	float alphaCutoff = -1.0f;
+};
+
+// Generates the full mip chain on the CPU, so it can be stored and uploaded in one go.
+class HelperMipMap
+{
+private:
+
+	static void generateBox(ImageDataResources& output, uint32_t pixelSize);
+
+	static void generateFiltered(ImageDataResources& output, uint32_t pixelSize, const MipMapSettings& settings);
+
+public:
+
+	// Bytes per pixel of the uncompressed 8 bit formats, zero if not supported.
+	static uint32_t getPixelSize(VkFormat format);
+
+	static uint32_t getMipLevels(uint32_t width, uint32_t height);
+
+	// Input has to be a single 8 bit image. The 2x2 box filter without sRGB and alpha test settings uses integers only.
+	static bool generate(ImageDataResources& output, const ImageDataResources& input, const MipMapSettings& settings = MipMapSettings());
+
+};
+
+#endif /* IO_HELPERMIPMAP_H_ */
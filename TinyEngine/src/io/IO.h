@@ -1,9 +1,17 @@
 #ifndef IO_IO_H_
 #define IO_IO_H_
 
+#include "AsyncIO.h"
 #include "FileIO.h"
+#include "HelperBlockCompression.h"
 #include "HelperFile.h"
+#include "HelperFormat.h"
+#include "HelperMipMap.h"
 #include "ImageDataIO.h"
 #include "ImageDataResources.h"
+#include "JsonReader.h"
+#include "MappedFile.h"
+#include "PackFile.h"
+#include "VirtualFile.h"
 
 #endif /* IO_IO_H_ */
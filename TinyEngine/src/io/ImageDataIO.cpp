@@ -1,5 +1,6 @@
 #include "ImageDataIO.h"
 
+#include <algorithm>
 #include <cstdio>
 
 #define STB_IMAGE_IMPLEMENTATION
@@ -11,24 +12,196 @@
 #include "DefaultAllocationCallback.h"
 #include "DefaultMemoryStreamCallback.h"
 
+#if defined(TINYENGINE_USE_ZSTD)
+#include <zstd.h>
+#endif
+
 #include "FileIO.h"
 #include "HelperFile.h"
+#include "HelperFormat.h"
+#include "MappedFile.h"
 
 using namespace ux3d;
 
-bool ImageDataIO::open(ImageDataResources& output, const uint8_t* data, size_t length, uint32_t channels)
+// KTX2 header fields, the index and the level index.
+static const size_t KTX2_HEADER_SIZE = 80;
+static const size_t KTX2_LEVEL_SIZE = 24;
+
+static const uint32_t KTX2_SUPERCOMPRESSION_NONE = 0;
+static const uint32_t KTX2_SUPERCOMPRESSION_ZSTD = 2;
+
+static const uint8_t KTX2_IDENTIFIER[12] = {
+  0xAB, 0x4B, 0x54, 0x58, 0x20, 0x32, 0x30, 0xBB, 0x0D, 0x0A, 0x1A, 0x0A
+};
+
+// Data format descriptor values of the block compressed color models.
+static const uint32_t KDF_MODEL_BC4 = 131;
+static const uint32_t KDF_MODEL_BC5 = 132;
+static const uint32_t KDF_MODEL_BC7 = 134;
+static const uint32_t KDF_PRIMARIES_BT709 = 1;
+static const uint32_t KDF_TRANSFER_LINEAR = 1;
+static const uint32_t KDF_TRANSFER_SRGB = 2;
+
+static void appendValue(std::string& output, uint32_t value)
 {
-	static uint8_t KTX2Identifier[12] = {
-	  0xAB, 0x4B, 0x54, 0x58, 0x20, 0x32, 0x30, 0xBB, 0x0D, 0x0A, 0x1A, 0x0A
-	};
+	output.append(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+static void appendPadding(std::string& output, size_t alignment)
+{
+	output.append((alignment - output.size() % alignment) % alignment, '\0');
+}
+
+bool ImageDataIO::openKtx2Blocks(ImageDataResources& output, const uint8_t* data, size_t length)
+{
+	if (length < KTX2_HEADER_SIZE)
+	{
+		return false;
+	}
+
+	uint32_t header[9];
+	memcpy(header, data + 12, sizeof(header));
+
+	VkFormat format = static_cast<VkFormat>(header[0]);
+	uint32_t width = header[2];
+	uint32_t height = header[3];
+	uint32_t depth = header[4];
+	uint32_t layerCount = header[5];
+	uint32_t faceCount = header[6];
+	uint32_t levelCount = std::max(header[7], 1u);
+	uint32_t supercompressionScheme = header[8];
+
+	if (format == VK_FORMAT_UNDEFINED || width == 0 || height == 0 || depth > 1 || layerCount > 1 || (faceCount != 1 && faceCount != 6) || levelCount > 32)
+	{
+		Logger::print(TinyEngine_ERROR, __FILE__, __LINE__, "KTX2 with format %u is not a single 2D image or cube map", static_cast<uint32_t>(format));
+
+		return false;
+	}
+
+	if (supercompressionScheme != KTX2_SUPERCOMPRESSION_NONE && supercompressionScheme != KTX2_SUPERCOMPRESSION_ZSTD)
+	{
+		Logger::print(TinyEngine_ERROR, __FILE__, __LINE__, "KTX2 supercompression %u is not supported", supercompressionScheme);
+
+		return false;
+	}
+
+#if !defined(TINYENGINE_USE_ZSTD)
+	if (supercompressionScheme == KTX2_SUPERCOMPRESSION_ZSTD)
+	{
+		Logger::print(TinyEngine_ERROR, __FILE__, __LINE__, "KTX2 is zstd supercompressed, but built without TINYENGINE_USE_ZSTD");
+
+		return false;
+	}
+#endif
+
+	if (KTX2_HEADER_SIZE + levelCount * KTX2_LEVEL_SIZE > length)
+	{
+		return false;
+	}
+
+	bool blockCompressed = HelperFormat::isBlockCompressed(format);
 
+	// Color textures are decoded to linear in the shader, as the PNG and JPEG ones, so sRGB blocks are sampled as UNORM.
+	if (blockCompressed)
+	{
+		format = HelperFormat::getUnormFormat(format);
+	}
+
+	output.images.clear();
+	output.mipLevels = levelCount;
+	output.faceCount = faceCount;
+	output.images.resize(levelCount * faceCount);
+
+	std::vector<uint8_t> levelData;
+
+	for (uint32_t level = 0; level < levelCount; level++)
+	{
+		uint64_t levelIndex[3];
+		memcpy(levelIndex, data + KTX2_HEADER_SIZE + level * KTX2_LEVEL_SIZE, sizeof(levelIndex));
+
+		uint64_t byteOffset = levelIndex[0];
+		uint64_t byteLength = levelIndex[1];
+		uint64_t uncompressedByteLength = levelIndex[2];
+
+		if (byteOffset > length || byteLength > length - byteOffset)
+		{
+			return false;
+		}
+
+		const uint8_t* levelPixels = data + byteOffset;
+		size_t levelSize = static_cast<size_t>(byteLength);
+
+		if (supercompressionScheme == KTX2_SUPERCOMPRESSION_ZSTD)
+		{
+#if defined(TINYENGINE_USE_ZSTD)
+			levelData.resize(static_cast<size_t>(uncompressedByteLength));
+
+			size_t result = ZSTD_decompress(levelData.data(), levelData.size(), levelPixels, levelSize);
+			if (ZSTD_isError(result) || result != levelData.size())
+			{
+				Logger::print(TinyEngine_ERROR, __FILE__, __LINE__, "Could not decompress KTX2 level %u", level);
+
+				return false;
+			}
+
+			levelPixels = levelData.data();
+			levelSize = levelData.size();
+#else
+			(void)uncompressedByteLength;
+#endif
+		}
+
+		uint32_t currentWidth = std::max(width >> level, 1u);
+		uint32_t currentHeight = std::max(height >> level, 1u);
+
+		// Faces are stored one after the other, without padding.
+		size_t imageSize = blockCompressed ? HelperFormat::getImageSize(format, currentWidth, currentHeight) : levelSize / faceCount;
+		if (imageSize == 0 || imageSize * faceCount > levelSize)
+		{
+			return false;
+		}
+
+		for (uint32_t face = 0; face < faceCount; face++)
+		{
+			ImageDataResource& imageDataResource = output.images[face + faceCount * level];
+
+			imageDataResource.width = currentWidth;
+			imageDataResource.height = currentHeight;
+			imageDataResource.format = format;
+			imageDataResource.mipLevel = level;
+			imageDataResource.face = face;
+			imageDataResource.pixels.assign(levelPixels + face * imageSize, levelPixels + (face + 1) * imageSize);
+		}
+	}
+
+	return true;
+}
+
+bool ImageDataIO::open(ImageDataResources& output, const uint8_t* data, size_t length, uint32_t channels)
+{
 	if (!data || length < 12)
 	{
 		return false;
 	}
 
-	if (memcmp(data, KTX2Identifier, 12) == 0)
+	if (memcmp(data, KTX2_IDENTIFIER, 12) == 0)
 	{
+		// Format and supercompression are read from the header, before anything else checks its size.
+		if (length < KTX2_HEADER_SIZE)
+		{
+			return false;
+		}
+
+		// slimktx2 only reads uncompressed images.
+		uint32_t vkFormat = 0;
+		uint32_t supercompressionScheme = 0;
+		memcpy(&vkFormat, data + 12, sizeof(vkFormat));
+		memcpy(&supercompressionScheme, data + 44, sizeof(supercompressionScheme));
+		if (HelperFormat::isBlockCompressed(static_cast<VkFormat>(vkFormat)) || supercompressionScheme != KTX2_SUPERCOMPRESSION_NONE)
+		{
+			return openKtx2Blocks(output, data, length);
+		}
+
 		slimktx2::DefaultMemoryStream defaultMemoryStream(data, length);
 
 		slimktx2::DefaultMemoryStreamCallback defaultMemoryStreamCallback;
@@ -135,19 +308,198 @@ bool ImageDataIO::open(ImageDataResources& output, const std::string& filename,
 		return false;
 	}
 
-	std::string binary = "";
-	if (!FileIO::open(binary, filename))
+	// Decoded from the mapping, so the file is not copied first.
+	MappedFile mappedFile;
+	if (!mappedFile.open(filename))
 	{
 		return false;
 	}
 
 	if (HelperFile::getExtension(filename) == "ktx2")
 	{
-		return open(output, (const uint8_t*)binary.data(), binary.length(), channels);
+		return open(output, mappedFile.getData(), mappedFile.getSize(), channels);
 	}
 	else if (HelperFile::getExtension(filename) == "png" || HelperFile::getExtension(filename) == "jpg" || HelperFile::getExtension(filename) == "jpeg")
 	{
-		return open(output, (const uint8_t*)binary.data(), binary.length(), channels);
+		return open(output, mappedFile.getData(), mappedFile.getSize(), channels);
+	}
+
+	return false;
+}
+
+bool ImageDataIO::save(const ImageDataResources& output, const std::string& filename, const std::map<std::string, std::string>& keyValues)
+{
+	if (output.images.empty() || output.images.size() != output.mipLevels * output.faceCount)
+	{
+		return false;
+	}
+
+	VkFormat format = output.images[0].format;
+
+	uint32_t colorModel = 0;
+	uint32_t transfer = KDF_TRANSFER_LINEAR;
+	switch (format)
+	{
+		case VK_FORMAT_BC4_UNORM_BLOCK:
+			colorModel = KDF_MODEL_BC4;
+			break;
+		case VK_FORMAT_BC5_UNORM_BLOCK:
+			colorModel = KDF_MODEL_BC5;
+			break;
+		case VK_FORMAT_BC7_SRGB_BLOCK:
+			transfer = KDF_TRANSFER_SRGB;
+			colorModel = KDF_MODEL_BC7;
+			break;
+		case VK_FORMAT_BC7_UNORM_BLOCK:
+			colorModel = KDF_MODEL_BC7;
+			break;
+		default:
+			Logger::print(TinyEngine_ERROR, __FILE__, __LINE__, "Saving KTX2 with format %u is not supported", static_cast<uint32_t>(format));
+			return false;
+	}
+
+	uint32_t blockWidth = 0;
+	uint32_t blockHeight = 0;
+	uint32_t blockSize = 0;
+	HelperFormat::getBlockInfo(blockWidth, blockHeight, blockSize, format);
+
+	for (const ImageDataResource& image : output.images)
+	{
+		if (image.format != format || image.pixels.size() != HelperFormat::getImageSize(format, image.width, image.height))
+		{
+			return false;
+		}
+	}
+
+	// BC5 has a sample per channel, the others one for the whole block.
+	uint32_t samplesCount = (format == VK_FORMAT_BC5_UNORM_BLOCK) ? 2 : 1;
+
+	std::string dfd;
+	appendValue(dfd, 0);
+	appendValue(dfd, 0);
+	appendValue(dfd, 2 | ((24 + 16 * samplesCount) << 16));
+	appendValue(dfd, colorModel | (KDF_PRIMARIES_BT709 << 8) | (transfer << 16));
+	appendValue(dfd, (blockWidth - 1) | ((blockHeight - 1) << 8));
+	appendValue(dfd, blockSize);
+	appendValue(dfd, 0);
+	for (uint32_t sample = 0; sample < samplesCount; sample++)
+	{
+		uint32_t bitLength = blockSize * 8 / samplesCount;
+
+		appendValue(dfd, (sample * bitLength) | ((bitLength - 1) << 16) | (sample << 24));
+		appendValue(dfd, 0);
+		appendValue(dfd, 0);
+		appendValue(dfd, 0xFFFFFFFF);
+	}
+	uint32_t dfdSize = static_cast<uint32_t>(dfd.size());
+	memcpy(&dfd[0], &dfdSize, sizeof(dfdSize));
+
+	// Keys are sorted by the map, as required.
+	std::string kvd;
+	for (const auto& keyValue : keyValues)
+	{
+		appendValue(kvd, static_cast<uint32_t>(keyValue.first.size() + 1 + keyValue.second.size() + 1));
+		kvd.append(keyValue.first);
+		kvd.push_back('\0');
+		kvd.append(keyValue.second);
+		kvd.push_back('\0');
+		appendPadding(kvd, 4);
+	}
+
+	uint32_t levelCount = output.mipLevels;
+
+	size_t dfdOffset = KTX2_HEADER_SIZE + levelCount * KTX2_LEVEL_SIZE;
+	size_t kvdOffset = dfdOffset + dfd.size();
+
+	std::string file(reinterpret_cast<const char*>(KTX2_IDENTIFIER), sizeof(KTX2_IDENTIFIER));
+	appendValue(file, static_cast<uint32_t>(format));
+	appendValue(file, 1);
+	appendValue(file, output.images[0].width);
+	appendValue(file, output.images[0].height);
+	appendValue(file, 0);
+	appendValue(file, 0);
+	appendValue(file, output.faceCount);
+	appendValue(file, levelCount);
+	appendValue(file, KTX2_SUPERCOMPRESSION_NONE);
+	appendValue(file, static_cast<uint32_t>(dfdOffset));
+	appendValue(file, static_cast<uint32_t>(dfd.size()));
+	appendValue(file, kvd.empty() ? 0 : static_cast<uint32_t>(kvdOffset));
+	appendValue(file, static_cast<uint32_t>(kvd.size()));
+	file.append(16, '\0');
+
+	// Level index is filled in, after the levels are placed.
+	size_t levelIndexOffset = file.size();
+	file.append(levelCount * KTX2_LEVEL_SIZE, '\0');
+	file.append(dfd);
+	file.append(kvd);
+
+	// Smallest level first, each aligned to the block size.
+	for (uint32_t level = levelCount; level-- > 0;)
+	{
+		appendPadding(file, blockSize);
+
+		uint64_t levelIndex[3];
+		levelIndex[0] = file.size();
+
+		for (uint32_t face = 0; face < output.faceCount; face++)
+		{
+			const ImageDataResource& image = output.images[face + output.faceCount * level];
+
+			file.append(reinterpret_cast<const char*>(image.pixels.data()), image.pixels.size());
+		}
+
+		levelIndex[1] = file.size() - levelIndex[0];
+		levelIndex[2] = levelIndex[1];
+
+		memcpy(&file[levelIndexOffset + level * KTX2_LEVEL_SIZE], levelIndex, sizeof(levelIndex));
+	}
+
+	return FileIO::save(file, filename);
+}
+
+bool ImageDataIO::getKeyValue(std::string& value, const uint8_t* data, size_t length, const std::string& key)
+{
+	if (!data || length < KTX2_HEADER_SIZE || memcmp(data, KTX2_IDENTIFIER, 12) != 0)
+	{
+		return false;
+	}
+
+	uint32_t kvdOffset = 0;
+	uint32_t kvdLength = 0;
+	memcpy(&kvdOffset, data + 56, sizeof(kvdOffset));
+	memcpy(&kvdLength, data + 60, sizeof(kvdLength));
+
+	if (kvdOffset > length || kvdLength > length - kvdOffset)
+	{
+		return false;
+	}
+
+	const uint8_t* kvd = data + kvdOffset;
+
+	size_t offset = 0;
+	while (offset + 4 <= kvdLength)
+	{
+		uint32_t keyAndValueLength = 0;
+		memcpy(&keyAndValueLength, kvd + offset, sizeof(keyAndValueLength));
+		offset += 4;
+
+		if (keyAndValueLength > kvdLength - offset)
+		{
+			return false;
+		}
+
+		const char* keyAndValue = reinterpret_cast<const char*>(kvd + offset);
+
+		// The key is terminated, the value is text as well, with an optional terminator.
+		size_t keyLength = strnlen(keyAndValue, keyAndValueLength);
+		if (keyLength < keyAndValueLength && key.compare(0, std::string::npos, keyAndValue, keyLength) == 0)
+		{
+			value.assign(keyAndValue + keyLength + 1, strnlen(keyAndValue + keyLength + 1, keyAndValueLength - keyLength - 1));
+
+			return true;
+		}
+
+		offset += (keyAndValueLength + 3) & ~3u;
 	}
 
 	return false;
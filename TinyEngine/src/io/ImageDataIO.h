@@ -2,17 +2,29 @@
 #define IO_IMAGEDATAIO_H_
 
 #include <cstdint>
+#include <map>
 #include <string>
 
 #include "ImageDataResources.h"
 
 class ImageDataIO
 {
+private:
+
+	// Block compressed or zstd supercompressed KTX2, which is read without decoding the blocks.
+	static bool openKtx2Blocks(ImageDataResources& output, const uint8_t* data, size_t length);
+
 public:
 
 	static bool open(ImageDataResources& output, const uint8_t* data, size_t length, uint32_t channels = 4);
 
 	static bool open(ImageDataResources& output, const std::string& filename, uint32_t channels = 4);
+
+	// Saves BC4, BC5 or BC7 images as KTX2, including all levels and faces. Values are stored as text in the key value data.
+	static bool save(const ImageDataResources& output, const std::string& filename, const std::map<std::string, std::string>& keyValues = {});
+
+	// Reads a text value from the key value data of a KTX2 file.
+	static bool getKeyValue(std::string& value, const uint8_t* data, size_t length, const std::string& key);
 };
 
 #endif /* IO_IMAGEDATAIO_H_ */
@@ -14,6 +14,10 @@ struct ImageDataResource {
 
 	uint32_t mipLevel = 0;
 	uint32_t face = 0;
+
+	// Points into a mapped file instead of the pixels, if set. Has to stay valid until uploaded.
+	const uint8_t* mapped = nullptr;
+	size_t mappedSize = 0;
 };
 
 struct ImageDataResources {
@@ -0,0 +1,623 @@
+#include "JsonReader.h"
+
+#include <cmath>
+#include <cstdlib>
+
+// Powers of ten, which are exact as double.
+static const double powersOfTen[] = {
+	1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+	1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+};
+
+static void appendUtf8(std::string& value, uint32_t codePoint)
+{
+	if (codePoint < 0x80)
+	{
+		value.push_back(static_cast<char>(codePoint));
+	}
+	else if (codePoint < 0x800)
+	{
+		value.push_back(static_cast<char>(0xC0 | (codePoint >> 6)));
+		value.push_back(static_cast<char>(0x80 | (codePoint & 0x3F)));
+	}
+	else if (codePoint < 0x10000)
+	{
+		value.push_back(static_cast<char>(0xE0 | (codePoint >> 12)));
+		value.push_back(static_cast<char>(0x80 | ((codePoint >> 6) & 0x3F)));
+		value.push_back(static_cast<char>(0x80 | (codePoint & 0x3F)));
+	}
+	else
+	{
+		value.push_back(static_cast<char>(0xF0 | (codePoint >> 18)));
+		value.push_back(static_cast<char>(0x80 | ((codePoint >> 12) & 0x3F)));
+		value.push_back(static_cast<char>(0x80 | ((codePoint >> 6) & 0x3F)));
+		value.push_back(static_cast<char>(0x80 | (codePoint & 0x3F)));
+	}
+}
+
+JsonReader::JsonReader(const char* data, size_t length) :
+	current(data), end(data + length)
+{
+}
+
+void JsonReader::skipWhitespace()
+{
+	while (current < end && (*current == ' ' || *current == '\n' || *current == '\r' || *current == '\t'))
+	{
+		current++;
+	}
+}
+
+bool JsonReader::fail()
+{
+	failed = true;
+
+	return false;
+}
+
+bool JsonReader::readLiteral(const char* literal, size_t length)
+{
+	if (static_cast<size_t>(end - current) < length)
+	{
+		return fail();
+	}
+
+	for (size_t i = 0; i < length; i++)
+	{
+		if (current[i] != literal[i])
+		{
+			return fail();
+		}
+	}
+	current += length;
+
+	return true;
+}
+
+bool JsonReader::readHex(uint32_t& value)
+{
+	if (end - current < 4)
+	{
+		return fail();
+	}
+
+	value = 0;
+	for (uint32_t i = 0; i < 4; i++)
+	{
+		char c = *current++;
+
+		value <<= 4;
+		if (c >= '0' && c <= '9')
+		{
+			value |= static_cast<uint32_t>(c - '0');
+		}
+		else if (c >= 'a' && c <= 'f')
+		{
+			value |= static_cast<uint32_t>(c - 'a' + 10);
+		}
+		else if (c >= 'A' && c <= 'F')
+		{
+			value |= static_cast<uint32_t>(c - 'A' + 10);
+		}
+		else
+		{
+			return fail();
+		}
+	}
+
+	return true;
+}
+
+bool JsonReader::beginObject()
+{
+	if (failed)
+	{
+		return false;
+	}
+
+	skipWhitespace();
+	if (current == end || *current != '{')
+	{
+		return fail();
+	}
+	current++;
+
+	first = true;
+
+	return true;
+}
+
+bool JsonReader::nextMember(std::string& key)
+{
+	if (failed)
+	{
+		return false;
+	}
+
+	skipWhitespace();
+	if (current < end && *current == '}')
+	{
+		current++;
+
+		first = false;
+
+		return false;
+	}
+
+	if (!first)
+	{
+		if (current == end || *current != ',')
+		{
+			return fail();
+		}
+		current++;
+	}
+	first = false;
+
+	if (!readString(key))
+	{
+		return false;
+	}
+
+	skipWhitespace();
+	if (current == end || *current != ':')
+	{
+		return fail();
+	}
+	current++;
+
+	return true;
+}
+
+bool JsonReader::beginArray()
+{
+	if (failed)
+	{
+		return false;
+	}
+
+	skipWhitespace();
+	if (current == end || *current != '[')
+	{
+		return fail();
+	}
+	current++;
+
+	first = true;
+
+	return true;
+}
+
+bool JsonReader::nextElement()
+{
+	if (failed)
+	{
+		return false;
+	}
+
+	skipWhitespace();
+	if (current < end && *current == ']')
+	{
+		current++;
+
+		first = false;
+
+		return false;
+	}
+
+	if (!first)
+	{
+		if (current == end || *current != ',')
+		{
+			return fail();
+		}
+		current++;
+	}
+	first = false;
+
+	return true;
+}
+
+bool JsonReader::readString(std::string& value)
+{
+	if (failed)
+	{
+		return false;
+	}
+
+	skipWhitespace();
+	if (current == end || *current != '"')
+	{
+		return fail();
+	}
+	current++;
+
+	value.clear();
+
+	while (true)
+	{
+		// Plain characters are appended as one run.
+		const char* run = current;
+		while (current < end && *current != '"' && *current != '\\' && static_cast<unsigned char>(*current) >= 0x20)
+		{
+			current++;
+		}
+		value.append(run, current - run);
+
+		if (current == end || static_cast<unsigned char>(*current) < 0x20)
+		{
+			return fail();
+		}
+
+		if (*current == '"')
+		{
+			current++;
+
+			return true;
+		}
+
+		// Escape sequence
+		current++;
+		if (current == end)
+		{
+			return fail();
+		}
+
+		switch (*current++)
+		{
+			case '"':
+				value.push_back('"');
+				break;
+			case '\\':
+				value.push_back('\\');
+				break;
+			case '/':
+				value.push_back('/');
+				break;
+			case 'b':
+				value.push_back('\b');
+				break;
+			case 'f':
+				value.push_back('\f');
+				break;
+			case 'n':
+				value.push_back('\n');
+				break;
+			case 'r':
+				value.push_back('\r');
+				break;
+			case 't':
+				value.push_back('\t');
+				break;
+			case 'u':
+			{
+				uint32_t codePoint = 0;
+				if (!readHex(codePoint))
+				{
+					return false;
+				}
+
+				// Characters outside of the basic plane are written as surrogate pair.
+				if (codePoint >= 0xD800 && codePoint <= 0xDBFF)
+				{
+					uint32_t lowSurrogate = 0;
+					if (!readLiteral("\\u", 2) || !readHex(lowSurrogate) || lowSurrogate < 0xDC00 || lowSurrogate > 0xDFFF)
+					{
+						return fail();
+					}
+
+					codePoint = 0x10000 + ((codePoint - 0xD800) << 10) + (lowSurrogate - 0xDC00);
+				}
+				else if (codePoint >= 0xDC00 && codePoint <= 0xDFFF)
+				{
+					return fail();
+				}
+
+				appendUtf8(value, codePoint);
+			}
+			break;
+			default:
+				return fail();
+		}
+	}
+}
+
+bool JsonReader::readDouble(double& value)
+{
+	if (failed)
+	{
+		return false;
+	}
+
+	skipWhitespace();
+
+	const char* start = current;
+
+	bool negative = false;
+	if (current < end && *current == '-')
+	{
+		negative = true;
+		current++;
+	}
+
+	if (current == end || *current < '0' || *current > '9')
+	{
+		return fail();
+	}
+
+	// Up to 19 significant digits are gathered, which fit into 64 bit.
+	uint64_t mantissa = 0;
+	int32_t digits = 0;
+	int32_t exponent = 0;
+	bool exact = true;
+
+	if (*current == '0')
+	{
+		current++;
+	}
+	else
+	{
+		while (current < end && *current >= '0' && *current <= '9')
+		{
+			if (digits < 19)
+			{
+				mantissa = mantissa * 10 + static_cast<uint64_t>(*current - '0');
+				digits++;
+			}
+			else
+			{
+				exponent++;
+				exact = false;
+			}
+			current++;
+		}
+	}
+
+	if (current < end && *current == '.')
+	{
+		current++;
+
+		if (current == end || *current < '0' || *current > '9')
+		{
+			return fail();
+		}
+
+		while (current < end && *current >= '0' && *current <= '9')
+		{
+			if (mantissa == 0 && *current == '0')
+			{
+				exponent--;
+			}
+			else if (digits < 19)
+			{
+				mantissa = mantissa * 10 + static_cast<uint64_t>(*current - '0');
+				digits++;
+				exponent--;
+			}
+			else
+			{
+				exact = false;
+			}
+			current++;
+		}
+	}
+
+	if (current < end && (*current == 'e' || *current == 'E'))
+	{
+		current++;
+
+		bool negativeExponent = false;
+		if (current < end && (*current == '+' || *current == '-'))
+		{
+			negativeExponent = (*current == '-');
+			current++;
+		}
+
+		if (current == end || *current < '0' || *current > '9')
+		{
+			return fail();
+		}
+
+		int32_t explicitExponent = 0;
+		while (current < end && *current >= '0' && *current <= '9')
+		{
+			if (explicitExponent < 100000)
+			{
+				explicitExponent = explicitExponent * 10 + (*current - '0');
+			}
+			current++;
+		}
+
+		exponent += negativeExponent ? -explicitExponent : explicitExponent;
+	}
+
+	// Exact, if both the mantissa and the power of ten are exact as double.
+	if (exact && mantissa <= (1ull << 53) && exponent >= -22 && exponent <= 22)
+	{
+		value = static_cast<double>(mantissa);
+		if (exponent < 0)
+		{
+			value /= powersOfTen[-exponent];
+		}
+		else
+		{
+			value *= powersOfTen[exponent];
+		}
+
+		if (negative)
+		{
+			value = -value;
+		}
+
+		return true;
+	}
+
+	// Rare, long or large numbers need correct rounding.
+	std::string number(start, current - start);
+	value = strtod(number.c_str(), nullptr);
+
+	return true;
+}
+
+bool JsonReader::readFloat(float& value)
+{
+	double number = 0.0;
+	if (!readDouble(number))
+	{
+		return false;
+	}
+
+	value = static_cast<float>(number);
+
+	return true;
+}
+
+bool JsonReader::readInt32(int32_t& value)
+{
+	double number = 0.0;
+	if (!readDouble(number))
+	{
+		return false;
+	}
+
+	if (number != std::floor(number) || number < -2147483648.0 || number > 2147483647.0)
+	{
+		return fail();
+	}
+
+	value = static_cast<int32_t>(number);
+
+	return true;
+}
+
+bool JsonReader::readUint32(uint32_t& value)
+{
+	double number = 0.0;
+	if (!readDouble(number))
+	{
+		return false;
+	}
+
+	if (number != std::floor(number) || number < 0.0 || number > 4294967295.0)
+	{
+		return fail();
+	}
+
+	value = static_cast<uint32_t>(number);
+
+	return true;
+}
+
+bool JsonReader::readBool(bool& value)
+{
+	if (failed)
+	{
+		return false;
+	}
+
+	skipWhitespace();
+	if (current < end && *current == 't')
+	{
+		value = true;
+
+		return readLiteral("true", 4);
+	}
+
+	value = false;
+
+	return readLiteral("false", 5);
+}
+
+bool JsonReader::skipValue()
+{
+	if (failed)
+	{
+		return false;
+	}
+
+	skipWhitespace();
+	if (current == end)
+	{
+		return fail();
+	}
+
+	switch (*current)
+	{
+		case '{':
+		{
+			std::string key = "";
+
+			beginObject();
+			while (nextMember(key))
+			{
+				if (!skipValue())
+				{
+					return false;
+				}
+			}
+		}
+		break;
+		case '[':
+		{
+			beginArray();
+			while (nextElement())
+			{
+				if (!skipValue())
+				{
+					return false;
+				}
+			}
+		}
+		break;
+		case '"':
+		{
+			current++;
+			while (current < end && *current != '"')
+			{
+				if (*current == '\\')
+				{
+					current++;
+				}
+				current++;
+			}
+
+			if (current >= end)
+			{
+				return fail();
+			}
+			current++;
+		}
+		break;
+		case 't':
+			return readLiteral("true", 4);
+		case 'f':
+			return readLiteral("false", 5);
+		case 'n':
+			return readLiteral("null", 4);
+		default:
+		{
+			double number = 0.0;
+
+			return readDouble(number);
+		}
+	}
+
+	return !failed;
+}
+
+bool JsonReader::finish()
+{
+	if (failed)
+	{
+		return false;
+	}
+
+	skipWhitespace();
+
+	return current == end;
+}
+
+bool JsonReader::hasFailed() const
+{
+	return failed;
+}
@@ -0,0 +1,64 @@
+#ifndef IO_JSONREADER_H_
+#define IO_JSONREADER_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// Pull parser reading JSON values in document order, without building a document. The data does not need to be null terminated.
+class JsonReader
+{
+private:
+
+	const char* current = nullptr;
+	const char* end = nullptr;
+
+	// No separator is expected before the first member or element.
+	bool first = false;
+
+	bool failed = false;
+
+	void skipWhitespace();
+
+	bool fail();
+
+	bool readLiteral(const char* literal, size_t length);
+
+	bool readHex(uint32_t& value);
+
+public:
+
+	JsonReader(const char* data, size_t length);
+
+	bool beginObject();
+
+	// Returns false at the end of the object or on failure, which is told apart by hasFailed().
+	bool nextMember(std::string& key);
+
+	bool beginArray();
+
+	// Returns false at the end of the array or on failure, which is told apart by hasFailed().
+	bool nextElement();
+
+	bool readString(std::string& value);
+
+	bool readDouble(double& value);
+
+	bool readFloat(float& value);
+
+	bool readInt32(int32_t& value);
+
+	bool readUint32(uint32_t& value);
+
+	bool readBool(bool& value);
+
+	bool skipValue();
+
+	// Only whitespace may follow the root value.
+	bool finish();
+
+	bool hasFailed() const;
+
+};
+
+#endif /* IO_JSONREADER_H_ */
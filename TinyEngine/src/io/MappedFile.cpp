@@ -0,0 +1,142 @@
+#include "MappedFile.h"
+
+#if defined(_WIN32)
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include "VirtualFile.h"
+
+MappedFile::MappedFile()
+{
+}
+
+MappedFile::~MappedFile()
+{
+	close();
+}
+
+bool MappedFile::open(const std::string& filename)
+{
+	close();
+
+	if (VirtualFile::exists(filename))
+	{
+		return VirtualFile::map(data, size, buffer, filename);
+	}
+
+#if defined(_WIN32)
+	HANDLE file = CreateFileA(filename.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+	if (file == INVALID_HANDLE_VALUE)
+	{
+		return false;
+	}
+
+	LARGE_INTEGER fileSize = {};
+	if (!GetFileSizeEx(file, &fileSize))
+	{
+		CloseHandle(file);
+
+		return false;
+	}
+
+	// Empty files can not be mapped.
+	if (fileSize.QuadPart == 0)
+	{
+		CloseHandle(file);
+
+		return true;
+	}
+
+	HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	CloseHandle(file);
+	if (mapping == nullptr)
+	{
+		return false;
+	}
+
+	// The view keeps the mapping alive.
+	void* view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+	CloseHandle(mapping);
+	if (view == nullptr)
+	{
+		return false;
+	}
+
+	data = static_cast<const uint8_t*>(view);
+	size = static_cast<size_t>(fileSize.QuadPart);
+	mapped = true;
+#else
+	int fileDescriptor = ::open(filename.c_str(), O_RDONLY);
+	if (fileDescriptor < 0)
+	{
+		return false;
+	}
+
+	struct stat fileStat = {};
+	if (fstat(fileDescriptor, &fileStat) != 0)
+	{
+		::close(fileDescriptor);
+
+		return false;
+	}
+
+	// Empty files can not be mapped.
+	if (fileStat.st_size == 0)
+	{
+		::close(fileDescriptor);
+
+		return true;
+	}
+
+	// The mapping keeps the file alive.
+	void* view = mmap(nullptr, static_cast<size_t>(fileStat.st_size), PROT_READ, MAP_PRIVATE, fileDescriptor, 0);
+	::close(fileDescriptor);
+	if (view == MAP_FAILED)
+	{
+		return false;
+	}
+
+	// Buffers are mostly read once from front to back, when uploaded.
+	madvise(view, static_cast<size_t>(fileStat.st_size), MADV_SEQUENTIAL);
+
+	data = static_cast<const uint8_t*>(view);
+	size = static_cast<size_t>(fileStat.st_size);
+	mapped = true;
+#endif
+
+	return true;
+}
+
+void MappedFile::close()
+{
+	if (mapped)
+	{
+#if defined(_WIN32)
+		UnmapViewOfFile(data);
+#else
+		munmap(const_cast<uint8_t*>(data), size);
+#endif
+	}
+
+	data = nullptr;
+	size = 0;
+	mapped = false;
+
+	buffer.clear();
+	buffer.shrink_to_fit();
+}
+
+const uint8_t* MappedFile::getData() const
+{
+	return data;
+}
+
+size_t MappedFile::getSize() const
+{
+	return size;
+}
@@ -0,0 +1,39 @@
+#ifndef IO_MAPPEDFILE_H_
+#define IO_MAPPEDFILE_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Read only memory mapping of a whole file. Pages are loaded on first access and stay valid until closed.
+// Files in a mounted archive point into the archive, or into the buffer, if compressed.
+class MappedFile
+{
+private:
+
+	const uint8_t* data = nullptr;
+	size_t size = 0;
+
+	bool mapped = false;
+	std::vector<uint8_t> buffer;
+
+public:
+
+	MappedFile();
+	~MappedFile();
+
+	MappedFile(const MappedFile&) = delete;
+	MappedFile& operator=(const MappedFile&) = delete;
+
+	bool open(const std::string& filename);
+
+	void close();
+
+	const uint8_t* getData() const;
+
+	size_t getSize() const;
+
+};
+
+#endif /* IO_MAPPEDFILE_H_ */
@@ -0,0 +1,422 @@
+#include "PackFile.h"
+
+#include <algorithm>
+#include <climits>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+
+#if defined(TINYENGINE_USE_ZSTD)
+#include <zstd.h>
+#endif
+#if defined(TINYENGINE_USE_LZ4)
+#include <lz4.h>
+#endif
+
+#include "../common/Common.h"
+
+#include "FileIO.h"
+
+static uint64_t alignOffset(uint64_t offset, uint64_t alignment)
+{
+	return (offset + alignment - 1) & ~(alignment - 1);
+}
+
+PackFile::PackFile()
+{
+}
+
+const PackFile::Entry* PackFile::find(const std::string& name) const
+{
+	if (!slots)
+	{
+		return nullptr;
+	}
+
+	uint64_t hash = HelperHash::hash(name);
+	uint32_t mask = header.slotsCount - 1;
+
+	// Linear probing, the index is at most half full.
+	uint32_t slot = static_cast<uint32_t>(hash) & mask;
+	for (uint32_t i = 0; i < header.slotsCount && slots[slot] != 0; i++, slot = (slot + 1) & mask)
+	{
+		uint32_t index = slots[slot] - 1;
+		if (index >= header.entriesCount)
+		{
+			return nullptr;
+		}
+
+		const Entry& entry = entries[index];
+		if (entry.hash != hash || entry.nameLength != name.size())
+		{
+			continue;
+		}
+
+		if (header.namesOffset + entry.nameOffset + entry.nameLength > mappedFile.getSize())
+		{
+			return nullptr;
+		}
+
+		if (memcmp(names + entry.nameOffset, name.data(), name.size()) == 0)
+		{
+			return &entry;
+		}
+	}
+
+	return nullptr;
+}
+
+bool PackFile::compress(std::string& output, const std::string& input, PackCompression compression)
+{
+	switch (compression)
+	{
+		case PackCompression_ZSTD:
+		{
+#if defined(TINYENGINE_USE_ZSTD)
+			output.resize(ZSTD_compressBound(input.size()));
+
+			// Packing is done offline, so the ratio matters more than the time.
+			size_t result = ZSTD_compress(&output[0], output.size(), input.data(), input.size(), 19);
+			if (ZSTD_isError(result))
+			{
+				return false;
+			}
+			output.resize(result);
+
+			return true;
+#else
+			(void)output;
+			(void)input;
+
+			return false;
+#endif
+		}
+		case PackCompression_LZ4:
+		{
+#if defined(TINYENGINE_USE_LZ4)
+			if (input.size() > LZ4_MAX_INPUT_SIZE)
+			{
+				return false;
+			}
+
+			output.resize(static_cast<size_t>(LZ4_compressBound(static_cast<int>(input.size()))));
+
+			int result = LZ4_compress_default(input.data(), &output[0], static_cast<int>(input.size()), static_cast<int>(output.size()));
+			if (result <= 0)
+			{
+				return false;
+			}
+			output.resize(static_cast<size_t>(result));
+
+			return true;
+#else
+			return false;
+#endif
+		}
+		default:
+			return false;
+	}
+}
+
+bool PackFile::decompress(uint8_t* output, size_t outputSize, const uint8_t* input, size_t inputSize, PackCompression compression)
+{
+	switch (compression)
+	{
+		case PackCompression_ZSTD:
+		{
+#if defined(TINYENGINE_USE_ZSTD)
+			size_t result = ZSTD_decompress(output, outputSize, input, inputSize);
+
+			return !ZSTD_isError(result) && result == outputSize;
+#else
+			(void)output;
+			(void)outputSize;
+			(void)input;
+			(void)inputSize;
+
+			return false;
+#endif
+		}
+		case PackCompression_LZ4:
+		{
+#if defined(TINYENGINE_USE_LZ4)
+			if (inputSize > INT_MAX || outputSize > INT_MAX)
+			{
+				return false;
+			}
+
+			int result = LZ4_decompress_safe(reinterpret_cast<const char*>(input), reinterpret_cast<char*>(output), static_cast<int>(inputSize), static_cast<int>(outputSize));
+
+			return result >= 0 && static_cast<size_t>(result) == outputSize;
+#else
+			return false;
+#endif
+		}
+		default:
+			return false;
+	}
+}
+
+bool PackFile::open(const std::string& filename)
+{
+	close();
+
+	if (!mappedFile.open(filename))
+	{
+		Logger::print(TinyEngine_ERROR, __FILE__, __LINE__, "Could not open archive '%s'", filename.c_str());
+
+		return false;
+	}
+
+	const uint8_t* data = mappedFile.getData();
+	size_t size = mappedFile.getSize();
+
+	if (size < sizeof(Header))
+	{
+		Logger::print(TinyEngine_ERROR, __FILE__, __LINE__, "Invalid archive '%s'", filename.c_str());
+
+		mappedFile.close();
+
+		return false;
+	}
+	memcpy(&header, data, sizeof(Header));
+
+	bool valid = header.magic == MAGIC && header.version == VERSION;
+	valid = valid && header.slotsCount > header.entriesCount && (header.slotsCount & (header.slotsCount - 1)) == 0;
+	valid = valid && sizeof(Header) + static_cast<uint64_t>(header.slotsCount) * sizeof(uint32_t) <= header.entriesOffset;
+	valid = valid && header.entriesOffset % alignof(Entry) == 0;
+	valid = valid && header.entriesOffset + static_cast<uint64_t>(header.entriesCount) * sizeof(Entry) <= header.namesOffset;
+	valid = valid && header.namesOffset <= size;
+	if (!valid)
+	{
+		Logger::print(TinyEngine_ERROR, __FILE__, __LINE__, "Invalid archive '%s'", filename.c_str());
+
+		header = {};
+		mappedFile.close();
+
+		return false;
+	}
+
+	slots = reinterpret_cast<const uint32_t*>(data + sizeof(Header));
+	entries = reinterpret_cast<const Entry*>(data + header.entriesOffset);
+	names = reinterpret_cast<const char*>(data + header.namesOffset);
+
+	return true;
+}
+
+void PackFile::close()
+{
+	header = {};
+	slots = nullptr;
+	entries = nullptr;
+	names = nullptr;
+
+	mappedFile.close();
+}
+
+bool PackFile::contains(const std::string& name) const
+{
+	return find(name) != nullptr;
+}
+
+bool PackFile::map(const uint8_t*& data, size_t& size, std::vector<uint8_t>& buffer, const std::string& name) const
+{
+	const Entry* entry = find(name);
+	if (!entry)
+	{
+		return false;
+	}
+
+	if (entry->offset > mappedFile.getSize() || entry->size > mappedFile.getSize() - entry->offset)
+	{
+		Logger::print(TinyEngine_ERROR, __FILE__, __LINE__, "Invalid archive entry '%s'", name.c_str());
+
+		return false;
+	}
+
+	const uint8_t* entryData = mappedFile.getData() + entry->offset;
+
+	if (entry->compression == PackCompression_NONE)
+	{
+		data = entryData;
+		size = static_cast<size_t>(entry->size);
+
+		return true;
+	}
+
+	buffer.resize(static_cast<size_t>(entry->originalSize));
+	if (!decompress(buffer.data(), buffer.size(), entryData, static_cast<size_t>(entry->size), static_cast<PackCompression>(entry->compression)))
+	{
+		Logger::print(TinyEngine_ERROR, __FILE__, __LINE__, "Could not decompress archive entry '%s'", name.c_str());
+
+		return false;
+	}
+
+	data = buffer.data();
+	size = buffer.size();
+
+	return true;
+}
+
+bool PackFile::pack(const std::string& filename, const std::string& directory, PackCompression compression, uint32_t alignment)
+{
+	if (alignment == 0 || (alignment & (alignment - 1)) != 0 || alignment < alignof(Entry))
+	{
+		Logger::print(TinyEngine_ERROR, __FILE__, __LINE__, "Alignment %u is not a power of two of at least %zu", alignment, alignof(Entry));
+
+		return false;
+	}
+
+#if !defined(TINYENGINE_USE_ZSTD)
+	if (compression == PackCompression_ZSTD)
+	{
+		Logger::print(TinyEngine_WARNING, __FILE__, __LINE__, "Built without zstd, entries are stored");
+
+		compression = PackCompression_NONE;
+	}
+#endif
+#if !defined(TINYENGINE_USE_LZ4)
+	if (compression == PackCompression_LZ4)
+	{
+		Logger::print(TinyEngine_WARNING, __FILE__, __LINE__, "Built without LZ4, entries are stored");
+
+		compression = PackCompression_NONE;
+	}
+#endif
+
+	std::filesystem::path root(directory);
+	std::error_code errorCode;
+
+	std::filesystem::recursive_directory_iterator iterator(root, errorCode);
+	if (errorCode)
+	{
+		Logger::print(TinyEngine_ERROR, __FILE__, __LINE__, "Could not read directory '%s'", directory.c_str());
+
+		return false;
+	}
+
+	// Sorted, so the same directory always gives the same archive.
+	std::vector<std::string> files;
+	for (const std::filesystem::directory_entry& directoryEntry : iterator)
+	{
+		if (!directoryEntry.is_regular_file(errorCode) || std::filesystem::equivalent(directoryEntry.path(), filename, errorCode))
+		{
+			continue;
+		}
+
+		files.push_back(directoryEntry.path().lexically_relative(root).generic_string());
+	}
+	std::sort(files.begin(), files.end());
+
+	if (files.size() >= 0x80000000)
+	{
+		Logger::print(TinyEngine_ERROR, __FILE__, __LINE__, "Too many files in '%s'", directory.c_str());
+
+		return false;
+	}
+
+	Header packHeader;
+	packHeader.magic = MAGIC;
+	packHeader.version = VERSION;
+	packHeader.entriesCount = static_cast<uint32_t>(files.size());
+	packHeader.alignment = alignment;
+
+	packHeader.slotsCount = 2;
+	while (packHeader.slotsCount < 2 * packHeader.entriesCount)
+	{
+		packHeader.slotsCount *= 2;
+	}
+
+	std::vector<Entry> packEntries(files.size());
+	std::vector<uint32_t> packSlots(packHeader.slotsCount, 0);
+	std::string packNames = "";
+
+	for (size_t i = 0; i < files.size(); i++)
+	{
+		Entry& entry = packEntries[i];
+		entry.hash = HelperHash::hash(files[i]);
+		entry.nameOffset = static_cast<uint32_t>(packNames.size());
+		entry.nameLength = static_cast<uint32_t>(files[i].size());
+
+		packNames += files[i];
+
+		uint32_t mask = packHeader.slotsCount - 1;
+		uint32_t slot = static_cast<uint32_t>(entry.hash) & mask;
+		while (packSlots[slot] != 0)
+		{
+			slot = (slot + 1) & mask;
+		}
+		packSlots[slot] = static_cast<uint32_t>(i + 1);
+	}
+
+	packHeader.entriesOffset = alignOffset(sizeof(Header) + packSlots.size() * sizeof(uint32_t), alignof(Entry));
+	packHeader.namesOffset = packHeader.entriesOffset + packEntries.size() * sizeof(Entry);
+
+	std::ofstream file(filename, std::ios::binary);
+	if (!file.is_open())
+	{
+		Logger::print(TinyEngine_ERROR, __FILE__, __LINE__, "Could not create archive '%s'", filename.c_str());
+
+		return false;
+	}
+
+	// The entries are written again, when the data offsets are known.
+	const std::string padding(alignment, '\0');
+	uint64_t offset = 0;
+
+	file.write(reinterpret_cast<const char*>(&packHeader), sizeof(Header));
+	file.write(reinterpret_cast<const char*>(packSlots.data()), packSlots.size() * sizeof(uint32_t));
+	file.write(padding.data(), packHeader.entriesOffset - (sizeof(Header) + packSlots.size() * sizeof(uint32_t)));
+	file.write(reinterpret_cast<const char*>(packEntries.data()), packEntries.size() * sizeof(Entry));
+	file.write(packNames.data(), packNames.size());
+	offset = packHeader.namesOffset + packNames.size();
+
+	uint64_t originalSize = 0;
+
+	for (size_t i = 0; i < files.size(); i++)
+	{
+		std::string input = "";
+		if (!FileIO::open(input, (root / files[i]).string()))
+		{
+			Logger::print(TinyEngine_ERROR, __FILE__, __LINE__, "Could not read '%s'", files[i].c_str());
+
+			return false;
+		}
+
+		Entry& entry = packEntries[i];
+		entry.originalSize = input.size();
+		originalSize += input.size();
+
+		std::string compressed = "";
+		const std::string* output = &input;
+		if (compression != PackCompression_NONE && compress(compressed, input, compression) && compressed.size() < input.size())
+		{
+			entry.compression = compression;
+			output = &compressed;
+		}
+
+		uint64_t alignedOffset = alignOffset(offset, alignment);
+		file.write(padding.data(), alignedOffset - offset);
+
+		entry.offset = alignedOffset;
+		entry.size = output->size();
+
+		file.write(output->data(), output->size());
+		offset = alignedOffset + output->size();
+	}
+
+	file.seekp(static_cast<std::streamoff>(packHeader.entriesOffset));
+	file.write(reinterpret_cast<const char*>(packEntries.data()), packEntries.size() * sizeof(Entry));
+	file.close();
+
+	if (file.fail())
+	{
+		Logger::print(TinyEngine_ERROR, __FILE__, __LINE__, "Could not write archive '%s'", filename.c_str());
+
+		return false;
+	}
+
+	Logger::print(TinyEngine_INFO, __FILE__, __LINE__, "Packed %zu files, %.1f MB into %.1f MB", files.size(), originalSize / (1024.0 * 1024.0), offset / (1024.0 * 1024.0));
+
+	return true;
+}
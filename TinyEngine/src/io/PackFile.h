@@ -0,0 +1,85 @@
+#ifndef IO_PACKFILE_H_
+#define IO_PACKFILE_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "MappedFile.h"
+
+enum PackCompression {
+	PackCompression_NONE = 0,
+	PackCompression_ZSTD = 1,
+	PackCompression_LZ4 = 2
+};
+
+// Many files packed into one archive, which is mapped as a whole. Entries are found by the hash of their name in an open addressing index.
+// Entries are aligned, so stored entries are used straight from the mapping. Compression needs TINYENGINE_USE_ZSTD or TINYENGINE_USE_LZ4.
+class PackFile
+{
+private:
+
+	static constexpr uint32_t MAGIC = 0x4B504554; // "TEPK"
+	static constexpr uint32_t VERSION = 1;
+
+	struct Header {
+		uint32_t magic = 0;
+		uint32_t version = 0;
+		uint32_t entriesCount = 0;
+		uint32_t slotsCount = 0;
+		uint32_t alignment = 0;
+		uint32_t reserved = 0;
+		uint64_t entriesOffset = 0;
+		uint64_t namesOffset = 0;
+	};
+
+	struct Entry {
+		uint64_t hash = 0;
+		uint64_t offset = 0;
+		uint64_t size = 0;
+		uint64_t originalSize = 0;
+		uint32_t nameOffset = 0;
+		uint32_t nameLength = 0;
+		uint32_t compression = PackCompression_NONE;
+		uint32_t reserved = 0;
+	};
+
+	MappedFile mappedFile;
+
+	Header header = {};
+
+	// Slots hold the entry index plus one, zero is empty.
+	const uint32_t* slots = nullptr;
+	const Entry* entries = nullptr;
+	const char* names = nullptr;
+
+	const Entry* find(const std::string& name) const;
+
+	static bool compress(std::string& output, const std::string& input, PackCompression compression);
+
+	static bool decompress(uint8_t* output, size_t outputSize, const uint8_t* input, size_t inputSize, PackCompression compression);
+
+public:
+
+	PackFile();
+
+	PackFile(const PackFile&) = delete;
+	PackFile& operator=(const PackFile&) = delete;
+
+	bool open(const std::string& filename);
+
+	void close();
+
+	// Names are relative to the packed directory, separated by '/'.
+	bool contains(const std::string& name) const;
+
+	// Stored entries point into the mapping, compressed entries are decompressed into the buffer.
+	bool map(const uint8_t*& data, size_t& size, std::vector<uint8_t>& buffer, const std::string& name) const;
+
+	// Packs all files below the directory. Entries are only kept compressed, if smaller.
+	static bool pack(const std::string& filename, const std::string& directory, PackCompression compression = PackCompression_NONE, uint32_t alignment = 16);
+
+};
+
+#endif /* IO_PACKFILE_H_ */
@@ -0,0 +1,105 @@
+#include "VirtualFile.h"
+
+#include <cstring>
+
+#include "../common/Common.h"
+
+#include "HelperFile.h"
+
+std::vector<VirtualFile::Mount> VirtualFile::mounts;
+
+const PackFile* VirtualFile::resolve(std::string& name, const std::string& filename)
+{
+	if (mounts.size() == 0)
+	{
+		return nullptr;
+	}
+
+	std::string normalized = HelperFile::normalize(filename);
+
+	for (auto it = mounts.rbegin(); it != mounts.rend(); it++)
+	{
+		if (it->root == "")
+		{
+			name = normalized;
+		}
+		else if (normalized.size() > it->root.size() && normalized.compare(0, it->root.size(), it->root) == 0 && normalized[it->root.size()] == '/')
+		{
+			name = normalized.substr(it->root.size() + 1);
+		}
+		else
+		{
+			continue;
+		}
+
+		if (it->packFile->contains(name))
+		{
+			return it->packFile.get();
+		}
+	}
+
+	return nullptr;
+}
+
+bool VirtualFile::mount(const std::string& filename, const std::string& root)
+{
+	Mount mount;
+	mount.root = HelperFile::normalize(root);
+	mount.packFile = std::make_unique<PackFile>();
+
+	if (!mount.packFile->open(filename))
+	{
+		return false;
+	}
+
+	Logger::print(TinyEngine_INFO, __FILE__, __LINE__, "Mounted '%s' at '%s'", filename.c_str(), root.c_str());
+
+	mounts.push_back(std::move(mount));
+
+	return true;
+}
+
+void VirtualFile::unmountAll()
+{
+	mounts.clear();
+}
+
+bool VirtualFile::exists(const std::string& filename)
+{
+	std::string name = "";
+
+	return resolve(name, filename) != nullptr;
+}
+
+bool VirtualFile::map(const uint8_t*& data, size_t& size, std::vector<uint8_t>& buffer, const std::string& filename)
+{
+	std::string name = "";
+
+	const PackFile* packFile = resolve(name, filename);
+	if (!packFile)
+	{
+		return false;
+	}
+
+	return packFile->map(data, size, buffer, name);
+}
+
+bool VirtualFile::open(std::string& output, const std::string& filename)
+{
+	const uint8_t* data = nullptr;
+	size_t size = 0;
+	std::vector<uint8_t> buffer;
+
+	if (!map(data, size, buffer, filename))
+	{
+		return false;
+	}
+
+	output.resize(size);
+	if (size > 0)
+	{
+		memcpy(&output[0], data, size);
+	}
+
+	return true;
+}
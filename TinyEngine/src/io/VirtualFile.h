@@ -0,0 +1,43 @@
+#ifndef IO_VIRTUALFILE_H_
+#define IO_VIRTUALFILE_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "PackFile.h"
+
+// Resolves files below a mounted root in its archive first, so the readers do not care, if a file is packed.
+// Archives are mounted before any file is read and looked up without locking.
+class VirtualFile
+{
+private:
+
+	struct Mount {
+		std::string root = "";
+		std::unique_ptr<PackFile> packFile;
+	};
+
+	static std::vector<Mount> mounts;
+
+	static const PackFile* resolve(std::string& name, const std::string& filename);
+
+public:
+
+	// Later mounts are looked up first. An empty root resolves relative file names.
+	static bool mount(const std::string& filename, const std::string& root);
+
+	static void unmountAll();
+
+	static bool exists(const std::string& filename);
+
+	// False, if the file is not in a mounted archive. Stored entries point into the archive, compressed ones are decompressed into the buffer.
+	static bool map(const uint8_t*& data, size_t& size, std::vector<uint8_t>& buffer, const std::string& filename);
+
+	static bool open(std::string& output, const std::string& filename);
+
+};
+
+#endif /* IO_VIRTUALFILE_H_ */
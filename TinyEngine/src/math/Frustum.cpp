@@ -7,7 +7,7 @@
 Frustum::Frustum(const glm::mat4& viewMatrix, const glm::mat4& projectionMatrix) :
 	sidesWorld()
 {
-	updateViewProjection(projectionMatrix, viewMatrix);
+	updateViewProjection(viewMatrix, projectionMatrix);
 }
 
 Frustum::~Frustum()
@@ -22,7 +22,9 @@ void Frustum::updateViewProjection(const glm::mat4& viewMatrix, const glm::mat4&
 
 	for (uint32_t i = 0; i < 6; i++)
 	{
-		sidesWorld[i] = transposedViewProjectionMatrix * sidesNDC[i];
+		glm::vec4 side = transposedViewProjectionMatrix * glm::vec4(sidesNDC[i].getNormal(), sidesNDC[i].getD());
+
+		sidesWorld[i] = Plane(glm::vec3(side), side.w);
 	}
 }
 
@@ -47,10 +49,10 @@ bool Frustum::isVisible(const Sphere& sphere) const
 
 		if (signedDistance + sphere.getRadius() < 0.0f)
 		{
-			return true;
+			return false;
 		}
 	}
 
-	return false;
+	return true;
 }
 
@@ -0,0 +1,115 @@
+#include "Matrix.h"
+
+#if defined(__SSE__) || defined(_M_X64)
+#include <xmmintrin.h>
+#define MATRIX_SSE
+#endif
+
+bool Matrix::isAffine(const glm::mat4& matrix)
+{
+	return matrix[0][3] == 0.0f && matrix[1][3] == 0.0f && matrix[2][3] == 0.0f && matrix[3][3] == 1.0f;
+}
+
+glm::mat4 Matrix::inverseAffine(const glm::mat4& matrix)
+{
+	if (!isAffine(matrix))
+	{
+		return glm::inverse(matrix);
+	}
+
+	glm::mat3 inverse = glm::inverse(glm::mat3(matrix));
+
+	glm::mat4 result = glm::mat4(inverse);
+	result[3] = glm::vec4(-(inverse * glm::vec3(matrix[3])), 1.0f);
+
+	return result;
+}
+
+void Matrix::multiply(glm::mat4& result, const glm::mat4& left, const glm::mat4& right)
+{
+	multiply(&result, &left, &right, 1);
+}
+
+void Matrix::multiply(glm::mat4* result, const glm::mat4& left, const glm::mat4* right, size_t count)
+{
+#ifdef MATRIX_SSE
+	const float* l = &left[0][0];
+
+	__m128 column0 = _mm_loadu_ps(l);
+	__m128 column1 = _mm_loadu_ps(l + 4);
+	__m128 column2 = _mm_loadu_ps(l + 8);
+	__m128 column3 = _mm_loadu_ps(l + 12);
+
+	for (size_t i = 0; i < count; i++)
+	{
+		const float* r = &right[i][0][0];
+		float* d = &result[i][0][0];
+
+		// Column j of the result is the left matrix times column j of the right one.
+		for (uint32_t j = 0; j < 4; j++)
+		{
+			__m128 value = _mm_mul_ps(column0, _mm_set1_ps(r[j * 4 + 0]));
+			value = _mm_add_ps(value, _mm_mul_ps(column1, _mm_set1_ps(r[j * 4 + 1])));
+			value = _mm_add_ps(value, _mm_mul_ps(column2, _mm_set1_ps(r[j * 4 + 2])));
+			value = _mm_add_ps(value, _mm_mul_ps(column3, _mm_set1_ps(r[j * 4 + 3])));
+
+			_mm_storeu_ps(d + j * 4, value);
+		}
+	}
+#else
+	for (size_t i = 0; i < count; i++)
+	{
+		result[i] = left * right[i];
+	}
+#endif
+}
+
+void Matrix::multiply(glm::mat4* result, const glm::mat4* left, const glm::mat4* right, size_t count)
+{
+#ifdef MATRIX_SSE
+	for (size_t i = 0; i < count; i++)
+	{
+		const float* l = &left[i][0][0];
+		const float* r = &right[i][0][0];
+
+		__m128 column0 = _mm_loadu_ps(l);
+		__m128 column1 = _mm_loadu_ps(l + 4);
+		__m128 column2 = _mm_loadu_ps(l + 8);
+		__m128 column3 = _mm_loadu_ps(l + 12);
+
+		__m128 values[4];
+		for (uint32_t j = 0; j < 4; j++)
+		{
+			values[j] = _mm_mul_ps(column0, _mm_set1_ps(r[j * 4 + 0]));
+			values[j] = _mm_add_ps(values[j], _mm_mul_ps(column1, _mm_set1_ps(r[j * 4 + 1])));
+			values[j] = _mm_add_ps(values[j], _mm_mul_ps(column2, _mm_set1_ps(r[j * 4 + 2])));
+			values[j] = _mm_add_ps(values[j], _mm_mul_ps(column3, _mm_set1_ps(r[j * 4 + 3])));
+		}
+
+		// Result may alias one of the inputs.
+		float* d = &result[i][0][0];
+		for (uint32_t j = 0; j < 4; j++)
+		{
+			_mm_storeu_ps(d + j * 4, values[j]);
+		}
+	}
+#else
+	for (size_t i = 0; i < count; i++)
+	{
+		result[i] = left[i] * right[i];
+	}
+#endif
+}
+
+void Matrix::toRows3x4(glm::vec4* rows, const glm::mat4* matrices, size_t count)
+{
+	for (size_t i = 0; i < count; i++)
+	{
+		const glm::mat4& matrix = matrices[i];
+
+		for (uint32_t row = 0; row < 3; row++)
+		{
+			rows[i * 3 + row] = glm::vec4(matrix[0][row], matrix[1][row], matrix[2][row], matrix[3][row]);
+		}
+	}
+}
@@ -0,0 +1,30 @@
+#ifndef MATH_MATRIX_H_
+#define MATH_MATRIX_H_
+
+#include <cstddef>
+#include <cstdint>
+
+#include "glm_include.h"
+
+class Matrix
+{
+public:
+
+	static bool isAffine(const glm::mat4& matrix);
+
+	// Inverts the upper 3x3 part and the translation only. Falls back to a full inverse, if the matrix is not affine.
+	static glm::mat4 inverseAffine(const glm::mat4& matrix);
+
+	static void multiply(glm::mat4& result, const glm::mat4& left, const glm::mat4& right);
+
+	// result[i] = left * right[i]
+	static void multiply(glm::mat4* result, const glm::mat4& left, const glm::mat4* right, size_t count);
+
+	// result[i] = left[i] * right[i]
+	static void multiply(glm::mat4* result, const glm::mat4* left, const glm::mat4* right, size_t count);
+
+	// Stores the first three rows of each affine matrix, as the last one is always (0, 0, 0, 1).
+	static void toRows3x4(glm::vec4* rows, const glm::mat4* matrices, size_t count);
+};
+
+#endif /* MATH_MATRIX_H_ */
@@ -0,0 +1,32 @@
+#ifndef RENDER_ANIMATIONARENARESOURCE_H_
+#define RENDER_ANIMATIONARENARESOURCE_H_
+
+#include <cstdint>
+#include <vector>
+
+#include "../composite/Composite.h"
+#include "../math/Math.h"
+
+#include "GeometryArenaResource.h"
+
+// Joint matrices and morph weights of all instances. One host visible storage buffer with a region per frame, bound with the region as dynamic offset.
+struct AnimationArenaResource {
+
+	StorageBufferResource storageBufferResource = {};
+
+	// Counted in vectors.
+	VkDeviceSize capacity = 0;
+	std::vector<ArenaRange> freeRanges;
+
+	// Aligned to the storage buffer offset alignment.
+	VkDeviceSize frameSize = 0;
+
+	// Latest data of all instances, copied with one upload into the region of a frame.
+	std::vector<glm::vec4> data;
+	VkDeviceSize used = 0;
+
+	std::vector<bool> dirty;
+
+};
+
+#endif /* RENDER_ANIMATIONARENARESOURCE_H_ */
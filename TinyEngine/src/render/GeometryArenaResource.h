@@ -0,0 +1,44 @@
+#ifndef RENDER_GEOMETRYARENARESOURCE_H_
+#define RENDER_GEOMETRYARENARESOURCE_H_
+
+#include <cstdint>
+#include <vector>
+
+#include "../composite/Composite.h"
+
+struct ArenaRange {
+
+	VkDeviceSize offset = 0;
+	VkDeviceSize size = 0;
+
+};
+
+// One arena per vertex layout. Every attribute has its own tightly packed buffer, so a vertex range is valid for all attributes.
+struct VertexArenaResource {
+
+	std::vector<VkFormat> formats;
+	std::vector<uint32_t> strides;
+
+	std::vector<VertexBufferResource> vertexBufferResources;
+	std::vector<VkBuffer> vertexBuffers;
+	std::vector<VkDeviceSize> vertexBuffersOffsets;
+
+	// Counted in vertices.
+	VkDeviceSize capacity = 0;
+	std::vector<ArenaRange> freeRanges;
+
+};
+
+struct IndexArenaResource {
+
+	VkIndexType indexType = VK_INDEX_TYPE_UINT32;
+
+	VertexBufferResource indexBufferResource = {};
+
+	// Counted in indices.
+	VkDeviceSize capacity = 0;
+	std::vector<ArenaRange> freeRanges;
+
+};
+
+#endif /* RENDER_GEOMETRYARENARESOURCE_H_ */
@@ -4,11 +4,25 @@
 #include <cstdint>
 #include <string>
 #include <map>
+#include <vector>
 
 #include "../composite/Composite.h"
+#include "../geometry/GeometryData.h"
+#include "../math/Math.h"
 
 #include "BaseResource.h"
 
+struct GeometryModelLod {
+
+	// Relative to the first index of the geometry model.
+	uint32_t firstIndex = 0;
+	uint32_t indicesCount = 0;
+
+	// Geometric error in model units.
+	float error = 0.0f;
+
+};
+
 struct GeometryModelResource : BaseResource {
 
 	uint64_t geometryHandle = 0;
@@ -29,15 +43,52 @@ struct GeometryModelResource : BaseResource {
 
 	uint32_t targetsCount = 0;
 
-	uint64_t targetPositionHandle = 0;
-	uint64_t targetNormalHandle = 0;
-	uint64_t targetTangentHandle = 0;
-
 	uint64_t indexHandle = 0;
 
 	uint32_t mode = 4;
 	VkPrimitiveTopology topology = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST;
 
+	// Geometry arena
+
+	const void* indexData = nullptr;
+
+	int32_t arenaIndex = -1;
+	uint32_t firstIndex = 0;
+	int32_t vertexOffset = 0;
+
+	// Level of detail
+
+	std::vector<GeometryModelLod> lods;
+
+	glm::vec3 boundsCenter = glm::vec3(0.0f, 0.0f, 0.0f);
+	float boundsRadius = 0.0f;
+
+	// Cluster culling
+
+	const GeometryMeshlet* meshletData = nullptr;
+	const uint32_t* meshletVertexData = nullptr;
+	const uint32_t* meshletTriangleData = nullptr;
+
+	uint32_t meshletsCount = 0;
+	uint32_t meshletVerticesCount = 0;
+	uint32_t meshletTrianglesCount = 0;
+
+	StorageBufferResource meshletBufferResource = {};
+	StorageBufferResource meshletVertexBufferResource = {};
+	StorageBufferResource meshletTriangleBufferResource = {};
+
+	// Sparse morph targets
+
+	const GeometryTargets* targetData = nullptr;
+
+	uint32_t targetVerticesCount = 0;
+	uint32_t targetEntriesCount = 0;
+
+	StorageBufferResource targetOffsetBufferResource = {};
+	StorageBufferResource targetPositionBufferResource = {};
+	StorageBufferResource targetNormalBufferResource = {};
+	StorageBufferResource targetTangentBufferResource = {};
+
 };
 
 #endif /* RENDER_GEOMETRYMODELRESOURCE_H_ */
@@ -6,6 +6,7 @@
 #include <vector>
 
 #include "../composite/Composite.h"
+#include "../geometry/GeometryData.h"
 
 #include "BaseResource.h"
 
@@ -21,6 +22,30 @@ struct GeometryResource : BaseResource {
 	std::vector<VkDeviceSize> vertexBuffersOffsets;
 	std::vector<VkDeviceSize> vertexBuffersRanges;
 
+	// Quantized positions
+	glm::vec4 positionDequantizeScale = glm::vec4(1.0f, 1.0f, 1.0f, 0.0f);
+	glm::vec4 positionDequantizeOffset = glm::vec4(0.0f);
+
+	// Geometry arena
+
+	std::vector<const void*> vertexData;
+	std::vector<uint32_t> vertexDataStrides;
+
+	int32_t arenaIndex = -1;
+	uint32_t baseVertex = 0;
+
+	// Deformation pre-pass
+
+	const GeometryDeform* deformData = nullptr;
+
+	uint32_t deformJointGroups = 0;
+
+	StorageBufferResource deformPositionBufferResource = {};
+	StorageBufferResource deformNormalBufferResource = {};
+	StorageBufferResource deformTangentBufferResource = {};
+	StorageBufferResource deformJointBufferResource = {};
+	StorageBufferResource deformWeightBufferResource = {};
+
 };
 
 #endif /* RENDER_GEOMETRYRESOURCE_H_ */
@@ -0,0 +1,65 @@
+#include "HelperArena.h"
+
+#include <algorithm>
+
+bool HelperArena::allocate(VkDeviceSize& offset, std::vector<ArenaRange>& freeRanges, VkDeviceSize size)
+{
+	if (size == 0)
+	{
+		return false;
+	}
+
+	// First fit, as ranges are sorted by offset.
+	for (auto it = freeRanges.begin(); it != freeRanges.end(); it++)
+	{
+		if (it->size >= size)
+		{
+			offset = it->offset;
+
+			it->offset += size;
+			it->size -= size;
+
+			if (it->size == 0)
+			{
+				freeRanges.erase(it);
+			}
+
+			return true;
+		}
+	}
+
+	return false;
+}
+
+void HelperArena::release(std::vector<ArenaRange>& freeRanges, VkDeviceSize offset, VkDeviceSize size)
+{
+	if (size == 0)
+	{
+		return;
+	}
+
+	auto it = std::lower_bound(freeRanges.begin(), freeRanges.end(), offset, [](const ArenaRange& range, VkDeviceSize value) {
+		return range.offset < value;
+	});
+
+	it = freeRanges.insert(it, {offset, size});
+
+	// Merge with the following range.
+	auto next = it + 1;
+	if (next != freeRanges.end() && it->offset + it->size == next->offset)
+	{
+		it->size += next->size;
+		freeRanges.erase(next);
+	}
+
+	// Merge with the preceding range.
+	if (it != freeRanges.begin())
+	{
+		auto previous = it - 1;
+		if (previous->offset + previous->size == it->offset)
+		{
+			previous->size += it->size;
+			freeRanges.erase(it);
+		}
+	}
+}
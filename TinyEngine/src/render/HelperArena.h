@@ -0,0 +1,19 @@
+#ifndef RENDER_HELPERARENA_H_
+#define RENDER_HELPERARENA_H_
+
+#include <cstdint>
+#include <vector>
+
+#include "GeometryArenaResource.h"
+
+class HelperArena
+{
+public:
+
+	static bool allocate(VkDeviceSize& offset, std::vector<ArenaRange>& freeRanges, VkDeviceSize size);
+
+	static void release(std::vector<ArenaRange>& freeRanges, VkDeviceSize offset, VkDeviceSize size);
+
+};
+
+#endif /* RENDER_HELPERARENA_H_ */
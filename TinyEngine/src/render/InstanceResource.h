@@ -9,6 +9,16 @@
 
 #include "BaseResource.h"
 
+// Instance of a crowd, drawn with hardware instancing. Time is the world time scaled by the speed plus the offset.
+struct CrowdMember {
+	glm::mat4 worldMatrix = glm::mat4(1.0f);
+
+	float timeOffset = 0.0f;
+	float speed = 1.0f;
+
+	float padding[2] = {0.0f, 0.0f};
+};
+
 struct InstanceContainer {
 
 	VkDescriptorSetLayout descriptorSetLayout = VK_NULL_HANDLE;
@@ -21,9 +31,45 @@ struct InstanceContainer {
 	VkPipelineLayout pipelineLayout = VK_NULL_HANDLE;
 	VkPipeline graphicsPipeline = VK_NULL_HANDLE;
 
-	//
+	// Animation arena is bound with the region of the frame as dynamic offset.
+	bool animated = false;
+
+	// Push constant range includes the position dequantization.
+	bool positionDequantize = false;
+
+	// Cluster culling, with one compacted index buffer and draw command per frame.
+
+	VkDescriptorPool cullDescriptorPool = VK_NULL_HANDLE;
+	std::vector<VkDescriptorSet> cullDescriptorSets;
+
+	std::vector<StorageBufferResource> cullIndexBufferResources;
+	std::vector<StorageBufferResource> cullDrawBufferResources;
+
+	bool culled = false;
 
-	std::vector<uint32_t> dynamicOffsets;
+	// Deformation pre-pass, with one output buffer per frame, which is drawn as static geometry.
+
+	VkShaderModule deformShaderModule = VK_NULL_HANDLE;
+	VkPipeline deformPipeline = VK_NULL_HANDLE;
+
+	VkDescriptorPool deformDescriptorPool = VK_NULL_HANDLE;
+	std::vector<VkDescriptorSet> deformDescriptorSets;
+
+	std::vector<StorageBufferResource> deformPositionBufferResources;
+	std::vector<StorageBufferResource> deformNormalBufferResources;
+	std::vector<StorageBufferResource> deformTangentBufferResources;
+
+	// Vertex buffers of all frames, with the deformed attributes replaced. Offsets already include the vertex offset.
+	std::vector<VkBuffer> deformVertexBuffers;
+	std::vector<VkDeviceSize> deformVertexBuffersOffsets;
+
+	// Deform version of the instance, the output buffer of the frame was written with.
+	std::vector<uint64_t> deformVersions;
+
+	// Skinning and morphing in the vertex shader, drawn while the output buffer of the frame is outdated.
+	VkShaderModule fallbackVertexShaderModule = VK_NULL_HANDLE;
+	VkShaderModule fallbackFragmentShaderModule = VK_NULL_HANDLE;
+	VkPipeline fallbackGraphicsPipeline = VK_NULL_HANDLE;
 
 };
 
@@ -35,10 +81,31 @@ struct InstanceResource : BaseResource {
 
 	std::vector<InstanceContainer> instanceContainers;
 
-	uint64_t weightsHandle = 0;
+	// Offsets are counted in vectors of the animation arena.
+	uint32_t weightsOffset = 0;
+	uint32_t weightsCount = 0;
 
-	uint64_t jointMatricesHandle = 0;
+	uint32_t jointMatricesOffset = 0;
 	uint32_t jointMatricesCount = 0;
+	// Three or four vectors per joint, as allocated.
+	uint32_t jointMatricesVectorsCount = 0;
+
+	// Incremented, if the weights or joint matrices did change.
+	uint64_t deformVersion = 1;
+	std::vector<float> deformWeights;
+	std::vector<glm::mat4> deformJointMatrices;
+
+	// Joint matrices sampled from a texture with the world time, see HelperAnimate::bakeJointMatrices().
+	uint64_t bakedJointsTextureHandle = 0;
+	uint32_t bakedJointsCount = 0;
+	uint32_t bakedFramesCount = 0;
+	float bakedDuration = 0.0f;
+
+	// Crowd members are uploaded during finalization and released afterwards.
+	std::vector<CrowdMember> crowdMembers;
+	uint32_t crowdCount = 0;
+
+	StorageBufferResource crowdBufferResource = {};
 
 };
 
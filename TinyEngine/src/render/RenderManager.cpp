@@ -1,9 +1,14 @@
 #include "RenderManager.h"
 
+#include <cstddef>
 #include <cstring>
+#include <utility>
 
+#include "../geometry/HelperTarget.h"
 #include "../shader/Shader.h"
 
+#include "HelperArena.h"
+
 void RenderManager::terminate(SharedDataResource& sharedDataResource, VkDevice device)
 {
 	VulkanResource::destroyVertexBufferResource(device, sharedDataResource.vertexBufferResource);
@@ -13,7 +18,25 @@ void RenderManager::terminate(SharedDataResource& sharedDataResource, VkDevice d
 
 void RenderManager::terminate(TextureDataResource& textureResource, VkDevice device)
 {
-	VulkanResource::destroyTextureResource(device, textureResource.textureResource);
+	if (!textureResource.finalized)
+	{
+		return;
+	}
+
+	auto textureImageResource = textureImageResources.find(textureResource.imageHash);
+	if (textureImageResource != textureImageResources.end() && --textureImageResource->second.references == 0)
+	{
+		destroyTextureImage(textureImageResource);
+	}
+
+	auto textureSamplerResource = textureSamplerResources.find(textureResource.samplerResourceCreateInfo);
+	if (textureSamplerResource != textureSamplerResources.end() && --textureSamplerResource->second.references == 0)
+	{
+		VulkanResource::destroySamplerResource(device, textureSamplerResource->second.samplerResource);
+		textureSamplerResources.erase(textureSamplerResource);
+	}
+
+	textureResource.textureResource = TextureResource();
 }
 
 void RenderManager::terminate(MaterialResource& materialResource, VkDevice device)
@@ -23,10 +46,35 @@ void RenderManager::terminate(MaterialResource& materialResource, VkDevice devic
 
 void RenderManager::terminate(GeometryResource& geometryResource, VkDevice device)
 {
+	if (geometryResource.arenaIndex >= 0)
+	{
+		HelperArena::release(vertexArenaResources[geometryResource.arenaIndex].freeRanges, geometryResource.baseVertex, geometryResource.count);
+		geometryResource.arenaIndex = -1;
+	}
+
+	VulkanResource::destroyStorageBufferResource(device, geometryResource.deformPositionBufferResource);
+	VulkanResource::destroyStorageBufferResource(device, geometryResource.deformNormalBufferResource);
+	VulkanResource::destroyStorageBufferResource(device, geometryResource.deformTangentBufferResource);
+	VulkanResource::destroyStorageBufferResource(device, geometryResource.deformJointBufferResource);
+	VulkanResource::destroyStorageBufferResource(device, geometryResource.deformWeightBufferResource);
 }
 
 void RenderManager::terminate(GeometryModelResource& geometryModelResource, VkDevice device)
 {
+	if (geometryModelResource.arenaIndex >= 0)
+	{
+		HelperArena::release(indexArenaResources[geometryModelResource.arenaIndex].freeRanges, geometryModelResource.firstIndex, geometryModelResource.indicesCount);
+		geometryModelResource.arenaIndex = -1;
+	}
+
+	VulkanResource::destroyStorageBufferResource(device, geometryModelResource.meshletBufferResource);
+	VulkanResource::destroyStorageBufferResource(device, geometryModelResource.meshletVertexBufferResource);
+	VulkanResource::destroyStorageBufferResource(device, geometryModelResource.meshletTriangleBufferResource);
+
+	VulkanResource::destroyStorageBufferResource(device, geometryModelResource.targetOffsetBufferResource);
+	VulkanResource::destroyStorageBufferResource(device, geometryModelResource.targetPositionBufferResource);
+	VulkanResource::destroyStorageBufferResource(device, geometryModelResource.targetNormalBufferResource);
+	VulkanResource::destroyStorageBufferResource(device, geometryModelResource.targetTangentBufferResource);
 }
 
 void RenderManager::terminate(GroupResource& groupResource, VkDevice device)
@@ -77,7 +125,106 @@ void RenderManager::terminate(InstanceResource& instanceResource, VkDevice devic
 			vkDestroyDescriptorSetLayout(device, instanceResource.instanceContainers[geometryModelIndex].descriptorSetLayout, nullptr);
 			instanceResource.instanceContainers[geometryModelIndex].descriptorSetLayout = VK_NULL_HANDLE;
 		}
+
+		//
+
+		instanceResource.instanceContainers[geometryModelIndex].cullDescriptorSets.clear();
+
+		if (instanceResource.instanceContainers[geometryModelIndex].cullDescriptorPool != VK_NULL_HANDLE)
+		{
+			vkDestroyDescriptorPool(device, instanceResource.instanceContainers[geometryModelIndex].cullDescriptorPool, nullptr);
+			instanceResource.instanceContainers[geometryModelIndex].cullDescriptorPool = VK_NULL_HANDLE;
+		}
+
+		for (StorageBufferResource& storageBufferResource : instanceResource.instanceContainers[geometryModelIndex].cullIndexBufferResources)
+		{
+			VulkanResource::destroyStorageBufferResource(device, storageBufferResource);
+		}
+		instanceResource.instanceContainers[geometryModelIndex].cullIndexBufferResources.clear();
+
+		for (StorageBufferResource& storageBufferResource : instanceResource.instanceContainers[geometryModelIndex].cullDrawBufferResources)
+		{
+			VulkanResource::destroyStorageBufferResource(device, storageBufferResource);
+		}
+		instanceResource.instanceContainers[geometryModelIndex].cullDrawBufferResources.clear();
+
+		//
+
+		if (instanceResource.instanceContainers[geometryModelIndex].fallbackGraphicsPipeline != VK_NULL_HANDLE)
+		{
+			vkDestroyPipeline(device, instanceResource.instanceContainers[geometryModelIndex].fallbackGraphicsPipeline, nullptr);
+			instanceResource.instanceContainers[geometryModelIndex].fallbackGraphicsPipeline = VK_NULL_HANDLE;
+		}
+
+		if (instanceResource.instanceContainers[geometryModelIndex].fallbackVertexShaderModule != VK_NULL_HANDLE)
+		{
+			vkDestroyShaderModule(device, instanceResource.instanceContainers[geometryModelIndex].fallbackVertexShaderModule, nullptr);
+			instanceResource.instanceContainers[geometryModelIndex].fallbackVertexShaderModule = VK_NULL_HANDLE;
+		}
+
+		if (instanceResource.instanceContainers[geometryModelIndex].fallbackFragmentShaderModule != VK_NULL_HANDLE)
+		{
+			vkDestroyShaderModule(device, instanceResource.instanceContainers[geometryModelIndex].fallbackFragmentShaderModule, nullptr);
+			instanceResource.instanceContainers[geometryModelIndex].fallbackFragmentShaderModule = VK_NULL_HANDLE;
+		}
+
+		if (instanceResource.instanceContainers[geometryModelIndex].deformPipeline != VK_NULL_HANDLE)
+		{
+			vkDestroyPipeline(device, instanceResource.instanceContainers[geometryModelIndex].deformPipeline, nullptr);
+			instanceResource.instanceContainers[geometryModelIndex].deformPipeline = VK_NULL_HANDLE;
+		}
+
+		if (instanceResource.instanceContainers[geometryModelIndex].deformShaderModule != VK_NULL_HANDLE)
+		{
+			vkDestroyShaderModule(device, instanceResource.instanceContainers[geometryModelIndex].deformShaderModule, nullptr);
+			instanceResource.instanceContainers[geometryModelIndex].deformShaderModule = VK_NULL_HANDLE;
+		}
+
+		instanceResource.instanceContainers[geometryModelIndex].deformDescriptorSets.clear();
+
+		if (instanceResource.instanceContainers[geometryModelIndex].deformDescriptorPool != VK_NULL_HANDLE)
+		{
+			vkDestroyDescriptorPool(device, instanceResource.instanceContainers[geometryModelIndex].deformDescriptorPool, nullptr);
+			instanceResource.instanceContainers[geometryModelIndex].deformDescriptorPool = VK_NULL_HANDLE;
+		}
+
+		for (StorageBufferResource& storageBufferResource : instanceResource.instanceContainers[geometryModelIndex].deformPositionBufferResources)
+		{
+			VulkanResource::destroyStorageBufferResource(device, storageBufferResource);
+		}
+		instanceResource.instanceContainers[geometryModelIndex].deformPositionBufferResources.clear();
+
+		for (StorageBufferResource& storageBufferResource : instanceResource.instanceContainers[geometryModelIndex].deformNormalBufferResources)
+		{
+			VulkanResource::destroyStorageBufferResource(device, storageBufferResource);
+		}
+		instanceResource.instanceContainers[geometryModelIndex].deformNormalBufferResources.clear();
+
+		for (StorageBufferResource& storageBufferResource : instanceResource.instanceContainers[geometryModelIndex].deformTangentBufferResources)
+		{
+			VulkanResource::destroyStorageBufferResource(device, storageBufferResource);
+		}
+		instanceResource.instanceContainers[geometryModelIndex].deformTangentBufferResources.clear();
+
+		instanceResource.instanceContainers[geometryModelIndex].deformVertexBuffers.clear();
+		instanceResource.instanceContainers[geometryModelIndex].deformVertexBuffersOffsets.clear();
+		instanceResource.instanceContainers[geometryModelIndex].deformVersions.clear();
+	}
+
+	if (instanceResource.weightsCount > 0)
+	{
+		HelperArena::release(animationArenaResource.freeRanges, instanceResource.weightsOffset, HelperTarget::getPackedWeightsCount(instanceResource.weightsCount));
+		instanceResource.weightsCount = 0;
+	}
+
+	if (instanceResource.jointMatricesCount > 0)
+	{
+		HelperArena::release(animationArenaResource.freeRanges, instanceResource.jointMatricesOffset, instanceResource.jointMatricesVectorsCount);
+		instanceResource.jointMatricesCount = 0;
+		instanceResource.jointMatricesVectorsCount = 0;
 	}
+
+	VulkanResource::destroyStorageBufferResource(device, instanceResource.crowdBufferResource);
 }
 
 void RenderManager::terminate(LightResource& lightResource, VkDevice device)
@@ -95,6 +242,33 @@ void RenderManager::terminate(WorldResource& worldResource, VkDevice device)
 {
 }
 
+void RenderManager::terminate(VertexArenaResource& vertexArenaResource, VkDevice device)
+{
+	for (VertexBufferResource& vertexBufferResource : vertexArenaResource.vertexBufferResources)
+	{
+		VulkanResource::destroyVertexBufferResource(device, vertexBufferResource);
+	}
+	vertexArenaResource.vertexBufferResources.clear();
+	vertexArenaResource.vertexBuffers.clear();
+	vertexArenaResource.vertexBuffersOffsets.clear();
+	vertexArenaResource.freeRanges.clear();
+}
+
+void RenderManager::terminate(IndexArenaResource& indexArenaResource, VkDevice device)
+{
+	VulkanResource::destroyVertexBufferResource(device, indexArenaResource.indexBufferResource);
+	indexArenaResource.freeRanges.clear();
+}
+
+void RenderManager::terminate(AnimationArenaResource& animationArenaResource, VkDevice device)
+{
+	VulkanResource::destroyStorageBufferResource(device, animationArenaResource.storageBufferResource);
+	animationArenaResource.freeRanges.clear();
+	animationArenaResource.data.clear();
+	animationArenaResource.used = 0;
+	animationArenaResource.dirty.clear();
+}
+
 RenderManager::RenderManager()
 {
 }
@@ -276,6 +450,76 @@ bool RenderManager::renderSetFrames(uint32_t frames)
 	return true;
 }
 
+bool RenderManager::renderSetGeometryArena(bool geometryArena, uint32_t verticesCapacity, uint32_t indicesCapacity)
+{
+	if (geometryResources.size() > 0 || geometryModelResources.size() > 0)
+	{
+		return false;
+	}
+
+	this->geometryArena = geometryArena;
+	this->geometryArenaVerticesCapacity = verticesCapacity;
+	this->geometryArenaIndicesCapacity = indicesCapacity;
+
+	return true;
+}
+
+bool RenderManager::renderSetAnimationArena(uint32_t capacity)
+{
+	if (instanceResources.size() > 0 || capacity == 0)
+	{
+		return false;
+	}
+
+	this->animationArenaCapacity = capacity;
+
+	return true;
+}
+
+bool RenderManager::renderSetLodThreshold(float pixels)
+{
+	if (pixels < 0.0f)
+	{
+		return false;
+	}
+
+	this->lodThreshold = pixels;
+
+	return true;
+}
+
+void RenderManager::renderResetStatistics()
+{
+	RenderStatistics lastStatistics = renderStatistics;
+
+	renderStatistics = RenderStatistics();
+	renderStatistics.textureMemory = lastStatistics.textureMemory;
+	renderStatistics.textureMemoryUncompressed = lastStatistics.textureMemoryUncompressed;
+	renderStatistics.texturesDeduplicated = lastStatistics.texturesDeduplicated;
+	renderStatistics.samplersDeduplicated = lastStatistics.samplersDeduplicated;
+}
+
+bool RenderManager::renderSetClusterCulling(bool clusterCulling)
+{
+	this->clusterCulling = clusterCulling;
+
+	return true;
+}
+
+bool RenderManager::renderSetJointMatrices3x4(bool jointMatrices3x4)
+{
+	this->jointMatrices3x4 = jointMatrices3x4;
+
+	return true;
+}
+
+bool RenderManager::renderSetDeformPrepass(bool deformPrepass)
+{
+	this->deformPrepass = deformPrepass;
+
+	return true;
+}
+
 bool RenderManager::sharedDataSetData(uint64_t sharedDataHandle, VkDeviceSize size, const void* data, VkBufferUsageFlags usage)
 {
 	SharedDataResource* sharedDataResource = getSharedData(sharedDataHandle);
@@ -522,6 +766,20 @@ bool RenderManager::textureSetParameters(uint64_t textureHandle, const TextureRe
 	return true;
 }
 
+bool RenderManager::textureSetParameters(uint64_t textureHandle, TextureResourceCreateInfo&& textureResourceCreateInfo)
+{
+	TextureDataResource* textureDataResource = getTexture(textureHandle);
+
+	if (!textureDataResource->created || textureDataResource->finalized)
+	{
+		return false;
+	}
+
+	textureDataResource->textureResourceCreateInfo = std::move(textureResourceCreateInfo);
+
+	return true;
+}
+
 bool RenderManager::materialSetParameters(uint64_t materialHandle, const MaterialParameters& materialParameters)
 {
 	MaterialResource* materialResource = getMaterial(materialHandle);
@@ -572,29 +830,30 @@ bool RenderManager::materialSetTexture(uint64_t materialHandle, uint64_t texture
 	materialResource->macros[description + "_BINDING"] = std::to_string(binding);
 	materialResource->macros[description + "_TEXCOORD"] = HelperShader::getTexCoord(texCoord);
 
+	// Two channel textures only store x and y, so z is reconstructed in the shader.
+	VkFormat format = textureResource->textureResourceCreateInfo.imageDataResources.images[0].format;
+	if (format == VK_FORMAT_BC5_UNORM_BLOCK || format == VK_FORMAT_R8G8_UNORM)
+	{
+		materialResource->macros[description + "_XY"] = "";
+	}
+
 	return true;
 }
 
-bool RenderManager::geometrySetAttribute(uint64_t geometryHandle, uint64_t sharedDataHandle, const std::string& description, uint32_t count, VkFormat format, uint32_t stride, VkDeviceSize offset, VkDeviceSize range)
+bool RenderManager::geometrySetVertexInput(GeometryResource* geometryResource, const std::string& description, uint32_t count, VkFormat format, uint32_t stride, int32_t& attributeIndex)
 {
-	GeometryResource* geometryResource = getGeometry(geometryHandle);
-
-	if (!geometryResource->created || geometryResource->finalized)
-	{
-		return false;
-	}
-
 	uint32_t typeCount = 0;
 	if (!HelperVulkan::getTypeCount(typeCount, format))
 	{
 		return false;
 	}
 
-	int32_t attributeIndex = static_cast<int32_t>(geometryResource->vertexBuffers.size());
+	attributeIndex = static_cast<int32_t>(geometryResource->vertexInputBindingDescriptions.size());
 
 	if (description == "POSITION")
 	{
-		if (typeCount == 3)
+		// Four components, as three component 8 and 16 bit formats are padded. Fourth component is ignored.
+		if (typeCount == 3 || typeCount == 4)
 		{
 			geometryResource->macros[description + "_VEC3"] = "";
 		}
@@ -605,9 +864,15 @@ bool RenderManager::geometrySetAttribute(uint64_t geometryHandle, uint64_t share
 	}
 	else if (description == "NORMAL")
 	{
-		if (typeCount == 3)
+		if (typeCount == 3 || typeCount == 4)
+		{
+			geometryResource->macros[description + "_VEC3"] = "";
+		}
+		else if (typeCount == 2)
 		{
+			// Octahedral encoded.
 			geometryResource->macros[description + "_VEC3"] = "";
+			geometryResource->macros[description + "_OCT"] = "";
 		}
 		else
 		{
@@ -724,6 +989,31 @@ bool RenderManager::geometrySetAttribute(uint64_t geometryHandle, uint64_t share
 	geometryResource->vertexInputAttributeDescriptions[attributeIndex].format = format;
 	geometryResource->vertexInputAttributeDescriptions[attributeIndex].offset = 0;
 
+	geometryResource->count = count;
+
+	return true;
+}
+
+bool RenderManager::geometrySetAttribute(uint64_t geometryHandle, uint64_t sharedDataHandle, const std::string& description, uint32_t count, VkFormat format, uint32_t stride, VkDeviceSize offset, VkDeviceSize range)
+{
+	GeometryResource* geometryResource = getGeometry(geometryHandle);
+
+	if (!geometryResource->created || geometryResource->finalized)
+	{
+		return false;
+	}
+
+	if (geometryResource->vertexData.size() > 0)
+	{
+		return false;
+	}
+
+	int32_t attributeIndex = 0;
+	if (!geometrySetVertexInput(geometryResource, description, count, format, stride, attributeIndex))
+	{
+		return false;
+	}
+
 	//
 
 	geometryResource->vertexBuffers.resize(attributeIndex + 1);
@@ -735,8 +1025,6 @@ bool RenderManager::geometrySetAttribute(uint64_t geometryHandle, uint64_t share
 	geometryResource->vertexBuffersRanges.resize(attributeIndex + 1);
 	geometryResource->vertexBuffersRanges[attributeIndex] = range;
 
-	geometryResource->count = count;
-
 	return true;
 }
 
@@ -761,6 +1049,112 @@ bool RenderManager::geometrySetAttribute(uint64_t geometryHandle, uint64_t share
 	return geometrySetAttribute(geometryHandle, sharedDataHandle, description, count, format, stride, offset, range);
 }
 
+bool RenderManager::geometrySetAttributeData(uint64_t geometryHandle, const std::string& description, uint32_t count, VkFormat format, uint32_t stride, const void* data)
+{
+	if (!geometryArena)
+	{
+		return false;
+	}
+
+	GeometryResource* geometryResource = getGeometry(geometryHandle);
+
+	if (!geometryResource->created || geometryResource->finalized)
+	{
+		return false;
+	}
+
+	if (geometryResource->vertexBuffers.size() != geometryResource->vertexData.size() || data == nullptr)
+	{
+		return false;
+	}
+
+	if (geometryResource->vertexData.size() > 0 && geometryResource->count != count)
+	{
+		return false;
+	}
+
+	uint32_t typeCount;
+	if (!HelperVulkan::getTypeCount(typeCount, format))
+	{
+		return false;
+	}
+
+	uint32_t componentTypeSize;
+	if (!HelperVulkan::getComponentTypeSize(componentTypeSize, format))
+	{
+		return false;
+	}
+
+	// Data is packed tightly in the arena, no matter of the source stride.
+	int32_t attributeIndex = 0;
+	if (!geometrySetVertexInput(geometryResource, description, count, format, typeCount * componentTypeSize, attributeIndex))
+	{
+		return false;
+	}
+
+	geometryResource->vertexData.resize(attributeIndex + 1);
+	geometryResource->vertexData[attributeIndex] = data;
+
+	geometryResource->vertexDataStrides.resize(attributeIndex + 1);
+	geometryResource->vertexDataStrides[attributeIndex] = glm::max(stride, typeCount * componentTypeSize);
+
+	// Buffers are resolved during finalization.
+	geometryResource->vertexBuffers.resize(attributeIndex + 1, VK_NULL_HANDLE);
+	geometryResource->vertexBuffersOffsets.resize(attributeIndex + 1, 0);
+	geometryResource->vertexBuffersRanges.resize(attributeIndex + 1, 0);
+
+	return true;
+}
+
+bool RenderManager::geometrySetPositionDequantization(uint64_t geometryHandle, const glm::vec3& scale, const glm::vec3& offset)
+{
+	GeometryResource* geometryResource = getGeometry(geometryHandle);
+
+	if (!geometryResource->created || geometryResource->finalized)
+	{
+		return false;
+	}
+
+	if (!isPositionDequantizeSupported())
+	{
+		Logger::print(TinyEngine_ERROR, __FILE__, __LINE__, "Push constants are limited to %u bytes", physicalDeviceProperties.limits.maxPushConstantsSize);
+
+		return false;
+	}
+
+	// Scale and offset are push constants, so all quantized geometry shares the shaders and pipelines.
+	geometryResource->macros["POSITION_DEQUANTIZE"] = "";
+	geometryResource->positionDequantizeScale = glm::vec4(scale, 0.0f);
+	geometryResource->positionDequantizeOffset = glm::vec4(offset, 0.0f);
+
+	return true;
+}
+
+bool RenderManager::geometrySetDeformData(uint64_t geometryHandle, const GeometryDeform& geometryDeform)
+{
+	if (!deformPrepass)
+	{
+		return false;
+	}
+
+	GeometryResource* geometryResource = getGeometry(geometryHandle);
+
+	if (!geometryResource->created || geometryResource->finalized)
+	{
+		return false;
+	}
+
+	if (geometryDeform.count == 0 || geometryDeform.positions.size() != geometryDeform.count || geometryDeform.joints.size() != geometryDeform.count * geometryDeform.jointGroups)
+	{
+		return false;
+	}
+
+	// Uploaded during finalization.
+	geometryResource->deformData = &geometryDeform;
+
+	return true;
+}
+
 bool RenderManager::geometryModelSetGeometry(uint64_t geometryModelHandle, uint64_t geometryHandle)
 {
 	GeometryModelResource* geometryModelResource = getGeometryModel(geometryModelHandle);
@@ -778,6 +1172,7 @@ bool RenderManager::geometryModelSetGeometry(uint64_t geometryModelHandle, uint6
 	}
 
 	geometryModelResource->geometryHandle = geometryHandle;
+	geometryModelResource->vertexOffset = static_cast<int32_t>(geometryResource->baseVertex);
 
 	geometryModelResource->macros.insert(geometryResource->macros.begin(), geometryResource->macros.end());
 
@@ -888,45 +1283,92 @@ bool RenderManager::geometryModelSetIndices(uint64_t geometryModelHandle, uint64
 	return true;
 }
 
-bool RenderManager::geometryModelSetTarget(uint64_t geometryModelHandle, uint64_t sharedDataHandle, const std::string& targetName)
+bool RenderManager::geometryModelSetIndexData(uint64_t geometryModelHandle, uint32_t indicesCount, VkIndexType indexType, const void* data)
 {
-	GeometryModelResource* geometryModelResource = getGeometryModel(geometryModelHandle);
+	if (!geometryArena)
+	{
+		return false;
+	}
+
+	GeometryModelResource* geometryModelResource = getGeometryModel(geometryModelHandle);
 
 	if (!geometryModelResource->created || geometryModelResource->finalized)
 	{
 		return false;
 	}
 
-	SharedDataResource* sharedDataResource = getSharedData(sharedDataHandle);
+	if (data == nullptr)
+	{
+		return false;
+	}
+
+	// Uploaded during finalization, as the topology conversion might change the indices.
+	geometryModelResource->indicesCount = indicesCount;
+	geometryModelResource->indexType = indexType;
+	geometryModelResource->indexData = data;
+
+	return true;
+}
+
+bool RenderManager::geometryModelSetTargets(uint64_t geometryModelHandle, const GeometryTargets& geometryTargets)
+{
+	GeometryModelResource* geometryModelResource = getGeometryModel(geometryModelHandle);
+
+	if (!geometryModelResource->created || geometryModelResource->finalized)
+	{
+		return false;
+	}
 
-	if (!sharedDataResource->finalized)
+	if (geometryTargets.targetsCount == 0 || geometryTargets.offsets.size() != geometryTargets.count + 1)
 	{
 		return false;
 	}
 
-	if (targetName == "POSITION")
+	// All deltas are zero, so there is nothing to morph.
+	if (geometryTargets.offsets.back() == 0)
+	{
+		return true;
+	}
+
+	// Uploaded during finalization, the sparse data has to stay valid until then.
+	geometryModelResource->targetData = &geometryTargets;
+	geometryModelResource->targetVerticesCount = geometryTargets.count;
+	geometryModelResource->targetEntriesCount = geometryTargets.offsets.back();
+
+	geometryModelResource->targetsCount = geometryTargets.targetsCount;
+
+	geometryModelResource->macros["HAS_TARGETS"] = "";
+	if (geometryTargets.positions.size() > 0)
 	{
-		geometryModelResource->targetPositionHandle = sharedDataHandle;
+		geometryModelResource->macros["HAS_TARGET_POSITION"] = "";
 	}
-	else if (targetName == "NORMAL")
+	if (geometryTargets.normals.size() > 0)
 	{
-		geometryModelResource->targetNormalHandle = sharedDataHandle;
+		geometryModelResource->macros["HAS_TARGET_NORMAL"] = "";
 	}
-	else if (targetName == "TANGENT")
+	if (geometryTargets.tangents.size() > 0)
 	{
-		geometryModelResource->targetTangentHandle = sharedDataHandle;
+		geometryModelResource->macros["HAS_TARGET_TANGENT"] = "";
 	}
-	else
+
+	return true;
+}
+
+bool RenderManager::geometryModelSetCullMode(uint64_t geometryModelHandle, VkCullModeFlags cullMode)
+{
+	GeometryModelResource* geometryModelResource = getGeometryModel(geometryModelHandle);
+
+	if (!geometryModelResource->created || geometryModelResource->finalized)
 	{
 		return false;
 	}
 
-	geometryModelResource->macros["HAS_TARGET_" + targetName] = "";
+	geometryModelResource->cullMode = cullMode;
 
 	return true;
 }
 
-bool RenderManager::geometryModelSetTargetsCount(uint64_t geometryModelHandle, uint32_t targetsCount)
+bool RenderManager::geometryModelAddLod(uint64_t geometryModelHandle, uint32_t firstIndex, uint32_t indicesCount, float error)
 {
 	GeometryModelResource* geometryModelResource = getGeometryModel(geometryModelHandle);
 
@@ -935,20 +1377,38 @@ bool RenderManager::geometryModelSetTargetsCount(uint64_t geometryModelHandle, u
 		return false;
 	}
 
-	geometryModelResource->targetsCount = targetsCount;
+	// Levels have to be added from full to lowest resolution.
+	if (indicesCount == 0 || (geometryModelResource->lods.size() > 0 && geometryModelResource->lods.back().error > error))
+	{
+		return false;
+	}
+
+	GeometryModelLod geometryModelLod = {};
+	geometryModelLod.firstIndex = firstIndex;
+	geometryModelLod.indicesCount = indicesCount;
+	geometryModelLod.error = error;
+
+	geometryModelResource->lods.push_back(geometryModelLod);
+
+	return true;
+}
+
+bool RenderManager::geometryModelSetBounds(uint64_t geometryModelHandle, const glm::vec3& center, float radius)
+{
+	GeometryModelResource* geometryModelResource = getGeometryModel(geometryModelHandle);
 
-	uint32_t packedTargetsCount = targetsCount / 4;
-	if (targetsCount % 4 != 0)
+	if (!geometryModelResource->created || geometryModelResource->finalized)
 	{
-		packedTargetsCount++;
+		return false;
 	}
 
-	geometryModelResource->macros["TARGETS_COUNT"] = std::to_string(packedTargetsCount);
+	geometryModelResource->boundsCenter = center;
+	geometryModelResource->boundsRadius = radius;
 
 	return true;
 }
 
-bool RenderManager::geometryModelSetCullMode(uint64_t geometryModelHandle, VkCullModeFlags cullMode)
+bool RenderManager::geometryModelSetMeshlets(uint64_t geometryModelHandle, const std::vector<GeometryMeshlet>& meshlets, const std::vector<uint32_t>& meshletVertices, const std::vector<uint32_t>& meshletTriangles)
 {
 	GeometryModelResource* geometryModelResource = getGeometryModel(geometryModelHandle);
 
@@ -957,7 +1417,19 @@ bool RenderManager::geometryModelSetCullMode(uint64_t geometryModelHandle, VkCul
 		return false;
 	}
 
-	geometryModelResource->cullMode = cullMode;
+	if (meshlets.size() == 0 || meshletVertices.size() == 0 || meshletTriangles.size() == 0)
+	{
+		return false;
+	}
+
+	// Uploaded during finalization, only if cluster culling is enabled.
+	geometryModelResource->meshletData = meshlets.data();
+	geometryModelResource->meshletVertexData = meshletVertices.data();
+	geometryModelResource->meshletTriangleData = meshletTriangles.data();
+
+	geometryModelResource->meshletsCount = static_cast<uint32_t>(meshlets.size());
+	geometryModelResource->meshletVerticesCount = static_cast<uint32_t>(meshletVertices.size());
+	geometryModelResource->meshletTrianglesCount = static_cast<uint32_t>(meshletTriangles.size());
 
 	return true;
 }
@@ -1004,7 +1476,7 @@ bool RenderManager::instanceSetGroup(uint64_t instanceHandle, uint64_t groupHand
 	return true;
 }
 
-bool RenderManager::instanceSetWeights(uint64_t instanceHandle, uint64_t sharedDataHandle)
+bool RenderManager::instanceSetWeights(uint64_t instanceHandle, const std::vector<float>& weights)
 {
 	InstanceResource* instanceResource = getInstance(instanceHandle);
 
@@ -1013,19 +1485,25 @@ bool RenderManager::instanceSetWeights(uint64_t instanceHandle, uint64_t sharedD
 		return false;
 	}
 
-	SharedDataResource* sharedDataResource = getSharedData(sharedDataHandle);
+	if (weights.size() == 0 || instanceResource->weightsCount > 0)
+	{
+		return false;
+	}
 
-	if (!sharedDataResource->finalized)
+	if (!animationArenaAllocate(instanceResource->weightsOffset, HelperTarget::getPackedWeightsCount(static_cast<uint32_t>(weights.size()))))
 	{
 		return false;
 	}
+	instanceResource->weightsCount = static_cast<uint32_t>(weights.size());
 
-	instanceResource->weightsHandle = sharedDataHandle;
+	instanceResource->deformWeights = weights;
+
+	instanceWriteWeights(instanceResource, weights);
 
 	return true;
 }
 
-bool RenderManager::instanceSetJointMatrices(uint64_t instanceHandle, uint64_t sharedDataHandle, uint32_t jointMatricesCount)
+bool RenderManager::instanceSetJointMatrices(uint64_t instanceHandle, const std::vector<glm::mat4>& jointMatrices)
 {
 	InstanceResource* instanceResource = getInstance(instanceHandle);
 
@@ -1034,20 +1512,68 @@ bool RenderManager::instanceSetJointMatrices(uint64_t instanceHandle, uint64_t s
 		return false;
 	}
 
-	SharedDataResource* sharedDataResource = getSharedData(sharedDataHandle);
+	if (jointMatrices.size() == 0 || instanceResource->jointMatricesCount > 0 || instanceResource->bakedJointsTextureHandle > 0)
+	{
+		return false;
+	}
+
+	uint32_t vectorsCount = static_cast<uint32_t>(jointMatrices.size()) * (jointMatrices3x4 ? 3 : 4);
+	if (!animationArenaAllocate(instanceResource->jointMatricesOffset, vectorsCount))
+	{
+		return false;
+	}
+	instanceResource->jointMatricesCount = static_cast<uint32_t>(jointMatrices.size());
+	instanceResource->jointMatricesVectorsCount = vectorsCount;
+
+	instanceResource->deformJointMatrices = jointMatrices;
+
+	instanceWriteJointMatrices(instanceResource, jointMatrices);
+
+	return true;
+}
+
+bool RenderManager::instanceSetBakedJointMatrices(uint64_t instanceHandle, uint64_t textureHandle, uint32_t jointsCount, uint32_t framesCount, float duration)
+{
+	InstanceResource* instanceResource = getInstance(instanceHandle);
+
+	if (!instanceResource->created || instanceResource->finalized)
+	{
+		return false;
+	}
 
-	if (!sharedDataResource->finalized)
+	// At least two frames are needed to loop.
+	if (textureHandle == 0 || jointsCount == 0 || framesCount < 2 || duration <= 0.0f || instanceResource->jointMatricesCount > 0)
 	{
 		return false;
 	}
 
-	instanceResource->jointMatricesHandle = sharedDataHandle;
-	instanceResource->jointMatricesCount = jointMatricesCount;
+	instanceResource->bakedJointsTextureHandle = textureHandle;
+	instanceResource->bakedJointsCount = jointsCount;
+	instanceResource->bakedFramesCount = framesCount;
+	instanceResource->bakedDuration = duration;
 
 	return true;
 }
 
+bool RenderManager::instanceSetCrowd(uint64_t instanceHandle, const std::vector<CrowdMember>& crowdMembers)
+{
+	InstanceResource* instanceResource = getInstance(instanceHandle);
+
+	if (!instanceResource->created || instanceResource->finalized)
+	{
+		return false;
+	}
+
+	if (crowdMembers.size() == 0)
+	{
+		return false;
+	}
+
+	instanceResource->crowdMembers = crowdMembers;
+	instanceResource->crowdCount = static_cast<uint32_t>(crowdMembers.size());
 
+	return true;
+}
 
 bool RenderManager::lightSetEnvironment(uint64_t lightHandle, const std::string& environment)
 {
@@ -1152,11 +1678,94 @@ bool RenderManager::textureFinalize(uint64_t textureHandle)
 		return false;
 	}
 
-	if (!VulkanResource::createTextureResource(physicalDevice, device, queue, commandPool, textureDataResource->textureResource, textureDataResource->textureResourceCreateInfo))
+	const TextureResourceCreateInfo& textureResourceCreateInfo = textureDataResource->textureResourceCreateInfo;
+
+	if (textureResourceCreateInfo.imageDataResources.images.empty())
 	{
 		return false;
 	}
 
+	// Textures with the same image content share the image, the ones with the same parameters the sampler.
+	uint64_t imageHash = getImageHash(textureResourceCreateInfo);
+
+	auto textureImageResource = textureImageResources.find(imageHash);
+	while (textureImageResource != textureImageResources.end() && !isSameImage(textureImageResource->second, textureResourceCreateInfo))
+	{
+		Logger::print(TinyEngine_WARNING, __FILE__, __LINE__, "Image hash collision, texture gets its own image");
+
+		imageHash = HelperHash::combine(imageHash, 1);
+		textureImageResource = textureImageResources.find(imageHash);
+	}
+
+	if (textureImageResource == textureImageResources.end())
+	{
+		TextureImageResource newTextureImageResource = {};
+		if (!VulkanResource::createTextureImageResource(physicalDevice, device, queue, commandPool, newTextureImageResource.imageViewResource, newTextureImageResource.mipLevels, textureResourceCreateInfo))
+		{
+			return false;
+		}
+
+		for (const ImageDataResource& imageDataResource : textureResourceCreateInfo.imageDataResources.images)
+		{
+			TextureImageLayout textureImageLayout = {};
+			textureImageLayout.width = imageDataResource.width;
+			textureImageLayout.height = imageDataResource.height;
+			textureImageLayout.format = imageDataResource.format;
+			textureImageLayout.mipLevel = imageDataResource.mipLevel;
+			textureImageLayout.face = imageDataResource.face;
+			textureImageLayout.size = imageDataResource.mapped ? imageDataResource.mappedSize : imageDataResource.pixels.size();
+
+			newTextureImageResource.imageLayouts.push_back(textureImageLayout);
+		}
+		newTextureImageResource.imageMipLevels = textureResourceCreateInfo.imageDataResources.mipLevels;
+		newTextureImageResource.faceCount = textureResourceCreateInfo.imageDataResources.faceCount;
+		newTextureImageResource.mipMap = textureResourceCreateInfo.mipMap;
+		newTextureImageResource.textureHandle = textureHandle;
+
+		getTextureMemory(newTextureImageResource.memory, newTextureImageResource.memoryUncompressed, newTextureImageResource.imageViewResource, textureResourceCreateInfo.imageDataResources.images[0].format);
+
+		renderStatistics.textureMemory += newTextureImageResource.memory;
+		renderStatistics.textureMemoryUncompressed += newTextureImageResource.memoryUncompressed;
+
+		textureImageResource = textureImageResources.emplace(imageHash, newTextureImageResource).first;
+	}
+	else
+	{
+		renderStatistics.texturesDeduplicated++;
+	}
+
+	SamplerResourceCreateInfo samplerResourceCreateInfo = textureResourceCreateInfo.samplerResourceCreateInfo;
+	samplerResourceCreateInfo.maxLod = (float)textureImageResource->second.mipLevels;
+
+	auto textureSamplerResource = textureSamplerResources.find(samplerResourceCreateInfo);
+	if (textureSamplerResource == textureSamplerResources.end())
+	{
+		TextureSamplerResource newTextureSamplerResource = {};
+		if (!VulkanResource::createSamplerResource(device, newTextureSamplerResource.samplerResource, samplerResourceCreateInfo))
+		{
+			if (textureImageResource->second.references == 0)
+			{
+				destroyTextureImage(textureImageResource);
+			}
+
+			return false;
+		}
+
+		textureSamplerResource = textureSamplerResources.emplace(samplerResourceCreateInfo, newTextureSamplerResource).first;
+	}
+	else
+	{
+		renderStatistics.samplersDeduplicated++;
+	}
+
+	textureImageResource->second.references++;
+	textureSamplerResource->second.references++;
+
+	textureDataResource->imageHash = imageHash;
+	textureDataResource->samplerResourceCreateInfo = samplerResourceCreateInfo;
+	textureDataResource->textureResource.imageViewResource = textureImageResource->second.imageViewResource;
+	textureDataResource->textureResource.samplerResource = textureSamplerResource->second.samplerResource;
+
 	//
 
 	WorldResource* worldResource = getWorld();
@@ -1235,506 +1844,536 @@ bool RenderManager::materialFinalize(uint64_t materialHandle)
 	return true;
 }
 
-bool RenderManager::geometryFinalize(uint64_t geometryHandle)
+bool RenderManager::geometryArenaAllocate(GeometryResource* geometryResource)
 {
-	GeometryResource* geometryResource = getGeometry(geometryHandle);
+	size_t attributesCount = geometryResource->vertexData.size();
 
-	if (!geometryResource->created || geometryResource->finalized)
+	std::vector<VkFormat> formats(attributesCount);
+	std::vector<uint32_t> strides(attributesCount);
+	for (size_t i = 0; i < attributesCount; i++)
 	{
-		return false;
+		formats[i] = geometryResource->vertexInputAttributeDescriptions[i].format;
+		strides[i] = geometryResource->vertexInputBindingDescriptions[i].stride;
 	}
 
-	geometryResource->finalized = true;
-
-	return true;
-}
-
-bool RenderManager::geometryModelFinalize(uint64_t geometryModelHandle)
-{
-	GeometryModelResource* geometryModelResource = getGeometryModel(geometryModelHandle);
+	VkDeviceSize baseVertex = 0;
 
-	if (!geometryModelResource->created || geometryModelResource->finalized)
+	int32_t arenaIndex = -1;
+	for (size_t i = 0; i < vertexArenaResources.size(); i++)
 	{
-		return false;
-	}
-
-	bool convert = false;
+		if (vertexArenaResources[i].formats == formats && HelperArena::allocate(baseVertex, vertexArenaResources[i].freeRanges, geometryResource->count))
+		{
+			arenaIndex = static_cast<int32_t>(i);
 
-	switch (geometryModelResource->mode)
-	{
-		case 0:
-			geometryModelResource->topology = VK_PRIMITIVE_TOPOLOGY_POINT_LIST;
-			break;
-		case 1:
-			geometryModelResource->topology = VK_PRIMITIVE_TOPOLOGY_LINE_LIST;
-			break;
-		case 2:
-			geometryModelResource->topology = VK_PRIMITIVE_TOPOLOGY_LINE_STRIP;
-			convert = true;
-			break;
-		case 3:
-			geometryModelResource->topology = VK_PRIMITIVE_TOPOLOGY_LINE_STRIP;
-			break;
-		case 4:
-			geometryModelResource->topology = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST;
-			break;
-		case 5:
-			geometryModelResource->topology = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_STRIP;
-			break;
-		case 6:
-			geometryModelResource->topology = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_FAN;
 			break;
-		default:
-			return false;
+		}
 	}
 
-	if (convert)
+	if (arenaIndex < 0)
 	{
-		std::vector<uint32_t> newIndices;
+		VertexArenaResource vertexArenaResource = {};
+		vertexArenaResource.formats = formats;
+		vertexArenaResource.strides = strides;
+		vertexArenaResource.capacity = glm::max(geometryArenaVerticesCapacity, geometryResource->count);
+		vertexArenaResource.freeRanges.push_back({0, vertexArenaResource.capacity});
 
-		if (geometryModelResource->indexType == VK_INDEX_TYPE_NONE_KHR)
-		{
-			for (uint32_t i = 0; i < geometryModelResource->verticesCount; i++)
-			{
-				newIndices.push_back(i);
-			}
-			newIndices.push_back(0);
-		}
-		else
+		for (size_t i = 0; i < attributesCount; i++)
 		{
-			SharedDataResource* sharedDataResource = getSharedData(geometryModelResource->indexHandle);
-			if (geometryModelResource->indexType == VK_INDEX_TYPE_UINT16)
-			{
-				const uint16_t* shortData = reinterpret_cast<const uint16_t*>(sharedDataResource->vertexBufferResourceCreateInfo.data);
-
-				for (uint32_t i = 0; i < geometryModelResource->indicesCount; i++)
-				{
-					newIndices.push_back(static_cast<uint32_t>(shortData[i]));
-				}
+			VertexBufferResourceCreateInfo vertexBufferResourceCreateInfo = {};
+			vertexBufferResourceCreateInfo.bufferResourceCreateInfo.size = vertexArenaResource.capacity * strides[i];
+			vertexBufferResourceCreateInfo.bufferResourceCreateInfo.usage = VK_BUFFER_USAGE_VERTEX_BUFFER_BIT;
+			vertexBufferResourceCreateInfo.bufferResourceCreateInfo.memoryProperty = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT;
 
-				newIndices.push_back(newIndices[0]);
-			}
-			else if (geometryModelResource->indexType == VK_INDEX_TYPE_UINT32)
+			VertexBufferResource vertexBufferResource = {};
+			if (!VulkanResource::createVertexBufferResource(physicalDevice, device, queue, commandPool, vertexBufferResource, vertexBufferResourceCreateInfo))
 			{
-				const uint32_t* integerData = reinterpret_cast<const uint32_t*>(sharedDataResource->vertexBufferResourceCreateInfo.data);
-
-				for (uint32_t i = 0; i < geometryModelResource->indicesCount; i++)
-				{
-					newIndices.push_back(integerData[i]);
-				}
+				terminate(vertexArenaResource, device);
 
-				newIndices.push_back(newIndices[0]);
-			}
-			else
-			{
 				return false;
 			}
-		}
 
-		uint64_t sharedDataHandle;
-		if (!sharedDataCreate(sharedDataHandle))
-		{
-			return false;
+			vertexArenaResource.vertexBufferResources.push_back(vertexBufferResource);
+			vertexArenaResource.vertexBuffers.push_back(vertexBufferResource.bufferResource.buffer);
+			vertexArenaResource.vertexBuffersOffsets.push_back(0);
 		}
 
-		if (!sharedDataCreateIndexBuffer(sharedDataHandle, newIndices.size() * sizeof(uint32_t), newIndices.data()))
+		if (!HelperArena::allocate(baseVertex, vertexArenaResource.freeRanges, geometryResource->count))
 		{
-			return false;
-		}
+			terminate(vertexArenaResource, device);
 
-		if (!sharedDataFinalize(sharedDataHandle))
-		{
 			return false;
 		}
 
-		geometryModelResource->indicesCount = static_cast<uint32_t>(newIndices.size());
-		geometryModelResource->indexType = VK_INDEX_TYPE_UINT32;
-		geometryModelResource->indexBuffer = getBuffer(sharedDataHandle);
-		geometryModelResource->indexOffset = 0;
-		geometryModelResource->indexRange = newIndices.size() * sizeof(uint32_t);
+		vertexArenaResources.push_back(vertexArenaResource);
+		arenaIndex = static_cast<int32_t>(vertexArenaResources.size() - 1);
+
+		Logger::print(TinyEngine_INFO, __FILE__, __LINE__, "Created vertex arena %d for %u vertices", arenaIndex, static_cast<uint32_t>(vertexArenaResource.capacity));
 	}
 
-	geometryModelResource->finalized = true;
+	VertexArenaResource& vertexArenaResource = vertexArenaResources[arenaIndex];
 
-	return true;
-}
+	// Pack all attributes into one staging buffer, so the upload needs one submit.
 
-bool RenderManager::groupFinalize(uint64_t groupHandle)
-{
-	GroupResource* groupResource = getGroup(groupHandle);
+	std::vector<VkBufferCopy> bufferCopies(attributesCount);
 
-	if (!groupResource->created || groupResource->finalized)
+	VkDeviceSize stagingSize = 0;
+	for (size_t i = 0; i < attributesCount; i++)
 	{
-		return false;
+		bufferCopies[i].srcOffset = stagingSize;
+		bufferCopies[i].dstOffset = baseVertex * strides[i];
+		bufferCopies[i].size = geometryResource->count * strides[i];
+
+		stagingSize += bufferCopies[i].size;
 	}
 
-	groupResource->finalized = true;
+	std::vector<uint8_t> stagingData(stagingSize);
+	for (size_t i = 0; i < attributesCount; i++)
+	{
+		const uint8_t* sourceData = reinterpret_cast<const uint8_t*>(geometryResource->vertexData[i]);
 
-	return true;
-}
+		for (uint32_t vertex = 0; vertex < geometryResource->count; vertex++)
+		{
+			memcpy(&stagingData[bufferCopies[i].srcOffset + vertex * strides[i]], sourceData + vertex * geometryResource->vertexDataStrides[i], strides[i]);
+		}
+	}
 
-bool RenderManager::instanceFinalize(uint64_t instanceHandle)
-{
-	InstanceResource* instanceResource = getInstance(instanceHandle);
+	DeviceBufferResourceCreateInfo stagingBufferResourceCreateInfo = {};
+	stagingBufferResourceCreateInfo.bufferResourceCreateInfo.size = stagingSize;
+	stagingBufferResourceCreateInfo.bufferResourceCreateInfo.usage = VK_BUFFER_USAGE_TRANSFER_SRC_BIT;
+	stagingBufferResourceCreateInfo.bufferResourceCreateInfo.memoryProperty = VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT;
+	stagingBufferResourceCreateInfo.data = stagingData.data();
 
-	if (!instanceResource->created || instanceResource->finalized)
+	DeviceBufferResource stagingBufferResource = {};
+	if (!VulkanResource::createDeviceBufferResource(physicalDevice, device, queue, commandPool, stagingBufferResource, stagingBufferResourceCreateInfo))
 	{
+		HelperArena::release(vertexArenaResource.freeRanges, baseVertex, geometryResource->count);
+
 		return false;
 	}
 
-	//
+	VkCommandBuffer commandBuffer = VK_NULL_HANDLE;
+	if (!HelperVulkan::beginOneTimeSubmitCommand(device, commandPool, commandBuffer))
+	{
+		VulkanResource::destroyDeviceBufferResource(device, stagingBufferResource);
+		HelperArena::release(vertexArenaResource.freeRanges, baseVertex, geometryResource->count);
 
-	GroupResource* groupResource = getGroup(instanceResource->groupHandle);
+		return false;
+	}
 
-	instanceResource->instanceContainers.resize(groupResource->geometryModelHandles.size());
+	for (size_t i = 0; i < attributesCount; i++)
+	{
+		vkCmdCopyBuffer(commandBuffer, stagingBufferResource.bufferResource.buffer, vertexArenaResource.vertexBuffers[i], 1, &bufferCopies[i]);
+	}
 
-	for (size_t geometryModelIndex = 0; geometryModelIndex < groupResource->geometryModelHandles.size(); geometryModelIndex++)
+	if (!HelperVulkan::endOneTimeSubmitCommand(device, queue, commandPool, commandBuffer))
 	{
-		GeometryModelResource* geometryModelResource = getGeometryModel(groupResource->geometryModelHandles[geometryModelIndex]);
+		VulkanResource::destroyDeviceBufferResource(device, stagingBufferResource);
+		HelperArena::release(vertexArenaResource.freeRanges, baseVertex, geometryResource->count);
 
-		//
+		return false;
+	}
 
-		GeometryResource* geometryResource = getGeometry(geometryModelResource->geometryHandle);
+	VulkanResource::destroyDeviceBufferResource(device, stagingBufferResource);
 
-		//
+	//
 
-		uint32_t binding = 0;
-
-		std::vector<VkDescriptorSetLayout> setLayouts;
-		std::vector<VkDescriptorSetLayoutBinding> descriptorSetLayoutBindings;
-
-		std::vector<VkDescriptorImageInfo> descriptorImageInfos;
-		std::vector<VkDescriptorBufferInfo> descriptorBufferInfos;
+	geometryResource->vertexBuffers = vertexArenaResource.vertexBuffers;
+	geometryResource->vertexBuffersOffsets = vertexArenaResource.vertexBuffersOffsets;
+	for (size_t i = 0; i < attributesCount; i++)
+	{
+		geometryResource->vertexBuffersRanges[i] = bufferCopies[i].size;
+	}
 
-		if (geometryModelResource->materialHandle > 0)
-		{
-			MaterialResource* materialResource = getMaterial(geometryModelResource->materialHandle);
+	geometryResource->arenaIndex = arenaIndex;
+	geometryResource->baseVertex = static_cast<uint32_t>(baseVertex);
 
-			if (materialResource->descriptorSetLayoutBindings.size() > 0)
-			{
-				binding = materialResource->descriptorSetLayoutBindings.back().binding + 1;
-			}
+	geometryResource->vertexData.clear();
+	geometryResource->vertexDataStrides.clear();
 
-			descriptorSetLayoutBindings = materialResource->descriptorSetLayoutBindings;
+	return true;
+}
 
-			descriptorImageInfos = materialResource->descriptorImageInfos;
-			descriptorBufferInfos = materialResource->descriptorBufferInfos;
-		}
+bool RenderManager::geometryModelArenaAllocate(GeometryModelResource* geometryModelResource, const void* indices, uint32_t indicesCount, VkIndexType indexType)
+{
+	uint32_t indexSize = 0;
+	if (indexType == VK_INDEX_TYPE_UINT16)
+	{
+		indexSize = sizeof(uint16_t);
+	}
+	else if (indexType == VK_INDEX_TYPE_UINT32)
+	{
+		indexSize = sizeof(uint32_t);
+	}
+	else
+	{
+		return false;
+	}
 
-		// Morphing
+	VkDeviceSize firstIndex = 0;
 
-		if (geometryModelResource->targetPositionHandle != 0)
+	int32_t arenaIndex = -1;
+	for (size_t i = 0; i < indexArenaResources.size(); i++)
+	{
+		if (indexArenaResources[i].indexType == indexType && HelperArena::allocate(firstIndex, indexArenaResources[i].freeRanges, indicesCount))
 		{
-			VkDescriptorSetLayoutBinding descriptorSetLayoutBinding = {};
-			descriptorSetLayoutBinding = {};
-			descriptorSetLayoutBinding.binding = binding;
-			descriptorSetLayoutBinding.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
-			descriptorSetLayoutBinding.descriptorCount = 1;
-			descriptorSetLayoutBinding.stageFlags = VK_SHADER_STAGE_VERTEX_BIT;
-			descriptorSetLayoutBindings.push_back(descriptorSetLayoutBinding);
+			arenaIndex = static_cast<int32_t>(i);
 
-			VkDescriptorBufferInfo descriptorBufferInfo = {};
-			descriptorBufferInfo.buffer = getSharedData(geometryModelResource->targetPositionHandle)->storageBufferResource.bufferResource.buffer;
-			descriptorBufferInfo.offset = 0;
-			descriptorBufferInfo.range = sizeof(glm::vec3) * geometryModelResource->targetsCount * geometryResource->count;
-			descriptorBufferInfos.push_back(descriptorBufferInfo);
-
-			geometryModelResource->macros["TARGET_POSITION_BINDING"] = std::to_string(binding);
-
-			binding++;
+			break;
 		}
+	}
 
-		if (geometryModelResource->targetNormalHandle != 0)
-		{
-			VkDescriptorSetLayoutBinding descriptorSetLayoutBinding = {};
-			descriptorSetLayoutBinding = {};
-			descriptorSetLayoutBinding.binding = binding;
-			descriptorSetLayoutBinding.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
-			descriptorSetLayoutBinding.descriptorCount = 1;
-			descriptorSetLayoutBinding.stageFlags = VK_SHADER_STAGE_VERTEX_BIT;
-			descriptorSetLayoutBindings.push_back(descriptorSetLayoutBinding);
-
-			VkDescriptorBufferInfo descriptorBufferInfo = {};
-			descriptorBufferInfo.buffer = getSharedData(geometryModelResource->targetNormalHandle)->storageBufferResource.bufferResource.buffer;
-			descriptorBufferInfo.offset = 0;
-			descriptorBufferInfo.range = sizeof(glm::vec3) * geometryModelResource->targetsCount * geometryResource->count;
-			descriptorBufferInfos.push_back(descriptorBufferInfo);
-
-			geometryModelResource->macros["TARGET_NORMAL_BINDING"] = std::to_string(binding);
+	if (arenaIndex < 0)
+	{
+		IndexArenaResource indexArenaResource = {};
+		indexArenaResource.indexType = indexType;
+		indexArenaResource.capacity = glm::max(geometryArenaIndicesCapacity, indicesCount);
+		indexArenaResource.freeRanges.push_back({0, indexArenaResource.capacity});
 
-			binding++;
-		}
+		VertexBufferResourceCreateInfo indexBufferResourceCreateInfo = {};
+		indexBufferResourceCreateInfo.bufferResourceCreateInfo.size = indexArenaResource.capacity * indexSize;
+		indexBufferResourceCreateInfo.bufferResourceCreateInfo.usage = VK_BUFFER_USAGE_INDEX_BUFFER_BIT;
+		indexBufferResourceCreateInfo.bufferResourceCreateInfo.memoryProperty = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT;
 
-		if (geometryModelResource->targetTangentHandle != 0)
+		if (!VulkanResource::createVertexBufferResource(physicalDevice, device, queue, commandPool, indexArenaResource.indexBufferResource, indexBufferResourceCreateInfo))
 		{
-			VkDescriptorSetLayoutBinding descriptorSetLayoutBinding = {};
-			descriptorSetLayoutBinding = {};
-			descriptorSetLayoutBinding.binding = binding;
-			descriptorSetLayoutBinding.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
-			descriptorSetLayoutBinding.descriptorCount = 1;
-			descriptorSetLayoutBinding.stageFlags = VK_SHADER_STAGE_VERTEX_BIT;
-			descriptorSetLayoutBindings.push_back(descriptorSetLayoutBinding);
-
-			VkDescriptorBufferInfo descriptorBufferInfo = {};
-			descriptorBufferInfo.buffer = getSharedData(geometryModelResource->targetTangentHandle)->storageBufferResource.bufferResource.buffer;
-			descriptorBufferInfo.offset = 0;
-			descriptorBufferInfo.range = sizeof(glm::vec3) * geometryModelResource->targetsCount * geometryResource->count;
-			descriptorBufferInfos.push_back(descriptorBufferInfo);
-
-			geometryModelResource->macros["TARGET_TANGENT_BINDING"] = std::to_string(binding);
-
-			binding++;
+			return false;
 		}
 
-		if (instanceResource->weightsHandle != 0)
+		if (!HelperArena::allocate(firstIndex, indexArenaResource.freeRanges, indicesCount))
 		{
-			VkDescriptorSetLayoutBinding descriptorSetLayoutBinding = {};
-			descriptorSetLayoutBinding = {};
-			descriptorSetLayoutBinding.binding = binding;
-			descriptorSetLayoutBinding.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC;
-			descriptorSetLayoutBinding.descriptorCount = 1;
-			descriptorSetLayoutBinding.stageFlags = VK_SHADER_STAGE_VERTEX_BIT;
-			descriptorSetLayoutBindings.push_back(descriptorSetLayoutBinding);
+			terminate(indexArenaResource, device);
 
-			VkDescriptorBufferInfo descriptorBufferInfo = {};
-			descriptorBufferInfo.buffer = getSharedData(instanceResource->weightsHandle)->uniformBufferResource.bufferResource.buffer;
-			descriptorBufferInfo.offset = 0;
-			descriptorBufferInfo.range = sizeof(float) * geometryModelResource->targetsCount;
-			descriptorBufferInfos.push_back(descriptorBufferInfo);
-
-			geometryModelResource->macros["WEIGHTS_BINDING"] = std::to_string(binding);
-
-			geometryModelResource->macros["HAS_WEIGHTS"] = "";
+			return false;
+		}
 
-			binding++;
+		indexArenaResources.push_back(indexArenaResource);
+		arenaIndex = static_cast<int32_t>(indexArenaResources.size() - 1);
 
-			//
+		Logger::print(TinyEngine_INFO, __FILE__, __LINE__, "Created index arena %d for %u indices", arenaIndex, static_cast<uint32_t>(indexArenaResource.capacity));
+	}
 
-			instanceResource->instanceContainers[geometryModelIndex].dynamicOffsets.resize(frames, 0);
+	IndexArenaResource& indexArenaResource = indexArenaResources[arenaIndex];
 
-			VkDeviceSize size = getSharedData(instanceResource->weightsHandle)->size / (frames * groupResource->geometryModelHandles.size());
+	DeviceBufferResourceCreateInfo stagingBufferResourceCreateInfo = {};
+	stagingBufferResourceCreateInfo.bufferResourceCreateInfo.size = indicesCount * indexSize;
+	stagingBufferResourceCreateInfo.bufferResourceCreateInfo.usage = VK_BUFFER_USAGE_TRANSFER_SRC_BIT;
+	stagingBufferResourceCreateInfo.bufferResourceCreateInfo.memoryProperty = VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT;
+	stagingBufferResourceCreateInfo.data = indices;
 
-			for (uint32_t i = 0; i < frames; i++)
-			{
-				instanceResource->instanceContainers[geometryModelIndex].dynamicOffsets[i] = i * size + geometryModelIndex * groupResource->geometryModelHandles.size() * size;
-			}
-		}
+	DeviceBufferResource stagingBufferResource = {};
+	if (!VulkanResource::createDeviceBufferResource(physicalDevice, device, queue, commandPool, stagingBufferResource, stagingBufferResourceCreateInfo))
+	{
+		HelperArena::release(indexArenaResource.freeRanges, firstIndex, indicesCount);
 
-		// Skinning
+		return false;
+	}
 
-		if (instanceResource->jointMatricesHandle != 0)
-		{
-			VkDescriptorSetLayoutBinding descriptorSetLayoutBinding = {};
-			descriptorSetLayoutBinding = {};
-			descriptorSetLayoutBinding.binding = binding;
-			descriptorSetLayoutBinding.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC;
-			descriptorSetLayoutBinding.descriptorCount = 1;
-			descriptorSetLayoutBinding.stageFlags = VK_SHADER_STAGE_VERTEX_BIT;
-			descriptorSetLayoutBindings.push_back(descriptorSetLayoutBinding);
+	if (!HelperVulkan::copyBuffer(device, queue, commandPool, stagingBufferResource.bufferResource.buffer, indexArenaResource.indexBufferResource.bufferResource.buffer, indicesCount * indexSize, 0, firstIndex * indexSize))
+	{
+		VulkanResource::destroyDeviceBufferResource(device, stagingBufferResource);
+		HelperArena::release(indexArenaResource.freeRanges, firstIndex, indicesCount);
 
-			VkDescriptorBufferInfo descriptorBufferInfo = {};
-			descriptorBufferInfo.buffer = getSharedData(instanceResource->jointMatricesHandle)->uniformBufferResource.bufferResource.buffer;
-			descriptorBufferInfo.offset = 0;
-			descriptorBufferInfo.range = sizeof(glm::mat4) * instanceResource->jointMatricesCount;
-			descriptorBufferInfos.push_back(descriptorBufferInfo);
+		return false;
+	}
 
-			geometryModelResource->macros["JOINT_MATRICES_BINDING"] = std::to_string(binding);
-			geometryModelResource->macros["JOINT_MATRICES_COUNT"] = std::to_string(instanceResource->jointMatricesCount);
+	VulkanResource::destroyDeviceBufferResource(device, stagingBufferResource);
 
-			geometryModelResource->macros["HAS_JOINTS"] = "";
+	//
 
-			binding++;
+	geometryModelResource->indicesCount = indicesCount;
+	geometryModelResource->indexType = indexType;
+	geometryModelResource->indexBuffer = indexArenaResource.indexBufferResource.bufferResource.buffer;
+	geometryModelResource->indexOffset = 0;
+	geometryModelResource->indexRange = indicesCount * indexSize;
 
-			//
+	geometryModelResource->arenaIndex = arenaIndex;
+	geometryModelResource->firstIndex = static_cast<uint32_t>(firstIndex);
 
-			std::vector<uint32_t> dynamicOffsets = instanceResource->instanceContainers[geometryModelIndex].dynamicOffsets;
-			instanceResource->instanceContainers[geometryModelIndex].dynamicOffsets.clear();
+	return true;
+}
 
-			VkDeviceSize size = getSharedData(instanceResource->jointMatricesHandle)->size / frames;
+bool RenderManager::animationArenaAllocate(uint32_t& offset, uint32_t count)
+{
+	if (animationArenaResource.storageBufferResource.bufferResource.buffer == VK_NULL_HANDLE)
+	{
+		// Every frame region has to start at a valid dynamic offset.
+		if (!HelperVulkan::getAligenedSize(animationArenaResource.frameSize, sizeof(glm::vec4) * animationArenaCapacity, physicalDeviceProperties.limits.minStorageBufferOffsetAlignment))
+		{
+			return false;
+		}
 
-			for (uint32_t i = 0; i < frames; i++)
-			{
-				if (dynamicOffsets.size() > 0)
-				{
-					instanceResource->instanceContainers[geometryModelIndex].dynamicOffsets.push_back(dynamicOffsets[i]);
-				}
+		StorageBufferResourceCreateInfo storageBufferResourceCreateInfo = {};
+		storageBufferResourceCreateInfo.bufferResourceCreateInfo.size = animationArenaResource.frameSize * frames;
+		storageBufferResourceCreateInfo.bufferResourceCreateInfo.usage = VK_BUFFER_USAGE_STORAGE_BUFFER_BIT;
+		storageBufferResourceCreateInfo.bufferResourceCreateInfo.memoryProperty = VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT;
 
-				instanceResource->instanceContainers[geometryModelIndex].dynamicOffsets.push_back(i * size);
-			}
+		if (!VulkanResource::createStorageBufferResource(physicalDevice, device, queue, commandPool, animationArenaResource.storageBufferResource, storageBufferResourceCreateInfo))
+		{
+			return false;
 		}
 
-		// Lighting
-
-		WorldResource* worldResource = getWorld();
+		animationArenaResource.capacity = animationArenaCapacity;
+		animationArenaResource.freeRanges.push_back({0, animationArenaResource.capacity});
+		animationArenaResource.data.resize(animationArenaResource.capacity, glm::vec4(0.0f));
+		animationArenaResource.used = 0;
+		animationArenaResource.dirty.resize(frames, true);
+	}
 
-		if (worldResource->lightHandle > 0)
-		{
-			LightResource* lightResource = getLight(worldResource->lightHandle);
+	VkDeviceSize arenaOffset = 0;
+	if (!HelperArena::allocate(arenaOffset, animationArenaResource.freeRanges, count))
+	{
+		Logger::print(TinyEngine_ERROR, __FILE__, __LINE__, "Animation arena with %u vectors is full", animationArenaCapacity);
 
-			VkDescriptorSetLayoutBinding descriptorSetLayoutBinding = {};
-			descriptorSetLayoutBinding.binding = binding;
-			descriptorSetLayoutBinding.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
-			descriptorSetLayoutBinding.descriptorCount = 1;
-			descriptorSetLayoutBinding.stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT;
-			descriptorSetLayoutBindings.push_back(descriptorSetLayoutBinding);
+		return false;
+	}
 
-			VkDescriptorImageInfo descriptorImageInfo = {};
-			descriptorImageInfo.sampler = lightResource->diffuse.samplerResource.sampler;
-			descriptorImageInfo.imageView = lightResource->diffuse.imageViewResource.imageView;
-			descriptorImageInfo.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
-			descriptorImageInfos.push_back(descriptorImageInfo);
+	offset = static_cast<uint32_t>(arenaOffset);
 
-			geometryModelResource->macros["DIFFUSE_BINDING"] = std::to_string(binding);
+	animationArenaResource.used = glm::max(animationArenaResource.used, arenaOffset + count);
 
-			binding++;
+	return true;
+}
 
-			//
+bool RenderManager::animationArenaUpload(uint32_t frameIndex)
+{
+	if (animationArenaResource.used == 0 || !animationArenaResource.dirty[frameIndex])
+	{
+		return true;
+	}
 
-			descriptorSetLayoutBinding = {};
-			descriptorSetLayoutBinding.binding = binding;
-			descriptorSetLayoutBinding.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
-			descriptorSetLayoutBinding.descriptorCount = 1;
-			descriptorSetLayoutBinding.stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT;
-			descriptorSetLayoutBindings.push_back(descriptorSetLayoutBinding);
+	if (!VulkanResource::copyHostToDevice(device, animationArenaResource.storageBufferResource.bufferResource, animationArenaResource.data.data(), sizeof(glm::vec4) * animationArenaResource.used, animationArenaResource.frameSize * frameIndex))
+	{
+		return false;
+	}
 
-			descriptorImageInfo = {};
-			descriptorImageInfo.sampler = lightResource->specular.samplerResource.sampler;
-			descriptorImageInfo.imageView = lightResource->specular.imageViewResource.imageView;
-			descriptorImageInfo.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
-			descriptorImageInfos.push_back(descriptorImageInfo);
+	animationArenaResource.dirty[frameIndex] = false;
 
-			geometryModelResource->macros["SPECULAR_BINDING"] = std::to_string(binding);
+	renderStatistics.animationUploads++;
+	renderStatistics.animationUploadBytes += sizeof(glm::vec4) * animationArenaResource.used;
 
-			binding++;
+	return true;
+}
 
-			//
+void RenderManager::instanceWriteWeights(const InstanceResource* instanceResource, const std::vector<float>& weights)
+{
+	HelperTarget::packWeights(weightsPacked, weights);
 
-			descriptorSetLayoutBinding = {};
-			descriptorSetLayoutBinding.binding = binding;
-			descriptorSetLayoutBinding.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
-			descriptorSetLayoutBinding.descriptorCount = 1;
-			descriptorSetLayoutBinding.stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT;
-			descriptorSetLayoutBindings.push_back(descriptorSetLayoutBinding);
+	memcpy(&animationArenaResource.data[instanceResource->weightsOffset], weightsPacked.data(), sizeof(glm::uvec4) * weightsPacked.size());
 
-			descriptorImageInfo = {};
-			descriptorImageInfo.sampler = lightResource->lut.samplerResource.sampler;
-			descriptorImageInfo.imageView = lightResource->lut.imageViewResource.imageView;
-			descriptorImageInfo.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
-			descriptorImageInfos.push_back(descriptorImageInfo);
+	animationArenaResource.dirty.assign(frames, true);
+}
 
-			geometryModelResource->macros["LUT_BINDING"] = std::to_string(binding);
-		}
+void RenderManager::instanceWriteJointMatrices(const InstanceResource* instanceResource, const std::vector<glm::mat4>& jointMatrices)
+{
+	glm::vec4* data = &animationArenaResource.data[instanceResource->jointMatricesOffset];
 
-		//
+	if (jointMatrices3x4)
+	{
+		Matrix::toRows3x4(data, jointMatrices.data(), jointMatrices.size());
+	}
+	else
+	{
+		memcpy(data, jointMatrices.data(), sizeof(glm::mat4) * jointMatrices.size());
+	}
 
-		VkResult result = VK_SUCCESS;
+	animationArenaResource.dirty.assign(frames, true);
+}
 
-		//
+bool RenderManager::geometryFinalize(uint64_t geometryHandle)
+{
+	GeometryResource* geometryResource = getGeometry(geometryHandle);
 
-		VkDescriptorSetLayoutCreateInfo descriptorSetLayoutCreateInfo = {};
-		descriptorSetLayoutCreateInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
-		descriptorSetLayoutCreateInfo.bindingCount = static_cast<uint32_t>(descriptorSetLayoutBindings.size());
-		descriptorSetLayoutCreateInfo.pBindings = descriptorSetLayoutBindings.data();
+	if (!geometryResource->created || geometryResource->finalized)
+	{
+		return false;
+	}
 
-		result = vkCreateDescriptorSetLayout(device, &descriptorSetLayoutCreateInfo, nullptr, &instanceResource->instanceContainers[geometryModelIndex].descriptorSetLayout);
-		if (result != VK_SUCCESS)
+	if (geometryResource->vertexData.size() > 0)
+	{
+		if (!geometryArenaAllocate(geometryResource))
 		{
-			Logger::print(TinyEngine_ERROR, __FILE__, __LINE__, result);
-
 			return false;
 		}
+	}
 
-		//
-
-		std::vector<VkDescriptorPoolSize> descriptorPoolSizes;
-		descriptorPoolSizes.resize(descriptorSetLayoutBindings.size(), {VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 1});
+	// Deformation pre-pass
 
-		VkDescriptorPoolCreateInfo descriptorPoolCreateInfo = {};
-		descriptorPoolCreateInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
-		descriptorPoolCreateInfo.poolSizeCount = static_cast<uint32_t>(descriptorSetLayoutBindings.size());
-		descriptorPoolCreateInfo.pPoolSizes = descriptorPoolSizes.data();
-		descriptorPoolCreateInfo.maxSets = 1;
+	if (geometryResource->deformData)
+	{
+		const GeometryDeform* geometryDeform = geometryResource->deformData;
 
-		result = vkCreateDescriptorPool(device, &descriptorPoolCreateInfo, nullptr, &instanceResource->instanceContainers[geometryModelIndex].descriptorPool);
-		if (result != VK_SUCCESS)
+		if (geometryDeform->count != geometryResource->count)
 		{
-			Logger::print(TinyEngine_ERROR, __FILE__, __LINE__, result);
-
 			return false;
 		}
 
-		VkDescriptorSetAllocateInfo descriptorSetAllocateInfo = {};
-		descriptorSetAllocateInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
-		descriptorSetAllocateInfo.descriptorPool = instanceResource->instanceContainers[geometryModelIndex].descriptorPool;
-		descriptorSetAllocateInfo.descriptorSetCount = 1;
-		descriptorSetAllocateInfo.pSetLayouts = &instanceResource->instanceContainers[geometryModelIndex].descriptorSetLayout;
+		StorageBufferResourceCreateInfo storageBufferResourceCreateInfo = {};
+		storageBufferResourceCreateInfo.bufferResourceCreateInfo.usage = VK_BUFFER_USAGE_STORAGE_BUFFER_BIT;
+		storageBufferResourceCreateInfo.bufferResourceCreateInfo.memoryProperty = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT;
 
-		result = vkAllocateDescriptorSets(device, &descriptorSetAllocateInfo, &instanceResource->instanceContainers[geometryModelIndex].descriptorSet);
-		if (result != VK_SUCCESS)
+		storageBufferResourceCreateInfo.bufferResourceCreateInfo.size = sizeof(glm::vec4) * geometryDeform->positions.size();
+		storageBufferResourceCreateInfo.data = geometryDeform->positions.data();
+		if (!VulkanResource::createStorageBufferResource(physicalDevice, device, queue, commandPool, geometryResource->deformPositionBufferResource, storageBufferResourceCreateInfo))
 		{
-			Logger::print(TinyEngine_ERROR, __FILE__, __LINE__, result);
-
 			return false;
 		}
 
-		uint32_t descriptorImageInfosSize = static_cast<uint32_t>(descriptorImageInfos.size());
-		uint32_t descriptorBufferInfosSize = static_cast<uint32_t>(descriptorBufferInfos.size());
+		if (geometryDeform->normals.size() == geometryDeform->count)
+		{
+			storageBufferResourceCreateInfo.bufferResourceCreateInfo.size = sizeof(glm::vec4) * geometryDeform->normals.size();
+			storageBufferResourceCreateInfo.data = geometryDeform->normals.data();
+			if (!VulkanResource::createStorageBufferResource(physicalDevice, device, queue, commandPool, geometryResource->deformNormalBufferResource, storageBufferResourceCreateInfo))
+			{
+				return false;
+			}
+		}
 
-		//
+		if (geometryDeform->tangents.size() == geometryDeform->count)
+		{
+			storageBufferResourceCreateInfo.bufferResourceCreateInfo.size = sizeof(glm::vec4) * geometryDeform->tangents.size();
+			storageBufferResourceCreateInfo.data = geometryDeform->tangents.data();
+			if (!VulkanResource::createStorageBufferResource(physicalDevice, device, queue, commandPool, geometryResource->deformTangentBufferResource, storageBufferResourceCreateInfo))
+			{
+				return false;
+			}
+		}
 
-		std::vector<VkWriteDescriptorSet> writeDescriptorSets(descriptorImageInfosSize + descriptorBufferInfosSize);
+		if (geometryDeform->jointGroups > 0)
+		{
+			storageBufferResourceCreateInfo.bufferResourceCreateInfo.size = sizeof(glm::uvec4) * geometryDeform->joints.size();
+			storageBufferResourceCreateInfo.data = geometryDeform->joints.data();
+			if (!VulkanResource::createStorageBufferResource(physicalDevice, device, queue, commandPool, geometryResource->deformJointBufferResource, storageBufferResourceCreateInfo))
+			{
+				return false;
+			}
 
-		uint32_t imageIndex = 0;
-		uint32_t bufferIndex = 0;
-		for (uint32_t k = 0; k < descriptorImageInfosSize + descriptorBufferInfosSize; k++)
+			storageBufferResourceCreateInfo.bufferResourceCreateInfo.size = sizeof(glm::vec4) * geometryDeform->weights.size();
+			storageBufferResourceCreateInfo.data = geometryDeform->weights.data();
+			if (!VulkanResource::createStorageBufferResource(physicalDevice, device, queue, commandPool, geometryResource->deformWeightBufferResource, storageBufferResourceCreateInfo))
+			{
+				return false;
+			}
+
+			geometryResource->deformJointGroups = geometryDeform->jointGroups;
+		}
+	}
+
+	geometryResource->deformData = nullptr;
+
+	geometryResource->finalized = true;
+
+	return true;
+}
+
+bool RenderManager::geometryModelFinalize(uint64_t geometryModelHandle)
+{
+	GeometryModelResource* geometryModelResource = getGeometryModel(geometryModelHandle);
+
+	if (!geometryModelResource->created || geometryModelResource->finalized)
+	{
+		return false;
+	}
+
+	// Level of details are only supported for indexed triangle lists.
+	if (geometryModelResource->lods.size() > 0)
+	{
+		if (geometryModelResource->mode != 4 || geometryModelResource->indexType == VK_INDEX_TYPE_NONE_KHR)
 		{
-			if (descriptorSetLayoutBindings[k].descriptorType == VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER)
+			return false;
+		}
+
+		for (const GeometryModelLod& geometryModelLod : geometryModelResource->lods)
+		{
+			if (geometryModelLod.firstIndex + geometryModelLod.indicesCount > geometryModelResource->indicesCount)
 			{
-				writeDescriptorSets[k].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
-				writeDescriptorSets[k].dstSet = instanceResource->instanceContainers[geometryModelIndex].descriptorSet;
-				writeDescriptorSets[k].dstBinding = k;
-				writeDescriptorSets[k].dstArrayElement = 0;
-				writeDescriptorSets[k].descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
-				writeDescriptorSets[k].descriptorCount = 1;
-				writeDescriptorSets[k].pImageInfo = &descriptorImageInfos[imageIndex];
+				return false;
+			}
+		}
+	}
 
-				imageIndex++;
+	bool convert = false;
+
+	switch (geometryModelResource->mode)
+	{
+		case 0:
+			geometryModelResource->topology = VK_PRIMITIVE_TOPOLOGY_POINT_LIST;
+			break;
+		case 1:
+			geometryModelResource->topology = VK_PRIMITIVE_TOPOLOGY_LINE_LIST;
+			break;
+		case 2:
+			geometryModelResource->topology = VK_PRIMITIVE_TOPOLOGY_LINE_STRIP;
+			convert = true;
+			break;
+		case 3:
+			geometryModelResource->topology = VK_PRIMITIVE_TOPOLOGY_LINE_STRIP;
+			break;
+		case 4:
+			geometryModelResource->topology = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST;
+			break;
+		case 5:
+			geometryModelResource->topology = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_STRIP;
+			break;
+		case 6:
+			geometryModelResource->topology = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_FAN;
+			break;
+		default:
+			return false;
+	}
+
+	if (convert)
+	{
+		std::vector<uint32_t> newIndices;
+
+		if (geometryModelResource->indexType == VK_INDEX_TYPE_NONE_KHR)
+		{
+			for (uint32_t i = 0; i < geometryModelResource->verticesCount; i++)
+			{
+				newIndices.push_back(i);
 			}
-			else if (descriptorSetLayoutBindings[k].descriptorType == VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER)
+			newIndices.push_back(0);
+		}
+		else
+		{
+			const void* indexData = geometryModelResource->indexData;
+			if (indexData == nullptr)
 			{
-				writeDescriptorSets[k].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
-				writeDescriptorSets[k].dstSet = instanceResource->instanceContainers[geometryModelIndex].descriptorSet;
-				writeDescriptorSets[k].dstBinding = k;
-				writeDescriptorSets[k].dstArrayElement = 0;
-				writeDescriptorSets[k].descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
-				writeDescriptorSets[k].descriptorCount = 1;
-				writeDescriptorSets[k].pBufferInfo = &descriptorBufferInfos[bufferIndex];
+				SharedDataResource* sharedDataResource = getSharedData(geometryModelResource->indexHandle);
+				indexData = sharedDataResource->vertexBufferResourceCreateInfo.data;
+			}
 
-				bufferIndex++;
+			if (geometryModelResource->indexType == VK_INDEX_TYPE_UINT8_EXT)
+			{
+				const uint8_t* byteData = reinterpret_cast<const uint8_t*>(indexData);
+
+				for (uint32_t i = 0; i < geometryModelResource->indicesCount; i++)
+				{
+					newIndices.push_back(static_cast<uint32_t>(byteData[i]));
+				}
+
+				newIndices.push_back(newIndices[0]);
 			}
-			else if (descriptorSetLayoutBindings[k].descriptorType == VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC)
+			else if (geometryModelResource->indexType == VK_INDEX_TYPE_UINT16)
 			{
-				writeDescriptorSets[k].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
-				writeDescriptorSets[k].dstSet = instanceResource->instanceContainers[geometryModelIndex].descriptorSet;
-				writeDescriptorSets[k].dstBinding = k;
-				writeDescriptorSets[k].dstArrayElement = 0;
-				writeDescriptorSets[k].descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC;
-				writeDescriptorSets[k].descriptorCount = 1;
-				writeDescriptorSets[k].pBufferInfo = &descriptorBufferInfos[bufferIndex];
+				const uint16_t* shortData = reinterpret_cast<const uint16_t*>(indexData);
 
-				bufferIndex++;
+				for (uint32_t i = 0; i < geometryModelResource->indicesCount; i++)
+				{
+					newIndices.push_back(static_cast<uint32_t>(shortData[i]));
+				}
+
+				newIndices.push_back(newIndices[0]);
 			}
-			else if (descriptorSetLayoutBindings[k].descriptorType == VK_DESCRIPTOR_TYPE_STORAGE_BUFFER)
+			else if (geometryModelResource->indexType == VK_INDEX_TYPE_UINT32)
 			{
-				writeDescriptorSets[k].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
-				writeDescriptorSets[k].dstSet = instanceResource->instanceContainers[geometryModelIndex].descriptorSet;
-				writeDescriptorSets[k].dstBinding = k;
-				writeDescriptorSets[k].dstArrayElement = 0;
-				writeDescriptorSets[k].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
-				writeDescriptorSets[k].descriptorCount = 1;
-				writeDescriptorSets[k].pBufferInfo = &descriptorBufferInfos[bufferIndex];
+				const uint32_t* integerData = reinterpret_cast<const uint32_t*>(indexData);
 
-				bufferIndex++;
+				for (uint32_t i = 0; i < geometryModelResource->indicesCount; i++)
+				{
+					newIndices.push_back(integerData[i]);
+				}
+
+				newIndices.push_back(newIndices[0]);
 			}
 			else
 			{
@@ -1742,641 +2381,2461 @@ bool RenderManager::instanceFinalize(uint64_t instanceHandle)
 			}
 		}
 
-		vkUpdateDescriptorSets(device, descriptorImageInfosSize + descriptorBufferInfosSize, writeDescriptorSets.data(), 0, nullptr);
+		if (geometryArena)
+		{
+			if (!geometryModelArenaAllocate(geometryModelResource, newIndices.data(), static_cast<uint32_t>(newIndices.size()), VK_INDEX_TYPE_UINT32))
+			{
+				return false;
+			}
+		}
+		else
+		{
+			uint64_t sharedDataHandle;
+			if (!sharedDataCreate(sharedDataHandle))
+			{
+				return false;
+			}
 
-		setLayouts.push_back(instanceResource->instanceContainers[geometryModelIndex].descriptorSetLayout);
+			if (!sharedDataCreateIndexBuffer(sharedDataHandle, newIndices.size() * sizeof(uint32_t), newIndices.data()))
+			{
+				return false;
+			}
 
-		//
-		// Load the shader code.
-		//
+			if (!sharedDataFinalize(sharedDataHandle))
+			{
+				return false;
+			}
 
-		std::string vertexShaderSource = "";
-		if (!FileIO::open(vertexShaderSource, "../Resources/shaders/gltf.vert"))
+			geometryModelResource->indicesCount = static_cast<uint32_t>(newIndices.size());
+			geometryModelResource->indexType = VK_INDEX_TYPE_UINT32;
+			geometryModelResource->indexBuffer = getBuffer(sharedDataHandle);
+			geometryModelResource->indexOffset = 0;
+			geometryModelResource->indexRange = newIndices.size() * sizeof(uint32_t);
+		}
+	}
+	else if (geometryModelResource->indexData != nullptr)
+	{
+		if (geometryModelResource->indexType == VK_INDEX_TYPE_UINT8_EXT)
 		{
-			return false;
+			const uint8_t* byteData = reinterpret_cast<const uint8_t*>(geometryModelResource->indexData);
+
+			std::vector<uint16_t> newIndices(geometryModelResource->indicesCount);
+			for (size_t i = 0; i < newIndices.size(); i++)
+			{
+				newIndices[i] = static_cast<uint16_t>(byteData[i]);
+			}
+
+			if (!geometryModelArenaAllocate(geometryModelResource, newIndices.data(), static_cast<uint32_t>(newIndices.size()), VK_INDEX_TYPE_UINT16))
+			{
+				return false;
+			}
+		}
+		else
+		{
+			if (!geometryModelArenaAllocate(geometryModelResource, geometryModelResource->indexData, geometryModelResource->indicesCount, geometryModelResource->indexType))
+			{
+				return false;
+			}
 		}
+	}
+
+	geometryModelResource->indexData = nullptr;
 
-		std::string fragmentShaderSource = "";
-		if (!FileIO::open(fragmentShaderSource, "../Resources/shaders/gltf.frag"))
+	// Meshlets
+
+	if (clusterCulling && geometryModelResource->meshletsCount > 0)
+	{
+		if (geometryModelResource->mode != 4 || geometryModelResource->indexType == VK_INDEX_TYPE_NONE_KHR)
 		{
 			return false;
 		}
 
-		//
+		StorageBufferResourceCreateInfo storageBufferResourceCreateInfo = {};
+		storageBufferResourceCreateInfo.bufferResourceCreateInfo.usage = VK_BUFFER_USAGE_STORAGE_BUFFER_BIT;
+		storageBufferResourceCreateInfo.bufferResourceCreateInfo.memoryProperty = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT;
 
-		std::vector<uint32_t> vertexShaderCode;
-		if (!Compiler::buildShader(vertexShaderCode, vertexShaderSource, geometryModelResource->macros, shaderc_vertex_shader))
+		storageBufferResourceCreateInfo.bufferResourceCreateInfo.size = sizeof(GeometryMeshlet) * geometryModelResource->meshletsCount;
+		storageBufferResourceCreateInfo.data = geometryModelResource->meshletData;
+		if (!VulkanResource::createStorageBufferResource(physicalDevice, device, queue, commandPool, geometryModelResource->meshletBufferResource, storageBufferResourceCreateInfo))
 		{
 			return false;
 		}
 
-		std::vector<uint32_t> fragmentShaderCode;
-		if (!Compiler::buildShader(fragmentShaderCode, fragmentShaderSource, geometryModelResource->macros, shaderc_fragment_shader))
+		storageBufferResourceCreateInfo.bufferResourceCreateInfo.size = sizeof(uint32_t) * geometryModelResource->meshletVerticesCount;
+		storageBufferResourceCreateInfo.data = geometryModelResource->meshletVertexData;
+		if (!VulkanResource::createStorageBufferResource(physicalDevice, device, queue, commandPool, geometryModelResource->meshletVertexBufferResource, storageBufferResourceCreateInfo))
 		{
 			return false;
 		}
 
-		if (!VulkanResource::createShaderModule(instanceResource->instanceContainers[geometryModelIndex].vertexShaderModule, device, vertexShaderCode))
+		storageBufferResourceCreateInfo.bufferResourceCreateInfo.size = sizeof(uint32_t) * geometryModelResource->meshletTrianglesCount;
+		storageBufferResourceCreateInfo.data = geometryModelResource->meshletTriangleData;
+		if (!VulkanResource::createStorageBufferResource(physicalDevice, device, queue, commandPool, geometryModelResource->meshletTriangleBufferResource, storageBufferResourceCreateInfo))
 		{
 			return false;
 		}
+	}
+	else
+	{
+		geometryModelResource->meshletsCount = 0;
+		geometryModelResource->meshletVerticesCount = 0;
+		geometryModelResource->meshletTrianglesCount = 0;
+	}
+
+	geometryModelResource->meshletData = nullptr;
+	geometryModelResource->meshletVertexData = nullptr;
+	geometryModelResource->meshletTriangleData = nullptr;
+
+	// Morph targets
+
+	if (geometryModelResource->targetData != nullptr)
+	{
+		const GeometryTargets& geometryTargets = *geometryModelResource->targetData;
+
+		StorageBufferResourceCreateInfo storageBufferResourceCreateInfo = {};
+		storageBufferResourceCreateInfo.bufferResourceCreateInfo.usage = VK_BUFFER_USAGE_STORAGE_BUFFER_BIT;
+		storageBufferResourceCreateInfo.bufferResourceCreateInfo.memoryProperty = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT;
 
-		if (!VulkanResource::createShaderModule(instanceResource->instanceContainers[geometryModelIndex].fragmentShaderModule, device, fragmentShaderCode))
+		storageBufferResourceCreateInfo.bufferResourceCreateInfo.size = sizeof(uint32_t) * geometryTargets.offsets.size();
+		storageBufferResourceCreateInfo.data = geometryTargets.offsets.data();
+		if (!VulkanResource::createStorageBufferResource(physicalDevice, device, queue, commandPool, geometryModelResource->targetOffsetBufferResource, storageBufferResourceCreateInfo))
 		{
 			return false;
 		}
 
-		//
+		if (geometryTargets.positions.size() > 0)
+		{
+			storageBufferResourceCreateInfo.bufferResourceCreateInfo.size = sizeof(glm::uvec2) * geometryTargets.positions.size();
+			storageBufferResourceCreateInfo.data = geometryTargets.positions.data();
+			if (!VulkanResource::createStorageBufferResource(physicalDevice, device, queue, commandPool, geometryModelResource->targetPositionBufferResource, storageBufferResourceCreateInfo))
+			{
+				return false;
+			}
+		}
+		if (geometryTargets.normals.size() > 0)
+		{
+			storageBufferResourceCreateInfo.bufferResourceCreateInfo.size = sizeof(glm::uvec2) * geometryTargets.normals.size();
+			storageBufferResourceCreateInfo.data = geometryTargets.normals.data();
+			if (!VulkanResource::createStorageBufferResource(physicalDevice, device, queue, commandPool, geometryModelResource->targetNormalBufferResource, storageBufferResourceCreateInfo))
+			{
+				return false;
+			}
+		}
+		if (geometryTargets.tangents.size() > 0)
+		{
+			storageBufferResourceCreateInfo.bufferResourceCreateInfo.size = sizeof(glm::uvec2) * geometryTargets.tangents.size();
+			storageBufferResourceCreateInfo.data = geometryTargets.tangents.data();
+			if (!VulkanResource::createStorageBufferResource(physicalDevice, device, queue, commandPool, geometryModelResource->targetTangentBufferResource, storageBufferResourceCreateInfo))
+			{
+				return false;
+			}
+		}
+	}
 
-		VkPipelineShaderStageCreateInfo pipelineShaderStageCreateInfo[2] = {};
+	geometryModelResource->targetData = nullptr;
 
-		pipelineShaderStageCreateInfo[0].sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
-		pipelineShaderStageCreateInfo[0].stage = VK_SHADER_STAGE_VERTEX_BIT;
-		pipelineShaderStageCreateInfo[0].module = instanceResource->instanceContainers[geometryModelIndex].vertexShaderModule;
-		pipelineShaderStageCreateInfo[0].pName = "main";
+	geometryModelResource->finalized = true;
 
-		pipelineShaderStageCreateInfo[1].sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
-		pipelineShaderStageCreateInfo[1].stage = VK_SHADER_STAGE_FRAGMENT_BIT;
-		pipelineShaderStageCreateInfo[1].module = instanceResource->instanceContainers[geometryModelIndex].fragmentShaderModule;
-		pipelineShaderStageCreateInfo[1].pName = "main";
+	return true;
+}
 
-		//
-		//
+bool RenderManager::groupFinalize(uint64_t groupHandle)
+{
+	GroupResource* groupResource = getGroup(groupHandle);
 
-		VkPipelineVertexInputStateCreateInfo pipelineVertexInputStateCreateInfo = {};
-		pipelineVertexInputStateCreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
-		pipelineVertexInputStateCreateInfo.vertexBindingDescriptionCount = static_cast<uint32_t>(geometryResource->vertexInputBindingDescriptions.size());
-		pipelineVertexInputStateCreateInfo.pVertexBindingDescriptions = geometryResource->vertexInputBindingDescriptions.data();
-		pipelineVertexInputStateCreateInfo.vertexAttributeDescriptionCount = static_cast<uint32_t>(geometryResource->vertexInputAttributeDescriptions.size());
-		pipelineVertexInputStateCreateInfo.pVertexAttributeDescriptions = geometryResource->vertexInputAttributeDescriptions.data();
+	if (!groupResource->created || groupResource->finalized)
+	{
+		return false;
+	}
 
-		//
-		//
+	groupResource->finalized = true;
 
-		VkPipelineInputAssemblyStateCreateInfo pipelineInputAssemblyStateCreateInfo = {};
-		pipelineInputAssemblyStateCreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_INPUT_ASSEMBLY_STATE_CREATE_INFO;
-		pipelineInputAssemblyStateCreateInfo.topology = geometryModelResource->topology;
+	return true;
+}
 
-		//
+bool RenderManager::cullSetup()
+{
+	if (cullPipeline != VK_NULL_HANDLE)
+	{
+		return true;
+	}
 
-		VkViewport viewport = {};
-		viewport.x = 0.0f;
-		viewport.y = 0.0f;
-		viewport.width = (float)width;
-		viewport.height = (float)height;
-		viewport.minDepth = 0.0f;
-		viewport.maxDepth = 1.0f;
-
-		VkRect2D scissor = {};
-		scissor.offset = {0, 0};
-		scissor.extent = {width, height};
-
-		VkPipelineViewportStateCreateInfo pipelineViewportStateCreateInfo = {};
-		pipelineViewportStateCreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_VIEWPORT_STATE_CREATE_INFO;
-		pipelineViewportStateCreateInfo.viewportCount = 1;
-		pipelineViewportStateCreateInfo.pViewports = &viewport;
-		pipelineViewportStateCreateInfo.scissorCount = 1;
-		pipelineViewportStateCreateInfo.pScissors = &scissor;
+	VkResult result = VK_SUCCESS;
 
-		//
+	// Meshlets, meshlet vertices, meshlet triangles, compacted indices and draw command.
+	std::vector<VkDescriptorSetLayoutBinding> descriptorSetLayoutBindings(5);
+	for (uint32_t binding = 0; binding < static_cast<uint32_t>(descriptorSetLayoutBindings.size()); binding++)
+	{
+		descriptorSetLayoutBindings[binding].binding = binding;
+		descriptorSetLayoutBindings[binding].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+		descriptorSetLayoutBindings[binding].descriptorCount = 1;
+		descriptorSetLayoutBindings[binding].stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+	}
 
-		VkCullModeFlags cullMode = geometryModelResource->cullMode;
+	VkDescriptorSetLayoutCreateInfo descriptorSetLayoutCreateInfo = {};
+	descriptorSetLayoutCreateInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+	descriptorSetLayoutCreateInfo.bindingCount = static_cast<uint32_t>(descriptorSetLayoutBindings.size());
+	descriptorSetLayoutCreateInfo.pBindings = descriptorSetLayoutBindings.data();
 
-		VkPipelineRasterizationStateCreateInfo pipelineRasterizationStateCreateInfo = {};
-		pipelineRasterizationStateCreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_RASTERIZATION_STATE_CREATE_INFO;
-		pipelineRasterizationStateCreateInfo.cullMode = cullMode;
-		pipelineRasterizationStateCreateInfo.frontFace = VK_FRONT_FACE_COUNTER_CLOCKWISE;
-		pipelineRasterizationStateCreateInfo.lineWidth = 1.0f;
+	result = vkCreateDescriptorSetLayout(device, &descriptorSetLayoutCreateInfo, nullptr, &cullDescriptorSetLayout);
+	if (result != VK_SUCCESS)
+	{
+		Logger::print(TinyEngine_ERROR, __FILE__, __LINE__, result);
 
-		//
+		return false;
+	}
 
-		VkPipelineMultisampleStateCreateInfo pipelineMultisampleStateCreateInfo = {};
-		pipelineMultisampleStateCreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_MULTISAMPLE_STATE_CREATE_INFO;
-		pipelineMultisampleStateCreateInfo.rasterizationSamples = samples;
-		pipelineMultisampleStateCreateInfo.minSampleShading = 1.0f;
+	//
 
-		//
+	const std::string* computeShaderSource = nullptr;
+	if (!getShaderSource(computeShaderSource, "../Resources/shaders/cull.comp"))
+	{
+		return false;
+	}
 
-		VkPipelineDepthStencilStateCreateInfo pipelineDepthStencilStateCreateInfo = {};
-		pipelineDepthStencilStateCreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_DEPTH_STENCIL_STATE_CREATE_INFO;
-		pipelineDepthStencilStateCreateInfo.depthTestEnable = VK_TRUE;
-		pipelineDepthStencilStateCreateInfo.depthWriteEnable = VK_TRUE;
-		pipelineDepthStencilStateCreateInfo.depthCompareOp = VK_COMPARE_OP_LESS;
+	std::vector<uint32_t> computeShaderCode;
+	if (!Compiler::buildShader(computeShaderCode, *computeShaderSource, std::map<std::string, std::string>(), shaderc_compute_shader))
+	{
+		return false;
+	}
 
-		//
+	if (!VulkanResource::createShaderModule(cullShaderModule, device, computeShaderCode))
+	{
+		return false;
+	}
 
-		VkPipelineColorBlendAttachmentState pipelineColorBlendAttachmentState = {};
-		pipelineColorBlendAttachmentState.blendEnable = VK_TRUE;
-		pipelineColorBlendAttachmentState.srcColorBlendFactor = VK_BLEND_FACTOR_SRC_ALPHA;
-		pipelineColorBlendAttachmentState.dstColorBlendFactor = VK_BLEND_FACTOR_ONE_MINUS_SRC_ALPHA;
-		pipelineColorBlendAttachmentState.colorBlendOp = VK_BLEND_OP_ADD;
-		pipelineColorBlendAttachmentState.srcAlphaBlendFactor = VK_BLEND_FACTOR_ONE;
-		pipelineColorBlendAttachmentState.dstAlphaBlendFactor = VK_BLEND_FACTOR_ZERO;
-		pipelineColorBlendAttachmentState.alphaBlendOp = VK_BLEND_OP_ADD;
-		pipelineColorBlendAttachmentState.colorWriteMask = VK_COLOR_COMPONENT_R_BIT | VK_COLOR_COMPONENT_G_BIT | VK_COLOR_COMPONENT_B_BIT | VK_COLOR_COMPONENT_A_BIT;
-
-		VkPipelineColorBlendStateCreateInfo pipelineColorBlendStateCreateInfo = {};
-		pipelineColorBlendStateCreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_COLOR_BLEND_STATE_CREATE_INFO;
-		pipelineColorBlendStateCreateInfo.attachmentCount = 1;
-		pipelineColorBlendStateCreateInfo.pAttachments = &pipelineColorBlendAttachmentState;
+	//
 
-		//
+	VkPushConstantRange pushConstantRange = {};
+	pushConstantRange.stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+	pushConstantRange.offset = 0;
+	pushConstantRange.size = sizeof(CullPushConstant);
 
-		VkPushConstantRange pushConstantRange = {};
-		pushConstantRange.stageFlags = VK_SHADER_STAGE_VERTEX_BIT;
-		pushConstantRange.offset = 0;
-		pushConstantRange.size = sizeof(UniformPushConstant);
+	VkPipelineLayoutCreateInfo pipelineLayoutCreateInfo = {};
+	pipelineLayoutCreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+	pipelineLayoutCreateInfo.setLayoutCount = 1;
+	pipelineLayoutCreateInfo.pSetLayouts = &cullDescriptorSetLayout;
+	pipelineLayoutCreateInfo.pushConstantRangeCount = 1;
+	pipelineLayoutCreateInfo.pPushConstantRanges = &pushConstantRange;
 
-		VkPipelineLayoutCreateInfo pipelineLayoutCreateInfo = {};
-		pipelineLayoutCreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
-		pipelineLayoutCreateInfo.setLayoutCount = static_cast<uint32_t>(setLayouts.size());
-		pipelineLayoutCreateInfo.pSetLayouts = setLayouts.data();
-		pipelineLayoutCreateInfo.pushConstantRangeCount = 1;
-		pipelineLayoutCreateInfo.pPushConstantRanges = &pushConstantRange;
+	result = vkCreatePipelineLayout(device, &pipelineLayoutCreateInfo, nullptr, &cullPipelineLayout);
+	if (result != VK_SUCCESS)
+	{
+		Logger::print(TinyEngine_ERROR, __FILE__, __LINE__, result);
 
-		result = vkCreatePipelineLayout(device, &pipelineLayoutCreateInfo, nullptr, &instanceResource->instanceContainers[geometryModelIndex].pipelineLayout);
-		if (result != VK_SUCCESS)
+		return false;
+	}
+
+	VkComputePipelineCreateInfo computePipelineCreateInfo = {};
+	computePipelineCreateInfo.sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO;
+	computePipelineCreateInfo.stage.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+	computePipelineCreateInfo.stage.stage = VK_SHADER_STAGE_COMPUTE_BIT;
+	computePipelineCreateInfo.stage.module = cullShaderModule;
+	computePipelineCreateInfo.stage.pName = "main";
+	computePipelineCreateInfo.layout = cullPipelineLayout;
+
+	result = vkCreateComputePipelines(device, VK_NULL_HANDLE, 1, &computePipelineCreateInfo, nullptr, &cullPipeline);
+	if (result != VK_SUCCESS)
+	{
+		Logger::print(TinyEngine_ERROR, __FILE__, __LINE__, result);
+
+		return false;
+	}
+
+	return true;
+}
+
+bool RenderManager::instanceCullFinalize(InstanceContainer& instanceContainer, const GeometryModelResource* geometryModelResource)
+{
+	if (!cullSetup())
+	{
+		return false;
+	}
+
+	VkResult result = VK_SUCCESS;
+
+	VkDescriptorPoolSize descriptorPoolSize = {VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 5 * frames};
+
+	VkDescriptorPoolCreateInfo descriptorPoolCreateInfo = {};
+	descriptorPoolCreateInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+	descriptorPoolCreateInfo.poolSizeCount = 1;
+	descriptorPoolCreateInfo.pPoolSizes = &descriptorPoolSize;
+	descriptorPoolCreateInfo.maxSets = frames;
+
+	result = vkCreateDescriptorPool(device, &descriptorPoolCreateInfo, nullptr, &instanceContainer.cullDescriptorPool);
+	if (result != VK_SUCCESS)
+	{
+		Logger::print(TinyEngine_ERROR, __FILE__, __LINE__, result);
+
+		return false;
+	}
+
+	std::vector<VkDescriptorSetLayout> setLayouts(frames, cullDescriptorSetLayout);
+
+	VkDescriptorSetAllocateInfo descriptorSetAllocateInfo = {};
+	descriptorSetAllocateInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+	descriptorSetAllocateInfo.descriptorPool = instanceContainer.cullDescriptorPool;
+	descriptorSetAllocateInfo.descriptorSetCount = frames;
+	descriptorSetAllocateInfo.pSetLayouts = setLayouts.data();
+
+	instanceContainer.cullDescriptorSets.resize(frames);
+
+	result = vkAllocateDescriptorSets(device, &descriptorSetAllocateInfo, instanceContainer.cullDescriptorSets.data());
+	if (result != VK_SUCCESS)
+	{
+		Logger::print(TinyEngine_ERROR, __FILE__, __LINE__, result);
+
+		return false;
+	}
+
+	//
+
+	instanceContainer.cullIndexBufferResources.resize(frames);
+	instanceContainer.cullDrawBufferResources.resize(frames);
+
+	for (uint32_t i = 0; i < frames; i++)
+	{
+		StorageBufferResourceCreateInfo storageBufferResourceCreateInfo = {};
+		storageBufferResourceCreateInfo.bufferResourceCreateInfo.size = 3 * sizeof(uint32_t) * geometryModelResource->meshletTrianglesCount;
+		storageBufferResourceCreateInfo.bufferResourceCreateInfo.usage = VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_INDEX_BUFFER_BIT;
+		storageBufferResourceCreateInfo.bufferResourceCreateInfo.memoryProperty = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT;
+
+		if (!VulkanResource::createStorageBufferResource(physicalDevice, device, queue, commandPool, instanceContainer.cullIndexBufferResources[i], storageBufferResourceCreateInfo))
 		{
-			Logger::print(TinyEngine_ERROR, __FILE__, __LINE__, result);
+			return false;
+		}
+
+		storageBufferResourceCreateInfo = {};
+		storageBufferResourceCreateInfo.bufferResourceCreateInfo.size = sizeof(VkDrawIndexedIndirectCommand);
+		storageBufferResourceCreateInfo.bufferResourceCreateInfo.usage = VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT;
+		storageBufferResourceCreateInfo.bufferResourceCreateInfo.memoryProperty = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT;
+
+		if (!VulkanResource::createStorageBufferResource(physicalDevice, device, queue, commandPool, instanceContainer.cullDrawBufferResources[i], storageBufferResourceCreateInfo))
+		{
+			return false;
+		}
+
+		//
+
+		VkDescriptorBufferInfo descriptorBufferInfos[5] = {};
+		descriptorBufferInfos[0].buffer = geometryModelResource->meshletBufferResource.bufferResource.buffer;
+		descriptorBufferInfos[1].buffer = geometryModelResource->meshletVertexBufferResource.bufferResource.buffer;
+		descriptorBufferInfos[2].buffer = geometryModelResource->meshletTriangleBufferResource.bufferResource.buffer;
+		descriptorBufferInfos[3].buffer = instanceContainer.cullIndexBufferResources[i].bufferResource.buffer;
+		descriptorBufferInfos[4].buffer = instanceContainer.cullDrawBufferResources[i].bufferResource.buffer;
+
+		VkWriteDescriptorSet writeDescriptorSets[5] = {};
+		for (uint32_t k = 0; k < 5; k++)
+		{
+			descriptorBufferInfos[k].offset = 0;
+			descriptorBufferInfos[k].range = VK_WHOLE_SIZE;
+
+			writeDescriptorSets[k].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+			writeDescriptorSets[k].dstSet = instanceContainer.cullDescriptorSets[i];
+			writeDescriptorSets[k].dstBinding = k;
+			writeDescriptorSets[k].dstArrayElement = 0;
+			writeDescriptorSets[k].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+			writeDescriptorSets[k].descriptorCount = 1;
+			writeDescriptorSets[k].pBufferInfo = &descriptorBufferInfos[k];
+		}
+
+		vkUpdateDescriptorSets(device, 5, writeDescriptorSets, 0, nullptr);
+	}
+
+	return true;
+}
+
+bool RenderManager::deformSetup()
+{
+	if (deformPipelineLayout != VK_NULL_HANDLE)
+	{
+		return true;
+	}
+
+	VkResult result = VK_SUCCESS;
+
+	// Positions, normals, tangents, joints, joint weights, target positions, target normals, target tangents, animation arena, target offsets and the deformed positions, normals and tangents.
+	std::vector<VkDescriptorSetLayoutBinding> descriptorSetLayoutBindings(13);
+	for (uint32_t binding = 0; binding < static_cast<uint32_t>(descriptorSetLayoutBindings.size()); binding++)
+	{
+		descriptorSetLayoutBindings[binding].binding = binding;
+		descriptorSetLayoutBindings[binding].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+		descriptorSetLayoutBindings[binding].descriptorCount = 1;
+		descriptorSetLayoutBindings[binding].stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+	}
+
+	VkDescriptorSetLayoutCreateInfo descriptorSetLayoutCreateInfo = {};
+	descriptorSetLayoutCreateInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+	descriptorSetLayoutCreateInfo.bindingCount = static_cast<uint32_t>(descriptorSetLayoutBindings.size());
+	descriptorSetLayoutCreateInfo.pBindings = descriptorSetLayoutBindings.data();
+
+	result = vkCreateDescriptorSetLayout(device, &descriptorSetLayoutCreateInfo, nullptr, &deformDescriptorSetLayout);
+	if (result != VK_SUCCESS)
+	{
+		Logger::print(TinyEngine_ERROR, __FILE__, __LINE__, result);
+
+		return false;
+	}
+
+	//
+
+	VkPushConstantRange pushConstantRange = {};
+	pushConstantRange.stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+	pushConstantRange.offset = 0;
+	pushConstantRange.size = sizeof(DeformPushConstant);
+
+	VkPipelineLayoutCreateInfo pipelineLayoutCreateInfo = {};
+	pipelineLayoutCreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+	pipelineLayoutCreateInfo.setLayoutCount = 1;
+	pipelineLayoutCreateInfo.pSetLayouts = &deformDescriptorSetLayout;
+	pipelineLayoutCreateInfo.pushConstantRangeCount = 1;
+	pipelineLayoutCreateInfo.pPushConstantRanges = &pushConstantRange;
+
+	result = vkCreatePipelineLayout(device, &pipelineLayoutCreateInfo, nullptr, &deformPipelineLayout);
+	if (result != VK_SUCCESS)
+	{
+		Logger::print(TinyEngine_ERROR, __FILE__, __LINE__, result);
+
+		return false;
+	}
+
+	return true;
+}
+
+bool RenderManager::instanceDeformFinalize(InstanceContainer& instanceContainer, const InstanceResource* instanceResource, const GeometryModelResource* geometryModelResource, const GeometryResource* geometryResource)
+{
+	if (!deformSetup())
+	{
+		return false;
+	}
+
+	VkResult result = VK_SUCCESS;
+
+	bool skinning = instanceResource->jointMatricesCount > 0 && geometryResource->deformJointGroups > 0;
+	bool morphing = instanceResource->weightsCount > 0 && geometryModelResource->targetsCount > 0;
+
+	bool hasNormal = geometryResource->deformNormalBufferResource.bufferResource.buffer != VK_NULL_HANDLE;
+	bool hasTangent = geometryResource->deformTangentBufferResource.bufferResource.buffer != VK_NULL_HANDLE;
+
+	//
+
+	std::map<std::string, std::string> macros;
+
+	if (hasNormal)
+	{
+		macros["HAS_NORMAL"] = "";
+	}
+	if (hasTangent)
+	{
+		macros["HAS_TANGENT"] = "";
+	}
+
+	if (skinning)
+	{
+		macros["HAS_JOINTS"] = "";
+		macros["JOINT_GROUPS"] = std::to_string(geometryResource->deformJointGroups);
+		if (jointMatrices3x4)
+		{
+			macros["JOINT_MATRICES_3X4"] = "";
+		}
+	}
+
+	if (morphing)
+	{
+		macros["HAS_WEIGHTS"] = "";
+		macros["HAS_TARGETS"] = "";
+
+		if (geometryModelResource->targetPositionBufferResource.bufferResource.buffer != VK_NULL_HANDLE)
+		{
+			macros["HAS_TARGET_POSITION"] = "";
+		}
+		if (geometryModelResource->targetNormalBufferResource.bufferResource.buffer != VK_NULL_HANDLE)
+		{
+			macros["HAS_TARGET_NORMAL"] = "";
+		}
+		if (geometryModelResource->targetTangentBufferResource.bufferResource.buffer != VK_NULL_HANDLE)
+		{
+			macros["HAS_TARGET_TANGENT"] = "";
+		}
+	}
+
+	const std::string* computeShaderSource = nullptr;
+	if (!getShaderSource(computeShaderSource, "../Resources/shaders/deform.comp"))
+	{
+		return false;
+	}
+
+	std::vector<uint32_t> computeShaderCode;
+	if (!Compiler::buildShader(computeShaderCode, *computeShaderSource, macros, shaderc_compute_shader))
+	{
+		return false;
+	}
+
+	if (!VulkanResource::createShaderModule(instanceContainer.deformShaderModule, device, computeShaderCode))
+	{
+		return false;
+	}
+
+	VkComputePipelineCreateInfo computePipelineCreateInfo = {};
+	computePipelineCreateInfo.sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO;
+	computePipelineCreateInfo.stage.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+	computePipelineCreateInfo.stage.stage = VK_SHADER_STAGE_COMPUTE_BIT;
+	computePipelineCreateInfo.stage.module = instanceContainer.deformShaderModule;
+	computePipelineCreateInfo.stage.pName = "main";
+	computePipelineCreateInfo.layout = deformPipelineLayout;
+
+	result = vkCreateComputePipelines(device, VK_NULL_HANDLE, 1, &computePipelineCreateInfo, nullptr, &instanceContainer.deformPipeline);
+	if (result != VK_SUCCESS)
+	{
+		Logger::print(TinyEngine_ERROR, __FILE__, __LINE__, result);
+
+		return false;
+	}
+
+	//
+
+	VkDescriptorPoolSize descriptorPoolSize = {VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 13 * frames};
+
+	VkDescriptorPoolCreateInfo descriptorPoolCreateInfo = {};
+	descriptorPoolCreateInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+	descriptorPoolCreateInfo.poolSizeCount = 1;
+	descriptorPoolCreateInfo.pPoolSizes = &descriptorPoolSize;
+	descriptorPoolCreateInfo.maxSets = frames;
+
+	result = vkCreateDescriptorPool(device, &descriptorPoolCreateInfo, nullptr, &instanceContainer.deformDescriptorPool);
+	if (result != VK_SUCCESS)
+	{
+		Logger::print(TinyEngine_ERROR, __FILE__, __LINE__, result);
+
+		return false;
+	}
+
+	std::vector<VkDescriptorSetLayout> setLayouts(frames, deformDescriptorSetLayout);
+
+	VkDescriptorSetAllocateInfo descriptorSetAllocateInfo = {};
+	descriptorSetAllocateInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+	descriptorSetAllocateInfo.descriptorPool = instanceContainer.deformDescriptorPool;
+	descriptorSetAllocateInfo.descriptorSetCount = frames;
+	descriptorSetAllocateInfo.pSetLayouts = setLayouts.data();
+
+	instanceContainer.deformDescriptorSets.resize(frames);
+
+	result = vkAllocateDescriptorSets(device, &descriptorSetAllocateInfo, instanceContainer.deformDescriptorSets.data());
+	if (result != VK_SUCCESS)
+	{
+		Logger::print(TinyEngine_ERROR, __FILE__, __LINE__, result);
+
+		return false;
+	}
+
+	//
+
+	instanceContainer.deformPositionBufferResources.resize(frames);
+	instanceContainer.deformNormalBufferResources.resize(frames);
+	instanceContainer.deformTangentBufferResources.resize(frames);
+
+	for (uint32_t i = 0; i < frames; i++)
+	{
+		StorageBufferResourceCreateInfo storageBufferResourceCreateInfo = {};
+		storageBufferResourceCreateInfo.bufferResourceCreateInfo.size = sizeof(glm::vec4) * geometryResource->count;
+		storageBufferResourceCreateInfo.bufferResourceCreateInfo.usage = VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_VERTEX_BUFFER_BIT;
+		storageBufferResourceCreateInfo.bufferResourceCreateInfo.memoryProperty = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT;
+
+		if (!VulkanResource::createStorageBufferResource(physicalDevice, device, queue, commandPool, instanceContainer.deformPositionBufferResources[i], storageBufferResourceCreateInfo))
+		{
+			return false;
+		}
+
+		if (hasNormal && !VulkanResource::createStorageBufferResource(physicalDevice, device, queue, commandPool, instanceContainer.deformNormalBufferResources[i], storageBufferResourceCreateInfo))
+		{
+			return false;
+		}
+
+		if (hasTangent && !VulkanResource::createStorageBufferResource(physicalDevice, device, queue, commandPool, instanceContainer.deformTangentBufferResources[i], storageBufferResourceCreateInfo))
+		{
+			return false;
+		}
+
+		//
+
+		std::vector<std::pair<uint32_t, VkDescriptorBufferInfo>> bindings;
+
+		bindings.push_back({0, {geometryResource->deformPositionBufferResource.bufferResource.buffer, 0, VK_WHOLE_SIZE}});
+		bindings.push_back({10, {instanceContainer.deformPositionBufferResources[i].bufferResource.buffer, 0, VK_WHOLE_SIZE}});
+		if (hasNormal)
+		{
+			bindings.push_back({1, {geometryResource->deformNormalBufferResource.bufferResource.buffer, 0, VK_WHOLE_SIZE}});
+			bindings.push_back({11, {instanceContainer.deformNormalBufferResources[i].bufferResource.buffer, 0, VK_WHOLE_SIZE}});
+		}
+		if (hasTangent)
+		{
+			bindings.push_back({2, {geometryResource->deformTangentBufferResource.bufferResource.buffer, 0, VK_WHOLE_SIZE}});
+			bindings.push_back({12, {instanceContainer.deformTangentBufferResources[i].bufferResource.buffer, 0, VK_WHOLE_SIZE}});
+		}
+
+		// Region of the frame in the animation arena.
+		bindings.push_back({8, {animationArenaResource.storageBufferResource.bufferResource.buffer, animationArenaResource.frameSize * i, animationArenaResource.frameSize}});
+
+		if (skinning)
+		{
+			bindings.push_back({3, {geometryResource->deformJointBufferResource.bufferResource.buffer, 0, VK_WHOLE_SIZE}});
+			bindings.push_back({4, {geometryResource->deformWeightBufferResource.bufferResource.buffer, 0, VK_WHOLE_SIZE}});
+		}
+
+		if (morphing)
+		{
+			bindings.push_back({9, {geometryModelResource->targetOffsetBufferResource.bufferResource.buffer, 0, VK_WHOLE_SIZE}});
+
+			if (macros.count("HAS_TARGET_POSITION") > 0)
+			{
+				bindings.push_back({5, {geometryModelResource->targetPositionBufferResource.bufferResource.buffer, 0, VK_WHOLE_SIZE}});
+			}
+			if (macros.count("HAS_TARGET_NORMAL") > 0)
+			{
+				bindings.push_back({6, {geometryModelResource->targetNormalBufferResource.bufferResource.buffer, 0, VK_WHOLE_SIZE}});
+			}
+			if (macros.count("HAS_TARGET_TANGENT") > 0)
+			{
+				bindings.push_back({7, {geometryModelResource->targetTangentBufferResource.bufferResource.buffer, 0, VK_WHOLE_SIZE}});
+			}
+		}
+
+		std::vector<VkWriteDescriptorSet> writeDescriptorSets(bindings.size());
+		for (size_t k = 0; k < bindings.size(); k++)
+		{
+			writeDescriptorSets[k].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+			writeDescriptorSets[k].dstSet = instanceContainer.deformDescriptorSets[i];
+			writeDescriptorSets[k].dstBinding = bindings[k].first;
+			writeDescriptorSets[k].dstArrayElement = 0;
+			writeDescriptorSets[k].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+			writeDescriptorSets[k].descriptorCount = 1;
+			writeDescriptorSets[k].pBufferInfo = &bindings[k].second;
+		}
+
+		vkUpdateDescriptorSets(device, static_cast<uint32_t>(writeDescriptorSets.size()), writeDescriptorSets.data(), 0, nullptr);
+	}
+
+	//
+
+	// Deformed vertices start at zero, so the vertex offset is moved into the binding offsets of the other attributes.
+	uint32_t attributesCount = static_cast<uint32_t>(geometryResource->vertexBuffers.size());
+
+	instanceContainer.deformVertexBuffersOffsets.resize(attributesCount);
+	for (uint32_t k = 0; k < attributesCount; k++)
+	{
+		instanceContainer.deformVertexBuffersOffsets[k] = geometryResource->vertexBuffersOffsets[k] + static_cast<VkDeviceSize>(geometryModelResource->vertexOffset) * geometryResource->vertexInputBindingDescriptions[k].stride;
+	}
+
+	instanceContainer.deformVertexBuffers.resize(frames * attributesCount);
+	for (uint32_t i = 0; i < frames; i++)
+	{
+		for (uint32_t k = 0; k < attributesCount; k++)
+		{
+			instanceContainer.deformVertexBuffers[i * attributesCount + k] = geometryResource->vertexBuffers[k];
+		}
+
+		std::vector<std::pair<std::string, VkBuffer>> deformed = {
+			{"POSITION_LOC", instanceContainer.deformPositionBufferResources[i].bufferResource.buffer},
+			{"NORMAL_LOC", instanceContainer.deformNormalBufferResources[i].bufferResource.buffer},
+			{"TANGENT_LOC", instanceContainer.deformTangentBufferResources[i].bufferResource.buffer}
+		};
+
+		for (const auto& it : deformed)
+		{
+			auto location = geometryResource->macros.find(it.first);
+			if (location == geometryResource->macros.end() || it.second == VK_NULL_HANDLE)
+			{
+				continue;
+			}
+
+			uint32_t k = static_cast<uint32_t>(std::stoi(location->second));
 
+			instanceContainer.deformVertexBuffers[i * attributesCount + k] = it.second;
+			instanceContainer.deformVertexBuffersOffsets[k] = 0;
+		}
+	}
+
+	// Nothing has been written yet.
+	instanceContainer.deformVersions.resize(frames, 0);
+
+	return true;
+}
+
+bool RenderManager::instanceFinalize(uint64_t instanceHandle)
+{
+	InstanceResource* instanceResource = getInstance(instanceHandle);
+
+	if (!instanceResource->created || instanceResource->finalized)
+	{
+		return false;
+	}
+
+	//
+
+	GroupResource* groupResource = getGroup(instanceResource->groupHandle);
+
+	instanceResource->instanceContainers.resize(groupResource->geometryModelHandles.size());
+
+	// Crowd
+
+	if (instanceResource->crowdMembers.size() > 0)
+	{
+		StorageBufferResourceCreateInfo storageBufferResourceCreateInfo = {};
+		storageBufferResourceCreateInfo.bufferResourceCreateInfo.size = sizeof(CrowdMember) * instanceResource->crowdCount;
+		storageBufferResourceCreateInfo.bufferResourceCreateInfo.usage = VK_BUFFER_USAGE_STORAGE_BUFFER_BIT;
+		storageBufferResourceCreateInfo.bufferResourceCreateInfo.memoryProperty = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT;
+		storageBufferResourceCreateInfo.data = instanceResource->crowdMembers.data();
+
+		if (!VulkanResource::createStorageBufferResource(physicalDevice, device, queue, commandPool, instanceResource->crowdBufferResource, storageBufferResourceCreateInfo))
+		{
 			return false;
 		}
 
-		//
+		// Only needed for the upload.
+		instanceResource->crowdMembers = std::vector<CrowdMember>();
+	}
+
+	const TextureDataResource* bakedJointsTextureResource = nullptr;
+	if (instanceResource->bakedJointsTextureHandle > 0)
+	{
+		bakedJointsTextureResource = getTexture(instanceResource->bakedJointsTextureHandle);
+
+		if (!bakedJointsTextureResource->finalized)
+		{
+			return false;
+		}
+	}
+
+	for (size_t geometryModelIndex = 0; geometryModelIndex < groupResource->geometryModelHandles.size(); geometryModelIndex++)
+	{
+		GeometryModelResource* geometryModelResource = getGeometryModel(groupResource->geometryModelHandles[geometryModelIndex]);
+
+		//
+
+		GeometryResource* geometryResource = getGeometry(geometryModelResource->geometryHandle);
+
+		//
+
+		uint32_t binding = 0;
+
+		std::vector<VkDescriptorSetLayout> setLayouts;
+		std::vector<VkDescriptorSetLayoutBinding> descriptorSetLayoutBindings;
+
+		std::vector<VkDescriptorImageInfo> descriptorImageInfos;
+		std::vector<VkDescriptorBufferInfo> descriptorBufferInfos;
+
+		if (geometryModelResource->materialHandle > 0)
+		{
+			MaterialResource* materialResource = getMaterial(geometryModelResource->materialHandle);
+
+			if (materialResource->descriptorSetLayoutBindings.size() > 0)
+			{
+				binding = materialResource->descriptorSetLayoutBindings.back().binding + 1;
+			}
+
+			descriptorSetLayoutBindings = materialResource->descriptorSetLayoutBindings;
+
+			descriptorImageInfos = materialResource->descriptorImageInfos;
+			descriptorBufferInfos = materialResource->descriptorBufferInfos;
+		}
+
+		// Morphing
+
+		if (geometryModelResource->targetOffsetBufferResource.bufferResource.buffer != VK_NULL_HANDLE)
+		{
+			VkDescriptorSetLayoutBinding descriptorSetLayoutBinding = {};
+			descriptorSetLayoutBinding = {};
+			descriptorSetLayoutBinding.binding = binding;
+			descriptorSetLayoutBinding.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+			descriptorSetLayoutBinding.descriptorCount = 1;
+			descriptorSetLayoutBinding.stageFlags = VK_SHADER_STAGE_VERTEX_BIT;
+			descriptorSetLayoutBindings.push_back(descriptorSetLayoutBinding);
+
+			VkDescriptorBufferInfo descriptorBufferInfo = {};
+			descriptorBufferInfo.buffer = geometryModelResource->targetOffsetBufferResource.bufferResource.buffer;
+			descriptorBufferInfo.offset = 0;
+			descriptorBufferInfo.range = sizeof(uint32_t) * (geometryModelResource->targetVerticesCount + 1);
+			descriptorBufferInfos.push_back(descriptorBufferInfo);
+
+			geometryModelResource->macros["TARGET_OFFSET_BINDING"] = std::to_string(binding);
+
+			binding++;
+		}
+
+		if (geometryModelResource->targetPositionBufferResource.bufferResource.buffer != VK_NULL_HANDLE)
+		{
+			VkDescriptorSetLayoutBinding descriptorSetLayoutBinding = {};
+			descriptorSetLayoutBinding = {};
+			descriptorSetLayoutBinding.binding = binding;
+			descriptorSetLayoutBinding.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+			descriptorSetLayoutBinding.descriptorCount = 1;
+			descriptorSetLayoutBinding.stageFlags = VK_SHADER_STAGE_VERTEX_BIT;
+			descriptorSetLayoutBindings.push_back(descriptorSetLayoutBinding);
+
+			VkDescriptorBufferInfo descriptorBufferInfo = {};
+			descriptorBufferInfo.buffer = geometryModelResource->targetPositionBufferResource.bufferResource.buffer;
+			descriptorBufferInfo.offset = 0;
+			descriptorBufferInfo.range = sizeof(glm::uvec2) * geometryModelResource->targetEntriesCount;
+			descriptorBufferInfos.push_back(descriptorBufferInfo);
+
+			geometryModelResource->macros["TARGET_POSITION_BINDING"] = std::to_string(binding);
+
+			binding++;
+		}
+
+		if (geometryModelResource->targetNormalBufferResource.bufferResource.buffer != VK_NULL_HANDLE)
+		{
+			VkDescriptorSetLayoutBinding descriptorSetLayoutBinding = {};
+			descriptorSetLayoutBinding = {};
+			descriptorSetLayoutBinding.binding = binding;
+			descriptorSetLayoutBinding.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+			descriptorSetLayoutBinding.descriptorCount = 1;
+			descriptorSetLayoutBinding.stageFlags = VK_SHADER_STAGE_VERTEX_BIT;
+			descriptorSetLayoutBindings.push_back(descriptorSetLayoutBinding);
+
+			VkDescriptorBufferInfo descriptorBufferInfo = {};
+			descriptorBufferInfo.buffer = geometryModelResource->targetNormalBufferResource.bufferResource.buffer;
+			descriptorBufferInfo.offset = 0;
+			descriptorBufferInfo.range = sizeof(glm::uvec2) * geometryModelResource->targetEntriesCount;
+			descriptorBufferInfos.push_back(descriptorBufferInfo);
+
+			geometryModelResource->macros["TARGET_NORMAL_BINDING"] = std::to_string(binding);
+
+			binding++;
+		}
+
+		if (geometryModelResource->targetTangentBufferResource.bufferResource.buffer != VK_NULL_HANDLE)
+		{
+			VkDescriptorSetLayoutBinding descriptorSetLayoutBinding = {};
+			descriptorSetLayoutBinding = {};
+			descriptorSetLayoutBinding.binding = binding;
+			descriptorSetLayoutBinding.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+			descriptorSetLayoutBinding.descriptorCount = 1;
+			descriptorSetLayoutBinding.stageFlags = VK_SHADER_STAGE_VERTEX_BIT;
+			descriptorSetLayoutBindings.push_back(descriptorSetLayoutBinding);
+
+			VkDescriptorBufferInfo descriptorBufferInfo = {};
+			descriptorBufferInfo.buffer = geometryModelResource->targetTangentBufferResource.bufferResource.buffer;
+			descriptorBufferInfo.offset = 0;
+			descriptorBufferInfo.range = sizeof(glm::uvec2) * geometryModelResource->targetEntriesCount;
+			descriptorBufferInfos.push_back(descriptorBufferInfo);
+
+			geometryModelResource->macros["TARGET_TANGENT_BINDING"] = std::to_string(binding);
+
+			binding++;
+		}
+
+		// Morph weights and skinning
+
+		if (instanceResource->weightsCount > 0 || instanceResource->jointMatricesCount > 0)
+		{
+			VkDescriptorSetLayoutBinding descriptorSetLayoutBinding = {};
+			descriptorSetLayoutBinding = {};
+			descriptorSetLayoutBinding.binding = binding;
+			descriptorSetLayoutBinding.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER_DYNAMIC;
+			descriptorSetLayoutBinding.descriptorCount = 1;
+			descriptorSetLayoutBinding.stageFlags = VK_SHADER_STAGE_VERTEX_BIT;
+			descriptorSetLayoutBindings.push_back(descriptorSetLayoutBinding);
+
+			VkDescriptorBufferInfo descriptorBufferInfo = {};
+			descriptorBufferInfo.buffer = animationArenaResource.storageBufferResource.bufferResource.buffer;
+			descriptorBufferInfo.offset = 0;
+			descriptorBufferInfo.range = animationArenaResource.frameSize;
+			descriptorBufferInfos.push_back(descriptorBufferInfo);
+
+			geometryModelResource->macros["ANIMATION_BINDING"] = std::to_string(binding);
+
+			if (instanceResource->weightsCount > 0)
+			{
+				geometryModelResource->macros["HAS_WEIGHTS"] = "";
+			}
+
+			if (instanceResource->jointMatricesCount > 0)
+			{
+				if (jointMatrices3x4)
+				{
+					geometryModelResource->macros["JOINT_MATRICES_3X4"] = "";
+				}
+
+				geometryModelResource->macros["HAS_JOINTS"] = "";
+			}
+
+			binding++;
+
+			instanceResource->instanceContainers[geometryModelIndex].animated = true;
+		}
+
+		// Baked skinning and crowd, only valid for this instance.
+
+		std::map<std::string, std::string> instanceMacros;
+
+		if (bakedJointsTextureResource != nullptr)
+		{
+			VkDescriptorSetLayoutBinding descriptorSetLayoutBinding = {};
+			descriptorSetLayoutBinding.binding = binding;
+			descriptorSetLayoutBinding.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+			descriptorSetLayoutBinding.descriptorCount = 1;
+			descriptorSetLayoutBinding.stageFlags = VK_SHADER_STAGE_VERTEX_BIT;
+			descriptorSetLayoutBindings.push_back(descriptorSetLayoutBinding);
+
+			VkDescriptorImageInfo descriptorImageInfo = {};
+			descriptorImageInfo.sampler = bakedJointsTextureResource->textureResource.samplerResource.sampler;
+			descriptorImageInfo.imageView = bakedJointsTextureResource->textureResource.imageViewResource.imageView;
+			descriptorImageInfo.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+			descriptorImageInfos.push_back(descriptorImageInfo);
+
+			instanceMacros["BAKED_JOINTS_BINDING"] = std::to_string(binding);
+			instanceMacros["BAKED_FRAMES_COUNT"] = std::to_string(instanceResource->bakedFramesCount);
+			instanceMacros["BAKED_DURATION"] = std::to_string(instanceResource->bakedDuration);
+			instanceMacros["HAS_BAKED_JOINTS"] = "";
+			instanceMacros["HAS_JOINTS"] = "";
+
+			binding++;
+		}
+
+		if (instanceResource->crowdBufferResource.bufferResource.buffer != VK_NULL_HANDLE)
+		{
+			VkDescriptorSetLayoutBinding descriptorSetLayoutBinding = {};
+			descriptorSetLayoutBinding.binding = binding;
+			descriptorSetLayoutBinding.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+			descriptorSetLayoutBinding.descriptorCount = 1;
+			descriptorSetLayoutBinding.stageFlags = VK_SHADER_STAGE_VERTEX_BIT;
+			descriptorSetLayoutBindings.push_back(descriptorSetLayoutBinding);
+
+			VkDescriptorBufferInfo descriptorBufferInfo = {};
+			descriptorBufferInfo.buffer = instanceResource->crowdBufferResource.bufferResource.buffer;
+			descriptorBufferInfo.offset = 0;
+			descriptorBufferInfo.range = sizeof(CrowdMember) * instanceResource->crowdCount;
+			descriptorBufferInfos.push_back(descriptorBufferInfo);
+
+			instanceMacros["CROWD_BINDING"] = std::to_string(binding);
+			instanceMacros["HAS_CROWD"] = "";
+
+			binding++;
+		}
+
+		// Lighting
+
+		WorldResource* worldResource = getWorld();
+
+		if (worldResource->lightHandle > 0)
+		{
+			LightResource* lightResource = getLight(worldResource->lightHandle);
+
+			VkDescriptorSetLayoutBinding descriptorSetLayoutBinding = {};
+			descriptorSetLayoutBinding.binding = binding;
+			descriptorSetLayoutBinding.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+			descriptorSetLayoutBinding.descriptorCount = 1;
+			descriptorSetLayoutBinding.stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT;
+			descriptorSetLayoutBindings.push_back(descriptorSetLayoutBinding);
+
+			VkDescriptorImageInfo descriptorImageInfo = {};
+			descriptorImageInfo.sampler = lightResource->diffuse.samplerResource.sampler;
+			descriptorImageInfo.imageView = lightResource->diffuse.imageViewResource.imageView;
+			descriptorImageInfo.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+			descriptorImageInfos.push_back(descriptorImageInfo);
+
+			geometryModelResource->macros["DIFFUSE_BINDING"] = std::to_string(binding);
+
+			binding++;
+
+			//
+
+			descriptorSetLayoutBinding = {};
+			descriptorSetLayoutBinding.binding = binding;
+			descriptorSetLayoutBinding.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+			descriptorSetLayoutBinding.descriptorCount = 1;
+			descriptorSetLayoutBinding.stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT;
+			descriptorSetLayoutBindings.push_back(descriptorSetLayoutBinding);
+
+			descriptorImageInfo = {};
+			descriptorImageInfo.sampler = lightResource->specular.samplerResource.sampler;
+			descriptorImageInfo.imageView = lightResource->specular.imageViewResource.imageView;
+			descriptorImageInfo.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+			descriptorImageInfos.push_back(descriptorImageInfo);
+
+			geometryModelResource->macros["SPECULAR_BINDING"] = std::to_string(binding);
+
+			binding++;
+
+			//
+
+			descriptorSetLayoutBinding = {};
+			descriptorSetLayoutBinding.binding = binding;
+			descriptorSetLayoutBinding.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+			descriptorSetLayoutBinding.descriptorCount = 1;
+			descriptorSetLayoutBinding.stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT;
+			descriptorSetLayoutBindings.push_back(descriptorSetLayoutBinding);
+
+			descriptorImageInfo = {};
+			descriptorImageInfo.sampler = lightResource->lut.samplerResource.sampler;
+			descriptorImageInfo.imageView = lightResource->lut.imageViewResource.imageView;
+			descriptorImageInfo.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+			descriptorImageInfos.push_back(descriptorImageInfo);
+
+			geometryModelResource->macros["LUT_BINDING"] = std::to_string(binding);
+		}
+
+		//
+
+		VkResult result = VK_SUCCESS;
+
+		//
+
+		VkDescriptorSetLayoutCreateInfo descriptorSetLayoutCreateInfo = {};
+		descriptorSetLayoutCreateInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+		descriptorSetLayoutCreateInfo.bindingCount = static_cast<uint32_t>(descriptorSetLayoutBindings.size());
+		descriptorSetLayoutCreateInfo.pBindings = descriptorSetLayoutBindings.data();
+
+		result = vkCreateDescriptorSetLayout(device, &descriptorSetLayoutCreateInfo, nullptr, &instanceResource->instanceContainers[geometryModelIndex].descriptorSetLayout);
+		if (result != VK_SUCCESS)
+		{
+			Logger::print(TinyEngine_ERROR, __FILE__, __LINE__, result);
+
+			return false;
+		}
+
+		//
+
+		std::vector<VkDescriptorPoolSize> descriptorPoolSizes;
+		descriptorPoolSizes.resize(descriptorSetLayoutBindings.size(), {VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 1});
+
+		VkDescriptorPoolCreateInfo descriptorPoolCreateInfo = {};
+		descriptorPoolCreateInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+		descriptorPoolCreateInfo.poolSizeCount = static_cast<uint32_t>(descriptorSetLayoutBindings.size());
+		descriptorPoolCreateInfo.pPoolSizes = descriptorPoolSizes.data();
+		descriptorPoolCreateInfo.maxSets = 1;
+
+		result = vkCreateDescriptorPool(device, &descriptorPoolCreateInfo, nullptr, &instanceResource->instanceContainers[geometryModelIndex].descriptorPool);
+		if (result != VK_SUCCESS)
+		{
+			Logger::print(TinyEngine_ERROR, __FILE__, __LINE__, result);
+
+			return false;
+		}
+
+		VkDescriptorSetAllocateInfo descriptorSetAllocateInfo = {};
+		descriptorSetAllocateInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+		descriptorSetAllocateInfo.descriptorPool = instanceResource->instanceContainers[geometryModelIndex].descriptorPool;
+		descriptorSetAllocateInfo.descriptorSetCount = 1;
+		descriptorSetAllocateInfo.pSetLayouts = &instanceResource->instanceContainers[geometryModelIndex].descriptorSetLayout;
+
+		result = vkAllocateDescriptorSets(device, &descriptorSetAllocateInfo, &instanceResource->instanceContainers[geometryModelIndex].descriptorSet);
+		if (result != VK_SUCCESS)
+		{
+			Logger::print(TinyEngine_ERROR, __FILE__, __LINE__, result);
+
+			return false;
+		}
+
+		uint32_t descriptorImageInfosSize = static_cast<uint32_t>(descriptorImageInfos.size());
+		uint32_t descriptorBufferInfosSize = static_cast<uint32_t>(descriptorBufferInfos.size());
+
+		//
+
+		std::vector<VkWriteDescriptorSet> writeDescriptorSets(descriptorImageInfosSize + descriptorBufferInfosSize);
+
+		uint32_t imageIndex = 0;
+		uint32_t bufferIndex = 0;
+		for (uint32_t k = 0; k < descriptorImageInfosSize + descriptorBufferInfosSize; k++)
+		{
+			if (descriptorSetLayoutBindings[k].descriptorType == VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER)
+			{
+				writeDescriptorSets[k].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+				writeDescriptorSets[k].dstSet = instanceResource->instanceContainers[geometryModelIndex].descriptorSet;
+				writeDescriptorSets[k].dstBinding = k;
+				writeDescriptorSets[k].dstArrayElement = 0;
+				writeDescriptorSets[k].descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+				writeDescriptorSets[k].descriptorCount = 1;
+				writeDescriptorSets[k].pImageInfo = &descriptorImageInfos[imageIndex];
+
+				imageIndex++;
+			}
+			else if (descriptorSetLayoutBindings[k].descriptorType == VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER)
+			{
+				writeDescriptorSets[k].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+				writeDescriptorSets[k].dstSet = instanceResource->instanceContainers[geometryModelIndex].descriptorSet;
+				writeDescriptorSets[k].dstBinding = k;
+				writeDescriptorSets[k].dstArrayElement = 0;
+				writeDescriptorSets[k].descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+				writeDescriptorSets[k].descriptorCount = 1;
+				writeDescriptorSets[k].pBufferInfo = &descriptorBufferInfos[bufferIndex];
+
+				bufferIndex++;
+			}
+			else if (descriptorSetLayoutBindings[k].descriptorType == VK_DESCRIPTOR_TYPE_STORAGE_BUFFER_DYNAMIC)
+			{
+				writeDescriptorSets[k].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+				writeDescriptorSets[k].dstSet = instanceResource->instanceContainers[geometryModelIndex].descriptorSet;
+				writeDescriptorSets[k].dstBinding = k;
+				writeDescriptorSets[k].dstArrayElement = 0;
+				writeDescriptorSets[k].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER_DYNAMIC;
+				writeDescriptorSets[k].descriptorCount = 1;
+				writeDescriptorSets[k].pBufferInfo = &descriptorBufferInfos[bufferIndex];
+
+				bufferIndex++;
+			}
+			else if (descriptorSetLayoutBindings[k].descriptorType == VK_DESCRIPTOR_TYPE_STORAGE_BUFFER)
+			{
+				writeDescriptorSets[k].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+				writeDescriptorSets[k].dstSet = instanceResource->instanceContainers[geometryModelIndex].descriptorSet;
+				writeDescriptorSets[k].dstBinding = k;
+				writeDescriptorSets[k].dstArrayElement = 0;
+				writeDescriptorSets[k].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+				writeDescriptorSets[k].descriptorCount = 1;
+				writeDescriptorSets[k].pBufferInfo = &descriptorBufferInfos[bufferIndex];
+
+				bufferIndex++;
+			}
+			else
+			{
+				return false;
+			}
+		}
+
+		vkUpdateDescriptorSets(device, descriptorImageInfosSize + descriptorBufferInfosSize, writeDescriptorSets.data(), 0, nullptr);
+
+		setLayouts.push_back(instanceResource->instanceContainers[geometryModelIndex].descriptorSetLayout);
+
+		//
+		// Deformation pre-pass
+		//
+
+		std::map<std::string, std::string> macros = geometryModelResource->macros;
+		macros.insert(instanceMacros.begin(), instanceMacros.end());
+
+		std::vector<VkVertexInputBindingDescription> vertexInputBindingDescriptions = geometryResource->vertexInputBindingDescriptions;
+		std::vector<VkVertexInputAttributeDescription> vertexInputAttributeDescriptions = geometryResource->vertexInputAttributeDescriptions;
+
+		bool skinning = instanceResource->jointMatricesCount > 0 && geometryResource->deformJointGroups > 0;
+		bool morphing = instanceResource->weightsCount > 0 && geometryModelResource->targetsCount > 0;
+
+		// Skinned and morphed in the vertex shader, while the pre-pass output of a frame is outdated.
+		bool deformed = false;
+		std::map<std::string, std::string> fallbackMacros = macros;
+		std::vector<VkVertexInputBindingDescription> fallbackVertexInputBindingDescriptions = vertexInputBindingDescriptions;
+		std::vector<VkVertexInputAttributeDescription> fallbackVertexInputAttributeDescriptions = vertexInputAttributeDescriptions;
+
+		if (deformPrepass && geometryResource->deformPositionBufferResource.bufferResource.buffer != VK_NULL_HANDLE && (skinning || morphing) && bakedJointsTextureResource == nullptr)
+		{
+			deformed = true;
+
+			if (!instanceDeformFinalize(instanceResource->instanceContainers[geometryModelIndex], instanceResource, geometryModelResource, geometryResource))
+			{
+				return false;
+			}
+
+			// Drawn as static geometry with 32 bit floats in model space.
+			for (const std::string& macro : {"HAS_JOINTS", "HAS_WEIGHTS", "HAS_TARGETS", "HAS_TARGET_POSITION", "HAS_TARGET_NORMAL", "HAS_TARGET_TANGENT", "POSITION_DEQUANTIZE", "NORMAL_OCT", "JOINTS_0_VEC4", "JOINTS_1_VEC4", "WEIGHTS_0_VEC4", "WEIGHTS_1_VEC4"})
+			{
+				macros.erase(macro);
+			}
+
+			std::vector<std::pair<std::string, VkFormat>> deformed = {
+				{"POSITION_LOC", VK_FORMAT_R32G32B32_SFLOAT},
+				{"NORMAL_LOC", VK_FORMAT_R32G32B32_SFLOAT},
+				{"TANGENT_LOC", VK_FORMAT_R32G32B32A32_SFLOAT}
+			};
+
+			for (const auto& it : deformed)
+			{
+				auto location = geometryResource->macros.find(it.first);
+				if (location == geometryResource->macros.end())
+				{
+					continue;
+				}
+
+				// Only replaced, if the attribute has been deformed.
+				uint32_t k = static_cast<uint32_t>(std::stoi(location->second));
+				if (instanceResource->instanceContainers[geometryModelIndex].deformVertexBuffers[k] == geometryResource->vertexBuffers[k])
+				{
+					continue;
+				}
+
+				vertexInputBindingDescriptions[k].stride = sizeof(glm::vec4);
+				vertexInputAttributeDescriptions[k].format = it.second;
+			}
+
+			// Joints and weights are not consumed anymore.
+			for (const std::string& description : {"JOINTS_0_LOC", "JOINTS_1_LOC", "WEIGHTS_0_LOC", "WEIGHTS_1_LOC"})
+			{
+				auto location = geometryResource->macros.find(description);
+				if (location == geometryResource->macros.end())
+				{
+					continue;
+				}
+
+				uint32_t k = static_cast<uint32_t>(std::stoi(location->second));
+				for (size_t a = 0; a < vertexInputAttributeDescriptions.size(); a++)
+				{
+					if (vertexInputAttributeDescriptions[a].location == k)
+					{
+						vertexInputAttributeDescriptions.erase(vertexInputAttributeDescriptions.begin() + a);
+						break;
+					}
+				}
+			}
+		}
+
+		// Dequantization is only covered, if one of the pipelines needs it, so other geometry stays within smaller limits.
+		instanceResource->instanceContainers[geometryModelIndex].positionDequantize = fallbackMacros.count("POSITION_DEQUANTIZE") > 0;
+
+		VkPushConstantRange pushConstantRange = {};
+		pushConstantRange.stageFlags = VK_SHADER_STAGE_VERTEX_BIT;
+		pushConstantRange.offset = 0;
+		pushConstantRange.size = instanceResource->instanceContainers[geometryModelIndex].positionDequantize ? sizeof(UniformPushConstant) : offsetof(UniformPushConstant, positionDequantizeScale);
+
+		VkPipelineLayoutCreateInfo pipelineLayoutCreateInfo = {};
+		pipelineLayoutCreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+		pipelineLayoutCreateInfo.setLayoutCount = static_cast<uint32_t>(setLayouts.size());
+		pipelineLayoutCreateInfo.pSetLayouts = setLayouts.data();
+		pipelineLayoutCreateInfo.pushConstantRangeCount = 1;
+		pipelineLayoutCreateInfo.pPushConstantRanges = &pushConstantRange;
+
+		result = vkCreatePipelineLayout(device, &pipelineLayoutCreateInfo, nullptr, &instanceResource->instanceContainers[geometryModelIndex].pipelineLayout);
+		if (result != VK_SUCCESS)
+		{
+			Logger::print(TinyEngine_ERROR, __FILE__, __LINE__, result);
+
+			return false;
+		}
+
+		//
+
+		// Both pipelines share the layout and the descriptor set.
+		for (uint32_t variant = 0; variant < (deformed ? 2u : 1u); variant++)
+		{
+			const std::map<std::string, std::string>& variantMacros = (variant == 0) ? macros : fallbackMacros;
+			const std::vector<VkVertexInputBindingDescription>& variantVertexInputBindingDescriptions = (variant == 0) ? vertexInputBindingDescriptions : fallbackVertexInputBindingDescriptions;
+			const std::vector<VkVertexInputAttributeDescription>& variantVertexInputAttributeDescriptions = (variant == 0) ? vertexInputAttributeDescriptions : fallbackVertexInputAttributeDescriptions;
+
+			InstanceContainer& instanceContainer = instanceResource->instanceContainers[geometryModelIndex];
+			VkShaderModule& vertexShaderModule = (variant == 0) ? instanceContainer.vertexShaderModule : instanceContainer.fallbackVertexShaderModule;
+			VkShaderModule& fragmentShaderModule = (variant == 0) ? instanceContainer.fragmentShaderModule : instanceContainer.fallbackFragmentShaderModule;
+			VkPipeline& graphicsPipeline = (variant == 0) ? instanceContainer.graphicsPipeline : instanceContainer.fallbackGraphicsPipeline;
+
+			//
+			// Load the shader code.
+			//
+
+			const std::string* vertexShaderSource = nullptr;
+			if (!getShaderSource(vertexShaderSource, "../Resources/shaders/gltf.vert"))
+			{
+				return false;
+			}
+
+			const std::string* fragmentShaderSource = nullptr;
+			if (!getShaderSource(fragmentShaderSource, "../Resources/shaders/gltf.frag"))
+			{
+				return false;
+			}
+
+			//
+
+			std::vector<uint32_t> vertexShaderCode;
+			if (!Compiler::buildShader(vertexShaderCode, *vertexShaderSource, variantMacros, shaderc_vertex_shader))
+			{
+				return false;
+			}
+
+			std::vector<uint32_t> fragmentShaderCode;
+			if (!Compiler::buildShader(fragmentShaderCode, *fragmentShaderSource, variantMacros, shaderc_fragment_shader))
+			{
+				return false;
+			}
+
+			if (!VulkanResource::createShaderModule(vertexShaderModule, device, vertexShaderCode))
+			{
+				return false;
+			}
+
+			if (!VulkanResource::createShaderModule(fragmentShaderModule, device, fragmentShaderCode))
+			{
+				return false;
+			}
+
+			//
+
+			VkPipelineShaderStageCreateInfo pipelineShaderStageCreateInfo[2] = {};
+
+			pipelineShaderStageCreateInfo[0].sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+			pipelineShaderStageCreateInfo[0].stage = VK_SHADER_STAGE_VERTEX_BIT;
+			pipelineShaderStageCreateInfo[0].module = vertexShaderModule;
+			pipelineShaderStageCreateInfo[0].pName = "main";
+
+			pipelineShaderStageCreateInfo[1].sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+			pipelineShaderStageCreateInfo[1].stage = VK_SHADER_STAGE_FRAGMENT_BIT;
+			pipelineShaderStageCreateInfo[1].module = fragmentShaderModule;
+			pipelineShaderStageCreateInfo[1].pName = "main";
+
+			//
+			//
+
+			VkPipelineVertexInputStateCreateInfo pipelineVertexInputStateCreateInfo = {};
+			pipelineVertexInputStateCreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
+			pipelineVertexInputStateCreateInfo.vertexBindingDescriptionCount = static_cast<uint32_t>(variantVertexInputBindingDescriptions.size());
+			pipelineVertexInputStateCreateInfo.pVertexBindingDescriptions = variantVertexInputBindingDescriptions.data();
+			pipelineVertexInputStateCreateInfo.vertexAttributeDescriptionCount = static_cast<uint32_t>(variantVertexInputAttributeDescriptions.size());
+			pipelineVertexInputStateCreateInfo.pVertexAttributeDescriptions = variantVertexInputAttributeDescriptions.data();
+
+			//
+			//
+
+			VkPipelineInputAssemblyStateCreateInfo pipelineInputAssemblyStateCreateInfo = {};
+			pipelineInputAssemblyStateCreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_INPUT_ASSEMBLY_STATE_CREATE_INFO;
+			pipelineInputAssemblyStateCreateInfo.topology = geometryModelResource->topology;
+
+			//
+
+			VkViewport viewport = {};
+			viewport.x = 0.0f;
+			viewport.y = 0.0f;
+			viewport.width = (float)width;
+			viewport.height = (float)height;
+			viewport.minDepth = 0.0f;
+			viewport.maxDepth = 1.0f;
+
+			VkRect2D scissor = {};
+			scissor.offset = {0, 0};
+			scissor.extent = {width, height};
+
+			VkPipelineViewportStateCreateInfo pipelineViewportStateCreateInfo = {};
+			pipelineViewportStateCreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_VIEWPORT_STATE_CREATE_INFO;
+			pipelineViewportStateCreateInfo.viewportCount = 1;
+			pipelineViewportStateCreateInfo.pViewports = &viewport;
+			pipelineViewportStateCreateInfo.scissorCount = 1;
+			pipelineViewportStateCreateInfo.pScissors = &scissor;
+
+			//
+
+			VkCullModeFlags cullMode = geometryModelResource->cullMode;
+
+			VkPipelineRasterizationStateCreateInfo pipelineRasterizationStateCreateInfo = {};
+			pipelineRasterizationStateCreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_RASTERIZATION_STATE_CREATE_INFO;
+			pipelineRasterizationStateCreateInfo.cullMode = cullMode;
+			pipelineRasterizationStateCreateInfo.frontFace = VK_FRONT_FACE_COUNTER_CLOCKWISE;
+			pipelineRasterizationStateCreateInfo.lineWidth = 1.0f;
+
+			//
+
+			VkPipelineMultisampleStateCreateInfo pipelineMultisampleStateCreateInfo = {};
+			pipelineMultisampleStateCreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_MULTISAMPLE_STATE_CREATE_INFO;
+			pipelineMultisampleStateCreateInfo.rasterizationSamples = samples;
+			pipelineMultisampleStateCreateInfo.minSampleShading = 1.0f;
+
+			//
+
+			VkPipelineDepthStencilStateCreateInfo pipelineDepthStencilStateCreateInfo = {};
+			pipelineDepthStencilStateCreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_DEPTH_STENCIL_STATE_CREATE_INFO;
+			pipelineDepthStencilStateCreateInfo.depthTestEnable = VK_TRUE;
+			pipelineDepthStencilStateCreateInfo.depthWriteEnable = VK_TRUE;
+			pipelineDepthStencilStateCreateInfo.depthCompareOp = VK_COMPARE_OP_LESS;
+
+			//
+
+			VkPipelineColorBlendAttachmentState pipelineColorBlendAttachmentState = {};
+			pipelineColorBlendAttachmentState.blendEnable = VK_TRUE;
+			pipelineColorBlendAttachmentState.srcColorBlendFactor = VK_BLEND_FACTOR_SRC_ALPHA;
+			pipelineColorBlendAttachmentState.dstColorBlendFactor = VK_BLEND_FACTOR_ONE_MINUS_SRC_ALPHA;
+			pipelineColorBlendAttachmentState.colorBlendOp = VK_BLEND_OP_ADD;
+			pipelineColorBlendAttachmentState.srcAlphaBlendFactor = VK_BLEND_FACTOR_ONE;
+			pipelineColorBlendAttachmentState.dstAlphaBlendFactor = VK_BLEND_FACTOR_ZERO;
+			pipelineColorBlendAttachmentState.alphaBlendOp = VK_BLEND_OP_ADD;
+			pipelineColorBlendAttachmentState.colorWriteMask = VK_COLOR_COMPONENT_R_BIT | VK_COLOR_COMPONENT_G_BIT | VK_COLOR_COMPONENT_B_BIT | VK_COLOR_COMPONENT_A_BIT;
+
+			VkPipelineColorBlendStateCreateInfo pipelineColorBlendStateCreateInfo = {};
+			pipelineColorBlendStateCreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_COLOR_BLEND_STATE_CREATE_INFO;
+			pipelineColorBlendStateCreateInfo.attachmentCount = 1;
+			pipelineColorBlendStateCreateInfo.pAttachments = &pipelineColorBlendAttachmentState;
+
+			//
+
+			VkGraphicsPipelineCreateInfo graphicsPipelineCreateInfo = {};
+			graphicsPipelineCreateInfo.sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO;
+			graphicsPipelineCreateInfo.stageCount = 2;
+			graphicsPipelineCreateInfo.pStages = pipelineShaderStageCreateInfo;
+			graphicsPipelineCreateInfo.pVertexInputState = &pipelineVertexInputStateCreateInfo;
+			graphicsPipelineCreateInfo.pInputAssemblyState = &pipelineInputAssemblyStateCreateInfo;
+			graphicsPipelineCreateInfo.pViewportState = &pipelineViewportStateCreateInfo;
+			graphicsPipelineCreateInfo.pRasterizationState = &pipelineRasterizationStateCreateInfo;
+			graphicsPipelineCreateInfo.pMultisampleState = &pipelineMultisampleStateCreateInfo;
+			graphicsPipelineCreateInfo.pDepthStencilState = &pipelineDepthStencilStateCreateInfo;
+			graphicsPipelineCreateInfo.pColorBlendState = &pipelineColorBlendStateCreateInfo;
+			graphicsPipelineCreateInfo.layout = instanceResource->instanceContainers[geometryModelIndex].pipelineLayout;
+			graphicsPipelineCreateInfo.renderPass = renderPass;
+
+			result = vkCreateGraphicsPipelines(device, VK_NULL_HANDLE, 1, &graphicsPipelineCreateInfo, nullptr, &graphicsPipeline);
+			if (result != VK_SUCCESS)
+			{
+				Logger::print(TinyEngine_ERROR, __FILE__, __LINE__, result);
+
+				return false;
+			}
+		}
+
+		// Meshlet bounds do not cover morphed or skinned vertices, nor the members of a crowd.
+		if (geometryModelResource->meshletsCount > 0 && geometryModelResource->targetsCount == 0 && instanceResource->jointMatricesCount == 0 && instanceResource->bakedJointsTextureHandle == 0 && instanceResource->crowdCount == 0)
+		{
+			if (!instanceCullFinalize(instanceResource->instanceContainers[geometryModelIndex], geometryModelResource))
+			{
+				return false;
+			}
+		}
+	}
+
+	//
+
+	instanceResource->finalized = true;
+
+	return true;
+}
+
+bool RenderManager::lightFinalize(uint64_t lightHandle)
+{
+	LightResource* lightResource = getLight(lightHandle);
+
+	if (!lightResource->created || lightResource->finalized)
+	{
+		return false;
+	}
+
+	// All three files are read at once.
+
+	std::string diffuseFilename = lightResource->environment + "/" + "diffuse.ktx2";
+	std::string specularFilename = lightResource->environment + "/" + "specular.ktx2";
+	std::string lutFilename = "../Resources/brdf/lut_ggx.png";
+
+	std::string diffuseData = "";
+	std::string specularData = "";
+	std::string lutData = "";
+
+	uint64_t diffuseRequest = asyncIO.submit(diffuseFilename, diffuseData);
+	uint64_t specularRequest = asyncIO.submit(specularFilename, specularData);
+	uint64_t lutRequest = asyncIO.submit(lutFilename, lutData);
+
+	bool diffuseRead = asyncIO.complete(diffuseRequest);
+	bool specularRead = asyncIO.complete(specularRequest);
+	bool lutRead = asyncIO.complete(lutRequest);
+
+	// Diffuse
+
+	TextureResourceCreateInfo diffuseMap = {};
+	diffuseMap.samplerResourceCreateInfo.minFilter = VK_FILTER_LINEAR;
+	diffuseMap.samplerResourceCreateInfo.magFilter = VK_FILTER_LINEAR;
+	diffuseMap.samplerResourceCreateInfo.mipmapMode = VK_SAMPLER_MIPMAP_MODE_NEAREST;
+
+	if(!diffuseRead || !ImageDataIO::open(diffuseMap.imageDataResources, reinterpret_cast<const uint8_t*>(diffuseData.data()), diffuseData.size()))
+	{
+		return false;
+	}
+
+	if (!VulkanResource::createTextureResource(physicalDevice, device, queue, commandPool, lightResource->diffuse, diffuseMap))
+	{
+		return false;
+	}
+
+	addTextureMemory(lightResource->diffuse.imageViewResource, diffuseMap.imageDataResources.images[0].format);
+
+	// Specular
+
+	TextureResourceCreateInfo specularMap = {};
+	specularMap.samplerResourceCreateInfo.minFilter = VK_FILTER_LINEAR;
+	specularMap.samplerResourceCreateInfo.magFilter = VK_FILTER_LINEAR;
+	specularMap.samplerResourceCreateInfo.mipmapMode = VK_SAMPLER_MIPMAP_MODE_LINEAR;
+
+	if(!specularRead || !ImageDataIO::open(specularMap.imageDataResources, reinterpret_cast<const uint8_t*>(specularData.data()), specularData.size()))
+	{
+		return false;
+	}
+
+	if (!VulkanResource::createTextureResource(physicalDevice, device, queue, commandPool, lightResource->specular, specularMap))
+	{
+		return false;
+	}
+
+	addTextureMemory(lightResource->specular.imageViewResource, specularMap.imageDataResources.images[0].format);
+
+	// LUT
+
+	TextureResourceCreateInfo lutMap = {};
+	lutMap.samplerResourceCreateInfo.minFilter = VK_FILTER_LINEAR;
+	lutMap.samplerResourceCreateInfo.magFilter = VK_FILTER_LINEAR;
+	lutMap.samplerResourceCreateInfo.mipmapMode = VK_SAMPLER_MIPMAP_MODE_NEAREST;
+	lutMap.samplerResourceCreateInfo.addressModeU = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+	lutMap.samplerResourceCreateInfo.addressModeV = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+
+	if(!lutRead || !ImageDataIO::open(lutMap.imageDataResources, reinterpret_cast<const uint8_t*>(lutData.data()), lutData.size()))
+	{
+		return false;
+	}
+
+	if (!VulkanResource::createTextureResource(physicalDevice, device, queue, commandPool, lightResource->lut, lutMap))
+	{
+		return false;
+	}
+
+	addTextureMemory(lightResource->lut.imageViewResource, lutMap.imageDataResources.images[0].format);
+
+
+	lightResource->finalized = true;
+
+	return true;
+}
+
+bool RenderManager::cameraFinalize(uint64_t cameraHandle)
+{
+	CameraResource* cameraResource = getCamera(cameraHandle);
+
+	if (!cameraResource->created || cameraResource->finalized)
+	{
+		return false;
+	}
+
+	cameraResource->finalized = true;
+
+	return true;
+}
+
+bool RenderManager::worldFinalize()
+{
+	WorldResource* worldResource = getWorld();
+
+	if (!worldResource->created || worldResource->finalized)
+	{
+		return false;
+	}
+
+	//
+
+	for (uint64_t instanceHandle : worldResource->instanceHandles)
+	{
+		InstanceResource* instanceResource = getInstance(instanceHandle);
+
+		if (!instanceResource->finalized)
+		{
+			return false;
+		}
+
+		if (instanceResource->groupHandle == 0)
+		{
+			continue;
+		}
+
+		//
+
+		GroupResource* groupResource = getGroup(instanceResource->groupHandle);
+
+		if (!groupResource->finalized)
+		{
+			return false;
+		}
+
+		for (uint64_t geometryModelHandle : groupResource->geometryModelHandles)
+		{
+			GeometryModelResource* geometryModelResource = getGeometryModel(geometryModelHandle);
+
+			if (!geometryModelResource->finalized)
+			{
+				return false;
+			}
+
+			//
+
+			GeometryResource* geometryResource = getGeometry(geometryModelResource->geometryHandle);
+
+			if (!geometryResource->finalized)
+			{
+				return false;
+			}
+
+			MaterialResource* materialResource = getMaterial(geometryModelResource->materialHandle);
+
+			if (!materialResource->finalized)
+			{
+				return false;
+			}
+		}
+	}
+
+	//
+
+	worldResource->finalized = true;
+
+	return true;
+}
+
+bool RenderManager::worldGetCamera(uint64_t& cameraHandle)
+{
+	WorldResource* worldResource = getWorld();
+
+	if (!worldResource->created || !worldResource->finalized)
+	{
+		return false;
+	}
+
+	if (worldResource->cameraHandle > 0)
+	{
+		cameraHandle = worldResource->cameraHandle;
+
+		return true;
+	}
+
+	return false;
+}
+
+bool RenderManager::isGeometryArena() const
+{
+	return geometryArena;
+}
+
+bool RenderManager::isJointMatrices3x4() const
+{
+	return jointMatrices3x4;
+}
+
+bool RenderManager::isDeformPrepass() const
+{
+	return deformPrepass;
+}
+
+bool RenderManager::isPositionDequantizeSupported() const
+{
+	return physicalDeviceProperties.limits.maxPushConstantsSize >= sizeof(UniformPushConstant);
+}
+
+const RenderStatistics& RenderManager::renderGetStatistics() const
+{
+	return renderStatistics;
+}
+
+bool RenderManager::instanceGetScreenSize(float& screenSize, uint64_t instanceHandle)
+{
+	InstanceResource* instanceResource = getInstance(instanceHandle);
+
+	if (!instanceResource->created || !instanceResource->finalized)
+	{
+		return false;
+	}
+
+	screenSize = 0.0f;
+
+	if (instanceResource->groupHandle == 0)
+	{
+		return true;
+	}
+
+	WorldResource* worldResource = getWorld();
+
+	GroupResource* groupResource = getGroup(instanceResource->groupHandle);
+
+	const std::vector<glm::mat4>& jointMatrices = instanceResource->deformJointMatrices;
+
+	for (uint64_t geometryModelHandle : groupResource->geometryModelHandles)
+	{
+		const GeometryModelResource* geometryModelResource = getGeometryModel(geometryModelHandle);
+
+		glm::vec3 boundsCenter = geometryModelResource->boundsCenter;
+		float boundsRadius = geometryModelResource->boundsRadius;
+
+		// Skinned vertices are blended from the bind pose bounds moved by each joint, so the animated bounds enclose all of them.
+		if (jointMatrices.size() > 0)
+		{
+			glm::vec3 minimum = glm::vec3(jointMatrices[0] * glm::vec4(geometryModelResource->boundsCenter, 1.0f));
+			glm::vec3 maximum = minimum;
+			for (const glm::mat4& jointMatrix : jointMatrices)
+			{
+				float scale = glm::max(glm::length(glm::vec3(jointMatrix[0])), glm::max(glm::length(glm::vec3(jointMatrix[1])), glm::length(glm::vec3(jointMatrix[2]))));
+
+				glm::vec3 center = glm::vec3(jointMatrix * glm::vec4(geometryModelResource->boundsCenter, 1.0f));
+				float radius = geometryModelResource->boundsRadius * scale;
+
+				minimum = glm::min(minimum, center - glm::vec3(radius));
+				maximum = glm::max(maximum, center + glm::vec3(radius));
+			}
+
+			boundsCenter = (minimum + maximum) * 0.5f;
+			boundsRadius = glm::length(maximum - minimum) * 0.5f;
+		}
+
+		screenSize = glm::max(screenSize, getScreenSize(boundsCenter, boundsRadius, instanceResource->worldMatrix, worldResource->viewProjection));
+	}
+
+	return true;
+}
+
+bool RenderManager::instanceUpdateWorldMatrix(uint64_t instanceHandle, const glm::mat4& worldMatrix)
+{
+	InstanceResource* instanceResource = getInstance(instanceHandle);
+
+	if (!instanceResource->created || !instanceResource->finalized)
+	{
+		return false;
+	}
+
+	instanceResource->worldMatrix = worldMatrix;
+
+	return true;
+}
+
+bool RenderManager::instanceUpdateWeights(uint64_t instanceHandle, const std::vector<float>& weights)
+{
+	InstanceResource* instanceResource = getInstance(instanceHandle);
+
+	if (!instanceResource->created || !instanceResource->finalized)
+	{
+		return false;
+	}
+
+	if (weights.size() != instanceResource->weightsCount)
+	{
+		return false;
+	}
+
+	// Nothing to upload or deform again.
+	if (instanceResource->deformWeights == weights)
+	{
+		return true;
+	}
+
+	instanceResource->deformWeights = weights;
+	instanceResource->deformVersion++;
+
+	instanceWriteWeights(instanceResource, weights);
+
+	return true;
+}
+
+bool RenderManager::instanceUpdateJointMatrices(uint64_t instanceHandle, const std::vector<glm::mat4>& jointMatrices)
+{
+	InstanceResource* instanceResource = getInstance(instanceHandle);
+
+	if (!instanceResource->created || !instanceResource->finalized)
+	{
+		return false;
+	}
+
+	if (jointMatrices.size() != instanceResource->jointMatricesCount)
+	{
+		return false;
+	}
+
+	// Nothing to upload or deform again.
+	if (memcmp(instanceResource->deformJointMatrices.data(), jointMatrices.data(), jointMatrices.size() * sizeof(glm::mat4)) == 0)
+	{
+		return true;
+	}
+
+	instanceResource->deformJointMatrices = jointMatrices;
+	instanceResource->deformVersion++;
+
+	instanceWriteJointMatrices(instanceResource, jointMatrices);
+
+	return true;
+}
+
+bool RenderManager::cameraUpdateProjectionMatrix(uint64_t cameraHandle, const glm::mat4& projectionMatrix)
+{
+	CameraResource* cameraResource = getCamera(cameraHandle);
+
+	if (!cameraResource->created || !cameraResource->finalized)
+	{
+		return false;
+	}
+
+	cameraResource->projection = projectionMatrix;
+
+	WorldResource* worldResource = getWorld();
+
+	worldResource->viewProjection.projection = projectionMatrix;
+
+	return true;
+}
+
+bool RenderManager::cameraUpdateViewMatrix(uint64_t cameraHandle, const glm::mat4& viewMatrix)
+{
+	CameraResource* cameraResource = getCamera(cameraHandle);
+
+	if (!cameraResource->created || !cameraResource->finalized)
+	{
+		return false;
+	}
+
+	cameraResource->view = viewMatrix;
+
+	WorldResource* worldResource = getWorld();
+
+	worldResource->viewProjection.view = viewMatrix;
+
+	return true;
+}
+
+bool RenderManager::worldUpdateTime(float time)
+{
+	WorldResource* worldResource = getWorld();
+
+	if (!worldResource->created)
+	{
+		return false;
+	}
+
+	worldResource->time = time;
+
+	return true;
+}
+
+bool RenderManager::sharedDataDelete(uint64_t sharedDataHandle)
+{
+	SharedDataResource* sharedDataResource = getSharedData(sharedDataHandle);
+
+	terminate(*sharedDataResource, device);
+	sharedDataResources.erase(sharedDataHandle);
+
+	return true;
+}
+
+bool RenderManager::textureDelete(uint64_t textureHandle)
+{
+	TextureDataResource* textureResource = getTexture(textureHandle);
+
+	terminate(*textureResource, device);
+	textureResources.erase(textureHandle);
+
+	return true;
+}
+
+bool RenderManager::materialDelete(uint64_t materialHandle)
+{
+	MaterialResource* materialResource = getMaterial(materialHandle);
+
+	terminate(*materialResource, device);
+	materialResources.erase(materialHandle);
+
+	return true;
+}
+
+bool RenderManager::geometryDelete(uint64_t geometryHandle)
+{
+	GeometryResource* geometryResource = getGeometry(geometryHandle);
+
+	terminate(*geometryResource, device);
+	geometryResources.erase(geometryHandle);
+
+	return true;
+}
+
+bool RenderManager::geometryModelDelete(uint64_t geometryModelHandle)
+{
+	GeometryModelResource* geometryModelResource = getGeometryModel(geometryModelHandle);
+
+	terminate(*geometryModelResource, device);
+	geometryModelResources.erase(geometryModelHandle);
+
+	return true;
+}
+
+bool RenderManager::groupDelete(uint64_t groupHandle)
+{
+	GroupResource* groupResource = getGroup(groupHandle);
+
+	terminate(*groupResource, device);
+	groupResources.erase(groupHandle);
+
+	return true;
+}
+
+bool RenderManager::instanceDelete(uint64_t instanceHandle)
+{
+	InstanceResource* instanceResource = getInstance(instanceHandle);
+
+	terminate(*instanceResource, device);
+	instanceResources.erase(instanceHandle);
+
+	return true;
+}
+
+bool RenderManager::lightDelete(uint64_t lightHandle)
+{
+	LightResource* lightResource = getLight(lightHandle);
 
-		VkGraphicsPipelineCreateInfo graphicsPipelineCreateInfo = {};
-		graphicsPipelineCreateInfo.sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO;
-		graphicsPipelineCreateInfo.stageCount = 2;
-		graphicsPipelineCreateInfo.pStages = pipelineShaderStageCreateInfo;
-		graphicsPipelineCreateInfo.pVertexInputState = &pipelineVertexInputStateCreateInfo;
-		graphicsPipelineCreateInfo.pInputAssemblyState = &pipelineInputAssemblyStateCreateInfo;
-		graphicsPipelineCreateInfo.pViewportState = &pipelineViewportStateCreateInfo;
-		graphicsPipelineCreateInfo.pRasterizationState = &pipelineRasterizationStateCreateInfo;
-		graphicsPipelineCreateInfo.pMultisampleState = &pipelineMultisampleStateCreateInfo;
-		graphicsPipelineCreateInfo.pDepthStencilState = &pipelineDepthStencilStateCreateInfo;
-		graphicsPipelineCreateInfo.pColorBlendState = &pipelineColorBlendStateCreateInfo;
-		graphicsPipelineCreateInfo.layout = instanceResource->instanceContainers[geometryModelIndex].pipelineLayout;
-		graphicsPipelineCreateInfo.renderPass = renderPass;
-
-		result = vkCreateGraphicsPipelines(device, VK_NULL_HANDLE, 1, &graphicsPipelineCreateInfo, nullptr, &instanceResource->instanceContainers[geometryModelIndex].graphicsPipeline);
-		if (result != VK_SUCCESS)
-		{
-			Logger::print(TinyEngine_ERROR, __FILE__, __LINE__, result);
+	terminate(*lightResource, device);
+	lightResources.erase(lightHandle);
 
-			return false;
-		}
-	}
+	return true;
+}
 
-	//
+bool RenderManager::cameraDelete(uint64_t cameraHandle)
+{
+	CameraResource* cameraResource = getCamera(cameraHandle);
 
-	instanceResource->finalized = true;
+	terminate(*cameraResource, device);
+	cameraResources.erase(cameraHandle);
 
 	return true;
 }
 
-bool RenderManager::lightFinalize(uint64_t lightHandle)
+bool RenderManager::worldDelete()
 {
-	LightResource* lightResource = getLight(lightHandle);
+	WorldResource* worldResource = getWorld();
 
-	if (!lightResource->created || lightResource->finalized)
-	{
-		return false;
-	}
+	terminate(*worldResource, device);
 
-	// Diffuse
+	return true;
+}
 
-	std::string diffuseFilename = lightResource->environment + "/" + "diffuse.ktx2";
-	TextureResourceCreateInfo diffuseMap = {};
-	diffuseMap.samplerResourceCreateInfo.minFilter = VK_FILTER_LINEAR;
-	diffuseMap.samplerResourceCreateInfo.magFilter = VK_FILTER_LINEAR;
-	diffuseMap.samplerResourceCreateInfo.mipmapMode = VK_SAMPLER_MIPMAP_MODE_NEAREST;
+void RenderManager::terminate()
+{
+	terminate(worldResource, device);
 
-	if(!ImageDataIO::open(diffuseMap.imageDataResources, diffuseFilename))
+	for (auto it : cameraResources)
 	{
-		return false;
+		terminate(it.second, device);
 	}
+	cameraResources.clear();
 
-	if (!VulkanResource::createTextureResource(physicalDevice, device, queue, commandPool, lightResource->diffuse, diffuseMap))
+	for (auto it : lightResources)
 	{
-		return false;
+		terminate(it.second, device);
 	}
+	lightResources.clear();
 
-	// Specular
-
-	std::string specularFilename = lightResource->environment + "/" + "specular.ktx2";
-	TextureResourceCreateInfo specularMap = {};
-	specularMap.samplerResourceCreateInfo.minFilter = VK_FILTER_LINEAR;
-	specularMap.samplerResourceCreateInfo.magFilter = VK_FILTER_LINEAR;
-	specularMap.samplerResourceCreateInfo.mipmapMode = VK_SAMPLER_MIPMAP_MODE_LINEAR;
-
-	if(!ImageDataIO::open(specularMap.imageDataResources, specularFilename))
+	for (auto it : instanceResources)
 	{
-		return false;
+		terminate(it.second, device);
 	}
+	instanceResources.clear();
 
-	if (!VulkanResource::createTextureResource(physicalDevice, device, queue, commandPool, lightResource->specular, specularMap))
+	for (auto it : groupResources)
 	{
-		return false;
+		terminate(it.second, device);
 	}
+	groupResources.clear();
 
-	// LUT
-
-	std::string lutFilename = "../Resources/brdf/lut_ggx.png";
-	TextureResourceCreateInfo lutMap = {};
-	lutMap.samplerResourceCreateInfo.minFilter = VK_FILTER_LINEAR;
-	lutMap.samplerResourceCreateInfo.magFilter = VK_FILTER_LINEAR;
-	lutMap.samplerResourceCreateInfo.mipmapMode = VK_SAMPLER_MIPMAP_MODE_NEAREST;
-	lutMap.samplerResourceCreateInfo.addressModeU = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
-	lutMap.samplerResourceCreateInfo.addressModeV = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
-
-	if(!ImageDataIO::open(lutMap.imageDataResources, lutFilename))
+	for (auto it : geometryModelResources)
 	{
-		return false;
+		terminate(it.second, device);
 	}
+	geometryModelResources.clear();
 
-	if (!VulkanResource::createTextureResource(physicalDevice, device, queue, commandPool, lightResource->lut, lutMap))
+	for (auto it : geometryResources)
 	{
-		return false;
+		terminate(it.second, device);
 	}
+	geometryResources.clear();
 
-
-	lightResource->finalized = true;
-
-	return true;
-}
-
-bool RenderManager::cameraFinalize(uint64_t cameraHandle)
-{
-	CameraResource* cameraResource = getCamera(cameraHandle);
-
-	if (!cameraResource->created || cameraResource->finalized)
+	for (auto it : materialResources)
 	{
-		return false;
+		terminate(it.second, device);
 	}
+	materialResources.clear();
 
-	cameraResource->finalized = true;
+	for (auto it : textureResources)
+	{
+		terminate(it.second, device);
+	}
+	textureResources.clear();
 
-	return true;
-}
+	for (auto it : sharedDataResources)
+	{
+		terminate(it.second, device);
+	}
+	sharedDataResources.clear();
 
-bool RenderManager::worldFinalize()
-{
-	WorldResource* worldResource = getWorld();
+	for (auto& it : indexArenaResources)
+	{
+		terminate(it, device);
+	}
+	indexArenaResources.clear();
 
-	if (!worldResource->created || worldResource->finalized)
+	for (auto& it : vertexArenaResources)
 	{
-		return false;
+		terminate(it, device);
 	}
+	vertexArenaResources.clear();
+
+	terminate(animationArenaResource, device);
 
 	//
 
-	for (uint64_t instanceHandle : worldResource->instanceHandles)
+	if (cullPipeline != VK_NULL_HANDLE)
 	{
-		InstanceResource* instanceResource = getInstance(instanceHandle);
+		vkDestroyPipeline(device, cullPipeline, nullptr);
+		cullPipeline = VK_NULL_HANDLE;
+	}
 
-		if (!instanceResource->finalized)
-		{
-			return false;
-		}
+	if (cullPipelineLayout != VK_NULL_HANDLE)
+	{
+		vkDestroyPipelineLayout(device, cullPipelineLayout, nullptr);
+		cullPipelineLayout = VK_NULL_HANDLE;
+	}
 
-		if (instanceResource->groupHandle == 0)
-		{
-			continue;
-		}
+	if (cullShaderModule != VK_NULL_HANDLE)
+	{
+		vkDestroyShaderModule(device, cullShaderModule, nullptr);
+		cullShaderModule = VK_NULL_HANDLE;
+	}
 
-		//
+	if (cullDescriptorSetLayout != VK_NULL_HANDLE)
+	{
+		vkDestroyDescriptorSetLayout(device, cullDescriptorSetLayout, nullptr);
+		cullDescriptorSetLayout = VK_NULL_HANDLE;
+	}
 
-		GroupResource* groupResource = getGroup(instanceResource->groupHandle);
+	if (deformPipelineLayout != VK_NULL_HANDLE)
+	{
+		vkDestroyPipelineLayout(device, deformPipelineLayout, nullptr);
+		deformPipelineLayout = VK_NULL_HANDLE;
+	}
 
-		if (!groupResource->finalized)
-		{
-			return false;
-		}
+	if (deformDescriptorSetLayout != VK_NULL_HANDLE)
+	{
+		vkDestroyDescriptorSetLayout(device, deformDescriptorSetLayout, nullptr);
+		deformDescriptorSetLayout = VK_NULL_HANDLE;
+	}
 
-		for (uint64_t geometryModelHandle : groupResource->geometryModelHandles)
-		{
-			GeometryModelResource* geometryModelResource = getGeometryModel(geometryModelHandle);
+	//
 
-			if (!geometryModelResource->finalized)
-			{
-				return false;
-			}
+	width = 0;
+	height = 0;
 
-			//
+	renderPass = VK_NULL_HANDLE;
+	samples = VK_SAMPLE_COUNT_1_BIT;
 
-			GeometryResource* geometryResource = getGeometry(geometryModelResource->geometryHandle);
+	imageView = VK_NULL_HANDLE;
 
-			if (!geometryResource->finalized)
-			{
-				return false;
-			}
+	physicalDevice = VK_NULL_HANDLE;
+	device = VK_NULL_HANDLE;
+	queue = VK_NULL_HANDLE;
+	commandPool = VK_NULL_HANDLE;
 
-			MaterialResource* materialResource = getMaterial(geometryModelResource->materialHandle);
+	handles = 0;
+}
 
-			if (!materialResource->finalized)
-			{
-				return false;
-			}
-		}
-	}
+void RenderManager::getTextureMemory(uint64_t& memory, uint64_t& memoryUncompressed, const ImageViewResource& imageViewResource, VkFormat format)
+{
+	VkMemoryRequirements memoryRequirements = {};
+	vkGetImageMemoryRequirements(device, imageViewResource.image, &memoryRequirements);
 
-	//
+	memory = memoryRequirements.size;
+	memoryUncompressed = HelperFormat::getUncompressedSize(format, static_cast<size_t>(memoryRequirements.size));
+}
 
-	worldResource->finalized = true;
+void RenderManager::addTextureMemory(const ImageViewResource& imageViewResource, VkFormat format)
+{
+	uint64_t memory = 0;
+	uint64_t memoryUncompressed = 0;
+	getTextureMemory(memory, memoryUncompressed, imageViewResource, format);
 
-	return true;
+	renderStatistics.textureMemory += memory;
+	renderStatistics.textureMemoryUncompressed += memoryUncompressed;
 }
 
-bool RenderManager::worldGetCamera(uint64_t& cameraHandle)
+uint64_t RenderManager::getImageHash(const TextureResourceCreateInfo& textureResourceCreateInfo)
 {
-	WorldResource* worldResource = getWorld();
+	const ImageDataResources& imageDataResources = textureResourceCreateInfo.imageDataResources;
 
-	if (!worldResource->created || !worldResource->finalized)
-	{
-		return false;
-	}
+	uint64_t hash = HelperHash::combine(imageDataResources.mipLevels, imageDataResources.faceCount);
+	hash = HelperHash::combine(hash, textureResourceCreateInfo.mipMap ? 1 : 0);
 
-	if (worldResource->cameraHandle > 0)
+	for (const ImageDataResource& imageDataResource : imageDataResources.images)
 	{
-		cameraHandle = worldResource->cameraHandle;
+		const uint8_t* pixels = imageDataResource.mapped ? imageDataResource.mapped : imageDataResource.pixels.data();
+		size_t pixelsSize = imageDataResource.mapped ? imageDataResource.mappedSize : imageDataResource.pixels.size();
 
-		return true;
+		hash = HelperHash::combine(hash, HelperHash::combine(imageDataResource.width, imageDataResource.height));
+		hash = HelperHash::combine(hash, HelperHash::combine(static_cast<uint64_t>(imageDataResource.format), HelperHash::combine(imageDataResource.mipLevel, imageDataResource.face)));
+		hash = HelperHash::combine(hash, HelperHash::hash(pixels, pixelsSize));
 	}
 
-	return false;
+	return hash;
 }
 
-bool RenderManager::instanceUpdateWorldMatrix(uint64_t instanceHandle, const glm::mat4& worldMatrix)
+bool RenderManager::isSameImage(const TextureImageResource& textureImageResource, const TextureResourceCreateInfo& textureResourceCreateInfo)
 {
-	InstanceResource* instanceResource = getInstance(instanceHandle);
+	const ImageDataResources& imageDataResources = textureResourceCreateInfo.imageDataResources;
 
-	if (!instanceResource->created || !instanceResource->finalized)
+	if (textureImageResource.imageMipLevels != imageDataResources.mipLevels || textureImageResource.faceCount != imageDataResources.faceCount || textureImageResource.mipMap != textureResourceCreateInfo.mipMap || textureImageResource.imageLayouts.size() != imageDataResources.images.size())
 	{
 		return false;
 	}
 
-	instanceResource->worldMatrix = worldMatrix;
-
-	return true;
-}
-
-bool RenderManager::instanceUpdateWeights(uint64_t instanceHandle, const std::vector<float>& weights, uint32_t frameIndex)
-{
-	InstanceResource* instanceResource = getInstance(instanceHandle);
-
-	if (!instanceResource->created || !instanceResource->finalized)
+	for (size_t i = 0; i < imageDataResources.images.size(); i++)
 	{
-		return false;
-	}
+		const TextureImageLayout& textureImageLayout = textureImageResource.imageLayouts[i];
+		const ImageDataResource& imageDataResource = imageDataResources.images[i];
 
-	SharedDataResource* sharedDataResource = getSharedData(instanceResource->weightsHandle);
+		size_t size = imageDataResource.mapped ? imageDataResource.mappedSize : imageDataResource.pixels.size();
 
-	VkDeviceSize offset = sharedDataResource->size / frames * frameIndex;
+		if (textureImageLayout.width != imageDataResource.width || textureImageLayout.height != imageDataResource.height || textureImageLayout.format != imageDataResource.format || textureImageLayout.mipLevel != imageDataResource.mipLevel || textureImageLayout.face != imageDataResource.face || textureImageLayout.size != size)
+		{
+			return false;
+		}
+	}
 
-	if (!VulkanResource::copyHostToDevice(device, sharedDataResource->uniformBufferResource.bufferResource, weights.data(), weights.size() * sizeof(float), offset))
+	// Mapped pixels are only valid until uploaded, so only the ones owned by the texture are compared.
+	auto textureDataResource = textureResources.find(textureImageResource.textureHandle);
+	if (textureDataResource == textureResources.end())
 	{
-		return false;
+		return true;
 	}
 
-	return true;
-}
-
-bool RenderManager::instanceUpdateJointMatrices(uint64_t instanceHandle, const std::vector<glm::mat4>& jointMatrices, uint32_t frameIndex)
-{
-	InstanceResource* instanceResource = getInstance(instanceHandle);
-
-	if (!instanceResource->created || !instanceResource->finalized)
+	const ImageDataResources& registeredImageDataResources = textureDataResource->second.textureResourceCreateInfo.imageDataResources;
+	if (registeredImageDataResources.images.size() != imageDataResources.images.size())
 	{
-		return false;
+		return true;
 	}
 
-	SharedDataResource* sharedDataResource = getSharedData(instanceResource->jointMatricesHandle);
+	for (size_t i = 0; i < imageDataResources.images.size(); i++)
+	{
+		const ImageDataResource& registeredImageDataResource = registeredImageDataResources.images[i];
+		const ImageDataResource& imageDataResource = imageDataResources.images[i];
 
-	VkDeviceSize offset = sharedDataResource->size / frames * frameIndex;
+		if (registeredImageDataResource.mapped || imageDataResource.mapped || registeredImageDataResource.pixels.size() != imageDataResource.pixels.size())
+		{
+			continue;
+		}
 
-	if (!VulkanResource::copyHostToDevice(device, sharedDataResource->uniformBufferResource.bufferResource, jointMatrices.data(), jointMatrices.size() * sizeof(glm::mat4), offset))
-	{
-		return false;
+		if (imageDataResource.pixels.size() > 0 && memcmp(registeredImageDataResource.pixels.data(), imageDataResource.pixels.data(), imageDataResource.pixels.size()) != 0)
+		{
+			return false;
+		}
 	}
 
 	return true;
 }
 
-bool RenderManager::cameraUpdateProjectionMatrix(uint64_t cameraHandle, const glm::mat4& projectionMatrix)
+void RenderManager::destroyTextureImage(std::map<uint64_t, TextureImageResource>::iterator textureImageResource)
 {
-	CameraResource* cameraResource = getCamera(cameraHandle);
+	renderStatistics.textureMemory -= textureImageResource->second.memory;
+	renderStatistics.textureMemoryUncompressed -= textureImageResource->second.memoryUncompressed;
 
-	if (!cameraResource->created || !cameraResource->finalized)
+	VulkanResource::destroyImageViewResource(device, textureImageResource->second.imageViewResource);
+	textureImageResources.erase(textureImageResource);
+}
+
+bool RenderManager::getShaderSource(const std::string*& shaderSource, const std::string& filename)
+{
+	if (shaderSources.size() == 0)
 	{
-		return false;
+		static const char* shaderFilenames[] = {
+			"../Resources/shaders/cull.comp",
+			"../Resources/shaders/deform.comp",
+			"../Resources/shaders/gltf.vert",
+			"../Resources/shaders/gltf.frag"
+		};
+
+		std::vector<uint64_t> requests;
+		for (const char* shaderFilename : shaderFilenames)
+		{
+			requests.push_back(asyncIO.submit(shaderFilename, shaderSources[shaderFilename]));
+		}
+
+		for (size_t i = 0; i < requests.size(); i++)
+		{
+			if (!asyncIO.complete(requests[i]))
+			{
+				shaderSources.erase(shaderFilenames[i]);
+			}
+		}
 	}
 
-	cameraResource->projection = projectionMatrix;
+	auto it = shaderSources.find(filename);
+	if (it == shaderSources.end())
+	{
+		// Not one of the known shaders.
+		std::string& source = shaderSources[filename];
+		if (!asyncIO.complete(asyncIO.submit(filename, source)))
+		{
+			shaderSources.erase(filename);
+
+			Logger::print(TinyEngine_ERROR, __FILE__, __LINE__, "Could not read shader '%s'", filename.c_str());
+
+			return false;
+		}
 
-	WorldResource* worldResource = getWorld();
+		it = shaderSources.find(filename);
+	}
 
-	worldResource->viewProjection.projection = projectionMatrix;
+	shaderSource = &it->second;
 
 	return true;
 }
 
-bool RenderManager::cameraUpdateViewMatrix(uint64_t cameraHandle, const glm::mat4& viewMatrix)
+float RenderManager::getScreenSize(const glm::vec3& boundsCenter, float boundsRadius, const glm::mat4& worldMatrix, const ViewProjectionUniformPushConstant& viewProjection) const
 {
-	CameraResource* cameraResource = getCamera(cameraHandle);
+	float scale = glm::max(glm::length(glm::vec3(worldMatrix[0])), glm::max(glm::length(glm::vec3(worldMatrix[1])), glm::length(glm::vec3(worldMatrix[2]))));
 
-	if (!cameraResource->created || !cameraResource->finalized)
+	Sphere sphere(worldMatrix * glm::vec4(boundsCenter, 1.0f), boundsRadius * scale);
+
+	Frustum frustum(viewProjection.view, viewProjection.projection);
+	if (!frustum.isVisible(sphere))
 	{
-		return false;
+		return 0.0f;
 	}
 
-	cameraResource->view = viewMatrix;
+	float pixelsPerUnit = glm::abs(viewProjection.projection[1][1]) * 0.5f * static_cast<float>(height);
+	if (viewProjection.projection[3][3] == 0.0f)
+	{
+		float distance = glm::length(glm::vec3(viewProjection.view * sphere.getCenter()));
 
-	WorldResource* worldResource = getWorld();
+		// Camera is inside of the bounds.
+		if (distance <= sphere.getRadius())
+		{
+			return static_cast<float>(height);
+		}
 
-	worldResource->viewProjection.view = viewMatrix;
+		pixelsPerUnit /= distance;
+	}
 
-	return true;
+	return 2.0f * sphere.getRadius() * pixelsPerUnit;
 }
 
-bool RenderManager::sharedDataDelete(uint64_t sharedDataHandle)
+uint32_t RenderManager::getLod(const GeometryModelResource* geometryModelResource, const glm::mat4& worldMatrix, const ViewProjectionUniformPushConstant& viewProjection) const
 {
-	SharedDataResource* sharedDataResource = getSharedData(sharedDataHandle);
-
-	terminate(*sharedDataResource, device);
-	sharedDataResources.erase(sharedDataHandle);
-
-	return true;
-}
+	if (geometryModelResource->lods.size() <= 1 || lodThreshold <= 0.0f)
+	{
+		return 0;
+	}
 
-bool RenderManager::textureDelete(uint64_t textureHandle)
-{
-	TextureDataResource* textureResource = getTexture(textureHandle);
+	float scale = glm::max(glm::length(glm::vec3(worldMatrix[0])), glm::max(glm::length(glm::vec3(worldMatrix[1])), glm::length(glm::vec3(worldMatrix[2]))));
 
-	terminate(*textureResource, device);
-	textureResources.erase(textureHandle);
+	// Pixels per world unit at the nearest point of the bounding sphere.
+	float pixelsPerUnit = glm::abs(viewProjection.projection[1][1]) * 0.5f * static_cast<float>(height);
+	if (viewProjection.projection[3][3] == 0.0f)
+	{
+		glm::vec4 center = viewProjection.view * worldMatrix * glm::vec4(geometryModelResource->boundsCenter, 1.0f);
 
-	return true;
-}
+		float distance = glm::length(glm::vec3(center)) - geometryModelResource->boundsRadius * scale;
+		if (distance <= 0.0f)
+		{
+			return 0;
+		}
 
-bool RenderManager::materialDelete(uint64_t materialHandle)
-{
-	MaterialResource* materialResource = getMaterial(materialHandle);
+		pixelsPerUnit /= distance;
+	}
 
-	terminate(*materialResource, device);
-	materialResources.erase(materialHandle);
+	for (uint32_t lod = static_cast<uint32_t>(geometryModelResource->lods.size()) - 1; lod > 0; lod--)
+	{
+		if (geometryModelResource->lods[lod].error * scale * pixelsPerUnit <= lodThreshold)
+		{
+			return lod;
+		}
+	}
 
-	return true;
+	return 0;
 }
 
-bool RenderManager::geometryDelete(uint64_t geometryHandle)
+void RenderManager::cull(VkCommandBuffer commandBuffer, uint32_t frameIndex)
 {
-	GeometryResource* geometryResource = getGeometry(geometryHandle);
+	WorldResource* worldResource = getWorld();
 
-	terminate(*geometryResource, device);
-	geometryResources.erase(geometryHandle);
+	std::vector<std::pair<InstanceContainer*, CullPushConstant>> dispatches;
 
-	return true;
-}
+	for (size_t i = 0; i < worldResource->instanceHandles.size(); i++)
+	{
+		InstanceResource* instanceResource = getInstance(worldResource->instanceHandles[i]);
 
-bool RenderManager::geometryModelDelete(uint64_t geometryModelHandle)
-{
-	GeometryModelResource* geometryModelResource = getGeometryModel(geometryModelHandle);
+		if (instanceResource->groupHandle == 0)
+		{
+			continue;
+		}
 
-	terminate(*geometryModelResource, device);
-	geometryModelResources.erase(geometryModelHandle);
+		GroupResource* groupResource = getGroup(instanceResource->groupHandle);
 
-	return true;
-}
+		for (size_t geometryModelIndex = 0; geometryModelIndex < groupResource->geometryModelHandles.size(); geometryModelIndex++)
+		{
+			InstanceContainer& instanceContainer = instanceResource->instanceContainers[geometryModelIndex];
 
-bool RenderManager::groupDelete(uint64_t groupHandle)
-{
-	GroupResource* groupResource = getGroup(groupHandle);
+			instanceContainer.culled = false;
 
-	terminate(*groupResource, device);
-	groupResources.erase(groupHandle);
+			if (instanceContainer.cullDescriptorSets.size() == 0)
+			{
+				continue;
+			}
 
-	return true;
-}
+			GeometryModelResource* geometryModelResource = getGeometryModel(groupResource->geometryModelHandles[geometryModelIndex]);
 
-bool RenderManager::instanceDelete(uint64_t instanceHandle)
-{
-	InstanceResource* instanceResource = getInstance(instanceHandle);
+			// Meshlets are only built for the full resolution.
+			if (getLod(geometryModelResource, instanceResource->worldMatrix, worldResource->viewProjection) != 0)
+			{
+				continue;
+			}
 
-	terminate(*instanceResource, device);
-	instanceResources.erase(instanceHandle);
+			MaterialResource* materialResource = getMaterial(geometryModelResource->materialHandle);
 
-	return true;
-}
+			//
 
-bool RenderManager::lightDelete(uint64_t lightHandle)
-{
-	LightResource* lightResource = getLight(lightHandle);
+			CullPushConstant cullPushConstant = {};
 
-	terminate(*lightResource, device);
-	lightResources.erase(lightHandle);
+			// Planes are extracted in model space, so no sphere has to be transformed.
+			glm::mat4 matrix = glm::transpose(worldResource->viewProjection.projection * worldResource->viewProjection.view * instanceResource->worldMatrix);
 
-	return true;
-}
+			cullPushConstant.planes[0] = matrix[3] + matrix[0];
+			cullPushConstant.planes[1] = matrix[3] - matrix[0];
+			cullPushConstant.planes[2] = matrix[3] + matrix[1];
+			cullPushConstant.planes[3] = matrix[3] - matrix[1];
+			cullPushConstant.planes[4] = matrix[2];
+			cullPushConstant.planes[5] = matrix[3] - matrix[2];
 
-bool RenderManager::cameraDelete(uint64_t cameraHandle)
-{
-	CameraResource* cameraResource = getCamera(cameraHandle);
+			for (uint32_t k = 0; k < 6; k++)
+			{
+				float length = glm::length(glm::vec3(cullPushConstant.planes[k]));
+				if (length > 0.0f)
+				{
+					cullPushConstant.planes[k] /= length;
+				}
+			}
 
-	terminate(*cameraResource, device);
-	cameraResources.erase(cameraHandle);
+			cullPushConstant.camera = glm::inverse(worldResource->viewProjection.view * instanceResource->worldMatrix) * glm::vec4(0.0f, 0.0f, 0.0f, 1.0f);
 
-	return true;
-}
+			cullPushConstant.meshletsCount = geometryModelResource->meshletsCount;
 
-bool RenderManager::worldDelete()
-{
-	WorldResource* worldResource = getWorld();
+			// Back facing clusters can only be rejected for single sided materials and a perspective camera.
+			cullPushConstant.coneCulling = (!materialResource->materialParameters.doubleSided && worldResource->viewProjection.projection[3][3] == 0.0f) ? 1 : 0;
 
-	terminate(*worldResource, device);
+			//
 
-	return true;
-}
+			VkDrawIndexedIndirectCommand drawIndexedIndirectCommand = {};
+			drawIndexedIndirectCommand.indexCount = 0;
+			drawIndexedIndirectCommand.instanceCount = 1;
+			drawIndexedIndirectCommand.firstIndex = 0;
+			// Culled geometry is never deformed, so it is drawn at its base vertex in the arena.
+			drawIndexedIndirectCommand.vertexOffset = geometryModelResource->vertexOffset;
+			drawIndexedIndirectCommand.firstInstance = 0;
 
-void RenderManager::terminate()
-{
-	terminate(worldResource, device);
+			vkCmdUpdateBuffer(commandBuffer, instanceContainer.cullDrawBufferResources[frameIndex].bufferResource.buffer, 0, sizeof(drawIndexedIndirectCommand), &drawIndexedIndirectCommand);
 
-	for (auto it : cameraResources)
-	{
-		terminate(it.second, device);
+			dispatches.push_back({&instanceContainer, cullPushConstant});
+		}
 	}
-	cameraResources.clear();
 
-	for (auto it : lightResources)
+	if (dispatches.size() == 0)
 	{
-		terminate(it.second, device);
+		return;
 	}
-	lightResources.clear();
 
-	for (auto it : instanceResources)
-	{
-		terminate(it.second, device);
-	}
-	instanceResources.clear();
+	VkMemoryBarrier memoryBarrier = {};
+	memoryBarrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+	memoryBarrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+	memoryBarrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
 
-	for (auto it : groupResources)
-	{
-		terminate(it.second, device);
-	}
-	groupResources.clear();
+	vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0, 1, &memoryBarrier, 0, nullptr, 0, nullptr);
 
-	for (auto it : geometryModelResources)
-	{
-		terminate(it.second, device);
-	}
-	geometryModelResources.clear();
+	vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, cullPipeline);
 
-	for (auto it : geometryResources)
+	for (auto& it : dispatches)
 	{
-		terminate(it.second, device);
-	}
-	geometryResources.clear();
+		vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, cullPipelineLayout, 0, 1, &it.first->cullDescriptorSets[frameIndex], 0, nullptr);
+		vkCmdPushConstants(commandBuffer, cullPipelineLayout, VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(CullPushConstant), &it.second);
 
-	for (auto it : materialResources)
-	{
-		terminate(it.second, device);
+		// One invocation per meshlet.
+		vkCmdDispatch(commandBuffer, (it.second.meshletsCount + 63) / 64, 1, 1);
+
+		it.first->culled = true;
+
+		renderStatistics.cullDispatches++;
+		renderStatistics.meshletsTested += it.second.meshletsCount;
 	}
-	materialResources.clear();
 
-	for (auto it : textureResources)
+	memoryBarrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+	memoryBarrier.dstAccessMask = VK_ACCESS_INDIRECT_COMMAND_READ_BIT | VK_ACCESS_INDEX_READ_BIT;
+
+	vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT | VK_PIPELINE_STAGE_VERTEX_INPUT_BIT, 0, 1, &memoryBarrier, 0, nullptr, 0, nullptr);
+}
+
+void RenderManager::deform(VkCommandBuffer commandBuffer, uint32_t frameIndex)
+{
+	if (!animationArenaUpload(frameIndex))
 	{
-		terminate(it.second, device);
+		return;
 	}
-	textureResources.clear();
 
-	for (auto it : sharedDataResources)
+	WorldResource* worldResource = getWorld();
+
+	bool dispatched = false;
+
+	for (size_t i = 0; i < worldResource->instanceHandles.size(); i++)
 	{
-		terminate(it.second, device);
-	}
-	sharedDataResources.clear();
+		InstanceResource* instanceResource = getInstance(worldResource->instanceHandles[i]);
 
-	//
+		if (instanceResource->groupHandle == 0)
+		{
+			continue;
+		}
 
-	width = 0;
-	height = 0;
+		GroupResource* groupResource = getGroup(instanceResource->groupHandle);
 
-	renderPass = VK_NULL_HANDLE;
-	samples = VK_SAMPLE_COUNT_1_BIT;
+		for (size_t geometryModelIndex = 0; geometryModelIndex < groupResource->geometryModelHandles.size(); geometryModelIndex++)
+		{
+			InstanceContainer& instanceContainer = instanceResource->instanceContainers[geometryModelIndex];
 
-	imageView = VK_NULL_HANDLE;
+			if (instanceContainer.deformDescriptorSets.size() == 0)
+			{
+				continue;
+			}
 
-	physicalDevice = VK_NULL_HANDLE;
-	device = VK_NULL_HANDLE;
-	queue = VK_NULL_HANDLE;
-	commandPool = VK_NULL_HANDLE;
+			// Output buffer of this frame is still valid.
+			if (instanceContainer.deformVersions[frameIndex] == instanceResource->deformVersion)
+			{
+				renderStatistics.deformSkipped++;
 
-	handles = 0;
+				continue;
+			}
+
+			GeometryModelResource* geometryModelResource = getGeometryModel(groupResource->geometryModelHandles[geometryModelIndex]);
+
+			GeometryResource* geometryResource = getGeometry(geometryModelResource->geometryHandle);
+
+			//
+
+			DeformPushConstant deformPushConstant = {};
+			deformPushConstant.verticesCount = geometryResource->count;
+			deformPushConstant.targetsCount = geometryModelResource->targetsCount;
+			deformPushConstant.jointMatricesOffset = instanceResource->jointMatricesOffset;
+			deformPushConstant.weightsOffset = instanceResource->weightsOffset;
+
+			vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, instanceContainer.deformPipeline);
+			vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, deformPipelineLayout, 0, 1, &instanceContainer.deformDescriptorSets[frameIndex], 0, nullptr);
+			vkCmdPushConstants(commandBuffer, deformPipelineLayout, VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(DeformPushConstant), &deformPushConstant);
+
+			// One invocation per vertex.
+			vkCmdDispatch(commandBuffer, (deformPushConstant.verticesCount + 63) / 64, 1, 1);
+
+			instanceContainer.deformVersions[frameIndex] = instanceResource->deformVersion;
+
+			renderStatistics.deformDispatches++;
+
+			dispatched = true;
+		}
+	}
+
+	if (!dispatched)
+	{
+		return;
+	}
+
+	VkMemoryBarrier memoryBarrier = {};
+	memoryBarrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+	memoryBarrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+	memoryBarrier.dstAccessMask = VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT;
+
+	vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_VERTEX_INPUT_BIT, 0, 1, &memoryBarrier, 0, nullptr, 0, nullptr);
 }
 
 void RenderManager::draw(VkCommandBuffer commandBuffer, uint32_t frameIndex, DrawMode drawMode)
 {
+	if (!animationArenaUpload(frameIndex))
+	{
+		return;
+	}
+
 	WorldResource* worldResource = getWorld();
 
+	// Vertex and index buffer bindings survive pipeline changes, so geometry sharing an arena is only bound once.
+	const GeometryResource* boundGeometryResource = nullptr;
+	VkBuffer boundIndexBuffer = VK_NULL_HANDLE;
+	VkDeviceSize boundIndexOffset = 0;
+	VkIndexType boundIndexType = VK_INDEX_TYPE_NONE_KHR;
+
 	for (size_t i = 0; i < worldResource->instanceHandles.size(); i++)
 	{
 		InstanceResource* instanceResource = getInstance(worldResource->instanceHandles[i]);
@@ -2409,10 +4868,25 @@ void RenderManager::draw(VkCommandBuffer commandBuffer, uint32_t frameIndex, Dra
 
 			//
 
-			vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, instanceResource->instanceContainers[geometryModelIndex].graphicsPipeline);
+			const InstanceContainer& instanceContainer = instanceResource->instanceContainers[geometryModelIndex];
+
+			// Without the pre-pass output of this frame, e.g. if deform() has not been recorded, the vertex shader deforms.
+			bool deformed = instanceContainer.deformDescriptorSets.size() > 0 && instanceContainer.deformVersions[frameIndex] == instanceResource->deformVersion;
+
+			VkPipeline graphicsPipeline = instanceContainer.graphicsPipeline;
+			if (instanceContainer.deformDescriptorSets.size() > 0 && !deformed)
+			{
+				graphicsPipeline = instanceContainer.fallbackGraphicsPipeline;
+			}
+
+			vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, graphicsPipeline);
 
-			uint32_t dynamicOffsetCount = static_cast<uint32_t>(instanceResource->instanceContainers[geometryModelIndex].dynamicOffsets.size()) / frames;
-			vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, instanceResource->instanceContainers[geometryModelIndex].pipelineLayout, 0, 1, &instanceResource->instanceContainers[geometryModelIndex].descriptorSet, dynamicOffsetCount, &instanceResource->instanceContainers[geometryModelIndex].dynamicOffsets.data()[frameIndex * dynamicOffsetCount]);
+			// Deformed vertices start at zero, all other geometry at its base vertex in the arena.
+			int32_t vertexOffset = deformed ? 0 : geometryModelResource->vertexOffset;
+
+			uint32_t dynamicOffsetCount = instanceResource->instanceContainers[geometryModelIndex].animated ? 1 : 0;
+			uint32_t dynamicOffset = static_cast<uint32_t>(animationArenaResource.frameSize * frameIndex);
+			vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, instanceResource->instanceContainers[geometryModelIndex].pipelineLayout, 0, 1, &instanceResource->instanceContainers[geometryModelIndex].descriptorSet, dynamicOffsetCount, &dynamicOffset);
 
 			uint32_t offset = 0;
 			vkCmdPushConstants(commandBuffer, instanceResource->instanceContainers[geometryModelIndex].pipelineLayout, VK_SHADER_STAGE_VERTEX_BIT, offset, sizeof(worldResource->viewProjection), &worldResource->viewProjection);
@@ -2423,21 +4897,104 @@ void RenderManager::draw(VkCommandBuffer commandBuffer, uint32_t frameIndex, Dra
 			offset += sizeof(geometryResource->count);
 			vkCmdPushConstants(commandBuffer, instanceResource->instanceContainers[geometryModelIndex].pipelineLayout, VK_SHADER_STAGE_VERTEX_BIT, offset, sizeof(geometryModelResource->targetsCount), &geometryModelResource->targetsCount);
 			offset += sizeof(geometryModelResource->targetsCount);
+			vkCmdPushConstants(commandBuffer, instanceResource->instanceContainers[geometryModelIndex].pipelineLayout, VK_SHADER_STAGE_VERTEX_BIT, offset, sizeof(vertexOffset), &vertexOffset);
+			offset += sizeof(vertexOffset);
+			vkCmdPushConstants(commandBuffer, instanceResource->instanceContainers[geometryModelIndex].pipelineLayout, VK_SHADER_STAGE_VERTEX_BIT, offset, sizeof(instanceResource->jointMatricesOffset), &instanceResource->jointMatricesOffset);
+			offset += sizeof(instanceResource->jointMatricesOffset);
+			vkCmdPushConstants(commandBuffer, instanceResource->instanceContainers[geometryModelIndex].pipelineLayout, VK_SHADER_STAGE_VERTEX_BIT, offset, sizeof(instanceResource->weightsOffset), &instanceResource->weightsOffset);
+			offset += sizeof(instanceResource->weightsOffset);
+			vkCmdPushConstants(commandBuffer, instanceResource->instanceContainers[geometryModelIndex].pipelineLayout, VK_SHADER_STAGE_VERTEX_BIT, offset, sizeof(worldResource->time), &worldResource->time);
+			offset += sizeof(worldResource->time);
+			if (instanceContainer.positionDequantize)
+			{
+				offset = offsetof(UniformPushConstant, positionDequantizeScale);
+				vkCmdPushConstants(commandBuffer, instanceResource->instanceContainers[geometryModelIndex].pipelineLayout, VK_SHADER_STAGE_VERTEX_BIT, offset, sizeof(geometryResource->positionDequantizeScale), &geometryResource->positionDequantizeScale);
+				offset += sizeof(geometryResource->positionDequantizeScale);
+				vkCmdPushConstants(commandBuffer, instanceResource->instanceContainers[geometryModelIndex].pipelineLayout, VK_SHADER_STAGE_VERTEX_BIT, offset, sizeof(geometryResource->positionDequantizeOffset), &geometryResource->positionDequantizeOffset);
+				offset += sizeof(geometryResource->positionDequantizeOffset);
+			}
+
+			if (instanceContainer.culled)
+			{
+				VkBuffer indexBuffer = instanceContainer.cullIndexBufferResources[frameIndex].bufferResource.buffer;
+				if (indexBuffer != boundIndexBuffer || boundIndexOffset != 0 || boundIndexType != VK_INDEX_TYPE_UINT32)
+				{
+					vkCmdBindIndexBuffer(commandBuffer, indexBuffer, 0, VK_INDEX_TYPE_UINT32);
+
+					boundIndexBuffer = indexBuffer;
+					boundIndexOffset = 0;
+					boundIndexType = VK_INDEX_TYPE_UINT32;
+				}
+			}
+			else if (geometryModelResource->indexBuffer != VK_NULL_HANDLE)
+			{
+				if (geometryModelResource->indexBuffer != boundIndexBuffer || geometryModelResource->indexOffset != boundIndexOffset || geometryModelResource->indexType != boundIndexType)
+				{
+					vkCmdBindIndexBuffer(commandBuffer, geometryModelResource->indexBuffer, geometryModelResource->indexOffset, geometryModelResource->indexType);
+
+					boundIndexBuffer = geometryModelResource->indexBuffer;
+					boundIndexOffset = geometryModelResource->indexOffset;
+					boundIndexType = geometryModelResource->indexType;
+				}
+			}
+
+			if (deformed)
+			{
+				uint32_t attributesCount = static_cast<uint32_t>(instanceContainer.deformVertexBuffersOffsets.size());
 
-			if (geometryModelResource->indexBuffer != VK_NULL_HANDLE)
+				vkCmdBindVertexBuffers(commandBuffer, 0, attributesCount, &instanceContainer.deformVertexBuffers[frameIndex * attributesCount], instanceContainer.deformVertexBuffersOffsets.data());
+
+				boundGeometryResource = nullptr;
+			}
+			else if (boundGeometryResource == nullptr || boundGeometryResource->vertexBuffers != geometryResource->vertexBuffers || boundGeometryResource->vertexBuffersOffsets != geometryResource->vertexBuffersOffsets)
+			{
+				vkCmdBindVertexBuffers(commandBuffer, 0, static_cast<uint32_t>(geometryResource->vertexBuffers.size()), geometryResource->vertexBuffers.data(), geometryResource->vertexBuffersOffsets.data());
+
+				boundGeometryResource = geometryResource;
+			}
+
+			uint32_t firstIndex = geometryModelResource->firstIndex;
+			uint32_t count = geometryModelResource->indexBuffer != VK_NULL_HANDLE ? geometryModelResource->indicesCount : geometryModelResource->verticesCount;
+			uint32_t fullResolutionCount = count;
+
+			// Members of a crowd are spread out, so the level of detail is not selected by the instance bounds.
+			uint32_t instanceCount = glm::max(instanceResource->crowdCount, 1u);
+
+			if (geometryModelResource->lods.size() > 0)
 			{
-				vkCmdBindIndexBuffer(commandBuffer, geometryModelResource->indexBuffer, geometryModelResource->indexOffset, geometryModelResource->indexType);
+				const GeometryModelLod& geometryModelLod = geometryModelResource->lods[instanceResource->crowdCount > 0 ? 0 : getLod(geometryModelResource, instanceResource->worldMatrix, worldResource->viewProjection)];
+
+				firstIndex += geometryModelLod.firstIndex;
+				count = geometryModelLod.indicesCount;
+				fullResolutionCount = geometryModelResource->lods[0].indicesCount;
 			}
 
-			vkCmdBindVertexBuffers(commandBuffer, 0, static_cast<uint32_t>(geometryResource->vertexBuffers.size()), geometryResource->vertexBuffers.data(), geometryResource->vertexBuffersOffsets.data());
+			if (instanceContainer.culled)
+			{
+				// Only known on the device, so the full resolution is counted.
+				count = fullResolutionCount;
 
-			if (geometryModelResource->indexBuffer != VK_NULL_HANDLE)
+				vkCmdDrawIndexedIndirect(commandBuffer, instanceContainer.cullDrawBufferResources[frameIndex].bufferResource.buffer, 0, 1, sizeof(VkDrawIndexedIndirectCommand));
+			}
+			else if (geometryModelResource->indexBuffer != VK_NULL_HANDLE)
 			{
-				vkCmdDrawIndexed(commandBuffer, geometryModelResource->indicesCount, 1, 0, 0, 0);
+				vkCmdDrawIndexed(commandBuffer, count, instanceCount, firstIndex, vertexOffset, 0);
 			}
 			else
 			{
-				vkCmdDraw(commandBuffer, geometryModelResource->verticesCount, 1, 0, 0);
+				vkCmdDraw(commandBuffer, count, instanceCount, static_cast<uint32_t>(vertexOffset), 0);
+			}
+
+			renderStatistics.drawCalls++;
+			if (geometryModelResource->topology == VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST)
+			{
+				renderStatistics.trianglesSubmitted += instanceCount * (count / 3);
+				renderStatistics.trianglesFullResolution += instanceCount * (fullResolutionCount / 3);
+			}
+			else if (geometryModelResource->topology == VK_PRIMITIVE_TOPOLOGY_TRIANGLE_STRIP || geometryModelResource->topology == VK_PRIMITIVE_TOPOLOGY_TRIANGLE_FAN)
+			{
+				renderStatistics.trianglesSubmitted += instanceCount * (count >= 3 ? count - 2 : 0);
+				renderStatistics.trianglesFullResolution += instanceCount * (count >= 3 ? count - 2 : 0);
 			}
 		}
 	}
@@ -11,6 +11,7 @@
 
 #include "SharedDataResource.h"
 #include "TextureDataResource.h"
+#include "TextureRegistryResource.h"
 #include "MaterialResource.h"
 #include "GeometryResource.h"
 #include "GeometryModelResource.h"
@@ -19,6 +20,9 @@
 #include "LightResource.h"
 #include "CameraResource.h"
 #include "WorldResource.h"
+#include "GeometryArenaResource.h"
+#include "AnimationArenaResource.h"
+#include "RenderStatistics.h"
 
 enum DrawMode {
 	ALL,
@@ -58,6 +62,40 @@ private:
 	std::map<uint64_t, CameraResource> cameraResources;
 	WorldResource worldResource;
 
+	// Images by the hash of their content and samplers by their parameters, shared and reference counted by the textures.
+	std::map<uint64_t, TextureImageResource> textureImageResources;
+	std::map<SamplerResourceCreateInfo, TextureSamplerResource> textureSamplerResources;
+
+	bool geometryArena = false;
+	uint32_t geometryArenaVerticesCapacity = 1048576;
+	uint32_t geometryArenaIndicesCapacity = 4194304;
+	std::vector<VertexArenaResource> vertexArenaResources;
+	std::vector<IndexArenaResource> indexArenaResources;
+
+	uint32_t animationArenaCapacity = 65536;
+	AnimationArenaResource animationArenaResource;
+
+	float lodThreshold = 1.0f;
+
+	bool clusterCulling = false;
+	VkDescriptorSetLayout cullDescriptorSetLayout = VK_NULL_HANDLE;
+	VkShaderModule cullShaderModule = VK_NULL_HANDLE;
+	VkPipelineLayout cullPipelineLayout = VK_NULL_HANDLE;
+	VkPipeline cullPipeline = VK_NULL_HANDLE;
+
+	bool deformPrepass = false;
+	VkDescriptorSetLayout deformDescriptorSetLayout = VK_NULL_HANDLE;
+	VkPipelineLayout deformPipelineLayout = VK_NULL_HANDLE;
+
+	RenderStatistics renderStatistics = {};
+
+	bool jointMatrices3x4 = false;
+	std::vector<glm::uvec4> weightsPacked;
+
+	// Shader sources and environment maps are read with many requests in flight.
+	AsyncIO asyncIO;
+	std::map<std::string, std::string> shaderSources;
+
 	void terminate(SharedDataResource& sharedDataResource, VkDevice device);
 	void terminate(TextureDataResource& textureResource, VkDevice device);
 	void terminate(MaterialResource& materialResource, VkDevice device);
@@ -68,6 +106,9 @@ private:
 	void terminate(LightResource& lightResource, VkDevice device);
 	void terminate(CameraResource& cameraResource, VkDevice device);
 	void terminate(WorldResource& worldResource, VkDevice device);
+	void terminate(VertexArenaResource& vertexArenaResource, VkDevice device);
+	void terminate(IndexArenaResource& indexArenaResource, VkDevice device);
+	void terminate(AnimationArenaResource& animationArenaResource, VkDevice device);
 
 	SharedDataResource* getSharedData(uint64_t sharedDataHandle);
 	TextureDataResource* getTexture(uint64_t textureHandle);
@@ -86,6 +127,42 @@ private:
 
 	bool sharedDataSetData(uint64_t sharedDataHandle, VkDeviceSize size, const void* data, VkBufferUsageFlags usage);
 
+	bool geometrySetVertexInput(GeometryResource* geometryResource, const std::string& description, uint32_t count, VkFormat format, uint32_t stride, int32_t& attributeIndex);
+
+	bool geometryArenaAllocate(GeometryResource* geometryResource);
+
+	bool geometryModelArenaAllocate(GeometryModelResource* geometryModelResource, const void* indices, uint32_t indicesCount, VkIndexType indexType);
+
+	bool animationArenaAllocate(uint32_t& offset, uint32_t count);
+	bool animationArenaUpload(uint32_t frameIndex);
+
+	void instanceWriteWeights(const InstanceResource* instanceResource, const std::vector<float>& weights);
+	void instanceWriteJointMatrices(const InstanceResource* instanceResource, const std::vector<glm::mat4>& jointMatrices);
+
+	bool cullSetup();
+	bool instanceCullFinalize(InstanceContainer& instanceContainer, const GeometryModelResource* geometryModelResource);
+
+	bool deformSetup();
+	bool instanceDeformFinalize(InstanceContainer& instanceContainer, const InstanceResource* instanceResource, const GeometryModelResource* geometryModelResource, const GeometryResource* geometryResource);
+
+	uint32_t getLod(const GeometryModelResource* geometryModelResource, const glm::mat4& worldMatrix, const ViewProjectionUniformPushConstant& viewProjection) const;
+
+	float getScreenSize(const glm::vec3& boundsCenter, float boundsRadius, const glm::mat4& worldMatrix, const ViewProjectionUniformPushConstant& viewProjection) const;
+
+	// All shader sources are read at once on first use.
+	bool getShaderSource(const std::string*& shaderSource, const std::string& filename);
+
+	void getTextureMemory(uint64_t& memory, uint64_t& memoryUncompressed, const ImageViewResource& imageViewResource, VkFormat format);
+	void addTextureMemory(const ImageViewResource& imageViewResource, VkFormat format);
+
+	// Covers the pixels and everything else, which changes the created image.
+	static uint64_t getImageHash(const TextureResourceCreateInfo& textureResourceCreateInfo);
+
+	// Checks, that a registered image with the same hash really has the same content.
+	bool isSameImage(const TextureImageResource& textureImageResource, const TextureResourceCreateInfo& textureResourceCreateInfo);
+
+	void destroyTextureImage(std::map<uint64_t, TextureImageResource>::iterator textureImageResource);
+
 public:
 
 	RenderManager();
@@ -102,6 +179,26 @@ public:
 
 	bool renderSetFrames(uint32_t frames);
 
+	// Vertex and index data is sub-allocated from large shared buffers. Has to be set before any geometry is created.
+	bool renderSetGeometryArena(bool geometryArena, uint32_t verticesCapacity = 1048576, uint32_t indicesCapacity = 4194304);
+
+	// Joint matrices and weights of all instances are sub-allocated from one buffer, capacity is counted in vectors. Has to be set before any instance is created.
+	bool renderSetAnimationArena(uint32_t capacity = 65536);
+
+	// Level of detail is selected, if the projected geometric error is below the given pixels. Zero always draws full resolution.
+	bool renderSetLodThreshold(float pixels);
+
+	void renderResetStatistics();
+
+	// Meshlets are culled against the frustum and their normal cone in a compute pass. Has to be set before any instance is finalized.
+	bool renderSetClusterCulling(bool clusterCulling);
+
+	// Joint matrices are uploaded as three rows. Has to be set before any joint matrices are created.
+	bool renderSetJointMatrices3x4(bool jointMatrices3x4);
+
+	// Skinning and morphing is done once per frame in a compute pass and drawn as static geometry. Has to be set before any geometry is created.
+	bool renderSetDeformPrepass(bool deformPrepass);
+
 	// Resources need to be created.
 
 	bool sharedDataCreate(uint64_t& sharedDataHandle);
@@ -124,28 +221,40 @@ public:
 	bool sharedDataCreateStorageBuffer(uint64_t sharedDataHandle, VkDeviceSize size, const void* data);
 
 	bool textureSetParameters(uint64_t textureHandle, const TextureResourceCreateInfo& textureResourceCreateInfo);
+	// Takes over the pixels, e.g. of mip maps generated only for this texture.
+	bool textureSetParameters(uint64_t textureHandle, TextureResourceCreateInfo&& textureResourceCreateInfo);
 
 	bool materialSetParameters(uint64_t materialHandle, const MaterialParameters& materialParameters);
 	bool materialSetTexture(uint64_t materialHandle, uint64_t textureHandle, const std::string& description, uint32_t texCoord = 0);
 
 	bool geometrySetAttribute(uint64_t geometryHandle, uint64_t sharedDataHandle, const std::string& description, uint32_t count, VkFormat format, uint32_t stride, VkDeviceSize offset, VkDeviceSize range);
 	bool geometrySetAttribute(uint64_t geometryHandle, uint64_t sharedDataHandle, const std::string& description, uint32_t count, VkFormat format);
+	bool geometrySetAttributeData(uint64_t geometryHandle, const std::string& description, uint32_t count, VkFormat format, uint32_t stride, const void* data);
+	bool geometrySetPositionDequantization(uint64_t geometryHandle, const glm::vec3& scale, const glm::vec3& offset);
+	bool geometrySetDeformData(uint64_t geometryHandle, const GeometryDeform& geometryDeform);
 
 	bool geometryModelSetGeometry(uint64_t geometryModelHandle, uint64_t geometryHandle);
 	bool geometryModelSetPrimitiveTopology(uint64_t geometryModelHandle, uint32_t mode);
 	bool geometryModelSetMaterial(uint64_t geometryModelHandle, uint64_t materialHandle);
 	bool geometryModelSetVertexCount(uint64_t geometryModelHandle, uint32_t verticesCount);
 	bool geometryModelSetIndices(uint64_t geometryModelHandle, uint64_t sharedDataHandle, uint32_t indicesCount, VkIndexType indexType, uint32_t indexOffset, uint32_t indexRange);
-	bool geometryModelSetTarget(uint64_t geometryModelHandle, uint64_t sharedDataHandle, const std::string& targetName);
-	bool geometryModelSetTargetsCount(uint64_t geometryModelHandle, uint32_t targetsCount);
+	bool geometryModelSetIndexData(uint64_t geometryModelHandle, uint32_t indicesCount, VkIndexType indexType, const void* data);
+	bool geometryModelSetTargets(uint64_t geometryModelHandle, const GeometryTargets& geometryTargets);
 	bool geometryModelSetCullMode(uint64_t geometryModelHandle, VkCullModeFlags cullMode);
+	bool geometryModelAddLod(uint64_t geometryModelHandle, uint32_t firstIndex, uint32_t indicesCount, float error);
+	bool geometryModelSetBounds(uint64_t geometryModelHandle, const glm::vec3& center, float radius);
+	bool geometryModelSetMeshlets(uint64_t geometryModelHandle, const std::vector<GeometryMeshlet>& meshlets, const std::vector<uint32_t>& meshletVertices, const std::vector<uint32_t>& meshletTriangles);
 
 	bool groupAddGeometryModel(uint64_t groupHandle, uint64_t geometryModelHandle);
 
 	bool instanceSetWorldMatrix(uint64_t instanceHandle, const glm::mat4& worldMatrix);
 	bool instanceSetGroup(uint64_t instanceHandle, uint64_t groupHandle);
-	bool instanceSetWeights(uint64_t instanceHandle, uint64_t sharedDataHandle);
-	bool instanceSetJointMatrices(uint64_t instanceHandle, uint64_t sharedDataHandle, uint32_t jointMatricesCount);
+	bool instanceSetWeights(uint64_t instanceHandle, const std::vector<float>& weights);
+	bool instanceSetJointMatrices(uint64_t instanceHandle, const std::vector<glm::mat4>& jointMatrices);
+	// Texture with three texels per joint in a row and one row per frame, looped over the duration. Excludes instanceSetJointMatrices().
+	bool instanceSetBakedJointMatrices(uint64_t instanceHandle, uint64_t textureHandle, uint32_t jointsCount, uint32_t framesCount, float duration);
+	// Draws the instance once per crowd member.
+	bool instanceSetCrowd(uint64_t instanceHandle, const std::vector<CrowdMember>& crowdMembers);
 
 	bool lightSetEnvironment(uint64_t lightHandle, const std::string& environment);
 
@@ -179,15 +288,32 @@ public:
 
 	bool worldGetCamera(uint64_t& cameraHandle);
 
+	bool isGeometryArena() const;
+
+	bool isJointMatrices3x4() const;
+
+	bool isDeformPrepass() const;
+
+	// Dequantization scale and offset are pushed after the other constants, which needs 256 bytes.
+	bool isPositionDequantizeSupported() const;
+
+	const RenderStatistics& renderGetStatistics() const;
+
+	// Projected diameter of the instance bounds in pixels with the current camera, zero if outside of the view frustum. Skinned bounds follow the last joint matrices.
+	bool instanceGetScreenSize(float& screenSize, uint64_t instanceHandle);
+
 	// Update also after finalization.
 
 	bool instanceUpdateWorldMatrix(uint64_t instanceHandle, const glm::mat4& worldMatrix);
-	bool instanceUpdateWeights(uint64_t instanceHandle, const std::vector<float>& weights, uint32_t frameIndex);
-	bool instanceUpdateJointMatrices(uint64_t instanceHandle, const std::vector<glm::mat4>& jointMatrices, uint32_t frameIndex);
+	// Uploaded for all instances at once, by the first deform or draw call of a frame.
+	bool instanceUpdateWeights(uint64_t instanceHandle, const std::vector<float>& weights);
+	bool instanceUpdateJointMatrices(uint64_t instanceHandle, const std::vector<glm::mat4>& jointMatrices);
 
 	bool cameraUpdateProjectionMatrix(uint64_t cameraHandle, const glm::mat4& projectionMatrix);
 	bool cameraUpdateViewMatrix(uint64_t cameraHandle, const glm::mat4& viewMatrix);
 
+	bool worldUpdateTime(float time);
+
 	// Delete and free data.
 
 	bool sharedDataDelete(uint64_t sharedDataHandle);
@@ -218,6 +344,12 @@ public:
 	// Rendering
 	//
 
+	// Records the cluster culling. Has to be called outside of the render pass and before drawing the frame.
+	void cull(VkCommandBuffer commandBuffer, uint32_t frameIndex);
+
+	// Records the deformation pre-pass. Has to be called outside of the render pass and before drawing the frame.
+	void deform(VkCommandBuffer commandBuffer, uint32_t frameIndex);
+
 	void draw(VkCommandBuffer commandBuffer, uint32_t frameIndex, DrawMode drawMode);
 
 };
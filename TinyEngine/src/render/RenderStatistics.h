@@ -0,0 +1,38 @@
+#ifndef RENDER_RENDERSTATISTICS_H_
+#define RENDER_RENDERSTATISTICS_H_
+
+#include <cstdint>
+
+// Accumulated by every draw until reset.
+struct RenderStatistics {
+
+	uint64_t drawCalls = 0;
+
+	uint64_t trianglesSubmitted = 0;
+
+	// Triangles, if every geometry model would have been drawn at full resolution.
+	uint64_t trianglesFullResolution = 0;
+
+	// Deformation pre-pass dispatches and the ones skipped, as weights and joint matrices did not change.
+	uint64_t deformDispatches = 0;
+	uint64_t deformSkipped = 0;
+
+	// Cluster culling dispatches and the meshlets tested by them.
+	uint64_t cullDispatches = 0;
+	uint64_t meshletsTested = 0;
+
+	// Uploads of the animation arena, at most one per frame.
+	uint64_t animationUploads = 0;
+	uint64_t animationUploadBytes = 0;
+
+	// Device memory of all textures and what it would be with uncompressed images. Not reset per frame.
+	uint64_t textureMemory = 0;
+	uint64_t textureMemoryUncompressed = 0;
+
+	// Textures and samplers, which reused an existing image with the same content or sampler with the same parameters. Not reset per frame.
+	uint64_t texturesDeduplicated = 0;
+	uint64_t samplersDeduplicated = 0;
+
+};
+
+#endif /* RENDER_RENDERSTATISTICS_H_ */
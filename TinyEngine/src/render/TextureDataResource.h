@@ -11,8 +11,12 @@ struct TextureDataResource : BaseResource {
 
 	TextureResourceCreateInfo textureResourceCreateInfo = {};
 
+	// Image and sampler are owned by the registry of the render manager.
 	TextureResource textureResource = {};
 
+	uint64_t imageHash = 0;
+	SamplerResourceCreateInfo samplerResourceCreateInfo = {};
+
 	int32_t textureIndex = -1;
 
 };
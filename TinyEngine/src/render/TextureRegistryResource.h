@@ -0,0 +1,58 @@
+#ifndef RENDER_TEXTUREREGISTRYRESOURCE_H_
+#define RENDER_TEXTUREREGISTRYRESOURCE_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "../composite/Composite.h"
+
+// Image of one level and face, without the pixels.
+struct TextureImageLayout {
+
+	uint32_t width = 0;
+	uint32_t height = 0;
+	VkFormat format = VK_FORMAT_UNDEFINED;
+
+	uint32_t mipLevel = 0;
+	uint32_t face = 0;
+
+	size_t size = 0;
+
+};
+
+// Image shared by all textures with the same content. Destroyed with the last texture using it.
+struct TextureImageResource {
+
+	ImageViewResource imageViewResource = {};
+
+	// Including the levels generated on the device.
+	uint32_t mipLevels = 1;
+
+	uint32_t references = 0;
+
+	// Compared on a hash hit, as the hash alone does not prove the same content.
+	std::vector<TextureImageLayout> imageLayouts;
+	uint32_t imageMipLevels = 1;
+	uint32_t faceCount = 1;
+	bool mipMap = false;
+
+	// Texture the image was created from. Its pixels are compared as well, as long as it exists.
+	uint64_t textureHandle = 0;
+
+	// Removed from the statistics, when the image is destroyed.
+	uint64_t memory = 0;
+	uint64_t memoryUncompressed = 0;
+
+};
+
+// Sampler shared by all textures with the same parameters. Destroyed with the last texture using it.
+struct TextureSamplerResource {
+
+	SamplerResource samplerResource = {};
+
+	uint32_t references = 0;
+
+};
+
+#endif /* RENDER_TEXTUREREGISTRYRESOURCE_H_ */
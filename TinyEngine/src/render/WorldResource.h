@@ -21,6 +21,38 @@ struct UniformPushConstant {
 	uint32_t verticesCount = 0;
 
 	uint32_t targetsCount = 0;
+
+	uint32_t vertexOffset = 0;
+
+	uint32_t jointMatricesOffset = 0;
+	uint32_t weightsOffset = 0;
+
+	float time = 0.0f;
+
+	// Aligned to 16 bytes, as in the shader.
+	float padding[2] = {0.0f, 0.0f};
+
+	glm::vec4 positionDequantizeScale = glm::vec4(1.0f, 1.0f, 1.0f, 0.0f);
+	glm::vec4 positionDequantizeOffset = glm::vec4(0.0f);
+};
+
+// Frustum planes and camera position are in model space.
+struct CullPushConstant {
+	glm::vec4 planes[6];
+	glm::vec4 camera = glm::vec4(0.0f, 0.0f, 0.0f, 1.0f);
+
+	uint32_t meshletsCount = 0;
+
+	uint32_t coneCulling = 0;
+};
+
+struct DeformPushConstant {
+	uint32_t verticesCount = 0;
+
+	uint32_t targetsCount = 0;
+
+	uint32_t jointMatricesOffset = 0;
+	uint32_t weightsOffset = 0;
 };
 
 struct WorldResource : BaseResource {
@@ -35,6 +67,9 @@ struct WorldResource : BaseResource {
 
 	ViewProjectionUniformPushConstant viewProjection = {};
 
+	// Seconds, used by baked animations.
+	float time = 0.0f;
+
 };
 
 #endif /* RENDER_WORLDRESOURCE_H_ */
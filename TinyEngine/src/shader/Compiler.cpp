@@ -1,9 +1,39 @@
 #include "Compiler.h"
 
+#include <mutex>
+
 #include "../common/Common.h"
 
+static std::mutex compiledShadersMutex;
+static std::map<uint64_t, CompiledShader> compiledShaders;
+
 bool Compiler::buildShader(std::vector<uint32_t>& spirv, const std::string& source, const std::map<std::string, std::string>& macros, shaderc_shader_kind shaderKind, shaderc_optimization_level optimizationLevel)
 {
+  std::string macroSet = "";
+  for (const auto& it : macros)
+  {
+	  macroSet += it.first + "=" + it.second + "\n";
+  }
+
+  uint64_t key = HelperHash::hash(source);
+  key = HelperHash::combine(key, HelperHash::hash(macroSet));
+  key = HelperHash::combine(key, static_cast<uint64_t>(shaderKind));
+  key = HelperHash::combine(key, static_cast<uint64_t>(optimizationLevel));
+
+  {
+	  std::lock_guard<std::mutex> lock(compiledShadersMutex);
+
+	  auto compiledShader = compiledShaders.find(key);
+	  if (compiledShader != compiledShaders.end())
+	  {
+		  spirv = compiledShader->second.spirv;
+
+		  return true;
+	  }
+  }
+
+  //
+
   shaderc::Compiler compiler;
   shaderc::CompileOptions options;
 
@@ -30,5 +60,32 @@ bool Compiler::buildShader(std::vector<uint32_t>& spirv, const std::string& sour
 
   spirv = {result.cbegin(), result.cend()};
 
+  CompiledShader compiledShader = {};
+  compiledShader.key = key;
+  compiledShader.macros = macroSet;
+  compiledShader.spirv = spirv;
+
+  addCompiledShader(compiledShader);
+
   return true;
 }
+
+void Compiler::addCompiledShader(const CompiledShader& compiledShader)
+{
+  std::lock_guard<std::mutex> lock(compiledShadersMutex);
+
+  compiledShaders[compiledShader.key] = compiledShader;
+}
+
+std::vector<CompiledShader> Compiler::getCompiledShaders()
+{
+  std::lock_guard<std::mutex> lock(compiledShadersMutex);
+
+  std::vector<CompiledShader> result;
+  for (const auto& it : compiledShaders)
+  {
+	  result.push_back(it.second);
+  }
+
+  return result;
+}
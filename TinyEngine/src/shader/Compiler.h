@@ -8,10 +8,23 @@
 
 #include <shaderc/shaderc.hpp>
 
+// Compiled shader with the macros it was built with.
+struct CompiledShader {
+	uint64_t key = 0;
+	std::string macros = "";
+	std::vector<uint32_t> spirv;
+};
+
 class Compiler
 {
 public:
+	// Results are kept by a hash of the source, macros, kind and optimization level, so each variant is only compiled once.
 	static bool buildShader(std::vector<uint32_t>& spirv, const std::string& source, const std::map<std::string, std::string>& macros, shaderc_shader_kind shaderKind, shaderc_optimization_level optimizationLevel = shaderc_optimization_level_zero);
+
+	// Previously compiled shaders, e.g. from a scene cache.
+	static void addCompiledShader(const CompiledShader& compiledShader);
+
+	static std::vector<CompiledShader> getCompiledShaders();
 };
 
 #endif /* SHADER_COMPILER_H_ */